@@ -7,4 +7,7 @@ class MemoryAllocationFailureError(BaseException):
 class ReadingProcessMemoryFailureError(BaseException):
     pass
 class WritingProcessMemoryFailureError(BaseException):
-    pass
\ No newline at end of file
+    pass
+
+class ScanCancelledError(BaseException):
+    pass
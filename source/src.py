@@ -1,23 +1,437 @@
-from ..utils.backend.dist.memory_extract import createAddressArray, get_pid_by_name,getHandleByPID, freeAddressArray
-from ..utils.backend.dist.memory_extract import scanINT, scanFLOAT, scanDOUBLE, scanNextINT, scanNextDOUBLE, scanNextFLOAT, RPM_INT, RPM_DOUBLE, RPM_FLOAT, WPM_DOUBLE, WPM_FLOAT, WPM_INT
-from ..errors.errors import MemoryAllocationFailureError, ReadingProcessMemoryFailureError, WritingProcessMemoryFailureError
+from ..utils.backend.memory_extract import createAddressArray, get_pid_by_name,getHandleByPID, freeAddressArray
+from ..utils.backend.memory_extract import HANDLE, UCharAddressVector, findProcessIdsByName, setProcessTableAge, closeHandle, scanTypedMulti
+from ..utils.backend.memory_extract import readAddressArray, writeAddressArray, scanPattern, scanString, GroupTerm, scanGroup
+from ..utils.backend.memory_extract import WatchEvent, createWatcher, freeWatcher, drainWatcher, getWatcherPendingCount, getWatcherSampleCount, getWatcherDroppedCount, setWatcherInterval
+from ..utils.backend.memory_extract import RegionFilter, createRegionMap, filterRegionMap, refreshRegionMap, freeRegionMap, getRegionCount, getRegionMapSize, getRegion, setScanRegionMap
+from ..utils.backend.memory_extract import getScanThreadCount, setScanThreadCount, setNextScanGap
+from ..utils.backend.memory_extract import ScanStats, setScanStats, getScanStatsEnabled, getLastScanStats, isExported
+from ..utils.backend.memory_extract import scanTyped, scanNextTyped, scanTypedSet, scanNextTypedSet
+from ..utils.backend.memory_extract import ScanTaskStatus, startScanTyped, cancelScanTask, waitScanTask, getScanTaskStatus, drainScanTask, getScanTaskPendingCount, freeScanTask
+from ..utils.backend.memory_extract import createScanSession, openScanSession, matchScanSession, scanTypedSession, scanNextTypedSession, closeScanSession, flushScanSession
+from ..utils.backend.memory_extract import getScanSessionCount, getScanSessionType, getScanSessionValueWidth, getScanSessionProcessId, getScanSessionScanCount, copyScanSessionRecords
+from ..utils.backend.memory_extract import createValueStore, freeValueStore, scanTypedStore, scanNextTypedStore, scanNextRelativeStore, getValueStoreCount, getValueStoreMemoryUsage, copyValueStoreRecords
+from ..utils.backend.memory_extract import createSnapshot, updateSnapshot, getSnapshotPageCount, getSnapshotMemoryUsage, freeSnapshot
+from ..utils.backend.memory_extract import createCandidateArray, freeCandidateArray, getCandidateCount, getCandidateAddress, copyCandidateAddresses, getCandidateMemoryUsage
+from ..utils.backend.memory_extract import scanNextSetINT, scanNextSetFLOAT, scanNextSetDOUBLE
+from ..utils.backend.memory_extract import createPointerMap, freePointerMap, getPointerMapSize, savePointerMap, loadPointerMap
+from ..utils.backend.memory_extract import createPointerPathArray, freePointerPathArray, getPointerPathCount, getPointerPath, scanPointerPaths, intersectPointerPaths, resolvePointerPath
+from ..utils.backend.memory_extract import scanSnapshotINT, scanSnapshotFLOAT, scanSnapshotDOUBLE, scanNextSnapshotINT, scanNextSnapshotFLOAT, scanNextSnapshotDOUBLE
+from ..utils.backend.memory_extract import scanINT, scanFLOAT, scanDOUBLE, scanNextINT, scanNextDOUBLE, scanNextFLOAT
+from ..utils.backend.memory_extract import UCP, RPM_INT, RPM_FLOAT, RPM_DOUBLE, WPM_INT, WPM_FLOAT, WPM_DOUBLE
+from ..errors.errors import MemoryAllocationFailureError, ReadingProcessMemoryFailureError, WritingProcessMemoryFailureError, ScanCancelledError
 import ctypes
+import os
+import struct
+import threading
 import time
 from collections import Counter
 from typing import Union
 
 
+PREDICATES = {
+    "equal": 0,
+    "epsilon": 1,
+    "range": 2,
+    "less": 3,
+    "greater": 4,
+    "masked": 5,
+}
+
+
+def _predicate_args(predicate, value, operand, datatype):
+    """
+    Converts a predicate name and its operands into the arguments of the scanTyped* functions.
+
+    Args:
+    - predicate (str)            : One of PREDICATES.
+    - value (int or float)       : The value ("equal", "epsilon", "less", "greater", "masked") or lower bound ("range").
+    - operand (int, float, None) : The epsilon, upper bound or bit mask. Unused by "equal", "less" and "greater".
+    - datatype (str)             : One of SCAN_TYPES.
+
+    Returns:
+    - tuple: (predicate code, value, operand), the operands as ctypes values of the data type.
+
+    Raises:
+    - ValueError: If the predicate is unknown, an operand is missing, has the wrong type
+                  or does not fit in the data type.
+
+    For "masked" the operand is an integer bit mask and the value is compared on its raw
+    bits; for FLOAT and DOUBLE the mask is passed with its bits reinterpreted.
+    """
+    if predicate not in PREDICATES:
+        raise ValueError("Unknown predicate, expected one of: " + ", ".join(PREDICATES))
+    if operand is None:
+        if predicate in ("epsilon", "range", "masked"):
+            raise ValueError("The '" + predicate + "' predicate needs an operand!")
+        operand = 0
+    value_type = VALUE_TYPES[datatype]
+    if datatype not in ("FLOAT", "DOUBLE"):
+        if not isinstance(value, int) or not isinstance(operand, int):
+            raise ValueError("Expected an integer!")
+        if predicate == "masked":
+            return PREDICATES[predicate], _from_bits(value_type, value), _from_bits(value_type, operand)
+        return PREDICATES[predicate], _integer_value(value, datatype), _integer_value(operand, datatype)
+    if predicate == "masked":
+        if not isinstance(operand, int):
+            raise ValueError("Expected an integer bit mask!")
+        # Passed as a ctypes value, a Python float could quiet NaN bit patterns.
+        return PREDICATES[predicate], value_type(float(value)), _from_bits(value_type, operand)
+    if not isinstance(value, (int, float)) or not isinstance(operand, (int, float)):
+        raise ValueError("Expected a floating point value!")
+    return PREDICATES[predicate], value_type(float(value)), value_type(float(operand))
+
+
+def _from_bits(value_type, bits):
+    """
+    Returns the ctypes value of 'value_type' whose raw bits are the low bits of the integer 'bits'.
+    """
+    size = ctypes.sizeof(value_type)
+    return value_type.from_buffer_copy((bits & ((1 << (8 * size)) - 1)).to_bytes(size, "little"))
+
+
+def _integer_value(value, datatype):
+    """
+    Returns 'value' as the ctypes value of an integer data type.
+
+    Raises:
+    - ValueError: If 'value' is not an integer or does not fit in the data type.
+    """
+    if not isinstance(value, int):
+        raise ValueError("Expected an integer!")
+    bits = 8 * ctypes.sizeof(VALUE_TYPES[datatype])
+    low, high = (0, (1 << bits) - 1) if datatype.startswith("UINT") else (-(1 << (bits - 1)), (1 << (bits - 1)) - 1)
+    if not low <= value <= high:
+        raise ValueError(str(value) + " does not fit in " + datatype + "!")
+    return VALUE_TYPES[datatype](value)
+
+
+def _scan_type(datatype):
+    """
+    Returns the native type tag of a data type name.
+
+    Raises:
+    - ValueError: If 'datatype' is not one of SCAN_TYPES.
+    """
+    if datatype not in SCAN_TYPES:
+        raise ValueError("Unknown data type, expected one of: " + ", ".join(SCAN_TYPES))
+    return SCAN_TYPES[datatype]
+
+
+REGIONS = {
+    "writable": 1,
+    "executable": 2,
+    "readonly": 4,
+}
+
+ENCODINGS = {
+    "ascii": 0,
+    "utf-16": 1,
+}
+
+# Data types of the scans and their native type tags (SCAN_TYPE_* in valuetypes.h).
+# INTEGER, FLOAT and DOUBLE are the 32 bit int, float and 64 bit double.
+SCAN_TYPES = {
+    "INT8": 0,
+    "UINT8": 1,
+    "INT16": 2,
+    "UINT16": 3,
+    "INTEGER": 4,
+    "UINT32": 5,
+    "INT64": 6,
+    "UINT64": 7,
+    "FLOAT": 8,
+    "DOUBLE": 9,
+}
+
+VALUE_TYPES = {
+    "INT8": ctypes.c_int8,
+    "UINT8": ctypes.c_uint8,
+    "INT16": ctypes.c_int16,
+    "UINT16": ctypes.c_uint16,
+    "INTEGER": ctypes.c_int,
+    "UINT32": ctypes.c_uint32,
+    "INT64": ctypes.c_int64,
+    "UINT64": ctypes.c_uint64,
+    "FLOAT": ctypes.c_float,
+    "DOUBLE": ctypes.c_double,
+}
+
+VALUE_FORMATS = {
+    "INT8": "<b",
+    "UINT8": "<B",
+    "INT16": "<h",
+    "UINT16": "<H",
+    "INTEGER": "<i",
+    "UINT32": "<I",
+    "INT64": "<q",
+    "UINT64": "<Q",
+    "FLOAT": "<f",
+    "DOUBLE": "<d",
+}
+
+
+def _address_view(address_array):
+    """
+    Returns the addresses of a native address array as a ctypes array of c_size_t
+    laid over the native memory, without copying.
+
+    The view supports the buffer protocol (memoryview, numpy.frombuffer) and is only
+    valid until the array is scanned again or freed.
+    """
+    vector = address_array.contents
+    if vector.size == 0:
+        return (ctypes.c_size_t * 0)()
+    data = ctypes.cast(vector.array, ctypes.c_void_p).value
+    return (ctypes.c_size_t * vector.size).from_address(data)
+
+
+def _address_pointer(address_array, index=None):
+    """
+    Returns the address of element 'index' of a native address array, to pass a
+    slice of it to readAddressArray / writeAddressArray. None returns the start of
+    the array, for calls covering all of it.
+
+    Raises:
+    - IndexError: If 'index' is out of range.
+    """
+    vector = address_array.contents
+    start = ctypes.cast(vector.array, ctypes.c_void_p).value
+    if index is None:
+        return start
+    if index < 0:
+        index += vector.size
+    if not 0 <= index < vector.size:
+        raise IndexError("Address index out of range!")
+    return start + index * ctypes.sizeof(ctypes.c_void_p)
+
+
+def _status_ok(status, count):
+    """
+    Returns True if the first 'count' bits of a readAddressArray / writeAddressArray
+    status bitmap are all set.
+    """
+    full, rest = divmod(count, 8)
+    return all(b == 0xFF for b in status[:full]) and (rest == 0 or status[full] & ((1 << rest) - 1) == (1 << rest) - 1)
+
+
+# The single address reads and writes of a library built before readAddressArray / writeAddressArray.
+SINGLE_READS = {"INTEGER": RPM_INT, "FLOAT": RPM_FLOAT, "DOUBLE": RPM_DOUBLE}
+SINGLE_WRITES = {"INTEGER": WPM_INT, "FLOAT": WPM_FLOAT, "DOUBLE": WPM_DOUBLE}
+
+
+def _read_addresses(hProcess, addresses, count, datatype, values, status):
+    """
+    Reads 'count' values of 'datatype' from the addresses at 'addresses' (see _address_pointer)
+    into the ctypes array 'values', with readAddressArray. A library without that export
+    reads one address per RPM_* call instead.
+
+    Returns the number of values read, or -1 on allocation failure.
+    """
+    if isExported(readAddressArray) or datatype not in SINGLE_READS:
+        return readAddressArray(hProcess, addresses, count, ctypes.sizeof(VALUE_TYPES[datatype]), values, status)
+    if count == 0:
+        return 0
+    read_value = SINGLE_READS[datatype]
+    data = VALUE_TYPES[datatype]()
+    read = 0
+    for i, address in enumerate((ctypes.c_size_t * count).from_address(addresses)):
+        if read_value(hProcess, ctypes.cast(address, UCP), ctypes.byref(data)):
+            values[i] = data.value
+            read += 1
+            if status is not None:
+                status[i // 8] |= 1 << (i % 8)
+    return read
+
+
+def _write_addresses(hProcess, addresses, count, datatype, value):
+    """
+    Writes the ctypes 'value' of 'datatype' to 'count' addresses at 'addresses' (see
+    _address_pointer), with writeAddressArray. A library without that export writes
+    one address per WPM_* call instead.
+
+    Returns the number of values written, or -1 on allocation failure.
+    """
+    if isExported(writeAddressArray) or datatype not in SINGLE_WRITES:
+        return writeAddressArray(hProcess, addresses, count, ctypes.sizeof(value), ctypes.byref(value), 0, None)
+    if count == 0:
+        return 0
+    write_value = SINGLE_WRITES[datatype]
+    written = 0
+    for address in (ctypes.c_size_t * count).from_address(addresses):
+        if write_value(hProcess, ctypes.cast(address, UCP), value):
+            written += 1
+    return written
+
+
+def _check_alignment(alignment):
+    """
+    Raises ValueError unless 'alignment' is 0 (the size of the data type), 1, 2, 4 or 8.
+    """
+    if alignment not in (0, 1, 2, 4, 8):
+        raise ValueError("Expected an alignment of 1, 2, 4 or 8 bytes!")
+
+
+def _group_term(term, anchor):
+    """
+    Converts a term of MemoryScanner.group_scan into a native GroupTerm.
+
+    Args:
+    - term (tuple or dict): (datatype, value), (datatype, value, offset) or a dict with the keys
+                            "value" and optionally "datatype", "predicate", "operand" and "offset".
+    - anchor (bool)       : True for the first term, which is always at offset 0.
+
+    Raises:
+    - ValueError: If the term, its datatype, predicate or operands are invalid.
+    """
+    if isinstance(term, dict):
+        spec = dict(term)
+    elif isinstance(term, tuple) and len(term) in (2, 3):
+        spec = {"datatype": term[0], "value": term[1], "offset": term[2] if len(term) == 3 else None}
+    else:
+        raise ValueError("Expected a term as (datatype, value), (datatype, value, offset) or a dict!")
+    if "value" not in spec:
+        raise ValueError("A term needs a value!")
+    datatype = spec.get("datatype", "INTEGER")
+    offset = 0 if anchor else spec.get("offset")
+    if offset is not None and not isinstance(offset, int):
+        raise ValueError("Expected an integer offset!")
+    type_tag = _scan_type(datatype)
+    code, a, b = _predicate_args(spec.get("predicate", "equal"), spec["value"], spec.get("operand"), datatype)
+    native = GroupTerm()
+    native.type = type_tag
+    native.kind = code
+    native.offset = offset or 0
+    native.fixed = int(offset is not None)
+    ctypes.memmove(native.a, ctypes.byref(a), ctypes.sizeof(a))
+    ctypes.memmove(native.b, ctypes.byref(b), ctypes.sizeof(b))
+    return native
+
+
+SCAN_STATS_FIELDS = {
+    "regionsVisited": "regions_visited",
+    "regionsSkipped": "regions_skipped",
+    "regionsFailed": "regions_failed",
+    "bytesRead": "bytes_read",
+    "readCalls": "read_calls",
+    "readFailures": "read_failures",
+    "candidates": "candidates",
+    "hits": "hits",
+    "reallocs": "reallocs",
+    "nsRegions": "regions_ns",
+    "nsRead": "read_ns",
+    "nsCompare": "compare_ns",
+    "nsMerge": "merge_ns",
+    "nsTotal": "total_ns",
+}
+
+
+def _last_scan_stats():
+    """
+    Returns the telemetry of the last finished scan as a dict, or None if scan
+    telemetry is off (see MemoryScanner.set_scan_stats) or the loaded library
+    predates it.
+    """
+    if not isExported(getScanStatsEnabled) or not getScanStatsEnabled():
+        return None
+    stats = ScanStats()
+    getLastScanStats(ctypes.byref(stats))
+    return {name: getattr(stats, field) for field, name in SCAN_STATS_FIELDS.items()}
+
+
+class MemoryWatcher:
+    def __init__(self, watcher, dt):
+        """
+        Initialize a new instance of MemoryWatcher.
+
+        Args:
+        - watcher (int): The pointer to the native watcher, already sampling.
+        - dt (str)     : The data type of the watched values.
+
+        Returns:
+        - MemoryWatcher() object
+        """
+        self.__watcher = watcher
+        self.__datatype = dt
+
+    @property
+    def samples(self) -> int:
+        """
+        Returns the number of samples taken so far.
+        """
+        return getWatcherSampleCount(self.__watcher)
+
+    @property
+    def dropped(self) -> int:
+        """
+        Returns the number of changes lost because drain() was not called often enough.
+        """
+        return getWatcherDroppedCount(self.__watcher)
+
+    @property
+    def pending(self) -> int:
+        """
+        Returns the number of changes waiting to be drained.
+        """
+        return getWatcherPendingCount(self.__watcher)
+
+    def set_interval(self, interval):
+        """
+        Changes the time between two samples, in seconds. Takes effect after the current wait.
+        """
+        setWatcherInterval(self.__watcher, max(0, int(interval * 1000000)))
+
+    def drain(self, max_events=None) -> list:
+        """
+        Takes the queued changes without blocking the sampler.
+
+        Args:
+        - max_events (int, optional): Take at most this many changes. Default takes all pending ones.
+
+        Returns:
+        - list: (address, old value, new value, timestamp) tuples, oldest first. The
+                timestamp is the time of the sample in monotonic nanoseconds.
+        """
+        count = self.pending
+        if max_events is not None:
+            count = min(count, max_events)
+        if count == 0:
+            return []
+        events = (WatchEvent * count)()
+        count = drainWatcher(self.__watcher, events, count)
+        fmt = VALUE_FORMATS[self.__datatype]
+        return [(event.address,
+                 struct.unpack_from(fmt, bytes(event.oldValue))[0],
+                 struct.unpack_from(fmt, bytes(event.newValue))[0],
+                 event.timestamp) for event in events[:count]]
+
+    def close(self):
+        """
+        Stops the sampler thread and frees the watcher.
+        """
+        if self.__watcher:
+            freeWatcher(self.__watcher)
+            self.__watcher = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
 
 class MemoryNextScan:
-    def __init__(self, hProcess, address_array, result, dt):
+    def __init__(self, hProcess, address_array, result, dt, stats=True, owns_handle=False):
         """
         Initialize a new instance of MemoryNextScan.
 
         Args:
         - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
         - address_array (ctypes.POINTER)   : The pointer to the address array.
-        - result (list)                    : The list of found addresses.
+        - result (list, None)              : The list of found addresses, or None to build it on first access.
         - dt (str)                         : The data type of the scan.
+        - stats (bool)                     : Whether the scan that found the addresses records telemetry.
+        - owns_handle (bool)               : Whether close() also closes 'hProcess'.
         
         Returns:
         - MemoryNextScan() object
@@ -26,6 +440,9 @@ class MemoryNextScan:
         self.__address_array = address_array
         self.__result = result
         self.__datatype = dt
+        self.__stats = _last_scan_stats() if stats else None
+        self.__convert_ns = 0
+        self.__owns_handle = owns_handle
     def __enter__(self):
         """
         Enter the context manager.
@@ -47,49 +464,182 @@ class MemoryNextScan:
         - None, but MemoryNextScan() object with updated address_list
 
         Raises:
-        - ValueError: If the type of 'data' is not which was used for new_scan.
+        - ValueError                  : If the type of 'data' is not which was used for new_scan.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
         """
         if self.__datatype == "INTEGER":
             if isinstance(data, int):
-                scanNextINT(self.__hProcess, self.__address_array, data)
+                res = scanNextINT(self.__hProcess, self.__address_array, data)
             else:
                 
                 raise ValueError("Expected an integer!")
         elif self.__datatype == "FLOAT":
             if isinstance(data, float):
-                scanNextFLOAT(self.__hProcess, self.__address_array, data)
+                res = scanNextFLOAT(self.__hProcess, self.__address_array, data)
             else:
                 
                 raise ValueError("Expected a float!")
         elif self.__datatype == "DOUBLE":
             if isinstance(data, (float)):
-                scanNextDOUBLE(self.__hProcess, self.__address_array, data)
+                res = scanNextDOUBLE(self.__hProcess, self.__address_array, data)
             else:
                 
                 raise ValueError("Expected a floating point value!")
+        else:
+            self.next_predicate_scan("equal", data)
+            return
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
         self.__update_result()
 
-    def __update_result(self):
+    def next_predicate_scan(self, predicate, value, operand=None):
         """
-        Updates the address_list by reading the memory of each found address.
+        Keeps only the found addresses whose current value satisfies the predicate.
 
         Args:
-        - None
+        - predicate (str)                      : "equal", "epsilon", "range", "less", "greater" or "masked".
+        - value (int or float)                 : The value, or the lower bound for "range".
+        - operand (int or float, optional)     : The epsilon, the upper bound for "range" or the bit mask for "masked".
+
+        Returns:
+        - None, but MemoryNextScan() object with updated address_list
+
+        Raises:
+        - ValueError                  : If the predicate is unknown or an operand has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        code, a, b = _predicate_args(predicate, value, operand, self.__datatype)
+        res = scanNextTyped(self.__hProcess, self.__address_array, SCAN_TYPES[self.__datatype], code,
+                            ctypes.byref(a), ctypes.byref(b))
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        self.__update_result()
+
+    def compare_snapshot(self, snapshot, mode, delta=0):
+        """
+        Keeps only the found addresses whose value compares to the value stored in
+        'snapshot' as described by 'mode'.
+
+        Args:
+        - snapshot (MemorySnapshot): The snapshot to compare against.
+        - mode (str)               : One of MemorySnapshot.MODES.
+        - delta (int or float)     : The difference used by "increased_by" and "decreased_by".
+
+        Returns:
+        - None, but MemoryNextScan() object with updated address_list
+
+        Raises:
+        - ValueError                      : If 'mode' is unknown or the snapshot data type differs.
+        - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
+        """
+        if snapshot.datatype != self.__datatype:
+            raise ValueError("The snapshot was taken for a different data type!")
+        res = snapshot._compare_next(self.__address_array, mode, delta)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        self.__update_result(stats=False)
+
+    def __update_result(self, stats=True):
+        """
+        Drops the cached address_list after the address array changed.
+
+        Args:
+        - stats (bool): Whether the scan that changed it records telemetry (snapshot compares do not).
 
         Returns:
         - None
 
-        This method clears the current list of found addresses and then iterates over each address
-        in the address array. It reads the memory at each address, converts it to an integer,
-        and appends the hexadecimal representation of the address to the result list.
+        The list of hex strings is rebuilt from the native array the next time
+        address_list is accessed, so scans that never look at it skip the conversion.
+        """
+        self.__result = None
+        self.__stats = _last_scan_stats() if stats else None
+        self.__convert_ns = 0
+
+    @property
+    def stats(self):
+        """
+        Returns the telemetry of the scan that last changed the found addresses.
+
+        Returns:
+        - dict or None: None if scan telemetry was off (see MemoryScanner.set_scan_stats).
+          Otherwise counters (regions_visited, regions_skipped, regions_failed, bytes_read,
+          read_calls, read_failures, candidates, hits, reallocs) and phase times in
+          nanoseconds (regions_ns, read_ns, compare_ns, merge_ns, total_ns), plus
+          convert_ns, the time spent building address_list in Python.
+
+        The native counters are those of the last scan finished in the process, so take
+        them before another scan runs on a different thread.
+        """
+        if self.__stats is None:
+            return None
+        return dict(self.__stats, convert_ns=self.__convert_ns)
+
+    @property
+    def addresses(self):
+        """
+        Returns the found addresses as a ctypes array of c_size_t over the native
+        address array, without copying. It supports the buffer protocol, e.g.
+        memoryview(scan.addresses) or numpy.frombuffer(scan.addresses, dtype=numpy.uintp).
+
+        The view is only valid until the next scan or close().
+        """
+        return _address_view(self.__address_array)
+
+    def values(self, status=False):
+        """
+        Reads the current value of every found address with one batched native call.
+
+        Args:
+        - status (bool, optional): Also return the per address status bitmap. Default is False.
+
+        Returns:
+        - ctypes array: One c_int, c_float or c_double per address, in address order.
+                        Values that could not be read are 0. Supports the buffer protocol.
+        - or (values, status) if 'status' is True, where bit (i % 8) of status[i // 8]
+          is set if value i was read.
+
+        Raises:
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        size = self.__address_array.contents.size
+        values = (VALUE_TYPES[self.__datatype] * size)()
+        bitmap = (ctypes.c_ubyte * ((size + 7) // 8))() if status else None
+        res = _read_addresses(self.__hProcess, _address_pointer(self.__address_array), size,
+                              self.__datatype, values, bitmap)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        return (values, bitmap) if status else values
+
+    def __value(self, data):
         """
-        _found_address = self.__address_array.contents
-        self.__result.clear()
-        for i in range(_found_address.size):
-            char_ptr = _found_address.array[i]
-            address_as_int = ctypes.cast(char_ptr, ctypes.c_void_p).value
-            hex_address = hex(address_as_int) 
-            self.__result.append(hex_address)
+        Returns 'data' as the ctypes value of the scan's data type.
+        """
+        if self.__datatype not in ("FLOAT", "DOUBLE"):
+            return _integer_value(int(data), self.__datatype)
+        return VALUE_TYPES[self.__datatype](data)
+
+    def to_numpy(self, values=False):
+        """
+        Returns the found addresses as a NumPy array sharing the native memory.
+
+        Args:
+        - values (bool, optional): Also return a NumPy array of the current values. Default is False.
+
+        Returns:
+        - numpy.ndarray, or (addresses, values) if 'values' is True. The address array
+          is only valid until the next scan or close(), copy it to keep it longer.
+
+        Raises:
+        - ImportError: If NumPy is not installed.
+        """
+        import numpy
+        addresses = numpy.frombuffer(self.addresses, dtype=numpy.uintp)
+        if not values:
+            return addresses
+        return addresses, numpy.frombuffer(self.values(), dtype=VALUE_TYPES[self.__datatype])
 
 
     def write_address_list(self, data):
@@ -105,34 +655,19 @@ class MemoryNextScan:
         Raises:
         - WritingProcessMemoryFailureError: If the write operation fails for any address.
 
-        This function iterates over all addresses in address_list. For each address,
-        it writes the given data to the memory. If the write operation fails for any address,
-        a WritingProcessMemoryFailureError is raised.
+        All addresses are written with one native call, adjacent addresses as a single
+        transfer. If any address cannot be written, the others are still written and a
+        WritingProcessMemoryFailureError is raised.
         """
-        _found_address = self.__address_array.contents
-        if self.__datatype == 'INTEGER':
-            for i in range(_found_address.size):
-                writing_address = _found_address.array[i]
-                if not WPM_INT(self.__hProcess, writing_address, int(data)):
-                    
-                    raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
-
-        elif self.__datatype == "DOUBLE":
-            for i in range(_found_address.size):
-                writing_address = _found_address.array[i]
-                if not WPM_DOUBLE(self.__hProcess, writing_address, ctypes.c_double(data)):
-                    
-                    raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
-        elif self.__datatype == "FLOAT":
-            for i in range(_found_address.size):
-                writing_address = _found_address.array[i]
-
-                if not WPM_FLOAT(self.__hProcess, writing_address, float(data)):
-                    
-                    raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
+        size = self.__address_array.contents.size
+        value = self.__value(data)
+        written = _write_addresses(self.__hProcess, _address_pointer(self.__address_array), size,
+                                   self.__datatype, value)
+        if written == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        if written != size:
+            raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
 
-        
-    
     def write_memory(self, address_index, data):
         """
         Writes the given data to the memory address at the specified index of address_list.
@@ -145,33 +680,18 @@ class MemoryNextScan:
         - bool: True if the write operation is successful, False otherwise.
 
         Raises:
+        - IndexError                      : If 'address_index' is out of range.
         - WritingProcessMemoryFailureError: If the write operation fails.
 
-        This function writes the given data to the memory address at the specified index.
-        It checks the data type of the given data and calls the appropriate write function
-        (WPM_INT, WPM_FLOAT, or WPM_DOUBLE) based on the data type. If the write operation
-        is successful, it returns True. Otherwise, it raises a WritingProcessMemoryFailureError.
+        This function converts the data to the data type of the scan and writes it to the
+        memory address at the specified index. If the write operation is successful, it
+        returns True. Otherwise, it raises a WritingProcessMemoryFailureError.
         """
-        _found_address = self.__address_array.contents
-        writing_address = _found_address.array[address_index]
-        if self.__datatype == "INTEGER":
-            if WPM_INT(self.__hProcess, writing_address, data):
-                return True
-            else:
-                
-                raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
-        elif self.__datatype == "FLOAT":
-            if WPM_FLOAT(self.__hProcess, writing_address, data):
-                return True
-            else:
-                
-                raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
-        elif self.__datatype == "DOUBLE":
-            if WPM_DOUBLE(self.__hProcess, writing_address, ctypes.c_double(data)):
-                return True
-            else:
-                
-                raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
+        value = self.__value(data)
+        if _write_addresses(self.__hProcess, _address_pointer(self.__address_array, address_index), 1,
+                            self.__datatype, value) == 1:
+            return True
+        raise WritingProcessMemoryFailureError('Failed to write memory to the process!')
 
     def read_memory(self, address_index: int) -> Union[int, float]:
         """
@@ -185,38 +705,17 @@ class MemoryNextScan:
                              If the data type is FLOAT or DOUBLE, it returns a float.
 
         Raises:
+        - IndexError                      : If 'address_index' is out of range.
         - ReadingProcessMemoryFailureError: If the read operation fails.
 
-        This function reads the memory at the specified index of the address_list. It checks the data type of the addresses
-        and calls the appropriate read function (RPM_INT, RPM_FLOAT, or RPM_DOUBLE) based on the data type. If the read operation
-        is successful, it returns the value read from the memory. Otherwise, it raises a ReadingProcessMemoryFailureError.
+        Use values() to read every address at once.
         """
-        _found_address = self.__address_array.contents
-        reading_address = _found_address.array[address_index]
-
-        if self.__datatype == "INTEGER":
-            data = ctypes.c_int(0)
-            if RPM_INT(self.__hProcess, reading_address, ctypes.byref(data)):
-                return data.value
-            else:
-                
-                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-        elif self.__datatype == "FLOAT":
-            data = ctypes.c_float(0)
-            if RPM_FLOAT(self.__hProcess, reading_address, ctypes.byref(data)):
-                return data.value
-            else:
-                
-                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-        elif self.__datatype == "DOUBLE":
-            data = ctypes.c_double(0)
-            if RPM_DOUBLE(self.__hProcess, reading_address, ctypes.byref(data)):
-                return data.value
-            else:
-                
-                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+        data = (VALUE_TYPES[self.__datatype] * 1)()
+        if _read_addresses(self.__hProcess, _address_pointer(self.__address_array, address_index), 1,
+                           self.__datatype, data, None) == 1:
+            return data[0]
+        raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
 
-        
     @property
     def address_list(self):
         """
@@ -224,10 +723,41 @@ class MemoryNextScan:
 
         Returns:
         - list: A list of hexadecimal strings representing the memory addresses.
+
+        The list is built on first access after a scan; use 'addresses' or to_numpy()
+        to avoid the conversion for large results.
         """
+        if self.__result is None:
+            start = time.perf_counter_ns()
+            self.__result = [hex(address) for address in self.addresses]
+            self.__convert_ns = time.perf_counter_ns() - start
         return self.__result
 
 
+    def watch(self, interval=0.001, capacity=65536) -> MemoryWatcher:
+        """
+        Starts a native thread sampling the found addresses and queueing every change.
+
+        Args:
+        - interval (float, optional): Seconds between two samples. Default is 0.001.
+        - capacity (int, optional)  : Changes kept until drained, rounded up to a power of two.
+                                      Further changes are dropped and counted. Default is 65536.
+
+        Returns:
+        - MemoryWatcher: Call drain() to take the changes, close() to stop.
+
+        Raises:
+        - MemoryAllocationFailureError: If the watcher cannot be created.
+
+        The watcher copies the current address list, later scans do not change what it watches.
+        """
+        size = self.__address_array.contents.size
+        watcher = createWatcher(self.__hProcess, _address_pointer(self.__address_array), size,
+                                ctypes.sizeof(VALUE_TYPES[self.__datatype]), max(0, int(interval * 1000000)), capacity)
+        if not watcher:
+            raise MemoryAllocationFailureError('Failed to create the watcher!')
+        return MemoryWatcher(watcher, self.__datatype)
+
     def monitor_scan(self, on_change ,min_addresses_to_exit_monitor=10,interval=10):
         """
         Monitors the memory addresses for changes and triggers a callback function.
@@ -251,33 +781,12 @@ class MemoryNextScan:
         The monitoring loop continues until the callback function returns a result of True and until the number of addresses
         falls below 'min_addresses_to_exit_monitor'.
         """
-        _found_address = self.__address_array.contents
-        res = []
         prev = None
         while True:
-            for i in range(_found_address.size):
-                reading_address = _found_address.array[i]
-                if self.__datatype == "INTEGER":
-                    data = ctypes.c_int(0)
-                    if RPM_INT(self.__hProcess, reading_address, ctypes.byref(data)):
-                        res.append(data.value)
-                    else:
-                        
-                        raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-                elif self.__datatype == "FLOAT":
-                    data = ctypes.c_float(0)
-                    if RPM_FLOAT(self.__hProcess, reading_address, ctypes.byref(data)):
-                        res.append(data.value)
-                    else:
-                        
-                        raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-                elif self.__datatype == "DOUBLE":
-                    data = ctypes.c_double(0)
-                    if RPM_DOUBLE(self.__hProcess, reading_address, ctypes.byref(data)):
-                        res.append(data.value)
-                    else:
-                        
-                        raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')       
+            values, status = self.values(status=True)
+            if not _status_ok(status, len(values)):
+                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+            res = list(values)
 
             ctr = Counter(res)
             if prev:
@@ -285,13 +794,12 @@ class MemoryNextScan:
                     result, target = on_change(res, ctr)
                     if result:
                         self.next_scan(target)
-                        if len(self.__result) < min_addresses_to_exit_monitor:
+                        if self.__address_array.contents.size < min_addresses_to_exit_monitor:
                             return
                     prev = ctr.copy()
             else:
                 prev = ctr.copy()
             time.sleep(interval)
-            res.clear()
 
     def __repr__(self) -> str:
         """
@@ -307,7 +815,7 @@ class MemoryNextScan:
         - str: A string representation of the MemoryNextScan object. The string contains
                the hexadecimal representation of the addresses found during the last scan.
         """
-        return str((self.__result))
+        return str(self.address_list)
     
     def __str__(self) -> str:
         """
@@ -323,7 +831,7 @@ class MemoryNextScan:
         - str: A string representation of the MemoryNextScan object. The string contains
                the hexadecimal representation of the addresses found during the last scan.
         """
-        return str(self.__result)
+        return str(self.address_list)
     
     def close(self) -> str:
         """
@@ -339,6 +847,9 @@ class MemoryNextScan:
         - None
         """
         freeAddressArray(self.__address_array)
+        if self.__owns_handle:
+            closeHandle(self.__hProcess)
+            self.__owns_handle = False
         del self
 
     def __exit__(self):
@@ -356,103 +867,2017 @@ class MemoryNextScan:
 
 
 
-class MemoryScanner(object):
-    def __init__(self, processPID: int):
-        """
-        Initialize a new instance of MemoryScanner.
+class MemorySnapshot:
+    MODES = {
+        "changed": 0,
+        "unchanged": 1,
+        "increased": 2,
+        "decreased": 3,
+        "increased_by": 4,
+        "decreased_by": 5,
+    }
 
-        This constructor opens a handle to the process with the given process ID,
-        creates an address array, and initializes the necessary attributes.
+    def __init__(self, hProcess, snapshot, dt):
+        """
+        Initialize a new instance of MemorySnapshot.
 
-        Parameters:
-        - processPID (int): The process ID of the target process.
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - snapshot (int)                   : The pointer to the native snapshot.
+        - dt (str)                         : The data type compared by the scans.
 
         Returns:
-        - None
+        - MemorySnapshot() object
+        """
+        self.__hProcess = hProcess
+        self.__snapshot = snapshot
+        self.__datatype = dt
 
-        Raises:
-        - None
+    @property
+    def datatype(self) -> str:
+        """
+        Returns the data type compared by the scans of this snapshot.
+        """
+        return self.__datatype
 
+    @property
+    def page_count(self) -> int:
         """
-        self.__pid = processPID
-        self.__hProcess = getHandleByPID(self.__pid)
-        self.__address_array = createAddressArray()
+        Returns the number of memory pages stored in the snapshot.
+        """
+        return getSnapshotPageCount(self.__snapshot)
+
+    @property
+    def memory_usage(self) -> int:
+        """
+        Returns the number of bytes the snapshot occupies in this process.
 
-    def new_scan(self, data, isdouble=False) -> MemoryNextScan:
+        Zero pages take no storage, mostly zero pages are stored sparsely and
+        identical pages are stored once, so this is usually far below
+        page_count * 4096.
         """
-        Initiates a new memory scan with the given data.
+        return getSnapshotMemoryUsage(self.__snapshot)
 
-        Parameters:
-        - data (int, float)        : The value to search for in the memory.
-        - isdouble (bool, optional): A flag indicating whether the data is of type double. Default is False.
+    def __mode(self, mode, delta):
+        if mode not in self.MODES:
+            raise ValueError("Unknown mode, expected one of: " + ", ".join(self.MODES))
+        if self.__datatype == "INTEGER":
+            if not isinstance(delta, int):
+                raise ValueError("Expected an integer!")
+        elif not isinstance(delta, (int, float)):
+            raise ValueError("Expected a floating point value!")
+        return self.MODES[mode]
+
+    def compare(self, mode, delta=0, alignment=0) -> MemoryNextScan:
+        """
+        Compares the live memory of the process against the snapshot.
+
+        Args:
+        - mode (str)          : "changed", "unchanged", "increased", "decreased",
+                                "increased_by" or "decreased_by".
+        - delta (int or float): The difference used by "increased_by" and "decreased_by". Default is 0.
+        - alignment (int)     : Compare every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+                                Values crossing a 4096 byte page are not compared.
 
         Returns:
-        - MemoryNextScan: An instance of MemoryNextScan containing the results of the scan.
+        - MemoryNextScan: An instance of MemoryNextScan containing every matching address.
 
         Raises:
+        - ValueError                      : If 'mode' is unknown or 'delta' has the wrong type.
         - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
         - ReadingProcessMemoryFailureError: If reading memory from the process fails.
         """
-        if isinstance(data, int):
-            res = scanINT(self.__hProcess, data, self.__address_array)
-            if res == -1:
-                raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
-            elif res == -2:
-                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-            elif res == 1:
-                _found_address = self.__address_array.contents
-                result = []
-                for i in range(_found_address.size):
-                    char_ptr = _found_address.array[i]
-                    address_as_int = ctypes.cast(char_ptr, ctypes.c_void_p).value
-                    hex_address = hex(address_as_int) 
-                    result.append(hex_address)
-                return MemoryNextScan(self.__hProcess, self.__address_array, result, "INTEGER")
-        elif isdouble:
-            res = scanDOUBLE(self.__hProcess, data, self.__address_array)
-            if res == -1:
-                raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
-            elif res == -2:
-                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-            elif res == 1:
-                _found_address = self.__address_array.contents
-                result = []
-                for i in range(_found_address.size):
-                    char_ptr = _found_address.array[i]
-                    address_as_int = ctypes.cast(char_ptr, ctypes.c_void_p).value
-                    hex_address = hex(address_as_int) 
-                    result.append(hex_address)
-                return MemoryNextScan(self.__hProcess, self.__address_array, result, "DOUBLE")
-        elif isinstance(data, float):
-            res = scanFLOAT(self.__hProcess, data, self.__address_array)
-            if res == -1:
-                raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
-            elif res == -2:
-                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
-            elif res == 1:
-                _found_address = self.__address_array.contents
-                result = []
-                for i in range(_found_address.size):
-                    char_ptr = _found_address.array[i]
-                    address_as_int = ctypes.cast(char_ptr, ctypes.c_void_p).value
-                    hex_address = hex(address_as_int) 
-                    result.append(hex_address)
-                return MemoryNextScan(self.__hProcess, self.__address_array, result, "FLOAT")
+        code = self.__mode(mode, delta)
+        _check_alignment(alignment)
+        address_array = createAddressArray()
+        if self.__datatype == "INTEGER":
+            res = scanSnapshotINT(self.__hProcess, self.__snapshot, code, delta, alignment, address_array)
+        elif self.__datatype == "FLOAT":
+            res = scanSnapshotFLOAT(self.__hProcess, self.__snapshot, code, float(delta), alignment, address_array)
+        else:
+            res = scanSnapshotDOUBLE(self.__hProcess, self.__snapshot, code, float(delta), alignment, address_array)
+        if res == -1:
+            freeAddressArray(address_array)
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -2:
+            freeAddressArray(address_array)
+            raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+        return MemoryNextScan(self.__hProcess, address_array, None, self.__datatype, stats=False)
+
+    def _compare_next(self, address_array, mode, delta):
+        code = self.__mode(mode, delta)
+        if self.__datatype == "INTEGER":
+            return scanNextSnapshotINT(self.__hProcess, self.__snapshot, address_array, code, delta)
+        elif self.__datatype == "FLOAT":
+            return scanNextSnapshotFLOAT(self.__hProcess, self.__snapshot, address_array, code, float(delta))
+        return scanNextSnapshotDOUBLE(self.__hProcess, self.__snapshot, address_array, code, float(delta))
 
+    def update(self):
+        """
+        Replaces the stored memory with the current memory of the process, so the
+        next compare() is relative to now.
 
-    
-    @staticmethod
-    def get_process_id_by_name(data: str) -> int:
+        Raises:
+        - MemoryAllocationFailureError: If memory allocation for the snapshot fails.
         """
-        Retrieves the process ID of a process by its name.
+        if updateSnapshot(self.__hProcess, self.__snapshot) == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the snapshot!')
+
+    def close(self):
+        """
+        Frees the memory held by the snapshot.
+        """
+        if self.__snapshot:
+            freeSnapshot(self.__snapshot)
+            self.__snapshot = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+
+class MemoryCandidateSet:
+    COPY_CHUNK = 65536
+
+    def __init__(self, hProcess, candidates, dt):
+        """
+        Initialize a new instance of MemoryCandidateSet.
+
+        Unlike MemoryNextScan the found addresses stay in the native, compressed
+        candidate set and are only converted to Python integers when indexed or
+        iterated, so scans with millions of results stay cheap.
 
         Args:
-        - data (str): The name of the process.
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - candidates (int)                 : The pointer to the native candidate set.
+        - dt (str)                         : The data type of the scan.
 
         Returns:
-        - int: The process ID of the process. If the process is not found, returns 0.
+        - MemoryCandidateSet() object
+        """
+        self.__hProcess = hProcess
+        self.__candidates = candidates
+        self.__datatype = dt
+        self.__stats = _last_scan_stats()
 
-        This function uses the `get_pid_by_name` function from the `pywinmemscanner.utils.backend.dist.memory_extract` module.
-        It encodes the process name as UTF-8 and passes it to the `get_pid_by_name` function to retrieve the process ID.
+    @property
+    def datatype(self) -> str:
         """
-        return get_pid_by_name(data.encode('utf-8'))
+        Returns the data type of the scan.
+        """
+        return self.__datatype
+
+    @property
+    def memory_usage(self) -> int:
+        """
+        Returns the number of bytes the candidate set occupies in this process.
+        """
+        return getCandidateMemoryUsage(self.__open_candidates())
+
+    @property
+    def stats(self):
+        """
+        Returns the telemetry of the scan that last changed the candidates, like
+        MemoryNextScan.stats (without convert_ns), or None if it was off.
+        """
+        return None if self.__stats is None else dict(self.__stats)
+
+    def __open_candidates(self):
+        if not self.__candidates:
+            raise ValueError("The candidate set is closed!")
+        return self.__candidates
+
+    def __len__(self) -> int:
+        return getCandidateCount(self.__open_candidates())
+
+    def __getitem__(self, index: int) -> int:
+        """
+        Returns the address of the candidate at 'index' as an integer.
+
+        Raises:
+        - IndexError: If 'index' is out of range.
+        - ValueError: If the set is closed.
+        """
+        count = len(self)
+        if index < 0:
+            index += count
+        if index < 0 or index >= count:
+            raise IndexError("Candidate index out of range!")
+        return getCandidateAddress(self.__open_candidates(), index)
+
+    def __iter__(self):
+        """
+        Yields every address in ascending order, copied out in chunks.
+        """
+        candidates = self.__open_candidates()
+        buffer = (ctypes.c_void_p * self.COPY_CHUNK)()
+        start = 0
+        while True:
+            copied = copyCandidateAddresses(candidates, start, self.COPY_CHUNK, buffer)
+            for i in range(copied):
+                yield buffer[i]
+            if copied < self.COPY_CHUNK:
+                return
+            start += copied
+
+    @property
+    def address_list(self):
+        """
+        Returns the found addresses as a list of hex strings, like MemoryNextScan.address_list.
+        """
+        return [hex(address) for address in self]
+
+    def next_scan(self, data):
+        """
+        Keeps only the candidates whose current value equals 'data'.
+
+        Args:
+        - data (int or float): The new value to which the old value was changed from.
+
+        Raises:
+        - ValueError                  : If the type of 'data' is not which was used for the first scan.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        if self.__datatype == "INTEGER":
+            if not isinstance(data, int):
+                raise ValueError("Expected an integer!")
+            res = scanNextSetINT(self.__hProcess, self.__open_candidates(), data)
+        elif self.__datatype == "FLOAT":
+            if not isinstance(data, float):
+                raise ValueError("Expected a float!")
+            res = scanNextSetFLOAT(self.__hProcess, self.__open_candidates(), data)
+        elif self.__datatype == "DOUBLE":
+            if not isinstance(data, float):
+                raise ValueError("Expected a floating point value!")
+            res = scanNextSetDOUBLE(self.__hProcess, self.__open_candidates(), data)
+        else:
+            self.next_predicate_scan("equal", data)
+            return
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        self.__stats = _last_scan_stats()
+
+    def next_predicate_scan(self, predicate, value, operand=None):
+        """
+        Keeps only the candidates whose current value satisfies the predicate.
+
+        Args:
+        - predicate (str)                 : "equal", "epsilon", "range", "less", "greater" or "masked".
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound for "range" or the bit mask for "masked".
+
+        Raises:
+        - ValueError                  : If the predicate is unknown or an operand has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        code, a, b = _predicate_args(predicate, value, operand, self.__datatype)
+        res = scanNextTypedSet(self.__hProcess, self.__open_candidates(), SCAN_TYPES[self.__datatype], code,
+                               ctypes.byref(a), ctypes.byref(b))
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        self.__stats = _last_scan_stats()
+
+    def __repr__(self) -> str:
+        if not self.__candidates:
+            return "MemoryCandidateSet(" + self.__datatype + ", closed)"
+        return "MemoryCandidateSet(" + self.__datatype + ", " + str(len(self)) + " addresses)"
+
+    def close(self):
+        """
+        Frees the memory held by the candidate set.
+        """
+        if self.__candidates:
+            freeCandidateArray(self.__candidates)
+            self.__candidates = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+
+class MemoryScanTask:
+    POLL_INTERVAL = 0.05
+    DRAIN_CHUNK = 65536
+
+    def __init__(self, hProcess, task, results, candidates, dt, on_hits=None, queue=None):
+        """
+        Initialize a new instance of MemoryScanTask.
+
+        The scan runs on native threads; none of the methods below block except wait()
+        and result(), and those only for as long as asked.
+
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - task (int)                       : The pointer to the native scan task, already running.
+        - results                          : The address array or candidate set the scan writes to.
+        - candidates (bool)                : True if 'results' is a candidate set.
+        - dt (str)                         : The data type of the scan.
+        - on_hits (callable, optional)     : Called with every list of streamed addresses.
+        - queue (queue.Queue, optional)    : Receives every list of streamed addresses, then None.
+
+        Returns:
+        - MemoryScanTask() object
+        """
+        self.__hProcess = hProcess
+        self.__task = task
+        self.__results = results
+        self.__candidates = candidates
+        self.__datatype = dt
+        self.__result = None
+        self.__pump = None
+        if on_hits is not None or queue is not None:
+            self.__pump = threading.Thread(target=self.__deliver, args=(on_hits, queue), daemon=True)
+            self.__pump.start()
+
+    def __deliver(self, on_hits, queue):
+        """
+        Hands the streamed addresses to 'on_hits' and 'queue' until the scan has finished.
+        """
+        while True:
+            finished = waitScanTask(self.__task, int(self.POLL_INTERVAL * 1000000))
+            hits = self.drain()
+            if hits:
+                if on_hits is not None:
+                    on_hits(hits)
+                if queue is not None:
+                    queue.put(hits)
+            if finished and getScanTaskPendingCount(self.__task) == 0:
+                break
+        if queue is not None:
+            queue.put(None)
+
+    @property
+    def status(self) -> dict:
+        """
+        Returns the progress of the scan: bytes_done, bytes_total, chunks_done, chunks_total,
+        hits, finished and cancelled. The totals are 0 until the regions have been listed.
+        """
+        status = ScanTaskStatus()
+        getScanTaskStatus(self.__task, ctypes.byref(status))
+        return {"bytes_done": status.bytesDone, "bytes_total": status.bytesTotal,
+                "chunks_done": status.chunksDone, "chunks_total": status.chunksTotal,
+                "hits": status.hits, "finished": bool(status.finished), "cancelled": bool(status.cancelled)}
+
+    @property
+    def progress(self) -> float:
+        """
+        Returns the scanned share of the memory, from 0.0 to 1.0.
+        """
+        status = self.status
+        if status["finished"]:
+            return 1.0
+        return status["bytes_done"] / status["bytes_total"] if status["bytes_total"] else 0.0
+
+    @property
+    def done(self) -> bool:
+        """
+        Returns True once the scan has finished, completely or because it was cancelled.
+        """
+        return bool(waitScanTask(self.__task, 0))
+
+    @property
+    def pending(self) -> int:
+        """
+        Returns the number of streamed addresses waiting to be drained.
+        """
+        return getScanTaskPendingCount(self.__task)
+
+    def cancel(self):
+        """
+        Asks the scan to stop. It stops once the chunks being scanned are done; result() then
+        raises ScanCancelledError.
+        """
+        cancelScanTask(self.__task)
+
+    def wait(self, timeout=None) -> bool:
+        """
+        Waits until the scan has finished.
+
+        Args:
+        - timeout (float, optional): Give up after this many seconds. Default waits without limit.
+
+        Returns:
+        - bool: True if the scan has finished.
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            step = self.POLL_INTERVAL if deadline is None else min(self.POLL_INTERVAL, max(0.0, deadline - time.monotonic()))
+            if waitScanTask(self.__task, int(step * 1000000)):
+                return True
+            if deadline is not None and time.monotonic() >= deadline:
+                return False
+
+    def drain(self, max_hits=None) -> list:
+        """
+        Takes the addresses streamed so far. Only available when the scan was started with
+        stream=True, on_hits or queue; the addresses of a chunk arrive when the chunk is done,
+        so they are not sorted across chunks.
+
+        Args:
+        - max_hits (int, optional): Take at most this many addresses. Default takes all pending ones.
+
+        Returns:
+        - list: The addresses as integers.
+        """
+        hits = []
+        buffer = (ctypes.c_void_p * self.DRAIN_CHUNK)()
+        while max_hits is None or len(hits) < max_hits:
+            want = self.DRAIN_CHUNK if max_hits is None else min(self.DRAIN_CHUNK, max_hits - len(hits))
+            count = drainScanTask(self.__task, buffer, want)
+            hits.extend(buffer[:count])
+            if count < want:
+                break
+        return hits
+
+    def result(self, timeout=None):
+        """
+        Waits for the scan and returns its result.
+
+        Args:
+        - timeout (float, optional): Give up after this many seconds. Default waits without limit.
+
+        Returns:
+        - MemoryNextScan, or MemoryCandidateSet for a scan started with candidates=True.
+
+        Raises:
+        - TimeoutError                    : If the scan is still running after 'timeout' seconds.
+        - ScanCancelledError              : If the scan was cancelled.
+        - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
+        - ReadingProcessMemoryFailureError: If reading memory from the process fails.
+        """
+        if self.__result is not None:
+            return self.__result
+        if not self.wait(timeout):
+            raise TimeoutError("The scan is still running!")
+        status = ScanTaskStatus()
+        getScanTaskStatus(self.__task, ctypes.byref(status))
+        if status.result == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif status.result == -2:
+            raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+        elif status.result == -5:
+            raise ScanCancelledError('The scan was cancelled!')
+        if self.__candidates:
+            self.__result = MemoryCandidateSet(self.__hProcess, self.__results, self.__datatype)
+        else:
+            self.__result = MemoryNextScan(self.__hProcess, self.__results, None, self.__datatype)
+        return self.__result
+
+    def __repr__(self) -> str:
+        return "MemoryScanTask(" + self.__datatype + ", " + str(round(self.progress * 100, 1)) + "%)"
+
+    def close(self):
+        """
+        Cancels the scan if it still runs and frees the task. A result taken with result()
+        stays valid; otherwise the found addresses are freed too.
+        """
+        if not self.__task:
+            return
+        cancelScanTask(self.__task)
+        if self.__pump is not None and self.__pump is not threading.current_thread():
+            self.__pump.join()
+        freeScanTask(self.__task)
+        self.__task = None
+        if self.__result is None:
+            if self.__candidates:
+                freeCandidateArray(self.__results)
+            else:
+                freeAddressArray(self.__results)
+        self.__results = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+
+class MemoryScanSession:
+    COPY_CHUNK = 65536
+
+    def __init__(self, hProcess, session, dt, path):
+        """
+        Initialize a new instance of MemoryScanSession.
+
+        The found addresses, and optionally their last read values, live in a memory
+        mapped file instead of the heap: the set can be larger than RAM, next scans
+        filter the file in place and the file can be opened again later with
+        MemoryScanner.open_session.
+
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - session (int)                    : The pointer to the native session.
+        - dt (str)                         : The data type of the scans.
+        - path (str)                       : The session file.
+
+        Returns:
+        - MemoryScanSession() object
+        """
+        self.__hProcess = hProcess
+        self.__session = session
+        self.__datatype = dt
+        self.__path = path
+
+    @property
+    def datatype(self) -> str:
+        """
+        Returns the data type of the scans.
+        """
+        return self.__datatype
+
+    @property
+    def path(self) -> str:
+        """
+        Returns the path of the session file.
+        """
+        return self.__path
+
+    @property
+    def process_id(self) -> int:
+        """
+        Returns the id of the process the session was taken from.
+
+        Raises:
+        - OSError: If the session file could not be mapped again after a failed scan.
+        """
+        pid = getScanSessionProcessId(self.__session)
+        if pid == -4:
+            raise OSError("The session file is no longer mapped!")
+        return pid
+
+    @property
+    def scan_count(self) -> int:
+        """
+        Returns the number of scans applied to the session, the first scan included.
+        """
+        return getScanSessionScanCount(self.__session)
+
+    @property
+    def has_values(self) -> bool:
+        """
+        Returns True if the session stores the last value read at every address.
+
+        Raises:
+        - OSError: If the session file could not be mapped again after a failed scan.
+        """
+        width = getScanSessionValueWidth(self.__session)
+        if width == -4:
+            raise OSError("The session file is no longer mapped!")
+        return width != 0
+
+    def __len__(self) -> int:
+        return getScanSessionCount(self.__session)
+
+    def __getitem__(self, index: int) -> int:
+        """
+        Returns the address at 'index' as an integer.
+
+        Raises:
+        - IndexError: If 'index' is out of range.
+        """
+        count = len(self)
+        if index < 0:
+            index += count
+        if index < 0 or index >= count:
+            raise IndexError("Session index out of range!")
+        address = ctypes.c_ulonglong()
+        copyScanSessionRecords(self.__session, index, 1, ctypes.byref(address), None)
+        return address.value
+
+    def __iter__(self):
+        """
+        Yields every address in ascending order, copied out of the file in chunks.
+        """
+        buffer = (ctypes.c_ulonglong * self.COPY_CHUNK)()
+        start = 0
+        while True:
+            copied = copyScanSessionRecords(self.__session, start, self.COPY_CHUNK, buffer, None)
+            for i in range(copied):
+                yield buffer[i]
+            if copied < self.COPY_CHUNK:
+                return
+            start += copied
+
+    def values(self, start=0, count=None) -> list:
+        """
+        Returns the values read at the addresses [start, start + count) by the last scan.
+
+        Args:
+        - start (int, optional): The index of the first address. Default is 0.
+        - count (int, optional): The number of values. Default is up to the last address.
+
+        Returns:
+        - list: The values, as int or float.
+
+        Raises:
+        - ValueError: If the session does not store values.
+        """
+        if not self.has_values:
+            raise ValueError("The session does not store values!")
+        total = len(self)
+        if count is None or count > total - start:
+            count = max(total - start, 0)
+        value_type = VALUE_TYPES[self.__datatype]
+        result = []
+        while count > 0:
+            chunk = min(count, self.COPY_CHUNK)
+            buffer = (value_type * chunk)()
+            copied = copyScanSessionRecords(self.__session, start, chunk, None, buffer)
+            result.extend(buffer[:copied])
+            if copied < chunk:
+                break
+            start += copied
+            count -= copied
+        return result
+
+    def next_scan(self, data):
+        """
+        Keeps only the addresses whose current value equals 'data'.
+
+        Args:
+        - data (int or float): The new value to which the old value was changed from.
+
+        Raises:
+        - ValueError                  : If 'data' has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        - OSError                     : If the session file cannot be accessed.
+        """
+        self.next_predicate_scan("equal", data)
+
+    def next_predicate_scan(self, predicate, value, operand=None):
+        """
+        Keeps only the addresses whose current value satisfies the predicate, rewriting
+        the session file in place (and the stored values, if any).
+
+        Args:
+        - predicate (str)                 : "equal", "epsilon", "range", "less", "greater" or "masked".
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound for "range" or the bit mask for "masked".
+
+        Raises:
+        - ValueError                  : If the predicate is unknown or an operand has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        - OSError                     : If the session file cannot be accessed.
+        """
+        code, a, b = _predicate_args(predicate, value, operand, self.__datatype)
+        res = scanNextTypedSession(self.__hProcess, self.__session, code, ctypes.byref(a), ctypes.byref(b))
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        elif res == -4:
+            raise OSError("Failed to access the session file " + str(self.__path))
+
+    def flush(self):
+        """
+        Writes the session to disk, e.g. before handing the file to another process.
+
+        Raises:
+        - OSError: If the file cannot be written.
+        """
+        if flushScanSession(self.__session) != 1:
+            raise OSError("Failed to write the session file " + str(self.__path))
+
+    def __repr__(self) -> str:
+        return "MemoryScanSession(" + self.__datatype + ", " + str(len(self)) + " addresses, " + str(self.__path) + ")"
+
+    def close(self):
+        """
+        Closes the session file; it stays on disk and can be opened again with
+        MemoryScanner.open_session.
+        """
+        if self.__session:
+            closeScanSession(self.__session)
+            self.__session = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+class MemoryValueStore:
+    COPY_CHUNK = 65536
+    MODES = {
+        "changed": 0,
+        "unchanged": 1,
+        "increased": 2,
+        "decreased": 3,
+        "increased_by": 4,
+        "decreased_by": 5,
+        "delta_range": 6,
+        "within_percent": 7,
+    }
+    DELTA_TYPES = {
+        1: ctypes.c_int8,
+        2: ctypes.c_int16,
+        4: ctypes.c_int32,
+        8: ctypes.c_int64,
+    }
+
+    def __init__(self, hProcess, store, dt):
+        """
+        Initialize a new instance of MemoryValueStore.
+
+        Keeps the found addresses together with the value read at each of them by
+        the last scan, as two parallel native arrays. Next scans update the values in
+        the same pass that filters the addresses, so scans relative to the previous
+        value ("decreased", "increased by 5", ...) need no snapshot of the process.
+
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - store (int)                      : The pointer to the native value store.
+        - dt (str)                         : The data type of the scans.
+
+        Returns:
+        - MemoryValueStore() object
+        """
+        self.__hProcess = hProcess
+        self.__store = store
+        self.__datatype = dt
+        self.__stats = _last_scan_stats()
+
+    @property
+    def datatype(self) -> str:
+        """
+        Returns the data type of the scans.
+        """
+        return self.__datatype
+
+    @property
+    def memory_usage(self) -> int:
+        """
+        Returns the number of bytes the store occupies in this process.
+        """
+        return getValueStoreMemoryUsage(self.__store)
+
+    @property
+    def stats(self):
+        """
+        Returns the telemetry of the scan that last changed the store, like
+        MemoryNextScan.stats (without convert_ns), or None if it was off.
+        """
+        return None if self.__stats is None else dict(self.__stats)
+
+    def __len__(self) -> int:
+        return getValueStoreCount(self.__store)
+
+    def __getitem__(self, index: int) -> tuple:
+        """
+        Returns the address at 'index' and the value read there by the last scan.
+
+        Raises:
+        - IndexError: If 'index' is out of range.
+        """
+        count = len(self)
+        if index < 0:
+            index += count
+        if index < 0 or index >= count:
+            raise IndexError("Value store index out of range!")
+        address = ctypes.c_ulonglong()
+        value = VALUE_TYPES[self.__datatype]()
+        copyValueStoreRecords(self.__store, index, 1, ctypes.byref(address), ctypes.byref(value))
+        return address.value, value.value
+
+    def __iter__(self):
+        """
+        Yields every address in ascending order, copied out in chunks.
+        """
+        for addresses, _ in self.__chunks(False):
+            yield from addresses
+
+    def __chunks(self, values):
+        value_type = VALUE_TYPES[self.__datatype]
+        addresses = (ctypes.c_ulonglong * self.COPY_CHUNK)()
+        buffer = (value_type * self.COPY_CHUNK)() if values else None
+        start = 0
+        while True:
+            copied = copyValueStoreRecords(self.__store, start, self.COPY_CHUNK, addresses, buffer)
+            yield addresses[:copied], buffer[:copied] if values else None
+            if copied < self.COPY_CHUNK:
+                return
+            start += copied
+
+    def values(self) -> list:
+        """
+        Returns the values read at the addresses by the last scan, in address order.
+        """
+        result = []
+        for _, values in self.__chunks(True):
+            result.extend(values)
+        return result
+
+    def items(self) -> list:
+        """
+        Returns (address, value) pairs for every address, in address order.
+        """
+        result = []
+        for addresses, values in self.__chunks(True):
+            result.extend(zip(addresses, values))
+        return result
+
+    @property
+    def address_list(self):
+        """
+        Returns the found addresses as a list of hex strings, like MemoryNextScan.address_list.
+        """
+        return [hex(address) for address in self]
+
+    def next_scan(self, data):
+        """
+        Keeps only the addresses whose current value equals 'data'.
+
+        Args:
+        - data (int or float): The new value to which the old value was changed from.
+
+        Raises:
+        - ValueError                  : If 'data' has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        self.next_predicate_scan("equal", data)
+
+    def next_predicate_scan(self, predicate, value, operand=None):
+        """
+        Keeps only the addresses whose current value satisfies the predicate and
+        stores that value.
+
+        Args:
+        - predicate (str)                 : "equal", "epsilon", "range", "less", "greater" or "masked".
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound for "range" or the bit mask for "masked".
+
+        Raises:
+        - ValueError                  : If the predicate is unknown or an operand has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        code, a, b = _predicate_args(predicate, value, operand, self.__datatype)
+        res = scanNextTypedStore(self.__hProcess, self.__store, code, ctypes.byref(a), ctypes.byref(b))
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        self.__stats = _last_scan_stats()
+
+    def __delta(self, mode, delta):
+        """
+        Returns 'delta' as the ctypes operand of a relative mode: the signed type of the
+        data type's width for integers, the data type itself for FLOAT and DOUBLE, a
+        double percentage for "within_percent".
+        """
+        if mode == "within_percent":
+            if not isinstance(delta, (int, float)) or not delta >= 0:
+                raise ValueError("Expected a percentage of 0 or more!")
+            return ctypes.c_double(float(delta))
+        value_type = VALUE_TYPES[self.__datatype]
+        if self.__datatype in ("FLOAT", "DOUBLE"):
+            if not isinstance(delta, (int, float)):
+                raise ValueError("Expected a floating point value!")
+            return value_type(float(delta))
+        if not isinstance(delta, int):
+            raise ValueError("Expected an integer!")
+        size = ctypes.sizeof(value_type)
+        bits = 8 * size
+        # Differences wrap like the target's arithmetic, so "increased_by" also takes
+        # the unsigned spelling of a delta; a range bound has to be a signed difference.
+        high = (1 << (bits - 1)) if mode == "delta_range" else (1 << bits)
+        if not -(1 << (bits - 1)) <= delta < high:
+            raise ValueError(str(delta) + " is not a difference of " + self.__datatype + " values!")
+        return _from_bits(self.DELTA_TYPES[size], delta)
+
+    def compare(self, mode, delta=0, high=None):
+        """
+        Keeps only the addresses whose current value relates to the value stored by
+        the last scan as 'mode' says, and stores the current value.
+
+        Args:
+        - mode (str)                   : "changed", "unchanged", "increased", "decreased",
+                                         "increased_by", "decreased_by", "delta_range" or "within_percent".
+        - delta (int or float)         : The difference for "increased_by" and "decreased_by", the lowest
+                                         difference (new - old) for "delta_range" or the percentage of the
+                                         old value the new one may differ by for "within_percent". Default is 0.
+        - high (int or float, optional): The highest difference for "delta_range".
+
+        Raises:
+        - ValueError                  : If 'mode' is unknown or an operand is missing or has the wrong type.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        if mode not in self.MODES:
+            raise ValueError("Unknown mode, expected one of: " + ", ".join(self.MODES))
+        if mode == "delta_range" and high is None:
+            raise ValueError("The 'delta_range' mode needs a high bound!")
+        a = self.__delta(mode, delta)
+        b = self.__delta(mode, high if high is not None else 0)
+        res = scanNextRelativeStore(self.__hProcess, self.__store, self.MODES[mode], ctypes.byref(a), ctypes.byref(b))
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid relative operands!")
+        self.__stats = _last_scan_stats()
+
+    def __repr__(self) -> str:
+        return "MemoryValueStore(" + self.__datatype + ", " + str(len(self)) + " addresses)"
+
+    def close(self):
+        """
+        Frees the memory held by the store.
+        """
+        if self.__store:
+            freeValueStore(self.__store)
+            self.__store = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+POINTER_MAX_DEPTH = 8
+POINTER_MODULE_NAME = 128
+
+
+class MemoryPointerPaths:
+    def __init__(self, hProcess, paths):
+        """
+        Initialize a new instance of MemoryPointerPaths.
+
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process, used by resolve().
+        - paths (int)                      : The pointer to the native path list.
+
+        Returns:
+        - MemoryPointerPaths() object
+        """
+        self.__hProcess = hProcess
+        self.__paths = paths
+
+    def __len__(self) -> int:
+        return getPointerPathCount(self.__paths)
+
+    def __getitem__(self, index: int) -> tuple:
+        """
+        Returns the path at 'index' as (module name, base offset, [offsets]), meaning
+        address = [[module + base offset] + offsets[0]] + offsets[1] ...
+
+        Raises:
+        - IndexError: If 'index' is out of range.
+        """
+        if index < 0:
+            index += len(self)
+        module = ctypes.create_string_buffer(POINTER_MODULE_NAME)
+        base_offset = ctypes.c_ulonglong(0)
+        offsets = (ctypes.c_uint * POINTER_MAX_DEPTH)()
+        depth = getPointerPath(self.__paths, index, module, ctypes.byref(base_offset), offsets) if index >= 0 else 0
+        if depth == 0:
+            raise IndexError("Pointer path index out of range!")
+        return module.value.decode("utf-8", "replace"), base_offset.value, list(offsets[:depth])
+
+    def __iter__(self):
+        for i in range(len(self)):
+            yield self[i]
+
+    def __repr__(self) -> str:
+        return "MemoryPointerPaths(" + str(len(self)) + " paths)"
+
+    def intersect(self, other) -> int:
+        """
+        Keeps only the paths that were also found in 'other', e.g. the paths of the same
+        value found after restarting the target.
+
+        Args:
+        - other (MemoryPointerPaths): The paths of another search.
+
+        Returns:
+        - int: The number of paths left.
+
+        Raises:
+        - MemoryAllocationFailureError: If memory allocation fails.
+        """
+        res = intersectPointerPaths(self.__paths, other._MemoryPointerPaths__paths)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the pointer paths!')
+        return res
+
+    def resolve(self, index: int):
+        """
+        Follows the path at 'index' in the live process.
+
+        Returns:
+        - int or None: The address the path leads to now, or None if its module is not
+                       loaded or a pointer on the way cannot be read.
+        """
+        if index < 0:
+            index += len(self)
+        if index < 0:
+            return None
+        return resolvePointerPath(self.__hProcess, self.__paths, index)
+
+    def close(self):
+        """
+        Frees the memory held by the path list.
+        """
+        if self.__paths:
+            freePointerPathArray(self.__paths)
+            self.__paths = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+
+class MemoryPointerMap:
+    def __init__(self, hProcess, pointer_map):
+        """
+        Initialize a new instance of MemoryPointerMap.
+
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - pointer_map (int)                : The pointer to the native pointer map.
+
+        Returns:
+        - MemoryPointerMap() object
+        """
+        self.__hProcess = hProcess
+        self.__map = pointer_map
+
+    def __len__(self) -> int:
+        """
+        Returns the number of pointers stored in the map.
+        """
+        return getPointerMapSize(self.__map)
+
+    def save(self, path):
+        """
+        Writes the map to a file, to be searched later with MemoryScanner.load_pointer_map.
+
+        Raises:
+        - OSError: If the file cannot be written.
+        """
+        if savePointerMap(self.__map, os.fsencode(path)) != 1:
+            raise OSError("Failed to write the pointer map to " + str(path))
+
+    def find_paths(self, target, max_depth=4, max_offset=4096, max_results=100000) -> MemoryPointerPaths:
+        """
+        Searches the map for module based pointer paths leading to 'target'.
+
+        Args:
+        - target (int)               : The address to find paths to, as recorded when the map was taken.
+        - max_depth (int, optional)  : The maximum number of offsets, 1 to 8. Default is 4.
+        - max_offset (int, optional) : The maximum value of every offset. Default is 4096.
+        - max_results (int, optional): Stop after this many paths. Default is 100000.
+
+        Returns:
+        - MemoryPointerPaths: The paths found.
+
+        Raises:
+        - ValueError                  : If an argument is out of range.
+        - MemoryAllocationFailureError: If memory allocation fails.
+        """
+        if isinstance(target, str):
+            target = int(target, 16)
+        if not 1 <= max_depth <= POINTER_MAX_DEPTH or not 0 <= max_offset <= 0xFFFFFFFF or max_results < 1:
+            raise ValueError("Expected 1 <= max_depth <= 8, 0 <= max_offset < 2**32 and max_results >= 1!")
+        paths = createPointerPathArray()
+        if not paths:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the pointer paths!')
+        res = scanPointerPaths(self.__map, target, max_depth, max_offset, max_results, paths)
+        if res != 1:
+            freePointerPathArray(paths)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the pointer paths!')
+        elif res == -3:
+            raise ValueError("Invalid pointer scan arguments!")
+        elif res != 1:
+            raise OSError("The pointer path search failed with code " + str(res) + "!")
+        return MemoryPointerPaths(self.__hProcess, paths)
+
+    def close(self):
+        """
+        Frees the memory held by the map.
+        """
+        if self.__map:
+            freePointerMap(self.__map)
+            self.__map = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+
+REGION_PROTECTIONS = {
+    "readonly": 0x02,
+    "readwrite": 0x04,
+    "writecopy": 0x08,
+    "execute": 0x10,
+    "execute_read": 0x20,
+    "execute_readwrite": 0x40,
+    "execute_writecopy": 0x80,
+}
+
+REGION_TYPES = {
+    "private": 0x20000,
+    "mapped": 0x40000,
+    "image": 0x1000000,
+}
+
+
+def _region_filter(module=None, lo=None, hi=None, protect=None, type=None, min_size=None, max_size=None):
+    """
+    Builds the RegionFilter of MemoryScanner.region_map and MemoryRegionMap.filter.
+    Arguments left to None do not filter.
+
+    Raises:
+    - ValueError: If a protection or type name is unknown, the module name is too long or lo >= hi.
+    """
+    region_filter = RegionFilter()
+    if module is not None:
+        name = module.encode("utf-8")
+        if len(name) >= POINTER_MODULE_NAME:
+            raise ValueError("The module name is too long!")
+        region_filter.module = name
+    if isinstance(lo, str):
+        lo = int(lo, 16)
+    if isinstance(hi, str):
+        hi = int(hi, 16)
+    if lo is not None and hi is not None and lo >= hi:
+        raise ValueError("Expected lo < hi!")
+    region_filter.lo = lo or 0
+    region_filter.hi = hi or 0
+    for name in protect or ():
+        if name not in REGION_PROTECTIONS:
+            raise ValueError("Unknown protection, expected one of: " + ", ".join(REGION_PROTECTIONS))
+        region_filter.protect |= REGION_PROTECTIONS[name]
+    for name in type or ():
+        if name not in REGION_TYPES:
+            raise ValueError("Unknown region type, expected one of: " + ", ".join(REGION_TYPES))
+        region_filter.type |= REGION_TYPES[name]
+    region_filter.minSize = min_size or 0
+    region_filter.maxSize = max_size or 0
+    return region_filter
+
+
+class MemoryRegionMap:
+    def __init__(self, hProcess, region_map):
+        """
+        Initialize a new instance of MemoryRegionMap.
+
+        Args:
+        - hProcess (ctypes.wintypes.HANDLE): The handle to the process.
+        - region_map (int)                 : The pointer to the native region map.
+
+        Returns:
+        - MemoryRegionMap() object
+        """
+        self.__hProcess = hProcess
+        self.__map = region_map
+
+    def __len__(self) -> int:
+        """
+        Returns the number of regions in the map.
+        """
+        return getRegionCount(self.__map)
+
+    def __getitem__(self, index: int) -> tuple:
+        """
+        Returns region 'index' as (base, size, protect, type, module, changed).
+
+        'protect' and 'type' are the raw PAGE_* and MEM_* values (see REGION_PROTECTIONS
+        and REGION_TYPES), 'module' is the name of the module the region belongs to or
+        None, 'changed' tells whether the region is new or changed since the last refresh.
+
+        Raises:
+        - IndexError: If 'index' is out of range.
+        """
+        if index < 0:
+            index += len(self)
+        base = ctypes.c_void_p()
+        size = ctypes.c_size_t()
+        protect = ctypes.c_uint32()
+        region_type = ctypes.c_uint32()
+        changed = ctypes.c_int()
+        module = ctypes.create_string_buffer(POINTER_MODULE_NAME)
+        if index < 0 or getRegion(self.__map, index, ctypes.byref(base), ctypes.byref(size), ctypes.byref(protect),
+                                  ctypes.byref(region_type), ctypes.byref(changed), module, POINTER_MODULE_NAME) != 1:
+            raise IndexError("Region index out of range!")
+        name = module.value.decode("utf-8", "replace") or None
+        return (base.value or 0, size.value, protect.value, region_type.value, name, bool(changed.value))
+
+    def __iter__(self):
+        for index in range(len(self)):
+            yield self[index]
+
+    def __repr__(self) -> str:
+        return f"<MemoryRegionMap regions={len(self)} size={self.size}>"
+
+    @property
+    def size(self) -> int:
+        """
+        Returns the total number of bytes covered by the regions.
+        """
+        return getRegionMapSize(self.__map)
+
+    def refresh(self) -> int:
+        """
+        Walks the process again with the filter the map was created with. Regions that
+        are new or changed are flagged (see __getitem__).
+
+        Returns:
+        - int: The number of regions added, changed or removed.
+
+        Raises:
+        - MemoryAllocationFailureError    : If memory allocation fails.
+        - ReadingProcessMemoryFailureError: If the modules of the process cannot be listed or it exited.
+        - RuntimeError                    : If a scan limited to the map is running; the map is left as it was.
+        """
+        res = refreshRegionMap(self.__hProcess, self.__map)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the region map!')
+        elif res == -2:
+            raise ReadingProcessMemoryFailureError('Failed to list the modules of the process!')
+        elif res == -3:
+            raise ReadingProcessMemoryFailureError('The process the region map was created for is gone!')
+        elif res == -6:
+            raise RuntimeError("The region map is in use by a running scan!")
+        elif res < 0:
+            raise OSError("The region map refresh failed with code " + str(res) + "!")
+        return res
+
+    def filter(self, module=None, lo=None, hi=None, protect=None, type=None, min_size=None, max_size=None):
+        """
+        Returns a new map with the regions of this map matching all the given criteria,
+        without walking the process again. The arguments are those of MemoryScanner.region_map.
+
+        Returns:
+        - MemoryRegionMap: The narrowed map, refreshing it applies both filters.
+
+        Raises:
+        - ValueError                  : If an argument is invalid.
+        - MemoryAllocationFailureError: If memory allocation fails.
+        """
+        region_filter = _region_filter(module, lo, hi, protect, type, min_size, max_size)
+        region_map = filterRegionMap(self.__map, ctypes.byref(region_filter))
+        if not region_map:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the region map!')
+        return MemoryRegionMap(self.__hProcess, region_map)
+
+    @property
+    def pointer(self):
+        """
+        Returns the native region map, as expected by MemoryScanner.set_scan_region_map.
+        """
+        return self.__map
+
+    def close(self):
+        """
+        Frees the map. Scanners using it as their scan scope cover the whole process again.
+        """
+        if self.__map:
+            freeRegionMap(self.__map)
+            self.__map = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+
+class MemoryScanner(object):
+    def __init__(self, processPID: int):
+        """
+        Initialize a new instance of MemoryScanner.
+
+        This constructor opens a handle to the process with the given process ID,
+        creates an address array, and initializes the necessary attributes.
+
+        Parameters:
+        - processPID (int): The process ID of the target process.
+
+        Returns:
+        - None
+
+        Raises:
+        - None
+
+        """
+        self.__pid = processPID
+        self.__hProcess = getHandleByPID(self.__pid)
+        self.__address_array = createAddressArray()
+
+    def new_scan(self, data, isdouble=False, alignment=0, datatype=None) -> MemoryNextScan:
+        """
+        Initiates a new memory scan with the given data.
+
+        Parameters:
+        - data (int, float)        : The value to search for in the memory.
+        - isdouble (bool, optional): A flag indicating whether the data is of type double. Default is False.
+        - alignment (int, optional): Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type,
+                                     e.g. 1 also finds values inside packed structures.
+        - datatype (str, optional) : One of SCAN_TYPES, e.g. "INT16" or "UINT64". Default is None, which
+                                     picks INTEGER, FLOAT or DOUBLE from 'data' and 'isdouble'.
+
+        Returns:
+        - MemoryNextScan: An instance of MemoryNextScan containing the results of the scan.
+
+        Raises:
+        - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
+        - ReadingProcessMemoryFailureError: If reading memory from the process fails.
+        """
+        if datatype is None and alignment:
+            datatype = "INTEGER" if isinstance(data, int) else ("DOUBLE" if isdouble else "FLOAT")
+        if datatype is not None:
+            return self.new_predicate_scan("equal", data, datatype=datatype, alignment=alignment)
+        if isinstance(data, int):
+            res = scanINT(self.__hProcess, data, self.__address_array)
+            if res == -1:
+                raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+            elif res == -2:
+                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+            elif res == 1:
+                return MemoryNextScan(self.__hProcess, self.__address_array, None, "INTEGER")
+        elif isdouble:
+            res = scanDOUBLE(self.__hProcess, data, self.__address_array)
+            if res == -1:
+                raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+            elif res == -2:
+                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+            elif res == 1:
+                return MemoryNextScan(self.__hProcess, self.__address_array, None, "DOUBLE")
+        elif isinstance(data, float):
+            res = scanFLOAT(self.__hProcess, data, self.__address_array)
+            if res == -1:
+                raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+            elif res == -2:
+                raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+            elif res == 1:
+                return MemoryNextScan(self.__hProcess, self.__address_array, None, "FLOAT")
+
+
+    
+    def new_predicate_scan(self, predicate, value, operand=None, datatype="INTEGER", alignment=0) -> MemoryNextScan:
+        """
+        Initiates a new memory scan for every value satisfying a predicate.
+
+        Parameters:
+        - predicate (str)                 : "equal"   : value == 'value'
+                                            "epsilon" : |value - 'value'| <= 'operand'
+                                            "range"   : 'value' <= value <= 'operand'
+                                            "less"    : value < 'value'
+                                            "greater" : value > 'value'
+                                            "masked"  : value & 'operand' == 'value' & 'operand' (raw bits)
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound or the integer bit mask.
+        - datatype (str, optional)        : One of SCAN_TYPES, e.g. "INTEGER", "UINT8", "INT64" or "DOUBLE".
+                                            Default is "INTEGER".
+        - alignment (int, optional)       : Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+
+        Returns:
+        - MemoryNextScan: An instance of MemoryNextScan containing the results of the scan.
+
+        Raises:
+        - ValueError                      : If the predicate, datatype or an operand is invalid.
+        - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
+        - ReadingProcessMemoryFailureError: If reading memory from the process fails.
+        """
+        type_tag = _scan_type(datatype)
+        _check_alignment(alignment)
+        code, a, b = _predicate_args(predicate, value, operand, datatype)
+        address_array = createAddressArray()
+        res = scanTyped(self.__hProcess, type_tag, code, ctypes.byref(a), ctypes.byref(b), alignment, address_array)
+        if res != 1:
+            freeAddressArray(address_array)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -2:
+            raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        elif res != 1:
+            raise OSError("The scan failed with code " + str(res) + "!")
+        return MemoryNextScan(self.__hProcess, address_array, None, datatype)
+
+    def new_candidate_scan(self, value, operand=None, predicate="equal", datatype="INTEGER", alignment=0) -> MemoryCandidateSet:
+        """
+        Like new_predicate_scan, but keeps the results in a compressed native candidate set
+        instead of an array of 8 byte addresses. Prefer it for first scans with many results.
+
+        Parameters:
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound or the integer bit mask.
+        - predicate (str, optional)       : One of PREDICATES. Default is "equal".
+        - datatype (str, optional)        : One of SCAN_TYPES. Default is "INTEGER".
+        - alignment (int, optional)       : Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+
+        Returns:
+        - MemoryCandidateSet: The found addresses.
+
+        Raises:
+        - ValueError                      : If the predicate, datatype or an operand is invalid.
+        - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
+        - ReadingProcessMemoryFailureError: If reading memory from the process fails.
+        """
+        type_tag = _scan_type(datatype)
+        _check_alignment(alignment)
+        code, a, b = _predicate_args(predicate, value, operand, datatype)
+        candidates = createCandidateArray()
+        if not candidates:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the candidate set!')
+        res = scanTypedSet(self.__hProcess, type_tag, code, ctypes.byref(a), ctypes.byref(b), alignment, candidates)
+        if res != 1:
+            freeCandidateArray(candidates)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -2:
+            raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        elif res != 1:
+            raise OSError("The scan failed with code " + str(res) + "!")
+        return MemoryCandidateSet(self.__hProcess, candidates, datatype)
+
+    def new_value_store(self, value, operand=None, predicate="equal", datatype="INTEGER", alignment=0) -> MemoryValueStore:
+        """
+        Like new_predicate_scan, but also keeps the value read at every found address,
+        so the next scans can compare against the previous value with MemoryValueStore.compare.
+
+        Args:
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound or the integer bit mask.
+        - predicate (str, optional)       : One of PREDICATES. Default is "equal".
+        - datatype (str, optional)        : One of SCAN_TYPES. Default is "INTEGER".
+        - alignment (int, optional)       : Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+
+        Returns:
+        - MemoryValueStore: The found addresses and their values.
+
+        Raises:
+        - ValueError                      : If the predicate, datatype or an operand is invalid.
+        - MemoryAllocationFailureError    : If memory allocation for buffer data fails.
+        - ReadingProcessMemoryFailureError: If reading memory from the process fails.
+        """
+        type_tag = _scan_type(datatype)
+        _check_alignment(alignment)
+        code, a, b = _predicate_args(predicate, value, operand, datatype)
+        store = createValueStore(type_tag)
+        if not store:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the value store!')
+        res = scanTypedStore(self.__hProcess, store, code, ctypes.byref(a), ctypes.byref(b), alignment)
+        if res != 1:
+            freeValueStore(store)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -2:
+            raise ReadingProcessMemoryFailureError('Failed to read memory from the process!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        elif res != 1:
+            raise OSError("The scan failed with code " + str(res) + "!")
+        return MemoryValueStore(self.__hProcess, store, datatype)
+
+    def start_scan(self, value, operand=None, predicate="equal", datatype="INTEGER", alignment=0,
+                   candidates=False, stream=False, on_hits=None, queue=None) -> MemoryScanTask:
+        """
+        Starts new_predicate_scan (or new_candidate_scan) in the background and returns at once.
+
+        Parameters:
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound or the integer bit mask.
+        - predicate (str, optional)       : One of PREDICATES. Default is "equal".
+        - datatype (str, optional)        : One of SCAN_TYPES. Default is "INTEGER".
+        - alignment (int, optional)       : Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+        - candidates (bool, optional)     : Keep the result in a MemoryCandidateSet. Default is False.
+        - stream (bool, optional)         : Keep the hits of every finished chunk for MemoryScanTask.drain().
+        - on_hits (callable, optional)    : Called from a helper thread with each list of streamed addresses.
+        - queue (queue.Queue, optional)   : Receives each list of streamed addresses, then None at the end.
+
+        Returns:
+        - MemoryScanTask: The running scan; poll it, cancel it or call result().
+
+        Raises:
+        - ValueError                  : If the predicate, datatype or an operand is invalid.
+        - MemoryAllocationFailureError: If the task cannot be started.
+        """
+        type_tag = _scan_type(datatype)
+        _check_alignment(alignment)
+        code, a, b = _predicate_args(predicate, value, operand, datatype)
+        if candidates:
+            results = createCandidateArray()
+            if not results:
+                raise MemoryAllocationFailureError('Failed to allocate memory for the candidate set!')
+            task = startScanTyped(self.__hProcess, type_tag, code, ctypes.byref(a), ctypes.byref(b), alignment,
+                                  None, results, stream or on_hits is not None or queue is not None)
+        else:
+            results = createAddressArray()
+            task = startScanTyped(self.__hProcess, type_tag, code, ctypes.byref(a), ctypes.byref(b), alignment,
+                                  results, None, stream or on_hits is not None or queue is not None)
+        if not task:
+            if candidates:
+                freeCandidateArray(results)
+            else:
+                freeAddressArray(results)
+            raise MemoryAllocationFailureError('Failed to start the scan!')
+        return MemoryScanTask(self.__hProcess, task, results, candidates, datatype, on_hits, queue)
+
+    def new_session(self, path, value, operand=None, predicate="equal", datatype="INTEGER", alignment=0,
+                    values=True) -> MemoryScanSession:
+        """
+        Scans like new_predicate_scan into a session file, replacing it if it exists.
+        The found addresses are written to a memory mapped file instead of being kept
+        in memory, so results larger than RAM work and survive this process.
+
+        Args:
+        - path (str)                      : The session file to create.
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound or the integer bit mask.
+        - predicate (str, optional)       : One of PREDICATES. Default is "equal".
+        - datatype (str, optional)        : One of SCAN_TYPES. Default is "INTEGER".
+        - alignment (int, optional)       : Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+        - values (bool, optional)         : Also store the value read at every address. Default is True.
+
+        Returns:
+        - MemoryScanSession: The session, open.
+
+        Raises:
+        - ValueError                  : If the predicate, datatype or an operand is invalid.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        - OSError                     : If the session file cannot be created or grown.
+        """
+        type_tag = _scan_type(datatype)
+        _check_alignment(alignment)
+        code, a, b = _predicate_args(predicate, value, operand, datatype)
+        session = createScanSession(self.__hProcess, os.fsencode(path), type_tag, int(values))
+        if not session:
+            raise OSError("Failed to create the session file " + str(path))
+        res = scanTypedSession(self.__hProcess, session, code, ctypes.byref(a), ctypes.byref(b), alignment)
+        if res != 1:
+            closeScanSession(session)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid predicate operands!")
+        elif res == -4:
+            raise OSError("Failed to grow the session file " + str(path))
+        elif res != 1:
+            raise OSError("The scan failed with code " + str(res) + "!")
+        return MemoryScanSession(self.__hProcess, session, datatype, path)
+
+    def open_session(self, path) -> MemoryScanSession:
+        """
+        Opens a session written by new_session, e.g. by an earlier run of this script,
+        without rescanning and without loading it into memory.
+
+        Args:
+        - path (str): The session file.
+
+        Returns:
+        - MemoryScanSession: The session, open.
+
+        Raises:
+        - OSError   : If the file cannot be opened, is not a session or was left in the middle of a scan.
+        - ValueError: If the session was taken from another process, or an earlier run of a reused pid.
+        """
+        session = openScanSession(os.fsencode(path))
+        if not session:
+            raise OSError("Failed to open the session file " + str(path))
+        if matchScanSession(self.__hProcess, session) != 1:
+            closeScanSession(session)
+            raise ValueError("The session was taken from a different process!")
+        type_tag = getScanSessionType(session)
+        datatype = next(name for name, tag in SCAN_TYPES.items() if tag == type_tag)
+        return MemoryScanSession(self.__hProcess, session, datatype, path)
+
+    def group_scan(self, terms, span=64, alignment=0) -> MemoryNextScan:
+        """
+        Finds structures from several values known to lie close together, e.g. health 100,
+        ammo 30 and a float speed of 1.5 within a few dozen bytes, in a single pass.
+
+        Only the rarest term with a known offset is tested at every position; the other
+        terms are checked around its hits while the memory is still in cache, so this is
+        about as fast as one scan and keeps no intermediate results.
+
+        Parameters:
+        - terms (list)             : The terms, each (datatype, value), (datatype, value, offset) or a dict
+                                     with "value" and optionally "datatype" (default "INTEGER"),
+                                     "predicate" (default "equal"), "operand" and "offset". The first term
+                                     is the anchor. A term with an offset is at that many bytes from the
+                                     anchor (may be negative), one without anywhere within 'span' bytes of it.
+        - span (int, optional)     : How far, in bytes, terms without an offset may be from the anchor,
+                                     at most 4096. Default is 64.
+        - alignment (int, optional): Test every 1, 2, 4 or 8 bytes. Default is 0, the size of each data type.
+
+        Returns:
+        - MemoryNextScan: The addresses of the anchor of every matching group, with the anchor's data type.
+
+        Raises:
+        - ValueError                  : If a term, the span or the alignment is invalid, or there are
+                                        no terms or more than 16.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        if not 1 <= len(terms) <= 16:
+            raise ValueError("Expected 1 to 16 terms!")
+        if not isinstance(span, int) or not 0 <= span <= 4096:
+            raise ValueError("Expected a span of 0 to 4096 bytes!")
+        _check_alignment(alignment)
+        native = (GroupTerm * len(terms))(*[_group_term(term, i == 0) for i, term in enumerate(terms)])
+        datatype = terms[0].get("datatype", "INTEGER") if isinstance(terms[0], dict) else terms[0][0]
+        address_array = createAddressArray()
+        res = scanGroup(self.__hProcess, native, len(terms), span, alignment, address_array)
+        if res == -1:
+            freeAddressArray(address_array)
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            freeAddressArray(address_array)
+            raise ValueError("Invalid group terms!")
+        return MemoryNextScan(self.__hProcess, address_array, None, datatype)
+
+    def pattern_scan(self, pattern, regions=("writable", "executable"), first_only=False) -> list:
+        """
+        Searches the memory of the process for an array of bytes signature.
+
+        Parameters:
+        - pattern (str)             : Hex bytes with wildcards, e.g. "48 8B 05 ?? ?? ?? ?? 89 ??".
+                                      "?" or "??" matches any byte, "4?" or "?B" a single nibble.
+        - regions (tuple, optional) : Any of "writable", "executable" and "readonly".
+                                      Default is ("writable", "executable").
+        - first_only (bool, optional): Stop at the lowest match. Default is False.
+
+        Returns:
+        - list: The start addresses (int) of every match, in ascending order.
+
+        Raises:
+        - ValueError                  : If the pattern or a region name is invalid.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        flags = 0
+        for region in regions:
+            if region not in REGIONS:
+                raise ValueError("Unknown region, expected one of: " + ", ".join(REGIONS))
+            flags |= REGIONS[region]
+        if flags == 0:
+            raise ValueError("Expected at least one region!")
+        address_array = createAddressArray()
+        res = scanPattern(self.__hProcess, pattern.encode("ascii"), flags, int(first_only), address_array)
+        if res == 1:
+            result = list(_address_view(address_array))
+        freeAddressArray(address_array)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Invalid pattern!")
+        elif res != 1:
+            raise OSError("The pattern scan failed with code " + str(res) + "!")
+        return result
+
+    def string_scan(self, text, encoding="ascii", ignore_case=False, regions=("writable",)) -> list:
+        """
+        Searches the memory of the process for a string.
+
+        Parameters:
+        - text (str)                  : The string to find, at most 256 bytes once encoded.
+        - encoding (str, optional)    : "ascii" or "utf-16" (little endian, as used by Windows). Default is "ascii".
+        - ignore_case (bool, optional): Match ASCII letters in either case. Default is False.
+        - regions (tuple, optional)   : Any of "writable", "executable" and "readonly". Default is ("writable",).
+
+        Returns:
+        - list: The start addresses (int) of every occurrence, in ascending order.
+
+        Raises:
+        - ValueError                  : If the text cannot be encoded, is empty or too long, or a region is unknown.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        if encoding not in ENCODINGS:
+            raise ValueError("Unknown encoding, expected one of: " + ", ".join(ENCODINGS))
+        flags = 0
+        for region in regions:
+            if region not in REGIONS:
+                raise ValueError("Unknown region, expected one of: " + ", ".join(REGIONS))
+            flags |= REGIONS[region]
+        if flags == 0:
+            raise ValueError("Expected at least one region!")
+        try:
+            needle = text.encode("ascii" if encoding == "ascii" else "utf-16-le")
+        except UnicodeEncodeError:
+            raise ValueError("The text cannot be encoded as " + encoding + "!")
+        address_array = createAddressArray()
+        res = scanString(self.__hProcess, needle, len(needle), ENCODINGS[encoding], int(ignore_case), flags, address_array)
+        if res == 1:
+            result = list(_address_view(address_array))
+        freeAddressArray(address_array)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        elif res == -3:
+            raise ValueError("Expected a non empty string of at most 256 bytes!")
+        elif res != 1:
+            raise OSError("The string scan failed with code " + str(res) + "!")
+        return result
+
+    def new_pointer_map(self) -> MemoryPointerMap:
+        """
+        Records every pointer in the writable memory of the process, together with the
+        loaded modules, for pointer path searches.
+
+        Returns:
+        - MemoryPointerMap: The map, use MemoryPointerMap.find_paths to search it.
+
+        Raises:
+        - MemoryAllocationFailureError: If memory allocation or listing the modules fails.
+        """
+        pointer_map = createPointerMap(self.__hProcess)
+        if not pointer_map:
+            raise MemoryAllocationFailureError('Failed to create the pointer map!')
+        return MemoryPointerMap(self.__hProcess, pointer_map)
+
+    def load_pointer_map(self, path) -> MemoryPointerMap:
+        """
+        Loads a map written by MemoryPointerMap.save, e.g. one taken before the target restarted.
+
+        Raises:
+        - OSError: If the file cannot be read or is not a pointer map.
+        """
+        pointer_map = loadPointerMap(os.fsencode(path))
+        if not pointer_map:
+            raise OSError("Failed to load a pointer map from " + str(path))
+        return MemoryPointerMap(self.__hProcess, pointer_map)
+
+    def region_map(self, module=None, lo=None, hi=None, protect=None, type=None, min_size=None, max_size=None) -> MemoryRegionMap:
+        """
+        Lists the committed memory regions of the process once, to inspect them or to limit
+        the scans to them with set_scan_region_map.
+
+        Args:
+        - module (str, optional)    : Only regions of this module, e.g. "game.exe" (case insensitive).
+        - lo (int or str, optional) : Only memory at or above this address; regions are clipped to it.
+        - hi (int or str, optional) : Only memory below this address; regions are clipped to it.
+        - protect (tuple, optional) : Any of REGION_PROTECTIONS, e.g. ("readwrite",).
+        - type (tuple, optional)    : Any of "private", "mapped" and "image".
+        - min_size (int, optional)  : Skip regions smaller than this many bytes.
+        - max_size (int, optional)  : Skip regions larger than this many bytes.
+
+        Returns:
+        - MemoryRegionMap: The regions, sorted by address.
+
+        Raises:
+        - ValueError                  : If an argument is invalid.
+        - MemoryAllocationFailureError: If memory allocation or listing the modules fails.
+        """
+        region_filter = _region_filter(module, lo, hi, protect, type, min_size, max_size)
+        region_map = createRegionMap(self.__hProcess, ctypes.byref(region_filter))
+        if not region_map:
+            raise MemoryAllocationFailureError('Failed to create the region map!')
+        return MemoryRegionMap(self.__hProcess, region_map)
+
+    def new_snapshot(self, datatype="INTEGER") -> MemorySnapshot:
+        """
+        Records the writable memory of the process for a scan with an unknown initial value.
+
+        Args:
+        - datatype (str, optional): "INTEGER", "FLOAT" or "DOUBLE". Default is "INTEGER".
+
+        Returns:
+        - MemorySnapshot: The snapshot, use MemorySnapshot.compare to get the first results.
+
+        Raises:
+        - ValueError                  : If 'datatype' is unknown.
+        - MemoryAllocationFailureError: If memory allocation for the snapshot fails.
+        """
+        if datatype not in ("INTEGER", "FLOAT", "DOUBLE"):
+            raise ValueError("Expected INTEGER, FLOAT or DOUBLE!")
+        snapshot = createSnapshot(self.__hProcess)
+        if not snapshot:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the snapshot!')
+        return MemorySnapshot(self.__hProcess, snapshot, datatype)
+
+    def set_scan_region_map(self, region_map):
+        """
+        Limits the first scans (value, predicate, candidate, pattern and string scans),
+        pointer maps and snapshots of this MemoryScanner to the regions of a MemoryRegionMap
+        of the same process. Closing the map ends the limit; scans already running keep
+        using it until they finish.
+
+        Next scans (next_scan, next_predicate_scan, compare_snapshot and the next scans of
+        candidate sets, value stores and sessions) are not limited: they only read the
+        addresses found before, whatever the scope is now. scan_processes takes its maps
+        through its 'region_maps' argument.
+
+        Args:
+        - region_map (MemoryRegionMap or None): The scope, None scans the whole process again.
+
+        Returns:
+        - None
+
+        Raises:
+        - ValueError                  : If the map is closed or was created for another process.
+        - MemoryAllocationFailureError: If memory allocation fails.
+        """
+        if region_map is not None and not region_map.pointer:
+            raise ValueError("The region map is closed!")
+        res = setScanRegionMap(self.__hProcess, region_map.pointer if region_map is not None else None)
+        if res == -1:
+            raise MemoryAllocationFailureError('Failed to allocate memory for the scan scope!')
+        elif res != 1:
+            raise ValueError("The region map belongs to another process!")
+
+    @staticmethod
+    def get_process_id_by_name(data: str) -> int:
+        """
+        Retrieves the process ID of a process by its name.
+
+        Args:
+        - data (str): The name of the process.
+
+        Returns:
+        - int: The process ID of the process. If the process is not found, returns 0.
+
+        This function uses the `get_pid_by_name` function from the `pywinmemscanner.utils.backend.memory_extract` module.
+        It encodes the process name as UTF-8 and passes it to the `get_pid_by_name` function to retrieve the process ID.
+        With several processes of that name the lowest process ID is returned; see find_process_ids.
+        """
+        return get_pid_by_name(data.encode('utf-8'))
+
+    @staticmethod
+    def find_process_ids(name: str) -> list:
+        """
+        Retrieves the process IDs of every process running the executable 'name'.
+
+        Args:
+        - name (str): The file name of the executable, e.g. "game.exe".
+
+        Returns:
+        - list: The process IDs, lowest first. Empty if no process is found.
+
+        Raises:
+        - MemoryAllocationFailureError    : If memory allocation for the process table fails.
+        - ReadingProcessMemoryFailureError: If the processes cannot be listed.
+
+        Names are looked up in a cached process table that is listed again at most once per
+        set_process_table_age, and then only reads the names of processes it has not seen yet,
+        so calling this in a loop is cheap.
+        """
+        encoded = name.encode('utf-8')
+        capacity = 64
+        while True:
+            pids = (ctypes.c_int * capacity)()
+            count = findProcessIdsByName(encoded, pids, capacity)
+            if count == -1:
+                raise MemoryAllocationFailureError('Failed to allocate memory for the process table!')
+            elif count < 0:
+                raise ReadingProcessMemoryFailureError('Failed to list the processes!')
+            if count <= capacity:
+                return list(pids[:count])
+            capacity = count
+
+    @staticmethod
+    def set_process_table_age(milliseconds: int) -> int:
+        """
+        Sets how long a listing of the processes is reused by get_process_id_by_name and
+        find_process_ids.
+
+        Args:
+        - milliseconds (int): The age in milliseconds. Default is 1000, 0 lists the processes on every call.
+
+        Returns:
+        - int: The previous age.
+        """
+        return setProcessTableAge(milliseconds)
+
+    @staticmethod
+    def scan_processes(processes, value, operand=None, predicate="equal", datatype="INTEGER", alignment=0,
+                       region_maps=None) -> dict:
+        """
+        Runs the same new_predicate_scan on several processes at once.
+
+        The memory of all processes is split into one set of chunks that the scan threads
+        (set_thread_count) work through together, so the scan uses every thread whether the
+        processes are few and large or many and small.
+
+        Args:
+        - processes (str or list)         : An executable name (see find_process_ids) or a list of process IDs.
+        - value (int or float)            : The value, or the lower bound for "range".
+        - operand (int or float, optional): The epsilon, the upper bound or the integer bit mask.
+        - predicate (str, optional)       : One of the predicates of new_predicate_scan. Default is "equal".
+        - datatype (str, optional)        : One of SCAN_TYPES. Default is "INTEGER".
+        - alignment (int, optional)       : Test every 1, 2, 4 or 8 bytes. Default is 0, the size of the data type.
+        - region_maps (dict, optional)    : {process ID: MemoryRegionMap}, limits the scan of those processes
+                                            to the regions of their map (see set_scan_region_map).
+
+        Returns:
+        - dict: {process ID: MemoryNextScan}, the results of every process in the order of 'processes'.
+                Processes that cannot be opened or scanned (e.g. that exited meanwhile) are left out.
+                Closing a result also closes the handle opened for its process.
+
+        Raises:
+        - ValueError                  : If the predicate, datatype, alignment or an operand is invalid,
+                                        or a region map is closed or was created for another process.
+        - MemoryAllocationFailureError: If memory allocation for buffer data fails.
+        """
+        type_tag = _scan_type(datatype)
+        _check_alignment(alignment)
+        code, a, b = _predicate_args(predicate, value, operand, datatype)
+        region_maps = region_maps or {}
+        if any(not region_map.pointer for region_map in region_maps.values()):
+            raise ValueError("The region map is closed!")
+        pids = MemoryScanner.find_process_ids(processes) if isinstance(processes, str) else list(processes)
+        opened = []
+        for pid in pids:
+            handle = getHandleByPID(pid)
+            if handle:
+                opened.append((pid, handle))
+        for pid, handle in opened:
+            if pid in region_maps and setScanRegionMap(handle, region_maps[pid].pointer) != 1:
+                for _, other in opened:
+                    closeHandle(other)
+                raise ValueError("The region map of process " + str(pid) + " belongs to another process!")
+        if not opened:
+            return {}
+        count = len(opened)
+        handles = (HANDLE * count)(*[handle for _, handle in opened])
+        arrays = [createAddressArray() for _ in opened]
+        results = (ctypes.POINTER(UCharAddressVector) * count)(*arrays)
+        statuses = (ctypes.c_int * count)()
+        res = scanTypedMulti(handles, count, type_tag, code, ctypes.byref(a), ctypes.byref(b), alignment, results, statuses)
+        if res != 1:
+            for (_, handle), array in zip(opened, arrays):
+                freeAddressArray(array)
+                closeHandle(handle)
+            if res == -3:
+                raise ValueError("Invalid predicate operands!")
+            raise MemoryAllocationFailureError('Failed to allocate memory for buffer data!')
+        scans = {}
+        for (pid, handle), array, status in zip(opened, arrays, statuses):
+            if status == 1:
+                scans[pid] = MemoryNextScan(handle, array, None, datatype, owns_handle=True)
+            else:
+                freeAddressArray(array)
+                closeHandle(handle)
+        return scans
+
+    @staticmethod
+    def set_thread_count(threads: int) -> int:
+        """
+        Sets the number of threads used by new_scan.
+
+        Args:
+        - threads (int): 1 keeps the scan serial (default), 0 uses one thread per logical CPU.
+
+        Returns:
+        - int: The thread count now in use.
+
+        With more than one thread the memory regions are split into chunks which are scanned
+        in parallel. The resulting address_list is identical to the one of a serial scan.
+        """
+        return setScanThreadCount(threads)
+
+    @staticmethod
+    def get_thread_count() -> int:
+        """
+        Returns the number of threads used by new_scan.
+
+        Returns:
+        - int: The current thread count.
+        """
+        return getScanThreadCount()
+
+    @staticmethod
+    def set_next_scan_gap(gap: int) -> int:
+        """
+        Sets how far apart (in bytes) two found addresses may be and still be read back
+        with a single call during MemoryNextScan.next_scan.
+
+        Args:
+        - gap (int): The largest gap in bytes that is read through. Default is 4096.
+
+        Returns:
+        - int: The previous gap.
+        """
+        return setNextScanGap(gap)
+
+    @staticmethod
+    def set_scan_stats(enable: bool) -> bool:
+        """
+        Turns scan telemetry on or off. While it is on every scan and next scan records
+        what it visited, read and found and where its time went; see MemoryNextScan.stats.
+
+        Args:
+        - enable (bool): True to record telemetry. Off by default.
+
+        Returns:
+        - bool: The previous setting.
+        """
+        return bool(setScanStats(1 if enable else 0))
@@ -0,0 +1,90 @@
+/*
+ * bench_compaction.c
+ *
+ * Description:
+ * Benchmark for the next-scan compaction step. Builds a vector_uchar_ptr of
+ * N candidate addresses and drops all but 1% of them, once with
+ * filterVectorUCharPtr (single read/write cursor pass) and, for the small
+ * sizes only, with the old deleteElementVectorUCharPtr loop that shifts the
+ * tail of the array for every rejected candidate.
+ *
+ * The filter time per candidate should stay flat from 1M to 50M candidates;
+ * the legacy loop grows with N and is only run where it finishes in seconds.
+ *
+ * Build:
+ * - MSVC : cl /O2 /I.. bench_compaction.c
+ * - MinGW: gcc -O2 -I.. bench_compaction.c -o bench_compaction.exe
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "vectors.h"
+
+#define KEEP_EVERY 100
+#define LEGACY_LIMIT 200000
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void fillCandidates(vector_uchar_ptr* vector, int count) {
+    if (!reserveVectorUCharPtr(vector, count)) {
+        fprintf(stderr, "bench_compaction: cannot allocate %d candidates\n", count);
+        exit(1);
+    }
+    vector->size = 0;
+    for (int i = 0; i < count; i++)
+        vector->array[vector->size++] = (unsigned char*)0x10000 + (size_t)i * 4;
+}
+
+static int keepOnePercent(void* context, unsigned char* element) {
+    (void)context;
+    return (((size_t)element >> 2) % KEEP_EVERY) == 0;
+}
+
+static double runFilter(vector_uchar_ptr* vector, int count) {
+    fillCandidates(vector, count);
+    double start = nowSeconds();
+    filterVectorUCharPtr(vector, keepOnePercent, NULL);
+    return nowSeconds() - start;
+}
+
+static double runLegacy(vector_uchar_ptr* vector, int count) {
+    fillCandidates(vector, count);
+    double start = nowSeconds();
+    for (int i = 0; i < vector->size; i++) {
+        if (!keepOnePercent(NULL, vector->array[i])) {
+            deleteElementVectorUCharPtr(vector, i);
+            i--;
+        }
+    }
+    return nowSeconds() - start;
+}
+
+int main(void) {
+    const int sizes[] = { 10000, 100000, 200000, 1000000, 10000000, 50000000 };
+    vector_uchar_ptr vector;
+    createVectorUCharPtr(&vector);
+
+    printf("%12s %14s %12s %14s %12s\n", "candidates", "filter ms", "ns/cand", "legacy ms", "ns/cand");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int count = sizes[i];
+        double filter = runFilter(&vector, count);
+        int kept = vector.size;
+        printf("%12d %14.2f %12.2f", count, filter * 1e3, filter * 1e9 / count);
+        if (count <= LEGACY_LIMIT) {
+            double legacy = runLegacy(&vector, count);
+            if (vector.size != kept)
+                printf("  result mismatch (%d vs %d)", vector.size, kept);
+            printf(" %14.2f %12.2f\n", legacy * 1e3, legacy * 1e9 / count);
+        }
+        else {
+            printf(" %14s %12s\n", "-", "-");
+        }
+    }
+    deleteVectorUCharPtr(&vector);
+    return 0;
+}
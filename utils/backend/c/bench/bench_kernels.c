@@ -0,0 +1,100 @@
+/*
+ * bench_kernels.c
+ *
+ * Description:
+ * Microbenchmark for the first-scan comparison kernels in kernels.h.
+ * Fills a synthetic buffer with pseudo random data, plants the target value
+ * at a fixed density and runs every kernel level the CPU supports over it,
+ * reporting throughput in GB/s and the number of hits (which must be equal
+ * for every level of the same type).
+ *
+ * Build:
+ * - MSVC : cl /O2 /I.. bench_kernels.c
+ * - MinGW: gcc -O2 -I.. bench_kernels.c -o bench_kernels.exe
+ *
+ * Usage:
+ * bench_kernels [buffer size in MB, default 256] [repetitions, default 5]
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stddef.h>
+typedef size_t SIZE_T;
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "vectors.h"
+#include "kernels.h"
+
+#define HIT_EVERY 4096
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static unsigned int nextRandom(unsigned int* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void fillBuffer(unsigned char* buffer, SIZE_T size, const void* target, SIZE_T width) {
+    unsigned int state = 0x9E3779B9u;
+    for (SIZE_T i = 0; i + sizeof(unsigned int) <= size; i += sizeof(unsigned int)) {
+        unsigned int r = nextRandom(&state) | 1u;
+        memcpy(buffer + i, &r, sizeof(r));
+    }
+    for (SIZE_T i = 0; i + width <= size; i += HIT_EVERY * width)
+        memcpy(buffer + i, target, width);
+}
+
+static void runKernels(const char* type, const scan_kernel* table, unsigned char* buffer, SIZE_T size,
+    const void* target, SIZE_T width, int reps) {
+    vector_uchar_ptr hits;
+    createVectorUCharPtr(&hits);
+    fillBuffer(buffer, size, target, width);
+
+    for (int isa = SCAN_ISA_SCALAR; isa <= maxScanISA(); isa++) {
+        double best = 1e30;
+        for (int r = 0; r < reps; r++) {
+            hits.size = 0;
+            double start = nowSeconds();
+            table[isa](buffer, size / width, target, (unsigned char*)0x10000, &hits);
+            double elapsed = nowSeconds() - start;
+            if (elapsed < best)
+                best = elapsed;
+        }
+        printf("%-7s %-7s %8.2f GB/s  %d hits\n", type, SCAN_ISA_NAMES[isa],
+            (double)size / best / 1e9, hits.size);
+    }
+    deleteVectorUCharPtr(&hits);
+}
+
+int main(int argc, char** argv) {
+    SIZE_T megabytes = argc > 1 ? (SIZE_T)atol(argv[1]) : 256;
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    SIZE_T size = megabytes * 1024 * 1024;
+    unsigned char* buffer = (unsigned char*)malloc(size);
+    if (buffer == NULL) {
+        printf("Failed to allocate %zu MB\n", (size_t)megabytes);
+        return 1;
+    }
+
+    int intTarget = 1337;
+    float floatTarget = 13.37f;
+    double doubleTarget = 13.37;
+
+    printf("buffer %zu MB, best of %d, detected level: %s\n", (size_t)megabytes, reps, SCAN_ISA_NAMES[maxScanISA()]);
+    runKernels("int", KERNELS_INT, buffer, size, &intTarget, sizeof(int), reps);
+    runKernels("float", KERNELS_FLOAT, buffer, size, &floatTarget, sizeof(float), reps);
+    runKernels("double", KERNELS_DOUBLE, buffer, size, &doubleTarget, sizeof(double), reps);
+
+    free(buffer);
+    return 0;
+}
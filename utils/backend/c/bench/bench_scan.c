@@ -0,0 +1,488 @@
+/*
+ * bench_scan.c
+ *
+ * Description:
+ * End to end benchmark of the scanner against a live process. For every heap
+ * size it starts bench_target (a synthetic process with a known number of
+ * planted values, see bench_target.c), attaches to it like the Python layer
+ * does and times, best of `reps`:
+ * - first_scan     : scanTyped, INT32 equal, into an address vector
+ * - first_scan_set : scanTypedSet, the same scan into a candidate set
+ * - export         : copying every address out of the candidate set
+ * - bulk_read      : readAddressValues over the first scan result
+ * - next_scan      : scanNextTyped after the target changed half of the values
+ * - multi_scan     : with processes > 1, scanTypedMulti over that many targets
+ *                    of the size, next to scanTyped on them one after another
+ *
+ * The result is written to stdout as one JSON document; progress and errors
+ * go to stderr. Throughput is reported as GB/s of scanned region bytes for the
+ * first scans and as candidates/s for the others. peak_rss_bytes is the peak
+ * resident set of the benchmark process over the whole run, i.e. of its largest
+ * size; run one size per invocation to measure each size on its own.
+ *
+ * Build (bench_target too, see there):
+ * - MSVC : cl /O2 /I.. bench_scan.c
+ * - MinGW: gcc -O2 -I.. bench_scan.c -o bench_scan.exe -lpsapi
+ * - Linux: gcc -O2 -pthread -I.. bench_scan.c -o bench_scan
+ *
+ * Usage:
+ * bench_scan [sizes=64,256,1024] [density=256] [regions=16] [fragmentation=0]
+ *            [reps=3] [threads=1] [processes=1] [target=./bench_target] > result.json
+ * - sizes        : heap sizes in MB, one target process each
+ * - density      : planted values per MB
+ * - regions      : separate allocations the heap is split into
+ * - fragmentation: percent of the pages made inaccessible
+ * - threads      : scan threads, 0 for one per logical CPU
+ * - processes    : target processes per size for multi_scan (at most 64)
+ *
+ * Note:
+ * - On Linux reading another process needs ptrace permission; the target is
+ *   a child of the benchmark, which the default Yama setting allows.
+ */
+
+#include "scanner.c"
+#include <time.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+#define BENCH_VALUE 1234567
+#define BENCH_MAX_SIZES 16
+#define EXPORT_CHUNK 65536
+#define BENCH_MAX_PROCESSES 64
+
+// Keeps the export loop from being optimized away.
+static volatile unsigned long long exportChecksum;
+static int printedRuns;
+
+typedef struct {
+    SIZE_T sizes[BENCH_MAX_SIZES];
+    int sizeCount;
+    SIZE_T density;
+    int regions;
+    int fragmentation;
+    int reps;
+    int threads;
+    int processes;
+    const char* target;
+} bench_options;
+
+typedef struct {
+    int pid;
+    FILE* in;
+    FILE* out;
+#ifdef _WIN32
+    HANDLE process;
+#endif
+} bench_target;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static unsigned long long peakRssBytes(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (unsigned long long)usage.ru_maxrss * 1024;
+#endif
+}
+
+// Target process
+
+static int startTarget(bench_target* target, const bench_options* options, SIZE_T megabytes) {
+    char size[32], density[32], regions[32], fragmentation[32], value[32];
+    snprintf(size, sizeof(size), "%zu", (size_t)megabytes);
+    snprintf(density, sizeof(density), "%zu", (size_t)options->density);
+    snprintf(regions, sizeof(regions), "%d", options->regions);
+    snprintf(fragmentation, sizeof(fragmentation), "%d", options->fragmentation);
+    snprintf(value, sizeof(value), "%d", BENCH_VALUE);
+#ifdef _WIN32
+    SECURITY_ATTRIBUTES inherit = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE childIn, parentIn, parentOut, childOut;
+    if (!CreatePipe(&childIn, &parentIn, &inherit, 0))
+        return 0;
+    if (!CreatePipe(&parentOut, &childOut, &inherit, 0)) {
+        CloseHandle(childIn);
+        CloseHandle(parentIn);
+        return 0;
+    }
+    SetHandleInformation(parentIn, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(parentOut, HANDLE_FLAG_INHERIT, 0);
+
+    char command[1024];
+    snprintf(command, sizeof(command), "\"%s\" %s %s %s %s %s", options->target, size, density, regions, fragmentation, value);
+    STARTUPINFOA startup;
+    PROCESS_INFORMATION info;
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = childIn;
+    startup.hStdOutput = childOut;
+    startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    BOOL started = CreateProcessA(NULL, command, NULL, NULL, TRUE, 0, NULL, NULL, &startup, &info);
+    CloseHandle(childIn);
+    CloseHandle(childOut);
+    if (!started) {
+        CloseHandle(parentIn);
+        CloseHandle(parentOut);
+        return 0;
+    }
+    CloseHandle(info.hThread);
+    target->process = info.hProcess;
+    target->pid = (int)info.dwProcessId;
+    target->in = _fdopen(_open_osfhandle((intptr_t)parentIn, _O_WRONLY), "w");
+    target->out = _fdopen(_open_osfhandle((intptr_t)parentOut, _O_RDONLY), "r");
+#else
+    int toChild[2], fromChild[2];
+    if (pipe(toChild) != 0)
+        return 0;
+    if (pipe(fromChild) != 0) {
+        close(toChild[0]);
+        close(toChild[1]);
+        return 0;
+    }
+    // Targets started later must not inherit the parent's ends, or this target never sees EOF.
+    fcntl(toChild[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fromChild[0], F_SETFD, FD_CLOEXEC);
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(toChild[0], 0);
+        dup2(fromChild[1], 1);
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        execl(options->target, options->target, size, density, regions, fragmentation, value, (char*)NULL);
+        _exit(127);
+    }
+    close(toChild[0]);
+    close(fromChild[1]);
+    if (pid < 0) {
+        close(toChild[1]);
+        close(fromChild[0]);
+        return 0;
+    }
+    target->pid = (int)pid;
+    target->in = fdopen(toChild[1], "w");
+    target->out = fdopen(fromChild[0], "r");
+#endif
+    return target->in != NULL && target->out != NULL;
+}
+
+// Sends a command (0 for none) and returns the number the target answers with, -1 if it exited.
+static long long targetCommand(bench_target* target, char command) {
+    char line[64];
+    if (command) {
+        fputc(command, target->in);
+        fflush(target->in);
+    }
+    if (fgets(line, sizeof(line), target->out) == NULL)
+        return -1;
+    return atoll(line);
+}
+
+static void stopTarget(bench_target* target) {
+    if (target->in != NULL)
+        fclose(target->in);
+    if (target->out != NULL)
+        fclose(target->out);
+#ifdef _WIN32
+    WaitForSingleObject(target->process, INFINITE);
+    CloseHandle(target->process);
+#else
+    waitpid(target->pid, NULL, 0);
+#endif
+}
+
+// Runs
+
+static unsigned long long scannedBytes(HANDLE hProcess) {
+    region_filter filter;
+    memset(&filter, 0, sizeof(filter));
+    filter.protect = SCAN_PROTECT_WRITABLE;
+    region_map* map = createRegionMap(hProcess, &filter);
+    if (map == NULL)
+        return 0;
+    unsigned long long bytes = getRegionMapSize(map);
+    freeRegionMap(map);
+    return bytes;
+}
+
+static int copyVector(vector_uchar_ptr* to, const vector_uchar_ptr* from) {
+    if (!reserveVectorUCharPtr(to, from->size))
+        return 0;
+    memcpy(to->array, from->array, from->size * sizeof(unsigned char*));
+    to->size = from->size;
+    return 1;
+}
+
+static double perSecond(double amount, double seconds) {
+    return seconds > 0 ? amount / seconds : 0;
+}
+
+typedef struct {
+    double seconds;
+    double oneByOne;
+    unsigned long long bytes;
+    unsigned long long hits;
+    int processes;
+} multi_result;
+
+// Times scanTypedMulti over `processes` targets of the size, the first being the one
+// of runSize, against scanTyped on each of them in turn.
+static void runMulti(const bench_options* options, SIZE_T megabytes, HANDLE first, multi_result* result) {
+    bench_target targets[BENCH_MAX_PROCESSES];
+    HANDLE handles[BENCH_MAX_PROCESSES];
+    vector_uchar_ptr* results[BENCH_MAX_PROCESSES];
+    int statuses[BENCH_MAX_PROCESSES];
+    int value = BENCH_VALUE;
+    int started = 1;
+
+    memset(result, 0, sizeof(*result));
+    memset(targets, 0, sizeof(targets));
+    handles[0] = first;
+    for (; started < options->processes; started++) {
+        if (!startTarget(&targets[started], options, megabytes) || targetCommand(&targets[started], 0) < 0
+            || (handles[started] = getHandleByPID(targets[started].pid)) == NULL) {
+            fprintf(stderr, "bench_scan: cannot start target %d of %d\n", started + 1, options->processes);
+            if (targets[started].pid > 0)
+                stopTarget(&targets[started]);
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        results[i] = createAddressArray();
+        result->bytes += scannedBytes(handles[i]);
+    }
+
+    result->seconds = result->oneByOne = 1e30;
+    for (int r = 0; r < options->reps; r++) {
+        for (int i = 0; i < started; i++)
+            results[i]->size = 0;
+        double start = nowSeconds();
+        scanTypedMulti(handles, started, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &value, NULL, 0, results, statuses);
+        double elapsed = nowSeconds() - start;
+        result->seconds = elapsed < result->seconds ? elapsed : result->seconds;
+    }
+    for (int i = 0; i < started; i++)
+        result->hits += results[i]->size;
+    for (int r = 0; r < options->reps; r++) {
+        double start = nowSeconds();
+        for (int i = 0; i < started; i++) {
+            results[i]->size = 0;
+            scanTyped(handles[i], SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &value, NULL, 0, results[i]);
+        }
+        double elapsed = nowSeconds() - start;
+        result->oneByOne = elapsed < result->oneByOne ? elapsed : result->oneByOne;
+    }
+    result->processes = started;
+
+    for (int i = 0; i < started; i++)
+        freeAddressArray(results[i]);
+    for (int i = 1; i < started; i++) {
+        closeHandle(handles[i]);
+        stopTarget(&targets[i]);
+    }
+}
+
+static int runSize(const bench_options* options, SIZE_T megabytes) {
+    bench_target target;
+    memset(&target, 0, sizeof(target));
+    fprintf(stderr, "bench_scan: %zu MB\n", (size_t)megabytes);
+    if (!startTarget(&target, options, megabytes)) {
+        fprintf(stderr, "bench_scan: cannot start %s\n", options->target);
+        return 0;
+    }
+    long long planted = targetCommand(&target, 0);
+    HANDLE hProcess = planted >= 0 ? getHandleByPID(target.pid) : NULL;
+    if (hProcess == NULL) {
+        fprintf(stderr, "bench_scan: cannot attach to the target\n");
+        stopTarget(&target);
+        return 0;
+    }
+    int value = BENCH_VALUE;
+    unsigned long long bytes = scannedBytes(hProcess);
+    double firstScan = 1e30, firstSet = 1e30, exportTime = 1e30, bulkRead = 1e30, nextScan = 1e30;
+    vector_uchar_ptr* addresses = createAddressArray();
+    vector_uchar_ptr* scratch = createAddressArray();
+    candidate_set* set = createCandidateArray();
+
+    for (int r = 0; r < options->reps; r++) {
+        addresses->size = 0;
+        double start = nowSeconds();
+        scanTyped(hProcess, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &value, NULL, 0, addresses);
+        double elapsed = nowSeconds() - start;
+        firstScan = elapsed < firstScan ? elapsed : firstScan;
+    }
+
+    for (int r = 0; r < options->reps; r++) {
+        double start = nowSeconds();
+        scanTypedSet(hProcess, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &value, NULL, 0, set);
+        double elapsed = nowSeconds() - start;
+        firstSet = elapsed < firstSet ? elapsed : firstSet;
+    }
+
+    unsigned char** chunk = (unsigned char**)malloc(EXPORT_CHUNK * sizeof(unsigned char*));
+    unsigned long long candidates = getCandidateCount(set);
+    for (int r = 0; r < options->reps && chunk != NULL; r++) {
+        unsigned long long sum = 0;
+        double start = nowSeconds();
+        for (unsigned long long at = 0; at < candidates; at += EXPORT_CHUNK) {
+            unsigned long long copied = copyCandidateAddresses(set, at, EXPORT_CHUNK, chunk);
+            for (unsigned long long i = 0; i < copied; i++)
+                sum += (unsigned long long)(SIZE_T)chunk[i];
+        }
+        double elapsed = nowSeconds() - start;
+        exportTime = elapsed < exportTime ? elapsed : exportTime;
+        exportChecksum += sum;
+    }
+    free(chunk);
+
+    int* values = (int*)malloc((addresses->size ? addresses->size : 1) * sizeof(int));
+    for (int r = 0; r < options->reps && values != NULL; r++) {
+        double start = nowSeconds();
+        readAddressValues(hProcess, addresses, sizeof(int), (unsigned char*)values);
+        double elapsed = nowSeconds() - start;
+        bulkRead = elapsed < bulkRead ? elapsed : bulkRead;
+    }
+    free(values);
+
+    multi_result multi;
+    if (options->processes > 1)
+        runMulti(options, megabytes, hProcess, &multi);
+
+    long long expected = targetCommand(&target, 'n');
+    for (int r = 0; r < options->reps; r++) {
+        if (!copyVector(scratch, addresses)) {
+            fprintf(stderr, "bench_scan: cannot copy %d candidates\n", addresses->size);
+            break;
+        }
+        double start = nowSeconds();
+        scanNextTyped(hProcess, scratch, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &value, NULL);
+        double elapsed = nowSeconds() - start;
+        nextScan = elapsed < nextScan ? elapsed : nextScan;
+    }
+
+    printf("%s    {\n", printedRuns++ ? ",\n" : "");
+    printf("      \"size_mb\": %zu,\n", (size_t)megabytes);
+    printf("      \"planted\": %lld,\n", planted);
+    printf("      \"scanned_bytes\": %llu,\n", bytes);
+    printf("      \"first_scan\": { \"seconds\": %.6f, \"gb_per_s\": %.3f, \"hits\": %d },\n",
+        firstScan, perSecond((double)bytes / 1e9, firstScan), addresses->size);
+    printf("      \"first_scan_set\": { \"seconds\": %.6f, \"gb_per_s\": %.3f, \"hits\": %llu, \"set_bytes\": %zu },\n",
+        firstSet, perSecond((double)bytes / 1e9, firstSet), candidates, (size_t)getCandidateMemoryUsage(set));
+    printf("      \"export\": { \"seconds\": %.6f, \"candidates_per_s\": %.0f, \"candidates\": %llu },\n",
+        exportTime, perSecond((double)candidates, exportTime), candidates);
+    printf("      \"bulk_read\": { \"seconds\": %.6f, \"candidates_per_s\": %.0f, \"candidates\": %d },\n",
+        bulkRead, perSecond((double)addresses->size, bulkRead), addresses->size);
+    printf("      \"next_scan\": { \"seconds\": %.6f, \"candidates_per_s\": %.0f, \"candidates\": %d, \"kept\": %d, \"expected\": %lld }",
+        nextScan, perSecond((double)addresses->size, nextScan), addresses->size, scratch->size, expected);
+    if (options->processes > 1)
+        printf(",\n      \"multi_scan\": { \"processes\": %d, \"seconds\": %.6f, \"gb_per_s\": %.3f, \"hits\": %llu, \"one_by_one_seconds\": %.6f, \"one_by_one_gb_per_s\": %.3f }",
+            multi.processes, multi.seconds, perSecond((double)multi.bytes / 1e9, multi.seconds), multi.hits,
+            multi.oneByOne, perSecond((double)multi.bytes / 1e9, multi.oneByOne));
+    printf("\n    }");
+    fflush(stdout);
+
+    freeCandidateArray(set);
+    freeAddressArray(scratch);
+    freeAddressArray(addresses);
+    closeHandle(hProcess);
+    stopTarget(&target);
+    return 1;
+}
+
+static void parseSizes(bench_options* options, const char* list) {
+    options->sizeCount = 0;
+    while (*list && options->sizeCount < BENCH_MAX_SIZES) {
+        char* end;
+        unsigned long size = strtoul(list, &end, 10);
+        if (end == list)
+            break;
+        if (size > 0)
+            options->sizes[options->sizeCount++] = (SIZE_T)size;
+        list = *end == ',' ? end + 1 : end;
+    }
+}
+
+int main(int argc, char** argv) {
+    bench_options options;
+    options.sizes[0] = 64;
+    options.sizes[1] = 256;
+    options.sizes[2] = 1024;
+    options.sizeCount = 3;
+    options.density = 256;
+    options.regions = 16;
+    options.fragmentation = 0;
+    options.reps = 3;
+    options.threads = 1;
+    options.processes = 1;
+#ifdef _WIN32
+    options.target = "bench_target.exe";
+#else
+    options.target = "./bench_target";
+#endif
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strncmp(arg, "sizes=", 6) == 0)
+            parseSizes(&options, arg + 6);
+        else if (strncmp(arg, "density=", 8) == 0)
+            options.density = (SIZE_T)atol(arg + 8);
+        else if (strncmp(arg, "regions=", 8) == 0)
+            options.regions = atoi(arg + 8);
+        else if (strncmp(arg, "fragmentation=", 14) == 0)
+            options.fragmentation = atoi(arg + 14);
+        else if (strncmp(arg, "reps=", 5) == 0)
+            options.reps = atoi(arg + 5);
+        else if (strncmp(arg, "threads=", 8) == 0)
+            options.threads = atoi(arg + 8);
+        else if (strncmp(arg, "processes=", 10) == 0)
+            options.processes = atoi(arg + 10);
+        else if (strncmp(arg, "target=", 7) == 0)
+            options.target = arg + 7;
+        else {
+            fprintf(stderr, "bench_scan: unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    if (options.reps < 1)
+        options.reps = 1;
+    if (options.processes > BENCH_MAX_PROCESSES)
+        options.processes = BENCH_MAX_PROCESSES;
+
+    int threads = setScanThreadCount(options.threads);
+    printf("{\n");
+    printf("  \"benchmark\": \"bench_scan\",\n");
+    printf("  \"isa\": \"%s\",\n", SCAN_ISA_NAMES[currentScanISA()]);
+    printf("  \"threads\": %d,\n", threads);
+    printf("  \"processes\": %d,\n", options.processes > 1 ? options.processes : 1);
+    printf("  \"reps\": %d,\n", options.reps);
+    printf("  \"density_per_mb\": %zu,\n", (size_t)options.density);
+    printf("  \"regions\": %d,\n", options.regions);
+    printf("  \"fragmentation_percent\": %d,\n", options.fragmentation);
+    printf("  \"runs\": [\n");
+    int ok = 1;
+    for (int i = 0; i < options.sizeCount; i++)
+        ok &= runSize(&options, options.sizes[i]);
+    printf("\n  ],\n");
+    printf("  \"peak_rss_bytes\": %llu\n}\n", peakRssBytes());
+    return ok ? 0 : 1;
+}
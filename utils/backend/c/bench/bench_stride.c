@@ -0,0 +1,133 @@
+/*
+ * bench_stride.c
+ *
+ * Description:
+ * Microbenchmark for scans with a stride (alignment) below the value size.
+ * Runs the predicate kernels of predicates.h over a synthetic buffer with a
+ * stride of sizeof(T) (the aligned scan, kernelPredicate) and with every
+ * smaller stride (kernelPredicateStrided), and reports throughput in GB/s and
+ * the cost relative to the aligned scan. A strided scan tests sizeof(T) /
+ * stride times as many positions, so a relative cost below that factor means
+ * the shifted loads are cheaper than separate passes.
+ *
+ * Build:
+ * - MSVC : cl /O2 /I.. bench_stride.c
+ * - MinGW: gcc -O2 -I.. bench_stride.c -o bench_stride.exe
+ *
+ * Usage:
+ * bench_stride [buffer size in MB, default 64] [repetitions, default 5]
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stddef.h>
+typedef size_t SIZE_T;
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "vectors.h"
+#include "kernels.h"
+#include "predicates.h"
+#include "valuetypes.h"
+
+#define HIT_EVERY 4099
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static unsigned int nextRandom(unsigned int* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Plants the value at odd offsets so that only the stride 1 scan finds all of them.
+static void fillBuffer(unsigned char* buffer, SIZE_T size, const void* value, SIZE_T width) {
+    unsigned int state = 0x9E3779B9u;
+    for (SIZE_T i = 0; i + sizeof(unsigned int) <= size; i += sizeof(unsigned int)) {
+        unsigned int r = nextRandom(&state) | 1u;
+        memcpy(buffer + i, &r, sizeof(r));
+    }
+    for (SIZE_T i = 1; i + width <= size; i += HIT_EVERY)
+        memcpy(buffer + i, value, width);
+}
+
+static double timeScan(scan_kernel kernel, const predicate_target* target, const unsigned char* buffer,
+    SIZE_T size, int reps, vector_uchar_ptr* hits) {
+    SIZE_T count = (size - target->width) / target->stride + 1;
+    double best = 1e30;
+    for (int r = 0; r < reps; r++) {
+        hits->size = 0;
+        double start = nowSeconds();
+        kernel(buffer, count, target, (unsigned char*)0x10000, hits);
+        double elapsed = nowSeconds() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+static void runStrides(const char* type, const char* name, const mask_kernel table[][SCAN_ISA_COUNT],
+    const scan_predicate* predicate, const void* value, unsigned char* buffer, SIZE_T size, SIZE_T width, int reps) {
+    vector_uchar_ptr hits;
+    createVectorUCharPtr(&hits);
+    fillBuffer(buffer, size, value, width);
+
+    predicate_target target;
+    target.mask = selectMaskKernel(table, predicate->kind);
+    target.width = width;
+    target.predicate = *predicate;
+
+    target.stride = width;
+    double aligned = timeScan(kernelPredicate, &target, buffer, size, reps, &hits);
+    printf("%-7s %-8s stride %zu %8.2f GB/s  1.00x  %d hits\n", type, name, (size_t)width,
+        (double)size / aligned / 1e9, hits.size);
+
+    for (SIZE_T stride = width / 2; stride >= 1; stride /= 2) {
+        target.stride = stride;
+        double elapsed = timeScan(kernelPredicateStrided, &target, buffer, size, reps, &hits);
+        printf("%-7s %-8s stride %zu %8.2f GB/s  %.2fx  %d hits (%zu positions per value)\n", type, name,
+            (size_t)stride, (double)size / elapsed / 1e9, elapsed / aligned, hits.size, (size_t)(width / stride));
+    }
+    deleteVectorUCharPtr(&hits);
+}
+
+int main(int argc, char** argv) {
+    SIZE_T megabytes = argc > 1 ? (SIZE_T)atol(argv[1]) : 64;
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    SIZE_T size = megabytes * 1024 * 1024;
+    unsigned char* buffer = (unsigned char*)malloc(size);
+    if (buffer == NULL) {
+        printf("Failed to allocate %zu MB\n", (size_t)megabytes);
+        return 1;
+    }
+
+    printf("buffer %zu MB, best of %d, level: %s\n", (size_t)megabytes, reps, SCAN_ISA_NAMES[currentScanISA()]);
+
+    scan_predicate predicate;
+    int intValue = 1337, intLow = 1000, intHigh = 2000;
+    makePredicateI32(&predicate, SCAN_PREDICATE_EQUAL, &intValue, NULL);
+    runStrides("int", "equal", MASKS_INT, &predicate, &intValue, buffer, size, sizeof(int), reps);
+    makePredicateI32(&predicate, SCAN_PREDICATE_RANGE, &intLow, &intHigh);
+    runStrides("int", "range", MASKS_INT, &predicate, &intValue, buffer, size, sizeof(int), reps);
+
+    float floatValue = 13.37f, floatEpsilon = 0.01f;
+    makePredicateF32(&predicate, SCAN_PREDICATE_EPSILON, &floatValue, &floatEpsilon);
+    runStrides("float", "epsilon", MASKS_FLOAT, &predicate, &floatValue, buffer, size, sizeof(float), reps);
+
+    double doubleValue = 13.37, doubleEpsilon = 1e-6;
+    makePredicateF64(&predicate, SCAN_PREDICATE_EQUAL, &doubleValue, NULL);
+    runStrides("double", "equal", MASKS_DOUBLE, &predicate, &doubleValue, buffer, size, sizeof(double), reps);
+    makePredicateF64(&predicate, SCAN_PREDICATE_EPSILON, &doubleValue, &doubleEpsilon);
+    runStrides("double", "epsilon", MASKS_DOUBLE, &predicate, &doubleValue, buffer, size, sizeof(double), reps);
+
+    free(buffer);
+    return 0;
+}
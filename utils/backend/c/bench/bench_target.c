@@ -0,0 +1,165 @@
+/*
+ * bench_target.c
+ *
+ * Description:
+ * Synthetic target process for bench_scan. Allocates a heap of known shape,
+ * plants a known value in it and then waits for commands on stdin, so every
+ * run of the benchmark scans exactly the same memory.
+ *
+ * The heap is split into `regions` separate allocations. Every region is
+ * filled with pseudo random 32 bit values that never equal the planted value,
+ * then `density` values per MB are planted at evenly spaced, 4 byte aligned
+ * offsets. With a fragmentation of F percent, F out of every 100 pages of a
+ * region are made inaccessible afterwards (the region is split into many
+ * small ones for the scanner); values planted there are not counted.
+ *
+ * Once ready the target prints one line, "<planted>", with the number of
+ * planted values that can be read. Commands (one character each):
+ * - 'n': adds one to every second planted value and prints the number of
+ *        planted values still equal to the value, for a next scan.
+ * - end of input: exits.
+ *
+ * Build:
+ * - MSVC : cl /O2 bench_target.c
+ * - MinGW: gcc -O2 bench_target.c -o bench_target.exe
+ *
+ * Usage:
+ * bench_target <heap size in MB> [values per MB, default 256] [regions, default 16]
+ *              [fragmentation percent, default 0] [value, default 1234567]
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
+typedef size_t SIZE_T;
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PAGE_BYTES 4096
+
+typedef struct {
+    unsigned char* base;
+    SIZE_T size;
+} target_region;
+
+static unsigned int nextRandom(unsigned int* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static unsigned char* allocateRegion(SIZE_T size) {
+#ifdef _WIN32
+    return (unsigned char*)VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return base == MAP_FAILED ? NULL : (unsigned char*)base;
+#endif
+}
+
+static void protectPage(unsigned char* page) {
+#ifdef _WIN32
+    DWORD old;
+    VirtualProtect(page, PAGE_BYTES, PAGE_NOACCESS, &old);
+#else
+    mprotect(page, PAGE_BYTES, PROT_NONE);
+#endif
+}
+
+// The pages made inaccessible by a fragmentation of `percent`, spread evenly over every 100 pages.
+static int isHolePage(SIZE_T page, int percent) {
+    return (int)(page % 100) * percent / 100 != (int)((page % 100) + 1) * percent / 100;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: bench_target <heap MB> [values per MB] [regions] [fragmentation %%] [value]\n");
+        return 1;
+    }
+    SIZE_T megabytes = (SIZE_T)atol(argv[1]);
+    SIZE_T density = argc > 2 ? (SIZE_T)atol(argv[2]) : 256;
+    int regionCount = argc > 3 ? atoi(argv[3]) : 16;
+    int fragmentation = argc > 4 ? atoi(argv[4]) : 0;
+    volatile unsigned int value = argc > 5 ? (unsigned int)strtoul(argv[5], NULL, 0) : 1234567u;
+    if (regionCount < 1)
+        regionCount = 1;
+    if (fragmentation < 0 || fragmentation > 99)
+        fragmentation = 0;
+    if (density > 1024 * 1024 / sizeof(unsigned int))
+        density = 1024 * 1024 / sizeof(unsigned int);
+
+    SIZE_T pages = (megabytes * 1024 * 1024 / PAGE_BYTES + regionCount - 1) / regionCount;
+    SIZE_T regionSize = (pages ? pages : 1) * PAGE_BYTES;
+    SIZE_T spacing = density ? (1024 * 1024 / density) & ~(SIZE_T)3 : 0;
+    target_region* regions = (target_region*)calloc(regionCount, sizeof(target_region));
+    unsigned int** planted = NULL;
+    SIZE_T plantedCount = 0, plantedCapacity = 0;
+    unsigned int state = 0x9E3779B9u;
+    if (regions == NULL)
+        return 1;
+
+    for (int r = 0; r < regionCount; r++) {
+        unsigned char* base = allocateRegion(regionSize);
+        if (base == NULL) {
+            fprintf(stderr, "bench_target: failed to allocate region %d\n", r);
+            return 1;
+        }
+        regions[r].base = base;
+        regions[r].size = regionSize;
+        for (SIZE_T i = 0; i + sizeof(unsigned int) <= regionSize; i += sizeof(unsigned int)) {
+            unsigned int random = nextRandom(&state);
+            if (random == value || random == value + 1)
+                random ^= 0x80000000u;
+            memcpy(base + i, &random, sizeof(random));
+        }
+        for (SIZE_T offset = spacing / 2; spacing && offset + sizeof(unsigned int) <= regionSize; offset += spacing) {
+            if (fragmentation && isHolePage(offset / PAGE_BYTES, fragmentation))
+                continue;
+            if (plantedCount == plantedCapacity) {
+                plantedCapacity = plantedCapacity ? plantedCapacity * 2 : 4096;
+                unsigned int** grown = (unsigned int**)realloc(planted, plantedCapacity * sizeof(unsigned int*));
+                if (grown == NULL)
+                    return 1;
+                planted = grown;
+            }
+            planted[plantedCount] = (unsigned int*)(base + offset);
+            *planted[plantedCount++] = value;
+        }
+        if (fragmentation) {
+            for (SIZE_T page = 0; page < regionSize / PAGE_BYTES; page++) {
+                if (isHolePage(page, fragmentation))
+                    protectPage(base + page * PAGE_BYTES);
+            }
+        }
+    }
+
+    // Only the heap may hold the value, or the scans would find more than was planted.
+    volatile unsigned int hidden = value ^ 0xA5A5A5A5u;
+    value = 0;
+    printf("%llu\n", (unsigned long long)plantedCount);
+    fflush(stdout);
+
+    int command;
+    while ((command = getchar()) != EOF) {
+        if (command != 'n')
+            continue;
+        SIZE_T matching = 0, remaining = 0;
+        for (SIZE_T i = 0; i < plantedCount; i++) {
+            if (*planted[i] != (hidden ^ 0xA5A5A5A5u))
+                continue;
+            if (matching++ % 2 == 0)
+                (*planted[i])++;
+            else
+                remaining++;
+        }
+        printf("%llu\n", (unsigned long long)remaining);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,436 @@
+/*
+ * candidates.h
+ *
+ * Description:
+ * A compact, ordered set of candidate addresses, used instead of a
+ * vector_uchar_ptr when a scan is expected to produce many hits.
+ *
+ * The set is a list of segments, one per scanned chunk (at most
+ * SCAN_WINDOW_SIZE bytes of one region). Candidate positions inside a segment
+ * are stored as offsets from the segment base in units of the scan stride,
+ * in whichever of two encodings is smaller:
+ * - CANDIDATE_BITMAP : one bit per position of the segment. Dense results such
+ *                      as a scan for 0 cost at most 1 bit per position.
+ * - CANDIDATE_DELTA  : the gaps between consecutive offsets as LEB128 varints,
+ *                      typically 1 to 3 bytes per candidate for sparse results.
+ * Either way a candidate costs far less than an 8 byte pointer, the set never
+ * reallocs one huge array, and counts are 64 bit.
+ *
+ * Every segment keeps a sample table (every 64th candidate for delta, the
+ * running count before every 4096 bits for bitmaps), so random access costs
+ * a binary search over the segments plus at most one sample span.
+ *
+ * Scans never touch the encodings directly: a segment is decoded into a
+ * scratch vector_uchar_ptr (bounded by the segment size), processed with the
+ * usual vector code (next scan compaction, filterVectorUCharPtr) and encoded
+ * again.
+ *
+ * Usage:
+ * - candidate_set set; createCandidateSet(&set, stride);
+ * - encodeCandidateSegment(&segment, base, span / stride, stride, addresses, count);  // sorted
+ *   adoptCandidateSegment(&set, &segment);
+ * - getCandidate(&set, index), decodeCandidateRange(&set, start, count, out)
+ * - filterCandidateSet(&set, keep, context, &scratch);
+ * - deleteCandidateSet(&set);
+ */
+
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "vectors.h"
+#include "kernels.h"
+
+#define CANDIDATE_SAMPLE_EVERY 64
+#define CANDIDATE_BLOCK_WORDS 64
+
+enum {
+    CANDIDATE_BITMAP = 0,
+    CANDIDATE_DELTA = 1
+};
+
+typedef struct {
+    unsigned int byteOffset;    // delta: where the sampled candidate's varint starts
+    unsigned int value;         // delta: its position; bitmap: candidates before the block
+} candidate_sample;
+
+typedef struct {
+    unsigned char* base;
+    SIZE_T positions;           // positions covered, base + i * unit for i < positions
+    unsigned long long first;   // index of the first candidate of this segment in the set
+    unsigned long long count;
+    int encoding;
+    unsigned char* data;
+    SIZE_T length;
+    candidate_sample* samples;
+    SIZE_T sampleCount;
+} candidate_segment;
+
+typedef struct {
+    candidate_segment* segments;
+    SIZE_T segmentCount;
+    SIZE_T segmentCapacity;
+    unsigned long long count;
+    SIZE_T unit;
+} candidate_set;
+
+static void createCandidateSet(candidate_set* set, SIZE_T unit) {
+    memset(set, 0, sizeof(*set));
+    set->unit = unit ? unit : 1;
+}
+
+static void freeCandidateSegment(candidate_segment* segment) {
+    free(segment->data);
+    free(segment->samples);
+    segment->data = NULL;
+    segment->samples = NULL;
+}
+
+static void clearCandidateSet(candidate_set* set, SIZE_T unit) {
+    for (SIZE_T i = 0; i < set->segmentCount; i++)
+        freeCandidateSegment(&set->segments[i]);
+    set->segmentCount = 0;
+    set->count = 0;
+    set->unit = unit ? unit : 1;
+}
+
+static void deleteCandidateSet(candidate_set* set) {
+    clearCandidateSet(set, set->unit);
+    free(set->segments);
+    set->segments = NULL;
+    set->segmentCapacity = 0;
+}
+
+static SIZE_T candidateSetMemoryUsage(const candidate_set* set) {
+    SIZE_T total = sizeof(*set) + set->segmentCapacity * sizeof(candidate_segment);
+    for (SIZE_T i = 0; i < set->segmentCount; i++)
+        total += set->segments[i].length + set->segments[i].sampleCount * sizeof(candidate_sample);
+    return total;
+}
+
+// Encoding
+
+static inline SIZE_T varintLength(SIZE_T value) {
+    SIZE_T length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static inline unsigned char* writeVarint(unsigned char* out, SIZE_T value) {
+    while (value >= 0x80) {
+        *out++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+static inline const unsigned char* readVarint(const unsigned char* in, SIZE_T* value) {
+    SIZE_T result = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        result |= (SIZE_T)(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    *value = result | ((SIZE_T)*in++ << shift);
+    return in;
+}
+
+static inline unsigned int popcount64(unsigned long long word) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    return (unsigned int)__popcnt64(word);
+#elif defined(_MSC_VER)
+    return __popcnt((unsigned int)word) + __popcnt((unsigned int)(word >> 32));
+#else
+    return (unsigned int)__builtin_popcountll(word);
+#endif
+}
+
+/*
+ * Encodes count sorted addresses, all inside [base, base + positions * unit),
+ * into segment with the smaller of the two encodings.
+ * Returns: 1 on success, -1 Memory Allocation Failure.
+ */
+static int encodeCandidateSegment(candidate_segment* segment, unsigned char* base, SIZE_T positions, SIZE_T unit,
+    unsigned char* const* addresses, SIZE_T count) {
+    memset(segment, 0, sizeof(*segment));
+    segment->base = base;
+    segment->positions = positions;
+    segment->count = count;
+    if (count == 0)
+        return 1;
+
+    SIZE_T deltaBytes = 0, previous = 0;
+    for (SIZE_T i = 0; i < count; i++) {
+        SIZE_T position = (SIZE_T)(addresses[i] - base) / unit;
+        deltaBytes += varintLength(i ? position - previous : position);
+        previous = position;
+    }
+    SIZE_T words = (positions + 63) / 64;
+
+    if (words * sizeof(unsigned long long) <= deltaBytes) {
+        SIZE_T blocks = (words + CANDIDATE_BLOCK_WORDS - 1) / CANDIDATE_BLOCK_WORDS;
+        unsigned long long* bits = (unsigned long long*)calloc(words, sizeof(unsigned long long));
+        segment->samples = (candidate_sample*)malloc(blocks * sizeof(candidate_sample));
+        if (bits == NULL || segment->samples == NULL) {
+            free(bits);
+            freeCandidateSegment(segment);
+            return -1;
+        }
+        for (SIZE_T i = 0; i < count; i++) {
+            SIZE_T position = (SIZE_T)(addresses[i] - base) / unit;
+            bits[position / 64] |= 1ull << (position % 64);
+        }
+        unsigned int running = 0;
+        for (SIZE_T w = 0; w < words; w++) {
+            if (w % CANDIDATE_BLOCK_WORDS == 0)
+                segment->samples[w / CANDIDATE_BLOCK_WORDS].value = running;
+            running += popcount64(bits[w]);
+        }
+        segment->encoding = CANDIDATE_BITMAP;
+        segment->data = (unsigned char*)bits;
+        segment->length = words * sizeof(unsigned long long);
+        segment->sampleCount = blocks;
+        return 1;
+    }
+
+    SIZE_T samples = (count + CANDIDATE_SAMPLE_EVERY - 1) / CANDIDATE_SAMPLE_EVERY;
+    segment->data = (unsigned char*)malloc(deltaBytes);
+    segment->samples = (candidate_sample*)malloc(samples * sizeof(candidate_sample));
+    if (segment->data == NULL || segment->samples == NULL) {
+        freeCandidateSegment(segment);
+        return -1;
+    }
+    unsigned char* out = segment->data;
+    previous = 0;
+    for (SIZE_T i = 0; i < count; i++) {
+        SIZE_T position = (SIZE_T)(addresses[i] - base) / unit;
+        if (i % CANDIDATE_SAMPLE_EVERY == 0) {
+            segment->samples[i / CANDIDATE_SAMPLE_EVERY].byteOffset = (unsigned int)(out - segment->data);
+            segment->samples[i / CANDIDATE_SAMPLE_EVERY].value = (unsigned int)position;
+        }
+        out = writeVarint(out, i ? position - previous : position);
+        previous = position;
+    }
+    segment->encoding = CANDIDATE_DELTA;
+    segment->length = deltaBytes;
+    segment->sampleCount = samples;
+    return 1;
+}
+
+/*
+ * Appends the candidates [start, start + count) of segment (segment local
+ * indexes) to out.
+ * Returns: 1 on success, -1 Memory Allocation Failure.
+ */
+static int decodeCandidateSegment(const candidate_segment* segment, SIZE_T unit, SIZE_T start, SIZE_T count,
+    vector_uchar_ptr* out) {
+    if (count == 0)
+        return 1;
+    if ((SIZE_T)out->size + count > (SIZE_T)0x7FFFFFFF || !reserveVectorUCharPtr(out, out->size + (int)count))
+        return -1;
+
+    if (segment->encoding == CANDIDATE_DELTA) {
+        const candidate_sample* sample = &segment->samples[start / CANDIDATE_SAMPLE_EVERY];
+        const unsigned char* in = segment->data + sample->byteOffset;
+        SIZE_T position = sample->value, gap;
+        in = readVarint(in, &gap); // the sampled candidate itself
+        for (SIZE_T i = start / CANDIDATE_SAMPLE_EVERY * CANDIDATE_SAMPLE_EVERY; i < start; i++) {
+            in = readVarint(in, &gap);
+            position += gap;
+        }
+        out->array[out->size++] = segment->base + position * unit;
+        for (SIZE_T i = 1; i < count; i++) {
+            in = readVarint(in, &gap);
+            position += gap;
+            out->array[out->size++] = segment->base + position * unit;
+        }
+        return 1;
+    }
+
+    // Bitmap: find the block holding candidate `start`, then the word.
+    const unsigned long long* bits = (const unsigned long long*)segment->data;
+    SIZE_T lo = 0, hi = segment->sampleCount;
+    while (hi - lo > 1) {
+        SIZE_T mid = (lo + hi) / 2;
+        if (segment->samples[mid].value <= start)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    SIZE_T word = lo * CANDIDATE_BLOCK_WORDS, seen = segment->samples[lo].value;
+    SIZE_T words = segment->length / sizeof(unsigned long long);
+    while (seen + popcount64(bits[word]) <= start) {
+        seen += popcount64(bits[word]);
+        word++;
+    }
+    unsigned long long current = bits[word];
+    for (; seen < start; seen++)
+        current &= current - 1;
+
+    SIZE_T produced = 0;
+    for (;;) {
+        while (current && produced < count) {
+            out->array[out->size++] = segment->base + (word * 64 + lowestSetBit(current)) * unit;
+            current &= current - 1;
+            produced++;
+        }
+        if (produced == count || ++word >= words)
+            break;
+        current = bits[word];
+    }
+    return 1;
+}
+
+// Set building
+
+// Moves an already encoded segment (e.g. built by a scan worker) to the end of the set.
+static int adoptCandidateSegment(candidate_set* set, candidate_segment* segment) {
+    if (segment->count == 0) {
+        freeCandidateSegment(segment);
+        return 1;
+    }
+    if (set->segmentCount == set->segmentCapacity) {
+        SIZE_T capacity = set->segmentCapacity ? set->segmentCapacity * 2 : 64;
+        candidate_segment* grown = (candidate_segment*)realloc(set->segments, capacity * sizeof(candidate_segment));
+        if (grown == NULL)
+            return -1;
+        set->segments = grown;
+        set->segmentCapacity = capacity;
+    }
+    segment->first = set->count;
+    set->count += segment->count;
+    set->segments[set->segmentCount++] = *segment;
+    memset(segment, 0, sizeof(*segment));
+    return 1;
+}
+
+// Access
+
+static SIZE_T findCandidateSegment(const candidate_set* set, unsigned long long index) {
+    SIZE_T lo = 0, hi = set->segmentCount;
+    while (hi - lo > 1) {
+        SIZE_T mid = (lo + hi) / 2;
+        if (set->segments[mid].first <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Returns the candidate at index, or NULL if index is out of range.
+static unsigned char* getCandidate(const candidate_set* set, unsigned long long index) {
+    if (index >= set->count)
+        return NULL;
+    const candidate_segment* segment = &set->segments[findCandidateSegment(set, index)];
+    unsigned char* address = NULL;
+    vector_uchar_ptr one = { &address, 0, 1 };
+    decodeCandidateSegment(segment, set->unit, (SIZE_T)(index - segment->first), 1, &one);
+    return address;
+}
+
+/*
+ * Appends the candidates [start, start + count) of the set to out, in order.
+ * Returns: 1 on success, -1 Memory Allocation Failure.
+ */
+static int decodeCandidateRange(const candidate_set* set, unsigned long long start, unsigned long long count,
+    vector_uchar_ptr* out) {
+    if (start >= set->count || count == 0)
+        return 1;
+    if (count > set->count - start)
+        count = set->count - start;
+    SIZE_T s = findCandidateSegment(set, start);
+    while (count > 0 && s < set->segmentCount) {
+        const candidate_segment* segment = &set->segments[s++];
+        SIZE_T local = (SIZE_T)(start - segment->first);
+        SIZE_T take = (SIZE_T)(segment->count - local < count ? segment->count - local : count);
+        if (decodeCandidateSegment(segment, set->unit, local, take, out) < 0)
+            return -1;
+        start += take;
+        count -= take;
+    }
+    return 1;
+}
+
+// Filtering
+
+typedef int (*segment_filter)(void* context, vector_uchar_ptr* candidates);
+
+/*
+ * Decodes every segment into scratch, lets filter() compact it in place and
+ * re-encodes what is left; empty segments are dropped. The candidate order
+ * never changes.
+ * Returns: 1 on success, -1 Memory Allocation Failure, or the first other
+ * negative result of filter().
+ */
+static int filterCandidateSegments(candidate_set* set, segment_filter filter, void* context, vector_uchar_ptr* scratch) {
+    SIZE_T kept = 0;
+    unsigned long long total = 0;
+    int result = 1;
+    for (SIZE_T i = 0; i < set->segmentCount; i++) {
+        candidate_segment* segment = &set->segments[i];
+        if (result == 1) {
+            scratch->size = 0;
+            result = decodeCandidateSegment(segment, set->unit, 0, (SIZE_T)segment->count, scratch);
+            if (result == 1)
+                result = filter(context, scratch);
+        }
+        if (result != 1) {
+            // keep the remaining segments untouched
+            set->segments[kept] = *segment;
+            set->segments[kept].first = total;
+            total += segment->count;
+            kept++;
+            continue;
+        }
+
+        candidate_segment encoded;
+        if ((SIZE_T)scratch->size == segment->count) {
+            encoded = *segment;
+        }
+        else {
+            if (encodeCandidateSegment(&encoded, segment->base, segment->positions, set->unit,
+                scratch->array, scratch->size) < 0) {
+                result = -1;
+                set->segments[kept] = *segment;
+                set->segments[kept].first = total;
+                total += segment->count;
+                kept++;
+                continue;
+            }
+            freeCandidateSegment(segment);
+        }
+        if (encoded.count == 0)
+            continue;
+        encoded.first = total;
+        total += encoded.count;
+        set->segments[kept++] = encoded;
+    }
+    set->segmentCount = kept;
+    set->count = total;
+    return result;
+}
+
+typedef struct {
+    int (*keep)(void* context, unsigned char* element);
+    void* context;
+} candidate_keep;
+
+static int keepFilter(void* context, vector_uchar_ptr* candidates) {
+    candidate_keep* keep = (candidate_keep*)context;
+    filterVectorUCharPtr(candidates, keep->keep, keep->context);
+    return 1;
+}
+
+static int filterCandidateSet(candidate_set* set, int (*keep)(void* context, unsigned char* element), void* context,
+    vector_uchar_ptr* scratch) {
+    candidate_keep filter = { keep, context };
+    return filterCandidateSegments(set, keepFilter, &filter, scratch);
+}
+
+#endif // CANDIDATES_H
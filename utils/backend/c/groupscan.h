@@ -0,0 +1,284 @@
+/*
+ * groupscan.h
+ *
+ * Description:
+ * Group scan: finds structures whose fields are known together, e.g. an int
+ * 100, an int 30 and a float 1.5 within a few dozen bytes of each other, in
+ * one pass instead of one scan per value and an intersection afterwards.
+ *
+ * A group is a list of terms, each a value type, a predicate and its operands
+ * (as for the typed scans). The first term is the anchor; the scan returns
+ * the anchor addresses of the matching groups. Every other term is either
+ * - fixed: at a known offset in bytes from the anchor (may be negative), or
+ * - free : anywhere from span bytes before to span bytes after the anchor, at
+ *          the alignment of the scan (0: the width of the term).
+ * Terms are matched independently, so two free terms may match one value.
+ *
+ * Only one term is tested at every position of a window: the prefilter, the
+ * fixed term ranked rarest by groupTermRank() (an equal compare on a value
+ * with many informative bytes ranks highest, a less / greater compare lowest).
+ * It runs on the predicate mask kernels of the typed scans (kernelPredicate,
+ * or kernelPredicateStrided when the anchor alignment is finer than its
+ * width), so the prefilter is as fast as a single typed scan. The remaining
+ * terms are verified around each prefilter hit while the window is still in
+ * cache, fixed terms first. A group reaching past the window is completed with
+ * small page sized reads of the target; unreadable pages fail the terms in them.
+ *
+ * kernelGroup has the scan_kernel signature, so a group runs on the windowed,
+ * parallel region walk of the first scans with the width of the prefilter.
+ *
+ * Usage:
+ * - group_term terms[3] = { ... };     // type, kind, offset, fixed, operands
+ * - group_scan group;
+ *   if (compileGroup(&group, hProcess, terms, 3, 64, 0))
+ *       kernelGroup(buffer, count, &group, remoteBase, anchors);
+ *
+ * Note:
+ * - Include `memsource.h`, `predicates.h` and `valuetypes.h` before this header.
+ * - The buffer passed to kernelGroup holds the positions of the prefilter:
+ *   count positions group.prefilter.stride apart, group.prefilter.width bytes each.
+ */
+
+#ifndef GROUPSCAN_H
+#define GROUPSCAN_H
+
+#include <string.h>
+#include "valuetypes.h"
+
+#define GROUP_MAX_TERMS 16
+#define GROUP_MAX_REACH 4096    // largest |offset| and span, in bytes
+#define GROUP_PAGE_SIZE 4096
+
+typedef struct {
+    int type;                   // SCAN_TYPE_*
+    int kind;                   // SCAN_PREDICATE_*
+    int offset;                 // bytes from the anchor, fixed terms only
+    int fixed;                  // 0: anywhere within span bytes of the anchor
+    unsigned char a[8];         // operands, in the first bytes as the type
+    unsigned char b[8];
+} group_term;
+
+typedef struct {
+    mask_kernel mask;
+    scan_predicate predicate;
+    SIZE_T width;
+    SIZE_T step;                // alignment of a free term
+    long long offset;
+    int fixed;
+} group_check;
+
+typedef struct {
+    HANDLE hProcess;
+    predicate_target prefilter;
+    scan_kernel prefilterKernel;
+    long long prefilterOffset;  // of the prefilter from the anchor
+    SIZE_T anchorStride;
+    SIZE_T before;              // the group lies in [anchor - before, anchor + after)
+    SIZE_T after;
+    long long span;
+    int checkCount;
+    group_check checks[GROUP_MAX_TERMS];    // fixed terms first, the prefilter left out
+} group_scan;
+
+// Higher is rarer.
+static int groupTermRank(const scan_predicate* predicate, SIZE_T width) {
+    const unsigned char* bytes = (const unsigned char*)&predicate->a;
+    const unsigned char* mask = (const unsigned char*)&predicate->b;
+    int rank = 0;
+    switch (predicate->kind) {
+    case SCAN_PREDICATE_EQUAL:
+        // Zero and all ones bytes fill most of any address space.
+        for (SIZE_T i = 0; i < width; i++)
+            rank += bytes[i] != 0x00 && bytes[i] != 0xFF ? 16 : 0;
+        return 8 + rank;
+    case SCAN_PREDICATE_MASKED:
+        for (SIZE_T i = 0; i < width; i++)
+            for (unsigned char m = mask[i]; m; m &= m - 1)
+                rank += 2;
+        return rank;
+    case SCAN_PREDICATE_EPSILON:
+    case SCAN_PREDICATE_RANGE:
+        return 6;
+    default:
+        return 1;
+    }
+}
+
+/*
+ * Sets up the scan of count terms; alignment is 0 (the width of each term),
+ * 1, 2, 4 or 8 and applies to the anchor and the free terms.
+ * Returns 1, or 0 for an invalid term, count, span or alignment.
+ */
+static int compileGroup(group_scan* group, HANDLE hProcess, const group_term* terms, int count, int span, int alignment) {
+    group_check all[GROUP_MAX_TERMS];
+    int best = 0, bestRank = -1;
+    memset(group, 0, sizeof(*group));
+    if (count < 1 || count > GROUP_MAX_TERMS || span < 0 || span > GROUP_MAX_REACH
+        || !(alignment == 0 || alignment == 1 || alignment == 2 || alignment == 4 || alignment == 8))
+        return 0;
+    group->hProcess = hProcess;
+    group->span = span;
+    for (int i = 0; i < count; i++) {
+        const scan_value_type* info = scanValueType(terms[i].type);
+        group_check* check = &all[i];
+        if (info == NULL || !info->makePredicate(&check->predicate, terms[i].kind, terms[i].a, terms[i].b))
+            return 0;
+        check->mask = selectMaskKernel(info->masks, check->predicate.kind);
+        check->width = info->width;
+        check->step = alignment ? (SIZE_T)alignment : info->width;
+        check->fixed = i == 0 || terms[i].fixed;
+        check->offset = i == 0 ? 0 : terms[i].offset;
+        if (check->fixed && (check->offset < -GROUP_MAX_REACH || check->offset > GROUP_MAX_REACH))
+            return 0;
+        SIZE_T before = check->fixed ? (check->offset < 0 ? (SIZE_T)-check->offset : 0) : (SIZE_T)span;
+        long long end = (check->fixed ? check->offset : span) + (long long)check->width;
+        SIZE_T after = end > 0 ? (SIZE_T)end : 0;
+        if (before > group->before)
+            group->before = before;
+        if (after > group->after)
+            group->after = after;
+        int rank = check->fixed ? groupTermRank(&check->predicate, check->width) : -1;
+        if (rank > bestRank) {
+            best = i;
+            bestRank = rank;
+        }
+    }
+    group->anchorStride = all[0].step;
+
+    // The prefilter tests every position an anchor on its stride can put it at:
+    // the largest power of two up to the stride and the width that divides the offset.
+    group_check* prefilter = &all[best];
+    SIZE_T distance = (SIZE_T)(prefilter->offset < 0 ? -prefilter->offset : prefilter->offset);
+    SIZE_T step = group->anchorStride < prefilter->width ? group->anchorStride : prefilter->width;
+    while (step > 1 && distance % step != 0)
+        step /= 2;
+    group->prefilter.mask = prefilter->mask;
+    group->prefilter.width = prefilter->width;
+    group->prefilter.stride = step;
+    group->prefilter.predicate = prefilter->predicate;
+    group->prefilterKernel = step < prefilter->width ? kernelPredicateStrided : kernelPredicate;
+    group->prefilterOffset = prefilter->offset;
+
+    for (int pass = 1; pass >= 0; pass--) {
+        for (int i = 0; i < count; i++) {
+            if (i != best && all[i].fixed == pass)
+                group->checks[group->checkCount++] = all[i];
+        }
+    }
+    return 1;
+}
+
+/*
+ * Tests the terms other than the prefilter on a group whose anchor value is
+ * at local; the `before` bytes before and `after` bytes after local (from
+ * its start) are readable, anchor is its remote address.
+ */
+static int matchGroup(const group_scan* group, const unsigned char* local, SIZE_T anchor, SIZE_T before, SIZE_T after) {
+    unsigned char block[64 * sizeof(double)];
+    for (int i = 0; i < group->checkCount; i++) {
+        const group_check* check = &group->checks[i];
+        SIZE_T width = check->width;
+        if (check->fixed) {
+            if (check->offset < -(long long)before || check->offset + (long long)width > (long long)after
+                || !check->mask(local + check->offset, 1, &check->predicate))
+                return 0;
+            continue;
+        }
+        // Positions of the free term: aligned to its step, within the span and the readable bytes.
+        long long low = -(long long)(before < (SIZE_T)group->span ? before : (SIZE_T)group->span);
+        long long high = (long long)after - (long long)width;
+        if (high > group->span)
+            high = group->span;
+        SIZE_T misalign = (SIZE_T)(anchor + (SIZE_T)low) & (check->step - 1);
+        if (misalign)
+            low += (long long)(check->step - misalign);
+        int found = 0;
+        for (long long p = low; p <= high && !found; p += 64 * (long long)check->step) {
+            SIZE_T n = (SIZE_T)((high - p) / (long long)check->step) + 1;
+            if (n > 64)
+                n = 64;
+            const unsigned char* values = local + p;
+            if (check->step != width) {
+                for (SIZE_T k = 0; k < n; k++)
+                    memcpy(block + k * width, local + p + (long long)(k * check->step), width);
+                values = block;
+            }
+            found = check->mask(values, n, &check->predicate) != 0;
+        }
+        if (!found)
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * Copies the bytes of the group around anchor to scratch: those inside the
+ * window [windowLow, windowHigh) from window, the others read from the target
+ * a page at a time outwards from the window until a read fails.
+ * Returns the position of anchor in scratch, and the readable bytes before
+ * and after it through before / after (both 0 if anchor itself is unreadable).
+ */
+static unsigned char* loadGroupEdge(const group_scan* group, const unsigned char* window, SIZE_T windowLow,
+    SIZE_T windowHigh, SIZE_T anchor, unsigned char* scratch, SIZE_T* before, SIZE_T* after) {
+    SIZE_T low = anchor >= group->before ? anchor - group->before : 0;
+    SIZE_T high = anchor + group->after;
+    SIZE_T validLow = low > windowLow ? low : windowLow;
+    SIZE_T validHigh = high < windowHigh ? high : windowHigh;
+    memcpy(scratch + (validLow - low), window + (validLow - windowLow), validHigh - validLow);
+    while (validLow > low) {
+        SIZE_T page = (validLow - 1) & ~(SIZE_T)(GROUP_PAGE_SIZE - 1);
+        SIZE_T from = page > low ? page : low;
+        if (!readRemote(group->hProcess, (unsigned char*)from, scratch + (from - low), validLow - from))
+            break;
+        validLow = from;
+    }
+    while (validHigh < high) {
+        SIZE_T page = (validHigh & ~(SIZE_T)(GROUP_PAGE_SIZE - 1)) + GROUP_PAGE_SIZE;
+        SIZE_T to = page < high ? page : high;
+        if (!readRemote(group->hProcess, (unsigned char*)validHigh, scratch + (validHigh - low), to - validHigh))
+            break;
+        validHigh = to;
+    }
+    // An unreadable anchor leaves nothing to match.
+    *before = anchor >= validLow && anchor < validHigh ? anchor - validLow : 0;
+    *after = anchor >= validLow && anchor < validHigh ? validHigh - anchor : 0;
+    return scratch + (anchor - low);
+}
+
+// Scan kernel of a group: runs the prefilter, then keeps the anchors of the hits whose group matches.
+static int kernelGroup(const unsigned char* buffer, SIZE_T count, const void* target,
+    unsigned char* base, vector_uchar_ptr* hits) {
+    const group_scan* group = (const group_scan*)target;
+    unsigned char scratch[2 * GROUP_MAX_REACH + 2 * sizeof(double)];
+    int first = hits->size;
+    if (!group->prefilterKernel(buffer, count, &group->prefilter, base, hits)) {
+        hits->size = first;
+        return 0;
+    }
+    SIZE_T windowLow = (SIZE_T)base;
+    SIZE_T windowHigh = windowLow + (count - 1) * group->prefilter.stride + group->prefilter.width;
+    int kept = first;
+    for (int i = first; i < hits->size; i++) {
+        SIZE_T hit = (SIZE_T)hits->array[i];
+        SIZE_T anchor = hit - (SIZE_T)group->prefilterOffset;
+        if ((anchor & (group->anchorStride - 1)) != 0
+            || (group->prefilterOffset > 0 && hit < (SIZE_T)group->prefilterOffset))
+            continue;
+        SIZE_T before, after;
+        const unsigned char* local;
+        if (anchor >= windowLow + group->before && anchor + group->after <= windowHigh) {
+            local = buffer + (anchor - windowLow);
+            before = group->before;
+            after = group->after;
+        }
+        else {
+            local = loadGroupEdge(group, buffer, windowLow, windowHigh, anchor, scratch, &before, &after);
+        }
+        if (after > 0 && matchGroup(group, local, anchor, before, after))
+            hits->array[kept++] = (unsigned char*)anchor;
+    }
+    hits->size = kept;
+    return 1;
+}
+
+#endif // GROUPSCAN_H
@@ -0,0 +1,285 @@
+/*
+ * kernels.h
+ *
+ * Description:
+ * Block comparison kernels used by the first scans (scanINT, scanFLOAT and
+ * scanDOUBLE). Every kernel takes a buffer holding a copy of a remote memory
+ * region, compares a whole vector of elements against the target at once and
+ * turns the resulting movemask bits into hit addresses, which are written
+ * straight into a vector_uchar_ptr.
+ *
+ * One kernel exists per element type and per instruction set level:
+ * - SCAN_ISA_SCALAR : plain C loop, always available.
+ * - SCAN_ISA_SSE2   : 128 bit compares.
+ * - SCAN_ISA_AVX2   : 256 bit compares.
+ * - SCAN_ISA_AVX512 : 512 bit compares (AVX-512F).
+ *
+ * The best level supported by the CPU (and enabled by the OS) is detected
+ * once at runtime; selectKernel() picks the matching entry from a kernel table.
+ * Float and double kernels use ordered equality, so they behave exactly like
+ * the scalar `==` (NaN never matches, +0.0 matches -0.0).
+ *
+ * Usage:
+ * - Include `memsource.h` (or `windows.h`) and `vectors.h` before this header.
+ * - scan_kernel kernel = selectKernel(KERNELS_INT);
+ *   if (!kernel(buffer, bytesRead / sizeof(int), &target, remoteBase, addresses)) ...   // out of memory
+ *
+ * Note:
+ * - Buffers do not have to be aligned, all loads are unaligned loads.
+ * - On non x86 targets every table entry falls back to the scalar kernel.
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "vectors.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SCAN_KERNELS_X86 1
+#include <immintrin.h>
+#ifndef _MSC_VER
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define KERNEL_TARGET(isa)
+#else
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+typedef enum {
+    SCAN_ISA_SCALAR = 0,
+    SCAN_ISA_SSE2 = 1,
+    SCAN_ISA_AVX2 = 2,
+    SCAN_ISA_AVX512 = 3,
+    SCAN_ISA_COUNT = 4
+} scan_isa;
+
+// A kernel appends the address of every match to hits.
+// Returns 1, or 0 if hits cannot grow (the matches of that block are not appended).
+typedef int (*scan_kernel)(const unsigned char* buffer, SIZE_T count, const void* target,
+    unsigned char* base, vector_uchar_ptr* hits);
+
+static const char* const SCAN_ISA_NAMES[SCAN_ISA_COUNT] = { "scalar", "sse2", "avx2", "avx512" };
+
+// Hit emission
+
+static inline unsigned int lowestSetBit(unsigned long long mask) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (unsigned int)index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, (unsigned long)mask))
+        return (unsigned int)index;
+    _BitScanForward(&index, (unsigned long)(mask >> 32));
+    return (unsigned int)index + 32;
+#else
+    return (unsigned int)__builtin_ctzll(mask);
+#endif
+}
+
+// Appends base + (first + bit) * width for every set bit of mask. A mask never
+// holds more than 64 bits, so one reserve covers the whole block.
+// Returns 0 if hits cannot grow.
+static inline int emitHitMask(vector_uchar_ptr* hits, unsigned char* base, SIZE_T first,
+    unsigned long long mask, SIZE_T width) {
+    if (!reserveVectorUCharPtr(hits, hits->size + 64))
+        return 0;
+    while (mask) {
+        hits->array[hits->size++] = base + (first + lowestSetBit(mask)) * width;
+        mask &= mask - 1;
+    }
+    return 1;
+}
+
+// Scalar kernels
+
+#define DEFINE_SCALAR_KERNEL(NAME, T)                                                       \
+    static int NAME(const unsigned char* buffer, SIZE_T count, const void* target,          \
+        unsigned char* base, vector_uchar_ptr* hits) {                                      \
+        const T value = *(const T*)target;                                                  \
+        for (SIZE_T i = 0; i < count; i++) {                                                \
+            if (*(const T*)(buffer + i * sizeof(T)) == value                                \
+                && !emitHitMask(hits, base, i, 1, sizeof(T)))                               \
+                return 0;                                                                   \
+        }                                                                                   \
+        return 1;                                                                           \
+    }
+
+DEFINE_SCALAR_KERNEL(kernelScalarINT, int)
+DEFINE_SCALAR_KERNEL(kernelScalarFLOAT, float)
+DEFINE_SCALAR_KERNEL(kernelScalarDOUBLE, double)
+
+#ifdef SCAN_KERNELS_X86
+
+// Each SIMD kernel compares four vectors per iteration and merges their
+// movemasks into one 64 bit mask, so a block without hits costs a single branch.
+// The remainder that does not fill a block goes through the scalar kernel.
+#define DEFINE_SIMD_KERNEL(NAME, ISA, T, VEC, SPLAT, CMPMASK, LANES, TAIL)                  \
+    KERNEL_TARGET(ISA) static int NAME(const unsigned char* buffer, SIZE_T count,           \
+        const void* target, unsigned char* base, vector_uchar_ptr* hits) {                  \
+        const VEC needle = SPLAT(*(const T*)target);                                        \
+        const SIZE_T step = (LANES) * sizeof(T);                                            \
+        SIZE_T i = 0;                                                                       \
+        for (; i + 4 * (LANES) <= count; i += 4 * (LANES)) {                                \
+            const unsigned char* p = buffer + i * sizeof(T);                                \
+            unsigned long long mask = (unsigned long long)CMPMASK(p, needle)                \
+                | ((unsigned long long)CMPMASK(p + step, needle) << (LANES))                \
+                | ((unsigned long long)CMPMASK(p + 2 * step, needle) << (2 * (LANES)))      \
+                | ((unsigned long long)CMPMASK(p + 3 * step, needle) << (3 * (LANES)));     \
+            if (mask && !emitHitMask(hits, base, i, mask, sizeof(T)))                       \
+                return 0;                                                                   \
+        }                                                                                   \
+        return TAIL(buffer + i * sizeof(T), count - i, target, base + i * sizeof(T), hits); \
+    }
+
+// SSE2
+KERNEL_TARGET("sse2") static inline unsigned int cmpMaskSSE2INT(const unsigned char* p, __m128i v) {
+    return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)p), v)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int cmpMaskSSE2FLOAT(const unsigned char* p, __m128 v) {
+    return (unsigned int)_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps((const float*)p), v));
+}
+KERNEL_TARGET("sse2") static inline unsigned int cmpMaskSSE2DOUBLE(const unsigned char* p, __m128d v) {
+    return (unsigned int)_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd((const double*)p), v));
+}
+
+DEFINE_SIMD_KERNEL(kernelSSE2INT, "sse2", int, __m128i, _mm_set1_epi32, cmpMaskSSE2INT, 4, kernelScalarINT)
+DEFINE_SIMD_KERNEL(kernelSSE2FLOAT, "sse2", float, __m128, _mm_set1_ps, cmpMaskSSE2FLOAT, 4, kernelScalarFLOAT)
+DEFINE_SIMD_KERNEL(kernelSSE2DOUBLE, "sse2", double, __m128d, _mm_set1_pd, cmpMaskSSE2DOUBLE, 2, kernelScalarDOUBLE)
+
+// AVX2
+KERNEL_TARGET("avx2") static inline unsigned int cmpMaskAVX2INT(const unsigned char* p, __m256i v) {
+    return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)p), v)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int cmpMaskAVX2FLOAT(const unsigned char* p, __m256 v) {
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps((const float*)p), v, _CMP_EQ_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int cmpMaskAVX2DOUBLE(const unsigned char* p, __m256d v) {
+    return (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd((const double*)p), v, _CMP_EQ_OQ));
+}
+
+DEFINE_SIMD_KERNEL(kernelAVX2INT, "avx2", int, __m256i, _mm256_set1_epi32, cmpMaskAVX2INT, 8, kernelScalarINT)
+DEFINE_SIMD_KERNEL(kernelAVX2FLOAT, "avx2", float, __m256, _mm256_set1_ps, cmpMaskAVX2FLOAT, 8, kernelScalarFLOAT)
+DEFINE_SIMD_KERNEL(kernelAVX2DOUBLE, "avx2", double, __m256d, _mm256_set1_pd, cmpMaskAVX2DOUBLE, 4, kernelScalarDOUBLE)
+
+// AVX-512
+KERNEL_TARGET("avx512f") static inline unsigned int cmpMaskAVX512INT(const unsigned char* p, __m512i v) {
+    return (unsigned int)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void*)p), v);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int cmpMaskAVX512FLOAT(const unsigned char* p, __m512 v) {
+    return (unsigned int)_mm512_cmp_ps_mask(_mm512_loadu_ps((const float*)p), v, _CMP_EQ_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int cmpMaskAVX512DOUBLE(const unsigned char* p, __m512d v) {
+    return (unsigned int)_mm512_cmp_pd_mask(_mm512_loadu_pd((const double*)p), v, _CMP_EQ_OQ);
+}
+
+DEFINE_SIMD_KERNEL(kernelAVX512INT, "avx512f", int, __m512i, _mm512_set1_epi32, cmpMaskAVX512INT, 16, kernelScalarINT)
+DEFINE_SIMD_KERNEL(kernelAVX512FLOAT, "avx512f", float, __m512, _mm512_set1_ps, cmpMaskAVX512FLOAT, 16, kernelScalarFLOAT)
+DEFINE_SIMD_KERNEL(kernelAVX512DOUBLE, "avx512f", double, __m512d, _mm512_set1_pd, cmpMaskAVX512DOUBLE, 8, kernelScalarDOUBLE)
+
+static const scan_kernel KERNELS_INT[SCAN_ISA_COUNT] = { kernelScalarINT, kernelSSE2INT, kernelAVX2INT, kernelAVX512INT };
+static const scan_kernel KERNELS_FLOAT[SCAN_ISA_COUNT] = { kernelScalarFLOAT, kernelSSE2FLOAT, kernelAVX2FLOAT, kernelAVX512FLOAT };
+static const scan_kernel KERNELS_DOUBLE[SCAN_ISA_COUNT] = { kernelScalarDOUBLE, kernelSSE2DOUBLE, kernelAVX2DOUBLE, kernelAVX512DOUBLE };
+
+#else
+
+static const scan_kernel KERNELS_INT[SCAN_ISA_COUNT] = { kernelScalarINT, kernelScalarINT, kernelScalarINT, kernelScalarINT };
+static const scan_kernel KERNELS_FLOAT[SCAN_ISA_COUNT] = { kernelScalarFLOAT, kernelScalarFLOAT, kernelScalarFLOAT, kernelScalarFLOAT };
+static const scan_kernel KERNELS_DOUBLE[SCAN_ISA_COUNT] = { kernelScalarDOUBLE, kernelScalarDOUBLE, kernelScalarDOUBLE, kernelScalarDOUBLE };
+
+#endif // SCAN_KERNELS_X86
+
+// CPU feature detection
+
+#ifdef SCAN_KERNELS_X86
+static inline void cpuidCount(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, (int)leaf, (int)subleaf);
+    regs[0] = (unsigned int)info[0];
+    regs[1] = (unsigned int)info[1];
+    regs[2] = (unsigned int)info[2];
+    regs[3] = (unsigned int)info[3];
+#else
+    if (!__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+}
+
+static inline unsigned long long readXCR0(void) {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+#endif
+
+// Returns the best scan_isa level usable on this machine. AVX levels also
+// require the OS to save the wider register state (XCR0), not just CPUID bits.
+static inline int detectScanISA(void) {
+#ifdef SCAN_KERNELS_X86
+    unsigned int regs[4];
+    int isa = SCAN_ISA_SCALAR;
+
+    cpuidCount(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+    cpuidCount(1, 0, regs);
+    if (regs[3] & (1u << 26))
+        isa = SCAN_ISA_SSE2;
+
+    int osxsave = (regs[2] & (1u << 27)) != 0;
+    int avx = (regs[2] & (1u << 28)) != 0;
+    if (!osxsave || !avx || maxLeaf < 7)
+        return isa;
+
+    unsigned long long xcr0 = readXCR0();
+    if ((xcr0 & 0x6) != 0x6)
+        return isa;
+
+    cpuidCount(7, 0, regs);
+    if (regs[1] & (1u << 5))
+        isa = SCAN_ISA_AVX2;
+    if ((regs[1] & (1u << 16)) && (xcr0 & 0xE0) == 0xE0)
+        isa = SCAN_ISA_AVX512;
+    return isa;
+#else
+    return SCAN_ISA_SCALAR;
+#endif
+}
+
+static int supportedScanISA = -1;
+static int activeScanISA = -1;
+
+static inline int maxScanISA(void) {
+    if (supportedScanISA < 0)
+        supportedScanISA = detectScanISA();
+    return supportedScanISA;
+}
+
+static inline int currentScanISA(void) {
+    if (activeScanISA < 0)
+        activeScanISA = maxScanISA();
+    return activeScanISA;
+}
+
+// Forces a lower level (for benchmarking / debugging); clamped to what the CPU supports.
+static inline int forceScanISA(int isa) {
+    if (isa < SCAN_ISA_SCALAR || isa > maxScanISA())
+        isa = maxScanISA();
+    activeScanISA = isa;
+    return activeScanISA;
+}
+
+static inline scan_kernel selectKernel(const scan_kernel* table) {
+    return table[currentScanISA()];
+}
+
+#endif // KERNELS_H
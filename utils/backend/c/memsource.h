@@ -0,0 +1,751 @@
+/*
+ * memsource.h
+ *
+ * Description:
+ * The memory source the scan engine runs against: opening a process, walking
+ * its memory regions and modules, and reading and writing its memory. Nothing
+ * else in the scanner talks to the operating system about the target, so the
+ * same first scan, next scan, snapshot and pointer code runs on both backends.
+ *
+ * Windows: a thin layer over OpenProcess, VirtualQueryEx, Toolhelp,
+ * ReadProcessMemory and WriteProcessMemory. HANDLE is the process handle.
+ *
+ * Linux: HANDLE points at a mem_process. Regions and modules come from
+ * /proc/<pid>/maps, reads go through process_vm_readv and writes through
+ * /proc/<pid>/mem (which, like WriteProcessMemory, also writes read-only
+ * pages). readRemoteBatch() sends many spans per process_vm_readv call, so a
+ * next scan needs one system call per READER_BATCH_SPANS candidate runs
+ * instead of one per run. The Windows names the engine uses (HANDLE, DWORD,
+ * SIZE_T, MEMORY_BASIC_INFORMATION and the MEM_* / PAGE_* constants) are
+ * defined here, and maps permissions are translated to PAGE_* protections:
+ * r-- PAGE_READONLY, rw- PAGE_READWRITE, r-x PAGE_EXECUTE_READ,
+ * rwx PAGE_EXECUTE_READWRITE, anything unreadable PAGE_NOACCESS.
+ *
+ * Usage:
+ * - Include this header before any other header of the scanner.
+ * - HANDLE h = openMemorySource(pid);
+ * - region_walk walk; beginRegionWalk(&walk, h);
+ *   while (nextRegion(&walk, &mbi)) { ... } endRegionWalk(&walk);
+ * - readRemote(h, remote, buffer, length);
+ * - process_walk procs; beginProcessWalk(&procs);
+ *   while (nextProcess(&procs, &pid, &stamp, &name)) { ... } endProcessWalk(&procs);
+ * - remote_module* modules; SIZE_T count; collectModules(h, &modules, &count);
+ * - closeMemorySource(h);
+ *
+ * Build (Linux):
+ * - gcc -O2 -shared -fPIC -fvisibility=hidden -pthread scanner.c -o libmemscanner.so
+ *
+ * Note:
+ * - readRemote() and readRemoteBatch() only report a span as read if all of
+ *   it was read; callers fall back to smaller reads themselves.
+ * - Every thread counts its read system calls, the bytes they read and the
+ *   calls that failed (readCounters()); the scan telemetry takes differences.
+ * - Reading another process on Linux needs ptrace access to it (same user and
+ *   kernel.yama.ptrace_scope 0, a parent of the target, or CAP_SYS_PTRACE).
+ * - Linux has no reserved / committed distinction, so every readable mapping
+ *   is scanned, including large sparse ones such as sanitizer shadow memory.
+ */
+
+#ifndef MEMSOURCE_H
+#define MEMSOURCE_H
+
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+typedef void* HANDLE;
+typedef unsigned int DWORD;
+typedef size_t SIZE_T;
+typedef int BOOL;
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+#define MAX_PATH 260
+
+typedef struct {
+    void* BaseAddress;
+    SIZE_T RegionSize;
+    DWORD State;
+    DWORD Protect;
+    DWORD Type;
+} MEMORY_BASIC_INFORMATION;
+
+#define MEM_COMMIT 0x1000
+#define MEM_FREE 0x10000
+#define MEM_PRIVATE 0x20000
+#define MEM_MAPPED 0x40000
+#define MEM_IMAGE 0x1000000
+
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_WRITECOPY 0x08
+#define PAGE_EXECUTE 0x10
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD 0x100
+#endif
+
+#define MEMSOURCE_BATCH_IOV 256
+
+typedef struct {
+    unsigned char* remote;
+    unsigned char* buffer;
+    SIZE_T length;
+    int ok;
+} read_span;
+
+typedef struct {
+    unsigned long long calls;
+    unsigned long long bytes;
+    unsigned long long failures;
+} read_counters;
+
+#ifdef _MSC_VER
+#define MEMSOURCE_THREAD_LOCAL __declspec(thread)
+#else
+#define MEMSOURCE_THREAD_LOCAL __thread
+#endif
+
+static MEMSOURCE_THREAD_LOCAL read_counters threadReadCounters;
+
+// Counts one read system call that transferred `bytes` bytes.
+static inline void countRead(SIZE_T bytes, int ok) {
+    threadReadCounters.calls++;
+    threadReadCounters.bytes += bytes;
+    threadReadCounters.failures += !ok;
+}
+
+// The read counters of the calling thread.
+static inline read_counters readCounters(void) {
+    return threadReadCounters;
+}
+
+#ifdef _WIN32
+
+// Process
+
+typedef struct {
+    HANDLE snapshot;
+    PROCESSENTRY32W entry;
+    BOOL more;
+    char name[MAX_PATH * 3];
+} process_walk;
+
+static int beginProcessWalk(process_walk* walk) {
+    walk->snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (walk->snapshot == INVALID_HANDLE_VALUE)
+        return 0;
+    walk->entry.dwSize = sizeof(walk->entry);
+    walk->more = Process32FirstW(walk->snapshot, &walk->entry);
+    return 1;
+}
+
+// Returns 0 after the last process. stamp changes when a pid is reused (0 when
+// the listing cannot tell, as here); name receives the UTF-8 file name of the
+// executable, or NULL if the listing does not carry it (see processName()).
+static int nextProcess(process_walk* walk, int* pid, unsigned long long* stamp, const char** name) {
+    if (!walk->more)
+        return 0;
+    *pid = (int)walk->entry.th32ProcessID;
+    *stamp = 0;
+    memset(walk->name, 0, sizeof(walk->name));
+    WideCharToMultiByte(CP_UTF8, 0, walk->entry.szExeFile, -1, walk->name, (int)sizeof(walk->name) - 1, NULL, NULL);
+    *name = walk->name;
+    walk->more = Process32NextW(walk->snapshot, &walk->entry);
+    return 1;
+}
+
+static void endProcessWalk(process_walk* walk) {
+    CloseHandle(walk->snapshot);
+}
+
+// The UTF-8 file name of the executable of pid. Returns 0 if it cannot be queried.
+static int processName(int pid, char* name, int nameSize) {
+    WCHAR path[MAX_PATH * 4];
+    DWORD length = MAX_PATH * 4;
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, (DWORD)pid);
+    if (process == NULL)
+        return 0;
+    int ok = QueryFullProcessImageNameW(process, 0, path, &length) != 0;
+    CloseHandle(process);
+    if (!ok)
+        return 0;
+    const WCHAR* file = wcsrchr(path, L'\\');
+    memset(name, 0, nameSize);
+    WideCharToMultiByte(CP_UTF8, 0, file != NULL ? file + 1 : path, -1, name, nameSize - 1, NULL, NULL);
+    return 1;
+}
+
+static int processCreationTime(HANDLE process, unsigned long long* started) {
+    FILETIME creation, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(process, &creation, &exitTime, &kernelTime, &userTime))
+        return 0;
+    *started = ((unsigned long long)creation.dwHighDateTime << 32) | creation.dwLowDateTime;
+    return 1;
+}
+
+// The creation time of pid (FILETIME ticks). Returns 0 if the process is gone
+// or cannot be queried.
+static int processStartTime(int pid, unsigned long long* started) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, (DWORD)pid);
+    if (process == NULL)
+        return 0;
+    int ok = processCreationTime(process, started);
+    CloseHandle(process);
+    return ok;
+}
+
+static HANDLE openMemorySource(int pid) {
+    return OpenProcess(PROCESS_ALL_ACCESS, FALSE, (DWORD)pid);
+}
+
+static int closeMemorySource(HANDLE hProcess) {
+    return CloseHandle(hProcess);
+}
+
+// Returns the size of a pointer in the target, 4 for WOW64 processes.
+static unsigned int remotePointerSize(HANDLE hProcess) {
+#ifdef _WIN64
+    BOOL wow64 = FALSE;
+    if (IsWow64Process(hProcess, &wow64) && wow64)
+        return 4;
+    return 8;
+#else
+    return 4;
+#endif
+}
+
+// Identifies one run of a process: its pid and its creation time (FILETIME
+// ticks), which differs when the pid is reused. Returns 0 if it cannot be queried.
+static int remoteProcessIdentity(HANDLE hProcess, int* pid, unsigned long long* started) {
+    *pid = (int)GetProcessId(hProcess);
+    return *pid != 0 && processCreationTime(hProcess, started);
+}
+
+// Reads and writes
+
+static int readRemote(HANDLE hProcess, const unsigned char* remote, void* buffer, SIZE_T length) {
+    SIZE_T bytesRead;
+    int ok = ReadProcessMemory(hProcess, remote, buffer, length, &bytesRead) ? 1 : 0;
+    countRead(ok ? length : 0, ok);
+    return ok;
+}
+
+static int writeRemote(HANDLE hProcess, unsigned char* remote, const void* data, SIZE_T length) {
+    SIZE_T bytesWritten;
+    return WriteProcessMemory(hProcess, remote, data, length, &bytesWritten) ? 1 : 0;
+}
+
+// Reads every span into its buffer and sets its ok flag. Returns the number of spans read.
+static SIZE_T readRemoteBatch(HANDLE hProcess, read_span* spans, SIZE_T count) {
+    SIZE_T read = 0;
+    for (SIZE_T i = 0; i < count; i++) {
+        spans[i].ok = readRemote(hProcess, spans[i].remote, spans[i].buffer, spans[i].length);
+        read += spans[i].ok;
+    }
+    return read;
+}
+
+// Regions
+
+typedef struct {
+    HANDLE hProcess;
+    unsigned char* next;
+} region_walk;
+
+static int beginRegionWalk(region_walk* walk, HANDLE hProcess) {
+    walk->hProcess = hProcess;
+    walk->next = 0x0;
+    return 1;
+}
+
+// Returns 0 after the last region. Free gaps are reported as MEM_FREE regions.
+static int nextRegion(region_walk* walk, MEMORY_BASIC_INFORMATION* mbi) {
+    if (!VirtualQueryEx(walk->hProcess, walk->next, mbi, sizeof(*mbi)))
+        return 0;
+    // Move to the next region
+    walk->next = (unsigned char*)mbi->BaseAddress + mbi->RegionSize;
+    return 1;
+}
+
+static void endRegionWalk(region_walk* walk) {
+    walk->next = 0x0;
+}
+
+// Modules
+
+typedef struct {
+    HANDLE snapshot;
+    MODULEENTRY32W entry;
+    BOOL more;
+} module_walk;
+
+static int beginModuleWalk(module_walk* walk, HANDLE hProcess) {
+    walk->snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, GetProcessId(hProcess));
+    if (walk->snapshot == INVALID_HANDLE_VALUE)
+        return 0;
+    walk->entry.dwSize = sizeof(walk->entry);
+    walk->more = Module32FirstW(walk->snapshot, &walk->entry);
+    return 1;
+}
+
+// Returns 0 after the last module. name receives the UTF-8 file name of the module.
+static int nextModule(module_walk* walk, unsigned long long* base, unsigned long long* size, char* name, int nameSize) {
+    if (!walk->more)
+        return 0;
+    *base = (unsigned long long)(SIZE_T)walk->entry.modBaseAddr;
+    *size = walk->entry.modBaseSize;
+    memset(name, 0, nameSize);
+    WideCharToMultiByte(CP_UTF8, 0, walk->entry.szModule, -1, name, nameSize - 1, NULL, NULL);
+    walk->more = Module32NextW(walk->snapshot, &walk->entry);
+    return 1;
+}
+
+static void endModuleWalk(module_walk* walk) {
+    CloseHandle(walk->snapshot);
+}
+
+#else // Linux
+
+typedef struct {
+    pid_t pid;
+    int memFd;
+} mem_process;
+
+// Process
+
+typedef struct {
+    DIR* proc;
+} process_walk;
+
+static int beginProcessWalk(process_walk* walk) {
+    walk->proc = opendir("/proc");
+    return walk->proc != NULL;
+}
+
+// Returns 0 after the last process. stamp changes when a pid is reused (the
+// inode number of /proc/<pid>, which procfs gives every new process); name is
+// NULL, the listing does not carry it (see processName()).
+static int nextProcess(process_walk* walk, int* pid, unsigned long long* stamp, const char** name) {
+    struct dirent* entry;
+    while ((entry = readdir(walk->proc)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9')
+            continue;
+        *pid = atoi(entry->d_name);
+        *stamp = (unsigned long long)entry->d_ino;
+        *name = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+static void endProcessWalk(process_walk* walk) {
+    closedir(walk->proc);
+}
+
+// The file name of the executable of pid, or the kernel's (15 character) comm
+// name when the executable link cannot be read. Returns 0 if neither can be read.
+static int processName(int pid, char* name, int nameSize) {
+    char path[64], target[4096];
+    const char* file = target;
+    snprintf(path, sizeof(path), "/proc/%d/exe", pid);
+    ssize_t length = readlink(path, target, sizeof(target) - 1);
+    if (length > 0) {
+        target[length] = '\0';
+        const char* base = strrchr(target, '/');
+        if (base != NULL)
+            file = base + 1;
+    }
+    else {
+        snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+        FILE* comm = fopen(path, "r");
+        if (comm == NULL)
+            return 0;
+        int ok = fgets(target, sizeof(target), comm) != NULL;
+        fclose(comm);
+        if (!ok)
+            return 0;
+        target[strcspn(target, "\n")] = '\0';
+    }
+    size_t size = strlen(file);
+    if (size >= (size_t)nameSize)
+        size = nameSize - 1;
+    memcpy(name, file, size);
+    name[size] = '\0';
+    return 1;
+}
+
+// The start time of pid (field 22 of /proc/<pid>/stat, clock ticks after
+// boot). Returns 0 if the process is gone.
+static int processStartTime(int pid, unsigned long long* started) {
+    char path[64], line[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE* stat = fopen(path, "r");
+    if (stat == NULL)
+        return 0;
+    int ok = fgets(line, sizeof(line), stat) != NULL;
+    fclose(stat);
+    // The command name in parentheses may hold spaces; the fields after it are 3 to 52.
+    const char* field = ok ? strrchr(line, ')') : NULL;
+    if (field == NULL)
+        return 0;
+    for (int i = 2; i < 22 && field != NULL; i++)
+        field = strchr(field + 1, ' ');
+    if (field == NULL)
+        return 0;
+    *started = strtoull(field + 1, NULL, 10);
+    return 1;
+}
+
+// Returns NULL if the process does not exist.
+static HANDLE openMemorySource(int pid) {
+    if (pid <= 0 || (kill((pid_t)pid, 0) != 0 && errno != EPERM))
+        return NULL;
+    mem_process* process = (mem_process*)malloc(sizeof(mem_process));
+    if (process == NULL)
+        return NULL;
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/mem", pid);
+    process->pid = (pid_t)pid;
+    process->memFd = open(path, O_RDWR | O_CLOEXEC);
+    if (process->memFd < 0)
+        process->memFd = open(path, O_RDONLY | O_CLOEXEC);
+    return process;
+}
+
+static int closeMemorySource(HANDLE hProcess) {
+    mem_process* process = (mem_process*)hProcess;
+    if (process == NULL)
+        return 0;
+    if (process->memFd >= 0)
+        close(process->memFd);
+    free(process);
+    return 1;
+}
+
+// Returns the size of a pointer in the target, from the ELF class of its executable.
+static unsigned int remotePointerSize(HANDLE hProcess) {
+    char path[64];
+    unsigned char ident[5];
+    snprintf(path, sizeof(path), "/proc/%d/exe", (int)((mem_process*)hProcess)->pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return (unsigned int)sizeof(void*);
+    ssize_t length = read(fd, ident, sizeof(ident));
+    close(fd);
+    if (length == sizeof(ident) && memcmp(ident, "\177ELF", 4) == 0)
+        return ident[4] == 1 ? 4 : 8;
+    return (unsigned int)sizeof(void*);
+}
+
+// Identifies one run of a process: its pid and its start time (see
+// processStartTime()). Returns 0 if it cannot be queried.
+static int remoteProcessIdentity(HANDLE hProcess, int* pid, unsigned long long* started) {
+    *pid = (int)((mem_process*)hProcess)->pid;
+    return processStartTime(*pid, started);
+}
+
+// Reads and writes
+
+static int readRemote(HANDLE hProcess, const unsigned char* remote, void* buffer, SIZE_T length) {
+    mem_process* process = (mem_process*)hProcess;
+    struct iovec local = { buffer, length };
+    struct iovec other = { (void*)remote, length };
+    ssize_t read = process_vm_readv(process->pid, &local, 1, &other, 1, 0);
+    countRead(read > 0 ? (SIZE_T)read : 0, read == (ssize_t)length);
+    if (read == (ssize_t)length)
+        return 1;
+    // Kernels without process_vm_readv, or ones that refuse it, may still allow /proc/<pid>/mem.
+    if (read < 0 && errno != EFAULT && process->memFd >= 0) {
+        int ok = pread(process->memFd, buffer, length, (off_t)(uintptr_t)remote) == (ssize_t)length;
+        countRead(ok ? length : 0, ok);
+        return ok;
+    }
+    return 0;
+}
+
+static int writeRemote(HANDLE hProcess, unsigned char* remote, const void* data, SIZE_T length) {
+    mem_process* process = (mem_process*)hProcess;
+    if (process->memFd >= 0 && pwrite(process->memFd, data, length, (off_t)(uintptr_t)remote) == (ssize_t)length)
+        return 1;
+    struct iovec local = { (void*)data, length };
+    struct iovec other = { remote, length };
+    return process_vm_writev(process->pid, &local, 1, &other, 1, 0) == (ssize_t)length;
+}
+
+// Reads every span into its buffer and sets its ok flag, MEMSOURCE_BATCH_IOV
+// spans per process_vm_readv call. A call stops at the first span it cannot
+// read completely; that span is marked failed and the next call resumes after it.
+// Returns the number of spans read.
+static SIZE_T readRemoteBatch(HANDLE hProcess, read_span* spans, SIZE_T count) {
+    mem_process* process = (mem_process*)hProcess;
+    struct iovec local[MEMSOURCE_BATCH_IOV], other[MEMSOURCE_BATCH_IOV];
+    SIZE_T read = 0, done = 0;
+    while (done < count) {
+        SIZE_T n = count - done < MEMSOURCE_BATCH_IOV ? count - done : MEMSOURCE_BATCH_IOV;
+        for (SIZE_T i = 0; i < n; i++) {
+            local[i].iov_base = spans[done + i].buffer;
+            local[i].iov_len = spans[done + i].length;
+            other[i].iov_base = spans[done + i].remote;
+            other[i].iov_len = spans[done + i].length;
+        }
+        ssize_t bytes = process_vm_readv(process->pid, local, (unsigned long)n, other, (unsigned long)n, 0);
+        countRead(bytes < 0 ? 0 : (SIZE_T)bytes, bytes >= 0);
+        if (bytes < 0) {
+            read_span* span = &spans[done++];
+            span->ok = errno != EFAULT && readRemote(hProcess, span->remote, span->buffer, span->length);
+            read += span->ok;
+            continue;
+        }
+        SIZE_T left = (SIZE_T)bytes;
+        while (n > 0 && left >= spans[done].length) {
+            left -= spans[done].length;
+            spans[done++].ok = 1;
+            read++;
+            n--;
+        }
+        if (n > 0) {
+            spans[done++].ok = 0;
+            threadReadCounters.failures++;
+        }
+    }
+    return read;
+}
+
+// Regions
+
+typedef struct {
+    FILE* maps;
+    char* line;
+    size_t capacity;
+} region_walk;
+
+typedef struct {
+    unsigned long long start;
+    unsigned long long end;
+    char perms[5];
+    const char* path;
+} maps_line;
+
+static int openMaps(HANDLE hProcess, FILE** maps) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/maps", (int)((mem_process*)hProcess)->pid);
+    *maps = fopen(path, "r");
+    return *maps != NULL;
+}
+
+static int readMapsLine(FILE* maps, char** line, size_t* capacity, maps_line* out) {
+    int pathOffset = 0;
+    while (getline(line, capacity, maps) > 0) {
+        if (sscanf(*line, "%llx-%llx %4s %*s %*s %*s %n", &out->start, &out->end, out->perms, &pathOffset) < 3)
+            continue;
+        if (out->end <= out->start)
+            continue;
+        char* path = *line + pathOffset;
+        path[strcspn(path, "\n")] = '\0';
+        out->path = path;
+        return 1;
+    }
+    return 0;
+}
+
+static DWORD mapsProtection(const maps_line* entry) {
+    // The vDSO data pages and vsyscall cannot be read from another process.
+    if (entry->perms[0] != 'r' || strncmp(entry->path, "[vvar", 5) == 0 || strcmp(entry->path, "[vsyscall]") == 0)
+        return PAGE_NOACCESS;
+    if (entry->perms[2] == 'x')
+        return entry->perms[1] == 'w' ? PAGE_EXECUTE_READWRITE : PAGE_EXECUTE_READ;
+    return entry->perms[1] == 'w' ? PAGE_READWRITE : PAGE_READONLY;
+}
+
+static int beginRegionWalk(region_walk* walk, HANDLE hProcess) {
+    walk->line = NULL;
+    walk->capacity = 0;
+    return openMaps(hProcess, &walk->maps);
+}
+
+// Returns 0 after the last region. Only mapped regions are reported, all as MEM_COMMIT.
+static int nextRegion(region_walk* walk, MEMORY_BASIC_INFORMATION* mbi) {
+    maps_line entry;
+    if (walk->maps == NULL || !readMapsLine(walk->maps, &walk->line, &walk->capacity, &entry))
+        return 0;
+    mbi->BaseAddress = (void*)(uintptr_t)entry.start;
+    mbi->RegionSize = (SIZE_T)(entry.end - entry.start);
+    mbi->State = MEM_COMMIT;
+    mbi->Protect = mapsProtection(&entry);
+    mbi->Type = entry.path[0] == '/' ? MEM_MAPPED : MEM_PRIVATE;
+    return 1;
+}
+
+static void endRegionWalk(region_walk* walk) {
+    if (walk->maps != NULL)
+        fclose(walk->maps);
+    free(walk->line);
+    walk->maps = NULL;
+    walk->line = NULL;
+}
+
+// Modules
+// A module is a run of consecutive mappings of the same file; its base is the
+// start of the first one.
+
+typedef struct {
+    FILE* maps;
+    char* line;
+    size_t capacity;
+    maps_line pending;
+    int hasPending;
+} module_walk;
+
+static int beginModuleWalk(module_walk* walk, HANDLE hProcess) {
+    walk->line = NULL;
+    walk->capacity = 0;
+    walk->hasPending = 0;
+    return openMaps(hProcess, &walk->maps);
+}
+
+// Returns 0 after the last module. name receives the file name of the module.
+static int nextModule(module_walk* walk, unsigned long long* base, unsigned long long* size, char* name, int nameSize) {
+    char* path = NULL;
+    unsigned long long end = 0;
+    for (;;) {
+        if (!walk->hasPending && !readMapsLine(walk->maps, &walk->line, &walk->capacity, &walk->pending))
+            break;
+        walk->hasPending = 0;
+        maps_line* entry = &walk->pending;
+        if (path != NULL) {
+            if (entry->start == end && strcmp(entry->path, path) == 0) {
+                end = entry->end;
+                continue;
+            }
+            // Not part of this module, the next call starts with it.
+            walk->hasPending = 1;
+            break;
+        }
+        if (entry->path[0] != '/')
+            continue;
+        path = (char*)malloc(strlen(entry->path) + 1);
+        if (path == NULL)
+            return 0;
+        strcpy(path, entry->path);
+        *base = entry->start;
+        end = entry->end;
+    }
+    if (path == NULL)
+        return 0;
+    *size = end - *base;
+    const char* file = strrchr(path, '/') + 1;
+    memset(name, 0, nameSize);
+    strncpy(name, file, nameSize - 1);
+    free(path);
+    return 1;
+}
+
+static void endModuleWalk(module_walk* walk) {
+    if (walk->maps != NULL)
+        fclose(walk->maps);
+    free(walk->line);
+}
+
+#endif
+
+// Module lists
+// Both backends list the modules through the module walk above; the region
+// maps and pointer maps keep the result sorted by base.
+
+#define MODULE_NAME_SIZE 128
+
+typedef struct {
+    unsigned long long base;
+    unsigned long long size;
+    char name[MODULE_NAME_SIZE];   // UTF-8
+} remote_module;
+
+// Compares two module names, ignoring the case of ASCII letters.
+static int moduleNameEquals(const char* a, const char* b) {
+    while (*a && *b) {
+        char x = (*a >= 'A' && *a <= 'Z') ? (char)(*a + 32) : *a;
+        char y = (*b >= 'A' && *b <= 'Z') ? (char)(*b + 32) : *b;
+        if (x != y)
+            return 0;
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static int compareRemoteModules(const void* a, const void* b) {
+    unsigned long long x = ((const remote_module*)a)->base, y = ((const remote_module*)b)->base;
+    return x < y ? -1 : x > y;
+}
+
+// Lists the modules of hProcess sorted by base; *modulesOut must be freed with free().
+// Returns: 1 on success, -1 Memory Allocation Failure, -2 Module List Failure.
+static int collectModules(HANDLE hProcess, remote_module** modulesOut, SIZE_T* moduleCount) {
+    *modulesOut = NULL;
+    *moduleCount = 0;
+    module_walk walk;
+    if (!beginModuleWalk(&walk, hProcess))
+        return -2;
+    remote_module* modules = NULL;
+    SIZE_T count = 0, capacity = 0;
+    remote_module module;
+    while (nextModule(&walk, &module.base, &module.size, module.name, MODULE_NAME_SIZE)) {
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            remote_module* grown = (remote_module*)realloc(modules, capacity * sizeof(remote_module));
+            if (grown == NULL) {
+                endModuleWalk(&walk);
+                free(modules);
+                return -1;
+            }
+            modules = grown;
+        }
+        modules[count++] = module;
+    }
+    endModuleWalk(&walk);
+    if (count > 1)
+        qsort(modules, count, sizeof(remote_module), compareRemoteModules);
+    *modulesOut = modules;
+    *moduleCount = count;
+    return 1;
+}
+
+// Returns the index of the module of modules (sorted by base) containing address, or -1.
+static int findModule(const remote_module* modules, SIZE_T count, unsigned long long address) {
+    SIZE_T lo = 0, hi = count;
+    while (lo < hi) {
+        SIZE_T mid = lo + (hi - lo) / 2;
+        if (modules[mid].base <= address)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0 || address - modules[lo - 1].base >= modules[lo - 1].size)
+        return -1;
+    return (int)(lo - 1);
+}
+
+#endif // MEMSOURCE_H
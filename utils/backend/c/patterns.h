@@ -0,0 +1,311 @@
+/*
+ * patterns.h
+ *
+ * Description:
+ * Array of bytes (AOB) signature scan. A pattern such as
+ * "48 8B 05 ?? ?? ?? ?? 89 ??" is compiled once into a byte_pattern: the bytes,
+ * a mask per byte ("??" or "?" is a full wildcard, "4?" / "?B" wildcard one
+ * nibble), a Horspool shift table and two anchor bytes.
+ *
+ * The kernels have the scan_kernel signature of kernels.h, so they run on the
+ * region walk of scanRegions() with sizeof(T) replaced by the pattern length:
+ * - SCAN_ISA_SCALAR : Boyer-Moore-Horspool on the last byte, wildcard aware.
+ * - SCAN_ISA_SSE2   : rare byte prefilter, 16 positions per compare.
+ * - SCAN_ISA_AVX2   : rare byte prefilter, 32 positions per compare.
+ * - SCAN_ISA_AVX512 : uses the AVX2 kernel, byte compares need AVX-512BW which
+ *                     currentScanISA() does not check for.
+ * The prefilter compares the two rarest anchor bytes of the pattern (rarest by
+ * a fixed table of bytes that are common in x86 code and data) at every
+ * position of a block and only verifies the full pattern where both hit. An
+ * anchor is a byte with at most one wildcard bit, so the case folded letters
+ * of compileString() (mask 0xDF) can anchor as well.
+ *
+ * compileString() turns an ASCII or UTF-16LE needle into the same pattern,
+ * optionally ignoring the case of the ASCII letters.
+ *
+ * Usage:
+ * - Include `memsource.h` (or `windows.h`), `vectors.h` and `kernels.h` before this header.
+ * - byte_pattern pattern;
+ *   if (compilePattern(text, &pattern) == 1)  // or compileString(...)
+ *       selectKernel(PATTERN_KERNELS)(buffer, size - pattern.length + 1, &pattern, remoteBase, addresses);
+ *
+ * Note:
+ * - The buffer passed to a kernel must hold count + length - 1 bytes.
+ * - Hits are start addresses of the pattern, leading wildcards included.
+ */
+
+#ifndef PATTERNS_H
+#define PATTERNS_H
+
+#include "vectors.h"
+#include "kernels.h"
+
+#define PATTERN_MAX_LENGTH 256
+
+#define STRING_ASCII 0
+#define STRING_UTF16 1
+
+typedef struct {
+    unsigned char bytes[PATTERN_MAX_LENGTH];  // pre-masked with mask
+    unsigned char mask[PATTERN_MAX_LENGTH];
+    SIZE_T length;
+    SIZE_T shift[256];
+    SIZE_T first;   // offsets of the prefilter bytes, valid if anchored
+    SIZE_T second;
+    int anchored;   // 0 if no byte of the pattern can anchor the prefilter
+    int exact;      // 1 if the pattern has no wildcards
+} byte_pattern;
+
+// Pattern compilation
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Lower is rarer. Zero and 0xFF fill most of any address space; the others
+// are frequent x86-64 opcodes, REX prefixes, ModRM bytes and padding.
+static int patternByteRank(unsigned char b) {
+    switch (b) {
+    case 0x00: case 0xFF:
+        return 3;
+    case 0xCC: case 0x90: case 0x48: case 0x8B: case 0x89: case 0x0F: case 0x01:
+    case 0xE8: case 0x24: case 0x4C: case 0x44: case 0x8D: case 0x83: case 0xC0:
+    case 0x20: case 0x40: case 0x10: case 0x08: case 0x02: case 0x04: case 0x80:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+// A byte with at most one wildcard bit can anchor the prefilter.
+static inline int isAnchorMask(unsigned char mask) {
+    unsigned char wildcard = (unsigned char)~mask;
+    return (wildcard & (wildcard - 1)) == 0;
+}
+
+// Fills in the Horspool table and the prefilter anchors of a pattern whose
+// bytes, masks and length are set.
+static void preparePattern(byte_pattern* pattern) {
+    SIZE_T length = pattern->length;
+    // Horspool: shift by the distance from the last occurrence (before the
+    // final byte) of a position the byte can match to the end of the pattern.
+    for (int c = 0; c < 256; c++) {
+        pattern->shift[c] = length;
+        for (SIZE_T j = 0; j + 1 < length; j++) {
+            if (((unsigned char)c & pattern->mask[j]) == pattern->bytes[j])
+                pattern->shift[c] = length - 1 - j;
+        }
+    }
+
+    pattern->anchored = 0;
+    pattern->exact = 1;
+    int bestRank = 4;
+    for (SIZE_T j = 0; j < length; j++) {
+        if (pattern->mask[j] != 0xFF)
+            pattern->exact = 0;
+        if (!isAnchorMask(pattern->mask[j]))
+            continue;
+        int rank = patternByteRank(pattern->bytes[j]);
+        if (rank < bestRank) {
+            bestRank = rank;
+            pattern->first = j;
+            pattern->anchored = 1;
+        }
+    }
+    if (pattern->anchored) {
+        // The second anchor is the rarest other byte, the one farthest from the
+        // first on ties, so the two compares are as independent as possible.
+        pattern->second = pattern->first;
+        bestRank = 4;
+        SIZE_T bestDistance = 0;
+        for (SIZE_T j = 0; j < length; j++) {
+            if (j == pattern->first || !isAnchorMask(pattern->mask[j]))
+                continue;
+            int rank = patternByteRank(pattern->bytes[j]);
+            SIZE_T distance = j > pattern->first ? j - pattern->first : pattern->first - j;
+            if (rank < bestRank || (rank == bestRank && distance > bestDistance)) {
+                bestRank = rank;
+                bestDistance = distance;
+                pattern->second = j;
+            }
+        }
+    }
+}
+
+/*
+ * Parses `text` into pattern. Bytes are two hex digits, separated by white
+ * space or written back to back; "?", "??" and "?" for a single nibble are
+ * wildcards.
+ * Returns: 1 compiled, 0 invalid or empty pattern, or longer than PATTERN_MAX_LENGTH.
+ */
+static int compilePattern(const char* text, byte_pattern* pattern) {
+    SIZE_T length = 0;
+    const char* p = text;
+    while (*p) {
+        if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+            p++;
+            continue;
+        }
+        if (length == PATTERN_MAX_LENGTH)
+            return 0;
+        unsigned char value = 0, mask = 0;
+        if (p[0] == '?' && (p[1] == '\0' || p[1] == ' ' || p[1] == '\t' || p[1] == '\n' || p[1] == '\r')) {
+            p++;
+        }
+        else {
+            for (int n = 0; n < 2; n++, p++) {
+                value <<= 4;
+                mask <<= 4;
+                if (*p == '?')
+                    continue;
+                int nibble = hexNibble(*p);
+                if (nibble < 0)
+                    return 0;
+                value |= (unsigned char)nibble;
+                mask |= 0x0F;
+            }
+        }
+        pattern->bytes[length] = value & mask;
+        pattern->mask[length] = mask;
+        length++;
+    }
+    if (length == 0)
+        return 0;
+    pattern->length = length;
+    preparePattern(pattern);
+    return 1;
+}
+
+/*
+ * Builds the pattern of a needle of `size` bytes, given as ASCII or UTF-16LE
+ * (STRING_ASCII, STRING_UTF16). With ignoreCase the ASCII letters match either
+ * case: their 0x20 bit becomes a wildcard. Other characters match exactly.
+ * Returns: 1 compiled, 0 invalid encoding, empty needle, odd UTF-16 size or
+ *          longer than PATTERN_MAX_LENGTH bytes.
+ */
+static int compileString(const unsigned char* needle, SIZE_T size, int encoding, int ignoreCase,
+    byte_pattern* pattern) {
+    SIZE_T unit = encoding == STRING_UTF16 ? 2 : 1;
+    if ((encoding != STRING_ASCII && encoding != STRING_UTF16) || size == 0 || size % unit != 0
+        || size > PATTERN_MAX_LENGTH)
+        return 0;
+    for (SIZE_T i = 0; i < size; i++) {
+        pattern->bytes[i] = needle[i];
+        pattern->mask[i] = 0xFF;
+    }
+    if (ignoreCase) {
+        for (SIZE_T i = 0; i < size; i += unit) {
+            unsigned char c = needle[i];
+            int ascii = unit == 1 || needle[i + 1] == 0;
+            if (ascii && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+                pattern->mask[i] = 0xDF;
+                pattern->bytes[i] = c & 0xDF;
+            }
+        }
+    }
+    pattern->length = size;
+    preparePattern(pattern);
+    return 1;
+}
+
+static inline int patternMatchesAt(const unsigned char* p, const byte_pattern* pattern) {
+    if (pattern->exact)
+        return memcmp(p, pattern->bytes, pattern->length) == 0;
+    for (SIZE_T k = 0; k < pattern->length; k++) {
+        if ((p[k] & pattern->mask[k]) != pattern->bytes[k])
+            return 0;
+    }
+    return 1;
+}
+
+// Scalar kernel
+
+static int patternScalar(const unsigned char* buffer, SIZE_T count, const void* target,
+    unsigned char* base, vector_uchar_ptr* hits) {
+    const byte_pattern* pattern = (const byte_pattern*)target;
+    const SIZE_T last = pattern->length - 1;
+    const unsigned char lastMask = pattern->mask[last];
+    const unsigned char lastByte = pattern->bytes[last];
+    SIZE_T i = 0;
+    while (i < count) {
+        unsigned char c = buffer[i + last];
+        if ((c & lastMask) == lastByte && patternMatchesAt(buffer + i, pattern)
+            && !emitHitMask(hits, base, i, 1, 1))
+            return 0;
+        i += pattern->shift[c];
+    }
+    return 1;
+}
+
+#ifdef SCAN_KERNELS_X86
+
+// Every block covers 64 positions: bit k of the prefilter mask is set when
+// both anchor bytes match for position i + k. Anchors are masked before the
+// compare, which is a no-op for fully specified bytes. Surviving bits are
+// verified and emitted together. The remainder goes through the scalar kernel.
+#define DEFINE_PATTERN_KERNEL(NAME, ISA, VEC, SPLAT, CMPMASK, LANES)                        \
+    KERNEL_TARGET(ISA) static int NAME(const unsigned char* buffer, SIZE_T count,           \
+        const void* target, unsigned char* base, vector_uchar_ptr* hits) {                  \
+        const byte_pattern* pattern = (const byte_pattern*)target;                          \
+        if (!pattern->anchored)                                                             \
+            return patternScalar(buffer, count, target, base, hits);                        \
+        const VEC first = SPLAT((char)pattern->bytes[pattern->first]);                      \
+        const VEC firstMask = SPLAT((char)pattern->mask[pattern->first]);                   \
+        const VEC second = SPLAT((char)pattern->bytes[pattern->second]);                    \
+        const VEC secondMask = SPLAT((char)pattern->mask[pattern->second]);                 \
+        const unsigned char* a = buffer + pattern->first;                                   \
+        const unsigned char* b = buffer + pattern->second;                                  \
+        SIZE_T i = 0;                                                                       \
+        for (; i + 64 <= count; i += 64) {                                                  \
+            unsigned long long mask = 0;                                                    \
+            for (int lane = 0; lane < 64; lane += (LANES))                                  \
+                mask |= (unsigned long long)CMPMASK(a + i + lane, b + i + lane,             \
+                    first, firstMask, second, secondMask) << lane;                          \
+            if (mask == 0)                                                                  \
+                continue;                                                                   \
+            unsigned long long verified = 0;                                                \
+            for (unsigned long long m = mask; m; m &= m - 1) {                              \
+                unsigned int bit = lowestSetBit(m);                                         \
+                if (patternMatchesAt(buffer + i + bit, pattern))                            \
+                    verified |= 1ULL << bit;                                                \
+            }                                                                               \
+            if (verified && !emitHitMask(hits, base, i, verified, 1))                       \
+                return 0;                                                                   \
+        }                                                                                   \
+        return patternScalar(buffer + i, count - i, target, base + i, hits);                \
+    }
+
+KERNEL_TARGET("sse2") static inline unsigned int patternMaskSSE2(const unsigned char* a, const unsigned char* b,
+    __m128i first, __m128i firstMask, __m128i second, __m128i secondMask) {
+    __m128i eq = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i*)a), firstMask), first),
+        _mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i*)b), secondMask), second));
+    return (unsigned int)_mm_movemask_epi8(eq);
+}
+
+KERNEL_TARGET("avx2") static inline unsigned int patternMaskAVX2(const unsigned char* a, const unsigned char* b,
+    __m256i first, __m256i firstMask, __m256i second, __m256i secondMask) {
+    __m256i eq = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)a), firstMask), first),
+        _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)b), secondMask), second));
+    return (unsigned int)_mm256_movemask_epi8(eq);
+}
+
+DEFINE_PATTERN_KERNEL(patternSSE2, "sse2", __m128i, _mm_set1_epi8, patternMaskSSE2, 16)
+DEFINE_PATTERN_KERNEL(patternAVX2, "avx2", __m256i, _mm256_set1_epi8, patternMaskAVX2, 32)
+
+static const scan_kernel PATTERN_KERNELS[SCAN_ISA_COUNT] = { patternScalar, patternSSE2, patternAVX2, patternAVX2 };
+
+#else
+
+static const scan_kernel PATTERN_KERNELS[SCAN_ISA_COUNT] = { patternScalar, patternScalar, patternScalar, patternScalar };
+
+#endif // SCAN_KERNELS_X86
+
+#endif // PATTERNS_H
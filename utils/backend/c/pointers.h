@@ -0,0 +1,565 @@
+/*
+ * pointers.h
+ *
+ * Description:
+ * Pointer map and multi-level pointer path search. A pointer path is a module
+ * relative base and a list of offsets that leads to a target address:
+ *
+ *     target = [[["game.exe" + baseOffset] + offsets[0]] + offsets[1]] ...
+ *
+ * and, unlike the address itself, usually survives a restart of the target.
+ *
+ * Pointer map:
+ * - Every aligned pointer sized value in the scanned regions whose value lies
+ *   inside a committed, readable region is recorded as (value, address).
+ * - Collection runs as a first scan (scanRegionsEx in scanner.c) with
+ *   pointerKernel as the kernel; it emits each pointer as an (address, value)
+ *   pair into the hit list, which buildPointerMap() turns into entries.
+ * - Entries are sorted by value, so all pointers into [node - maxOffset, node]
+ *   are one binary search away (the reverse index of the search).
+ * - The module list (name, base, size) is stored with the map; an address
+ *   inside a module image is a static base.
+ * - Maps can be saved and loaded (savePointerMap / loadPointerMap), so a map
+ *   taken before a restart can still be searched for that run's target.
+ *
+ * Search:
+ * - Backwards from the target: at every level each pointer whose value is at
+ *   most maxOffset below the current node is a predecessor. A predecessor stored
+ *   inside a module ends a path (it is reported, not followed further), any
+ *   other predecessor becomes the next node until maxDepth levels are used.
+ * - The predecessors of the target are split over the thread pool; every task
+ *   records the range of paths it produced, so the merged result is in the same
+ *   order for any thread count. At most maxResults paths are reported: the
+ *   first ones in that order, whatever the thread count. A task keeps at most
+ *   maxResults paths and stops once the finished tasks before it hold that
+ *   many, since the merge would drop whatever it finds.
+ *
+ * Paths found in two runs (e.g. before and after a restart) are intersected by
+ * module name, base offset and offsets with intersectPointerPaths().
+ *
+ * Note:
+ * - Include `memsource.h`, `vectors.h`, `kernels.h` and `threadpool.h` before
+ *   this header.
+ * - The map of a 32 bit (WOW64) target uses 4 byte pointers.
+ */
+
+#ifndef POINTERS_H
+#define POINTERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vectors.h"
+#include "kernels.h"
+#include "threadpool.h"
+
+#define POINTER_MAX_DEPTH 8
+#define POINTER_MODULE_NAME MODULE_NAME_SIZE
+#define POINTER_FILE_MAGIC 0x50414D50u   // "PMAP"
+#define POINTER_FILE_VERSION 1u
+
+typedef struct {
+    unsigned long long value;
+    unsigned long long address;
+} pointer_entry;
+
+typedef struct {
+    remote_module* modules;   // sorted by base
+    SIZE_T moduleCount;
+    pointer_entry* entries;    // sorted by value, then address
+    SIZE_T entryCount;
+    unsigned int pointerSize;
+} pointer_map;
+
+typedef struct {
+    unsigned long long baseOffset;
+    int module;                // index into the modules of the owning list
+    int depth;                 // number of offsets
+    unsigned int offsets[POINTER_MAX_DEPTH];
+} pointer_path;
+
+typedef struct {
+    pointer_path* paths;
+    SIZE_T count;
+    SIZE_T capacity;
+    remote_module* modules;   // copy of the modules of the searched map
+    SIZE_T moduleCount;
+} pointer_path_list;
+
+// Readable regions, the valid pointer values of the map being built.
+typedef struct {
+    unsigned long long* starts;
+    unsigned long long* ends;
+    SIZE_T count;
+    unsigned int pointerSize;
+} pointer_regions;
+
+static void clearPointerMap(pointer_map* map) {
+    free(map->modules);
+    free(map->entries);
+    memset(map, 0, sizeof(pointer_map));
+}
+
+static void createPointerPathList(pointer_path_list* list) {
+    memset(list, 0, sizeof(pointer_path_list));
+}
+
+static void clearPointerPathList(pointer_path_list* list) {
+    free(list->paths);
+    free(list->modules);
+    memset(list, 0, sizeof(pointer_path_list));
+}
+
+static int appendPointerPath(pointer_path_list* list, const pointer_path* path) {
+    if (list->count == list->capacity) {
+        SIZE_T capacity = list->capacity ? list->capacity * 2 : 64;
+        pointer_path* grown = (pointer_path*)realloc(list->paths, capacity * sizeof(pointer_path));
+        if (grown == NULL)
+            return -1;
+        list->paths = grown;
+        list->capacity = capacity;
+    }
+    list->paths[list->count++] = *path;
+    return 1;
+}
+
+// Region table
+
+static int isPointerRegion(unsigned long long value, const pointer_regions* regions) {
+    SIZE_T lo = 0, hi = regions->count;
+    while (lo < hi) {
+        SIZE_T mid = lo + (hi - lo) / 2;
+        if (regions->ends[mid] <= value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < regions->count && regions->starts[lo] <= value;
+}
+
+// Records every committed, readable region; adjacent regions are merged.
+// Returns: 1 on success, -1 Memory Allocation Failure.
+static int collectPointerRegions(HANDLE hProcess, pointer_regions* regions) {
+    SIZE_T capacity = 0;
+    regions->starts = NULL;
+    regions->ends = NULL;
+    regions->count = 0;
+
+    region_walk walk;
+    MEMORY_BASIC_INFORMATION mbi;
+    beginRegionWalk(&walk, hProcess);
+    while (nextRegion(&walk, &mbi)) {
+        unsigned long long start = (unsigned long long)(SIZE_T)mbi.BaseAddress;
+        unsigned long long end = start + mbi.RegionSize;
+        if (mbi.State == MEM_COMMIT && !(mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD))) {
+            if (regions->count > 0 && regions->ends[regions->count - 1] == start) {
+                regions->ends[regions->count - 1] = end;
+            }
+            else {
+                if (regions->count == capacity) {
+                    capacity = capacity ? capacity * 2 : 256;
+                    unsigned long long* starts = (unsigned long long*)realloc(regions->starts, capacity * sizeof(unsigned long long));
+                    if (starts != NULL)
+                        regions->starts = starts;
+                    unsigned long long* ends = (unsigned long long*)realloc(regions->ends, capacity * sizeof(unsigned long long));
+                    if (ends != NULL)
+                        regions->ends = ends;
+                    if (starts == NULL || ends == NULL) {
+                        endRegionWalk(&walk);
+                        return -1;
+                    }
+                }
+                regions->starts[regions->count] = start;
+                regions->ends[regions->count] = end;
+                regions->count++;
+            }
+        }
+    }
+    endRegionWalk(&walk);
+    return 1;
+}
+
+static void freePointerRegions(pointer_regions* regions) {
+    free(regions->starts);
+    free(regions->ends);
+    regions->starts = NULL;
+    regions->ends = NULL;
+    regions->count = 0;
+}
+
+// Collection kernel
+// target is a pointer_regions; every value that points into one of them is
+// emitted as two hit list elements: its address, then the value itself.
+
+static int pointerKernel(const unsigned char* buffer, SIZE_T count, const void* target,
+    unsigned char* base, vector_uchar_ptr* hits) {
+    const pointer_regions* regions = (const pointer_regions*)target;
+    if (regions->count == 0)
+        return 1;
+    const unsigned long long lowest = regions->starts[0];
+    const unsigned long long highest = regions->ends[regions->count - 1];
+    const SIZE_T width = regions->pointerSize;
+    for (SIZE_T i = 0; i < count; i++) {
+        unsigned long long value;
+        if (width == 8) {
+            memcpy(&value, buffer + i * 8, 8);
+        }
+        else {
+            unsigned int narrow;
+            memcpy(&narrow, buffer + i * 4, 4);
+            value = narrow;
+        }
+        if (value < lowest || value >= highest || !isPointerRegion(value, regions))
+            continue;
+        if (!reserveVectorUCharPtr(hits, hits->size + 2))
+            return 0;
+        hits->array[hits->size++] = base + i * width;
+        hits->array[hits->size++] = (unsigned char*)(SIZE_T)value;
+    }
+    return 1;
+}
+
+static int comparePointerEntries(const void* a, const void* b) {
+    const pointer_entry* x = (const pointer_entry*)a;
+    const pointer_entry* y = (const pointer_entry*)b;
+    if (x->value != y->value)
+        return x->value < y->value ? -1 : 1;
+    if (x->address != y->address)
+        return x->address < y->address ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Fills map from the (address, value) pairs collected by pointerKernel and
+ * takes ownership of modules (sorted by base, see collectModules()), also when it fails.
+ * Returns: 1 on success, -1 Memory Allocation Failure.
+ */
+static int buildPointerMap(pointer_map* map, const vector_uchar_ptr* pairs, remote_module* modules,
+    SIZE_T moduleCount, unsigned int pointerSize) {
+    memset(map, 0, sizeof(pointer_map));
+    SIZE_T count = (SIZE_T)pairs->size / 2;
+    map->entries = (pointer_entry*)malloc((count ? count : 1) * sizeof(pointer_entry));
+    if (map->entries == NULL) {
+        free(modules);
+        return -1;
+    }
+    for (SIZE_T i = 0; i < count; i++) {
+        map->entries[i].address = (unsigned long long)(SIZE_T)pairs->array[2 * i];
+        map->entries[i].value = (unsigned long long)(SIZE_T)pairs->array[2 * i + 1];
+    }
+    qsort(map->entries, count, sizeof(pointer_entry), comparePointerEntries);
+    map->entryCount = count;
+    map->modules = modules;
+    map->moduleCount = moduleCount;
+    map->pointerSize = pointerSize;
+    return 1;
+}
+
+// First entry whose value is at least value.
+static SIZE_T lowerPointerEntry(const pointer_map* map, unsigned long long value) {
+    SIZE_T lo = 0, hi = map->entryCount;
+    while (lo < hi) {
+        SIZE_T mid = lo + (hi - lo) / 2;
+        if (map->entries[mid].value < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Save and load
+
+static FILE* openPointerFile(const char* path, const char* mode) {
+#ifdef _MSC_VER
+    FILE* file = NULL;
+    if (fopen_s(&file, path, mode) != 0)
+        return NULL;
+    return file;
+#else
+    return fopen(path, mode);
+#endif
+}
+
+// Returns: 1 on success, 0 if the file could not be written.
+static int savePointerMapFile(const pointer_map* map, const char* path) {
+    FILE* file = openPointerFile(path, "wb");
+    if (file == NULL)
+        return 0;
+    unsigned int header[4] = { POINTER_FILE_MAGIC, POINTER_FILE_VERSION, map->pointerSize, (unsigned int)map->moduleCount };
+    unsigned long long entryCount = map->entryCount;
+    int ok = fwrite(header, sizeof(header), 1, file) == 1
+        && fwrite(&entryCount, sizeof(entryCount), 1, file) == 1
+        && fwrite(map->modules, sizeof(remote_module), map->moduleCount, file) == map->moduleCount
+        && fwrite(map->entries, sizeof(pointer_entry), map->entryCount, file) == map->entryCount;
+    if (fclose(file) != 0)
+        ok = 0;
+    return ok;
+}
+
+// Returns: 1 on success, 0 if the file is missing or not a pointer map, -1 Memory Allocation Failure.
+static int loadPointerMapFile(pointer_map* map, const char* path) {
+    memset(map, 0, sizeof(pointer_map));
+    FILE* file = openPointerFile(path, "rb");
+    if (file == NULL)
+        return 0;
+    unsigned int header[4];
+    unsigned long long entryCount;
+    int result = 0;
+    if (fread(header, sizeof(header), 1, file) == 1 && fread(&entryCount, sizeof(entryCount), 1, file) == 1
+        && header[0] == POINTER_FILE_MAGIC && header[1] == POINTER_FILE_VERSION
+        && (header[2] == 4 || header[2] == 8) && entryCount <= (SIZE_T)-1 / sizeof(pointer_entry)) {
+        map->pointerSize = header[2];
+        map->moduleCount = header[3];
+        map->entryCount = (SIZE_T)entryCount;
+        map->modules = (remote_module*)malloc((map->moduleCount ? map->moduleCount : 1) * sizeof(remote_module));
+        map->entries = (pointer_entry*)malloc((map->entryCount ? map->entryCount : 1) * sizeof(pointer_entry));
+        if (map->modules == NULL || map->entries == NULL)
+            result = -1;
+        else if (fread(map->modules, sizeof(remote_module), map->moduleCount, file) == map->moduleCount
+            && fread(map->entries, sizeof(pointer_entry), map->entryCount, file) == map->entryCount)
+            result = 1;
+    }
+    fclose(file);
+    if (result != 1)
+        clearPointerMap(map);
+    else {
+        for (SIZE_T i = 0; i < map->moduleCount; i++)
+            map->modules[i].name[POINTER_MODULE_NAME - 1] = '\0';
+    }
+    return result;
+}
+
+// Search
+
+typedef struct {
+    SIZE_T worker;
+    SIZE_T first;
+    SIZE_T count;
+    int done;
+} pointer_task;
+
+typedef struct {
+    const pointer_map* map;
+    unsigned long long target;
+    int maxDepth;
+    unsigned long long maxOffset;
+    SIZE_T maxResults;
+    SIZE_T rootFirst;          // first predecessor of the target
+    pointer_task* tasks;
+    SIZE_T taskCount;
+    pointer_path_list* local;  // one per worker
+    pool_lock lock;
+    SIZE_T doneTasks;          // tasks [0, doneTasks) are finished
+    volatile SIZE_T doneFound; // paths of those tasks
+    volatile int allocationFailed;
+} pointer_search;
+
+// A running task is never part of the finished prefix, so once that prefix
+// holds maxResults paths nothing a running task finds is reported.
+static int pointerTaskFull(const pointer_search* search, const pointer_path_list* out, const pointer_task* task) {
+    return search->allocationFailed || out->count - task->first >= search->maxResults
+        || search->doneFound >= search->maxResults;
+}
+
+static void finishPointerTask(pointer_search* search, pointer_task* task) {
+    poolLockAcquire(&search->lock);
+    task->done = 1;
+    while (search->doneTasks < search->taskCount && search->tasks[search->doneTasks].done) {
+        search->doneFound += search->tasks[search->doneTasks].count;
+        search->doneTasks++;
+    }
+    poolLockRelease(&search->lock);
+}
+
+// offsets[0 .. depth) hold the offsets found so far, from the target backwards.
+static void searchPointerNode(pointer_search* search, pointer_path_list* out, const pointer_task* task,
+    unsigned long long node, int depth, unsigned int* offsets) {
+    const pointer_map* map = search->map;
+    unsigned long long low = node > search->maxOffset ? node - search->maxOffset : 0;
+    for (SIZE_T i = lowerPointerEntry(map, low); i < map->entryCount && map->entries[i].value <= node; i++) {
+        if (pointerTaskFull(search, out, task))
+            return;
+        offsets[depth] = (unsigned int)(node - map->entries[i].value);
+        unsigned long long address = map->entries[i].address;
+        int module = findModule(map->modules, map->moduleCount, address);
+        if (module >= 0) {
+            pointer_path path;
+            memset(&path, 0, sizeof(path));
+            path.module = module;
+            path.baseOffset = address - map->modules[module].base;
+            path.depth = depth + 1;
+            for (int k = 0; k <= depth; k++)
+                path.offsets[k] = offsets[depth - k];
+            if (appendPointerPath(out, &path) < 0)
+                search->allocationFailed = 1;
+        }
+        else if (depth + 1 < search->maxDepth) {
+            searchPointerNode(search, out, task, address, depth + 1, offsets);
+        }
+    }
+}
+
+static void searchPointerTask(void* context, int worker, SIZE_T index) {
+    pointer_search* search = (pointer_search*)context;
+    pointer_path_list* out = &search->local[worker];
+    pointer_task* task = &search->tasks[index];
+    task->worker = (SIZE_T)worker;
+    task->first = out->count;
+
+    // Each task is one predecessor of the target, handled as in searchPointerNode.
+    const pointer_entry* entry = &search->map->entries[search->rootFirst + index];
+    unsigned int offsets[POINTER_MAX_DEPTH];
+    offsets[0] = (unsigned int)(search->target - entry->value);
+    int module = findModule(search->map->modules, search->map->moduleCount, entry->address);
+    if (pointerTaskFull(search, out, task)) {
+        // Nothing this task finds would be reported.
+    }
+    else if (module >= 0) {
+        pointer_path path;
+        memset(&path, 0, sizeof(path));
+        path.module = module;
+        path.baseOffset = entry->address - search->map->modules[module].base;
+        path.depth = 1;
+        path.offsets[0] = offsets[0];
+        if (appendPointerPath(out, &path) < 0)
+            search->allocationFailed = 1;
+    }
+    else if (search->maxDepth > 1) {
+        searchPointerNode(search, out, task, entry->address, 1, offsets);
+    }
+    task->count = out->count - task->first;
+    finishPointerTask(search, task);
+}
+
+/*
+ * Replaces the content of results with the paths from the modules of map to
+ * target, using at most maxDepth offsets of at most maxOffset each.
+ * Returns: 1 on success, -1 Memory Allocation Failure, -3 Invalid Arguments.
+ */
+static int searchPointerPaths(const pointer_map* map, unsigned long long target, int maxDepth, unsigned long long maxOffset,
+    SIZE_T maxResults, int threads, pointer_path_list* results) {
+    if (maxDepth < 1 || maxDepth > POINTER_MAX_DEPTH || maxOffset > 0xFFFFFFFFull || maxResults == 0)
+        return -3;
+    clearPointerPathList(results);
+    results->modules = (remote_module*)malloc((map->moduleCount ? map->moduleCount : 1) * sizeof(remote_module));
+    if (results->modules == NULL)
+        return -1;
+    memcpy(results->modules, map->modules, map->moduleCount * sizeof(remote_module));
+    results->moduleCount = map->moduleCount;
+
+    pointer_search search;
+    search.map = map;
+    search.target = target;
+    search.maxDepth = maxDepth;
+    search.maxOffset = maxOffset;
+    search.maxResults = maxResults;
+    search.rootFirst = lowerPointerEntry(map, target > maxOffset ? target - maxOffset : 0);
+    search.doneTasks = 0;
+    search.doneFound = 0;
+    search.allocationFailed = 0;
+    SIZE_T rootEnd = search.rootFirst;
+    while (rootEnd < map->entryCount && map->entries[rootEnd].value <= target)
+        rootEnd++;
+    SIZE_T taskCount = rootEnd - search.rootFirst;
+    if (taskCount == 0)
+        return 1;
+    if ((SIZE_T)threads > taskCount)
+        threads = (int)taskCount;
+
+    search.taskCount = taskCount;
+    search.tasks = (pointer_task*)calloc(taskCount, sizeof(pointer_task));
+    search.local = (pointer_path_list*)calloc(threads, sizeof(pointer_path_list));
+    if (search.tasks == NULL || search.local == NULL) {
+        free(search.tasks);
+        free(search.local);
+        return -1;
+    }
+    poolLockInit(&search.lock);
+    int result = runWorkStealing(threads, taskCount, searchPointerTask, &search);
+    poolLockDestroy(&search.lock);
+    if (search.allocationFailed)
+        result = -1;
+
+    // Merge in predecessor order, so the result does not depend on the scheduling.
+    for (SIZE_T i = 0; i < taskCount && result == 1 && results->count < maxResults; i++) {
+        pointer_path_list* local = &search.local[search.tasks[i].worker];
+        for (SIZE_T k = 0; k < search.tasks[i].count && results->count < maxResults; k++) {
+            if (appendPointerPath(results, &local->paths[search.tasks[i].first + k]) < 0) {
+                result = -1;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < threads; i++)
+        clearPointerPathList(&search.local[i]);
+    free(search.local);
+    free(search.tasks);
+    if (result != 1)
+        results->count = 0;
+    return result;
+}
+
+// Intersection
+
+static int pointerPathEquals(const pointer_path_list* a, const pointer_path* x, const pointer_path_list* b,
+    const pointer_path* y) {
+    if (x->baseOffset != y->baseOffset || x->depth != y->depth)
+        return 0;
+    if (memcmp(x->offsets, y->offsets, x->depth * sizeof(unsigned int)) != 0)
+        return 0;
+    return moduleNameEquals(a->modules[x->module].name, b->modules[y->module].name);
+}
+
+static unsigned long long hashPointerPath(const pointer_path_list* list, const pointer_path* path) {
+    unsigned long long hash = 1469598103934665603ull;
+    for (const char* c = list->modules[path->module].name; *c; c++) {
+        char lower = (*c >= 'A' && *c <= 'Z') ? (char)(*c + 32) : *c;
+        hash = (hash ^ (unsigned char)lower) * 1099511628211ull;
+    }
+    hash = (hash ^ path->baseOffset) * 1099511628211ull;
+    for (int k = 0; k < path->depth; k++)
+        hash = (hash ^ path->offsets[k]) * 1099511628211ull;
+    return hash ^ (unsigned long long)path->depth;
+}
+
+/*
+ * Keeps the paths of list that also occur in other, in order.
+ * Returns: the number of paths left, or -1 Memory Allocation Failure.
+ */
+static long long intersectPointerPathLists(pointer_path_list* list, const pointer_path_list* other) {
+    SIZE_T buckets = 1;
+    while (buckets < other->count * 2)
+        buckets <<= 1;
+    SIZE_T* heads = (SIZE_T*)malloc(buckets * sizeof(SIZE_T));
+    SIZE_T* next = (SIZE_T*)malloc((other->count ? other->count : 1) * sizeof(SIZE_T));
+    if (heads == NULL || next == NULL) {
+        free(heads);
+        free(next);
+        return -1;
+    }
+    for (SIZE_T i = 0; i < buckets; i++)
+        heads[i] = (SIZE_T)-1;
+    for (SIZE_T i = 0; i < other->count; i++) {
+        SIZE_T bucket = (SIZE_T)hashPointerPath(other, &other->paths[i]) & (buckets - 1);
+        next[i] = heads[bucket];
+        heads[bucket] = i;
+    }
+
+    SIZE_T kept = 0;
+    for (SIZE_T i = 0; i < list->count; i++) {
+        SIZE_T bucket = (SIZE_T)hashPointerPath(list, &list->paths[i]) & (buckets - 1);
+        for (SIZE_T j = heads[bucket]; j != (SIZE_T)-1; j = next[j]) {
+            if (pointerPathEquals(list, &list->paths[i], other, &other->paths[j])) {
+                list->paths[kept++] = list->paths[i];
+                break;
+            }
+        }
+    }
+    list->count = kept;
+    free(heads);
+    free(next);
+    return (long long)kept;
+}
+
+#endif // POINTERS_H
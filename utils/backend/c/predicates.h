@@ -0,0 +1,469 @@
+/*
+ * predicates.h
+ *
+ * Description:
+ * Predicate scans: instead of exact equality an element matches when it
+ * satisfies one of
+ * - SCAN_PREDICATE_EQUAL   : x == a
+ * - SCAN_PREDICATE_EPSILON : |x - a| <= b (rewritten to the range [a - b, a + b])
+ * - SCAN_PREDICATE_RANGE   : a <= x <= b
+ * - SCAN_PREDICATE_LESS    : x < a
+ * - SCAN_PREDICATE_GREATER : x > a
+ * - SCAN_PREDICATE_MASKED  : (x & b) == (a & b), on the raw bits of x
+ *
+ * Every predicate has a mask kernel per element type and instruction set
+ * level. A mask kernel evaluates a block of up to 64 contiguous elements and
+ * returns one bit per element. The first scan runs it over each window
+ * (kernelPredicate), the next scan gathers up to 64 candidate values into a
+ * block and runs the same kernel on it, so both paths share the vector code.
+ *
+ * Positions are normally sizeof(T) apart. kernelPredicateStrided() tests every
+ * `stride` bytes instead (stride < sizeof(T), so neighbouring values overlap):
+ * each of the sizeof(T) / stride lanes runs the same mask kernel on its own
+ * shifted run of 64 elements while the block is still in L1, and the lane
+ * masks are merged back into address order.
+ *
+ * Float and double comparisons are ordered: NaN never matches, except through
+ * SCAN_PREDICATE_MASKED which only looks at the bits.
+ *
+ * Usage:
+ * - scan_predicate predicate;
+ *   float a = 100.0f, b = 0.01f;
+ *   SCAN_VALUE_TYPE_INFO[SCAN_TYPE_F32].makePredicate(&predicate, SCAN_PREDICATE_EPSILON, &a, &b);
+ *   (predicates are set up per value type, see valuetypes.h)
+ * - predicate_target target = { selectMaskKernel(MASKS_FLOAT, predicate.kind), sizeof(float), sizeof(float), predicate };
+ *   kernelPredicate(buffer, count, &target, remoteBase, addresses);
+ *
+ * Note:
+ * - Include `kernels.h` before this header.
+ */
+
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include <string.h>
+#include "kernels.h"
+
+typedef enum {
+    SCAN_PREDICATE_EQUAL = 0,
+    SCAN_PREDICATE_EPSILON = 1,
+    SCAN_PREDICATE_RANGE = 2,
+    SCAN_PREDICATE_LESS = 3,
+    SCAN_PREDICATE_GREATER = 4,
+    SCAN_PREDICATE_MASKED = 5,
+    SCAN_PREDICATE_COUNT = 6
+} scan_predicate_kind;
+
+// Operands are stored in the first bytes of the union whatever the type.
+typedef union {
+    int i;
+    float f;
+    double d;
+    unsigned long long bits;
+} scan_value;
+
+typedef struct {
+    int kind;
+    scan_value a;
+    scan_value b;
+} scan_predicate;
+
+typedef unsigned long long (*mask_kernel)(const unsigned char* block, SIZE_T count, const scan_predicate* predicate);
+
+typedef struct {
+    mask_kernel mask;
+    SIZE_T width;
+    SIZE_T stride;
+    scan_predicate predicate;
+} predicate_target;
+
+// Scalar mask kernels
+
+#define PREDICATE_EQUAL(x, a, b) ((x) == (a))
+#define PREDICATE_RANGE(x, a, b) ((x) >= (a) && (x) <= (b))
+#define PREDICATE_LESS(x, a, b) ((x) < (a))
+#define PREDICATE_GREATER(x, a, b) ((x) > (a))
+#define PREDICATE_MASKED(x, a, b) (((x) & (b)) == (a))
+
+#define DEFINE_SCALAR_MASK(NAME, T, TEST)                                                   \
+    static unsigned long long NAME(const unsigned char* block, SIZE_T count,                \
+        const scan_predicate* predicate) {                                                  \
+        T a, b, x;                                                                          \
+        memcpy(&a, &predicate->a, sizeof(T));                                               \
+        memcpy(&b, &predicate->b, sizeof(T));                                               \
+        (void)b;                                                                            \
+        unsigned long long mask = 0;                                                        \
+        for (SIZE_T i = 0; i < count; i++) {                                                \
+            memcpy(&x, block + i * sizeof(T), sizeof(T));                                   \
+            if (TEST(x, a, b))                                                              \
+                mask |= 1ull << i;                                                          \
+        }                                                                                   \
+        return mask;                                                                        \
+    }
+
+DEFINE_SCALAR_MASK(maskScalarEqualINT, int, PREDICATE_EQUAL)
+DEFINE_SCALAR_MASK(maskScalarRangeINT, int, PREDICATE_RANGE)
+DEFINE_SCALAR_MASK(maskScalarLessINT, int, PREDICATE_LESS)
+DEFINE_SCALAR_MASK(maskScalarGreaterINT, int, PREDICATE_GREATER)
+DEFINE_SCALAR_MASK(maskScalarMasked32, unsigned int, PREDICATE_MASKED)
+
+DEFINE_SCALAR_MASK(maskScalarEqualFLOAT, float, PREDICATE_EQUAL)
+DEFINE_SCALAR_MASK(maskScalarRangeFLOAT, float, PREDICATE_RANGE)
+DEFINE_SCALAR_MASK(maskScalarLessFLOAT, float, PREDICATE_LESS)
+DEFINE_SCALAR_MASK(maskScalarGreaterFLOAT, float, PREDICATE_GREATER)
+
+DEFINE_SCALAR_MASK(maskScalarEqualDOUBLE, double, PREDICATE_EQUAL)
+DEFINE_SCALAR_MASK(maskScalarRangeDOUBLE, double, PREDICATE_RANGE)
+DEFINE_SCALAR_MASK(maskScalarLessDOUBLE, double, PREDICATE_LESS)
+DEFINE_SCALAR_MASK(maskScalarGreaterDOUBLE, double, PREDICATE_GREATER)
+DEFINE_SCALAR_MASK(maskScalarMasked64, unsigned long long, PREDICATE_MASKED)
+
+#ifdef SCAN_KERNELS_X86
+
+// A full block of 64 elements is compared LANES at a time; shorter blocks (the
+// end of a window or of a batch of candidates) use the scalar kernel.
+#define DEFINE_SIMD_MASK(NAME, ISA, T, VEC, SPLAT, CMPMASK, LANES, SCALAR)                  \
+    KERNEL_TARGET(ISA) static unsigned long long NAME(const unsigned char* block,           \
+        SIZE_T count, const scan_predicate* predicate) {                                    \
+        if (count < 64)                                                                     \
+            return SCALAR(block, count, predicate);                                         \
+        T a, b;                                                                             \
+        memcpy(&a, &predicate->a, sizeof(T));                                               \
+        memcpy(&b, &predicate->b, sizeof(T));                                               \
+        const VEC va = SPLAT(a);                                                            \
+        const VEC vb = SPLAT(b);                                                            \
+        unsigned long long mask = 0;                                                        \
+        for (int k = 0; k < 64; k += (LANES))                                               \
+            mask |= (unsigned long long)CMPMASK(block + k * sizeof(T), va, vb) << k;        \
+        return mask;                                                                        \
+    }
+
+// SSE2
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2EqualINT(const unsigned char* p, __m128i a, __m128i b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)p), a)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2RangeINT(const unsigned char* p, __m128i a, __m128i b) {
+    __m128i x = _mm_loadu_si128((const __m128i*)p);
+    __m128i out = _mm_or_si128(_mm_cmplt_epi32(x, a), _mm_cmpgt_epi32(x, b));
+    return ~(unsigned int)_mm_movemask_ps(_mm_castsi128_ps(out)) & 0xF;
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2LessINT(const unsigned char* p, __m128i a, __m128i b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(_mm_loadu_si128((const __m128i*)p), a)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2GreaterINT(const unsigned char* p, __m128i a, __m128i b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)p), a)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Masked32(const unsigned char* p, __m128i a, __m128i b) {
+    __m128i x = _mm_and_si128(_mm_loadu_si128((const __m128i*)p), b);
+    return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, a)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2EqualFLOAT(const unsigned char* p, __m128 a, __m128 b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps((const float*)p), a));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2RangeFLOAT(const unsigned char* p, __m128 a, __m128 b) {
+    __m128 x = _mm_loadu_ps((const float*)p);
+    return (unsigned int)_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, a), _mm_cmple_ps(x, b)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2LessFLOAT(const unsigned char* p, __m128 a, __m128 b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps((const float*)p), a));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2GreaterFLOAT(const unsigned char* p, __m128 a, __m128 b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps((const float*)p), a));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2EqualDOUBLE(const unsigned char* p, __m128d a, __m128d b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd((const double*)p), a));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2RangeDOUBLE(const unsigned char* p, __m128d a, __m128d b) {
+    __m128d x = _mm_loadu_pd((const double*)p);
+    return (unsigned int)_mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, a), _mm_cmple_pd(x, b)));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2LessDOUBLE(const unsigned char* p, __m128d a, __m128d b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd((const double*)p), a));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2GreaterDOUBLE(const unsigned char* p, __m128d a, __m128d b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd((const double*)p), a));
+}
+// SSE2 has no 64 bit compare: both 32 bit halves of a lane must be equal.
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Masked64(const unsigned char* p, __m128i a, __m128i b) {
+    __m128i eq = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)p), b), a);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (unsigned int)_mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+
+DEFINE_SIMD_MASK(maskSSE2EqualINT, "sse2", int, __m128i, _mm_set1_epi32, predSSE2EqualINT, 4, maskScalarEqualINT)
+DEFINE_SIMD_MASK(maskSSE2RangeINT, "sse2", int, __m128i, _mm_set1_epi32, predSSE2RangeINT, 4, maskScalarRangeINT)
+DEFINE_SIMD_MASK(maskSSE2LessINT, "sse2", int, __m128i, _mm_set1_epi32, predSSE2LessINT, 4, maskScalarLessINT)
+DEFINE_SIMD_MASK(maskSSE2GreaterINT, "sse2", int, __m128i, _mm_set1_epi32, predSSE2GreaterINT, 4, maskScalarGreaterINT)
+DEFINE_SIMD_MASK(maskSSE2Masked32, "sse2", int, __m128i, _mm_set1_epi32, predSSE2Masked32, 4, maskScalarMasked32)
+DEFINE_SIMD_MASK(maskSSE2EqualFLOAT, "sse2", float, __m128, _mm_set1_ps, predSSE2EqualFLOAT, 4, maskScalarEqualFLOAT)
+DEFINE_SIMD_MASK(maskSSE2RangeFLOAT, "sse2", float, __m128, _mm_set1_ps, predSSE2RangeFLOAT, 4, maskScalarRangeFLOAT)
+DEFINE_SIMD_MASK(maskSSE2LessFLOAT, "sse2", float, __m128, _mm_set1_ps, predSSE2LessFLOAT, 4, maskScalarLessFLOAT)
+DEFINE_SIMD_MASK(maskSSE2GreaterFLOAT, "sse2", float, __m128, _mm_set1_ps, predSSE2GreaterFLOAT, 4, maskScalarGreaterFLOAT)
+DEFINE_SIMD_MASK(maskSSE2EqualDOUBLE, "sse2", double, __m128d, _mm_set1_pd, predSSE2EqualDOUBLE, 2, maskScalarEqualDOUBLE)
+DEFINE_SIMD_MASK(maskSSE2RangeDOUBLE, "sse2", double, __m128d, _mm_set1_pd, predSSE2RangeDOUBLE, 2, maskScalarRangeDOUBLE)
+DEFINE_SIMD_MASK(maskSSE2LessDOUBLE, "sse2", double, __m128d, _mm_set1_pd, predSSE2LessDOUBLE, 2, maskScalarLessDOUBLE)
+DEFINE_SIMD_MASK(maskSSE2GreaterDOUBLE, "sse2", double, __m128d, _mm_set1_pd, predSSE2GreaterDOUBLE, 2, maskScalarGreaterDOUBLE)
+DEFINE_SIMD_MASK(maskSSE2Masked64, "sse2", long long, __m128i, _mm_set1_epi64x, predSSE2Masked64, 2, maskScalarMasked64)
+
+// AVX2
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2EqualINT(const unsigned char* p, __m256i a, __m256i b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)p), a)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2RangeINT(const unsigned char* p, __m256i a, __m256i b) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)p);
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(a, x), _mm256_cmpgt_epi32(x, b));
+    return ~(unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xFF;
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2LessINT(const unsigned char* p, __m256i a, __m256i b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, _mm256_loadu_si256((const __m256i*)p))));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2GreaterINT(const unsigned char* p, __m256i a, __m256i b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)p), a)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Masked32(const unsigned char* p, __m256i a, __m256i b) {
+    __m256i x = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), b);
+    return (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, a)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2EqualFLOAT(const unsigned char* p, __m256 a, __m256 b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps((const float*)p), a, _CMP_EQ_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2RangeFLOAT(const unsigned char* p, __m256 a, __m256 b) {
+    __m256 x = _mm256_loadu_ps((const float*)p);
+    return (unsigned int)_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, a, _CMP_GE_OQ), _mm256_cmp_ps(x, b, _CMP_LE_OQ)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2LessFLOAT(const unsigned char* p, __m256 a, __m256 b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps((const float*)p), a, _CMP_LT_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2GreaterFLOAT(const unsigned char* p, __m256 a, __m256 b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps((const float*)p), a, _CMP_GT_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2EqualDOUBLE(const unsigned char* p, __m256d a, __m256d b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd((const double*)p), a, _CMP_EQ_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2RangeDOUBLE(const unsigned char* p, __m256d a, __m256d b) {
+    __m256d x = _mm256_loadu_pd((const double*)p);
+    return (unsigned int)_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, a, _CMP_GE_OQ), _mm256_cmp_pd(x, b, _CMP_LE_OQ)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2LessDOUBLE(const unsigned char* p, __m256d a, __m256d b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd((const double*)p), a, _CMP_LT_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2GreaterDOUBLE(const unsigned char* p, __m256d a, __m256d b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd((const double*)p), a, _CMP_GT_OQ));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Masked64(const unsigned char* p, __m256i a, __m256i b) {
+    __m256i x = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), b);
+    return (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, a)));
+}
+
+DEFINE_SIMD_MASK(maskAVX2EqualINT, "avx2", int, __m256i, _mm256_set1_epi32, predAVX2EqualINT, 8, maskScalarEqualINT)
+DEFINE_SIMD_MASK(maskAVX2RangeINT, "avx2", int, __m256i, _mm256_set1_epi32, predAVX2RangeINT, 8, maskScalarRangeINT)
+DEFINE_SIMD_MASK(maskAVX2LessINT, "avx2", int, __m256i, _mm256_set1_epi32, predAVX2LessINT, 8, maskScalarLessINT)
+DEFINE_SIMD_MASK(maskAVX2GreaterINT, "avx2", int, __m256i, _mm256_set1_epi32, predAVX2GreaterINT, 8, maskScalarGreaterINT)
+DEFINE_SIMD_MASK(maskAVX2Masked32, "avx2", int, __m256i, _mm256_set1_epi32, predAVX2Masked32, 8, maskScalarMasked32)
+DEFINE_SIMD_MASK(maskAVX2EqualFLOAT, "avx2", float, __m256, _mm256_set1_ps, predAVX2EqualFLOAT, 8, maskScalarEqualFLOAT)
+DEFINE_SIMD_MASK(maskAVX2RangeFLOAT, "avx2", float, __m256, _mm256_set1_ps, predAVX2RangeFLOAT, 8, maskScalarRangeFLOAT)
+DEFINE_SIMD_MASK(maskAVX2LessFLOAT, "avx2", float, __m256, _mm256_set1_ps, predAVX2LessFLOAT, 8, maskScalarLessFLOAT)
+DEFINE_SIMD_MASK(maskAVX2GreaterFLOAT, "avx2", float, __m256, _mm256_set1_ps, predAVX2GreaterFLOAT, 8, maskScalarGreaterFLOAT)
+DEFINE_SIMD_MASK(maskAVX2EqualDOUBLE, "avx2", double, __m256d, _mm256_set1_pd, predAVX2EqualDOUBLE, 4, maskScalarEqualDOUBLE)
+DEFINE_SIMD_MASK(maskAVX2RangeDOUBLE, "avx2", double, __m256d, _mm256_set1_pd, predAVX2RangeDOUBLE, 4, maskScalarRangeDOUBLE)
+DEFINE_SIMD_MASK(maskAVX2LessDOUBLE, "avx2", double, __m256d, _mm256_set1_pd, predAVX2LessDOUBLE, 4, maskScalarLessDOUBLE)
+DEFINE_SIMD_MASK(maskAVX2GreaterDOUBLE, "avx2", double, __m256d, _mm256_set1_pd, predAVX2GreaterDOUBLE, 4, maskScalarGreaterDOUBLE)
+DEFINE_SIMD_MASK(maskAVX2Masked64, "avx2", long long, __m256i, _mm256_set1_epi64x, predAVX2Masked64, 4, maskScalarMasked64)
+
+// AVX-512
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512EqualINT(const unsigned char* p, __m512i a, __m512i b) {
+    (void)b;
+    return (unsigned int)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void*)p), a);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512RangeINT(const unsigned char* p, __m512i a, __m512i b) {
+    __m512i x = _mm512_loadu_si512((const void*)p);
+    return (unsigned int)_mm512_mask_cmp_epi32_mask(_mm512_cmp_epi32_mask(x, a, _MM_CMPINT_NLT), x, b, _MM_CMPINT_LE);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512LessINT(const unsigned char* p, __m512i a, __m512i b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_epi32_mask(_mm512_loadu_si512((const void*)p), a, _MM_CMPINT_LT);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512GreaterINT(const unsigned char* p, __m512i a, __m512i b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_epi32_mask(_mm512_loadu_si512((const void*)p), a, _MM_CMPINT_NLE);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512Masked32(const unsigned char* p, __m512i a, __m512i b) {
+    return (unsigned int)_mm512_cmpeq_epi32_mask(_mm512_and_si512(_mm512_loadu_si512((const void*)p), b), a);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512EqualFLOAT(const unsigned char* p, __m512 a, __m512 b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_ps_mask(_mm512_loadu_ps((const float*)p), a, _CMP_EQ_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512RangeFLOAT(const unsigned char* p, __m512 a, __m512 b) {
+    __m512 x = _mm512_loadu_ps((const float*)p);
+    return (unsigned int)_mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(x, a, _CMP_GE_OQ), x, b, _CMP_LE_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512LessFLOAT(const unsigned char* p, __m512 a, __m512 b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_ps_mask(_mm512_loadu_ps((const float*)p), a, _CMP_LT_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512GreaterFLOAT(const unsigned char* p, __m512 a, __m512 b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_ps_mask(_mm512_loadu_ps((const float*)p), a, _CMP_GT_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512EqualDOUBLE(const unsigned char* p, __m512d a, __m512d b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_pd_mask(_mm512_loadu_pd((const double*)p), a, _CMP_EQ_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512RangeDOUBLE(const unsigned char* p, __m512d a, __m512d b) {
+    __m512d x = _mm512_loadu_pd((const double*)p);
+    return (unsigned int)_mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(x, a, _CMP_GE_OQ), x, b, _CMP_LE_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512LessDOUBLE(const unsigned char* p, __m512d a, __m512d b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_pd_mask(_mm512_loadu_pd((const double*)p), a, _CMP_LT_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512GreaterDOUBLE(const unsigned char* p, __m512d a, __m512d b) {
+    (void)b;
+    return (unsigned int)_mm512_cmp_pd_mask(_mm512_loadu_pd((const double*)p), a, _CMP_GT_OQ);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512Masked64(const unsigned char* p, __m512i a, __m512i b) {
+    return (unsigned int)_mm512_cmpeq_epi64_mask(_mm512_and_si512(_mm512_loadu_si512((const void*)p), b), a);
+}
+
+DEFINE_SIMD_MASK(maskAVX512EqualINT, "avx512f", int, __m512i, _mm512_set1_epi32, predAVX512EqualINT, 16, maskScalarEqualINT)
+DEFINE_SIMD_MASK(maskAVX512RangeINT, "avx512f", int, __m512i, _mm512_set1_epi32, predAVX512RangeINT, 16, maskScalarRangeINT)
+DEFINE_SIMD_MASK(maskAVX512LessINT, "avx512f", int, __m512i, _mm512_set1_epi32, predAVX512LessINT, 16, maskScalarLessINT)
+DEFINE_SIMD_MASK(maskAVX512GreaterINT, "avx512f", int, __m512i, _mm512_set1_epi32, predAVX512GreaterINT, 16, maskScalarGreaterINT)
+DEFINE_SIMD_MASK(maskAVX512Masked32, "avx512f", int, __m512i, _mm512_set1_epi32, predAVX512Masked32, 16, maskScalarMasked32)
+DEFINE_SIMD_MASK(maskAVX512EqualFLOAT, "avx512f", float, __m512, _mm512_set1_ps, predAVX512EqualFLOAT, 16, maskScalarEqualFLOAT)
+DEFINE_SIMD_MASK(maskAVX512RangeFLOAT, "avx512f", float, __m512, _mm512_set1_ps, predAVX512RangeFLOAT, 16, maskScalarRangeFLOAT)
+DEFINE_SIMD_MASK(maskAVX512LessFLOAT, "avx512f", float, __m512, _mm512_set1_ps, predAVX512LessFLOAT, 16, maskScalarLessFLOAT)
+DEFINE_SIMD_MASK(maskAVX512GreaterFLOAT, "avx512f", float, __m512, _mm512_set1_ps, predAVX512GreaterFLOAT, 16, maskScalarGreaterFLOAT)
+DEFINE_SIMD_MASK(maskAVX512EqualDOUBLE, "avx512f", double, __m512d, _mm512_set1_pd, predAVX512EqualDOUBLE, 8, maskScalarEqualDOUBLE)
+DEFINE_SIMD_MASK(maskAVX512RangeDOUBLE, "avx512f", double, __m512d, _mm512_set1_pd, predAVX512RangeDOUBLE, 8, maskScalarRangeDOUBLE)
+DEFINE_SIMD_MASK(maskAVX512LessDOUBLE, "avx512f", double, __m512d, _mm512_set1_pd, predAVX512LessDOUBLE, 8, maskScalarLessDOUBLE)
+DEFINE_SIMD_MASK(maskAVX512GreaterDOUBLE, "avx512f", double, __m512d, _mm512_set1_pd, predAVX512GreaterDOUBLE, 8, maskScalarGreaterDOUBLE)
+DEFINE_SIMD_MASK(maskAVX512Masked64, "avx512f", long long, __m512i, _mm512_set1_epi64, predAVX512Masked64, 8, maskScalarMasked64)
+
+// Rows are scan_predicate_kind, EPSILON shares the RANGE kernels.
+static const mask_kernel MASKS_INT[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {
+    { maskScalarEqualINT, maskSSE2EqualINT, maskAVX2EqualINT, maskAVX512EqualINT },
+    { maskScalarRangeINT, maskSSE2RangeINT, maskAVX2RangeINT, maskAVX512RangeINT },
+    { maskScalarRangeINT, maskSSE2RangeINT, maskAVX2RangeINT, maskAVX512RangeINT },
+    { maskScalarLessINT, maskSSE2LessINT, maskAVX2LessINT, maskAVX512LessINT },
+    { maskScalarGreaterINT, maskSSE2GreaterINT, maskAVX2GreaterINT, maskAVX512GreaterINT },
+    { maskScalarMasked32, maskSSE2Masked32, maskAVX2Masked32, maskAVX512Masked32 }
+};
+static const mask_kernel MASKS_FLOAT[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {
+    { maskScalarEqualFLOAT, maskSSE2EqualFLOAT, maskAVX2EqualFLOAT, maskAVX512EqualFLOAT },
+    { maskScalarRangeFLOAT, maskSSE2RangeFLOAT, maskAVX2RangeFLOAT, maskAVX512RangeFLOAT },
+    { maskScalarRangeFLOAT, maskSSE2RangeFLOAT, maskAVX2RangeFLOAT, maskAVX512RangeFLOAT },
+    { maskScalarLessFLOAT, maskSSE2LessFLOAT, maskAVX2LessFLOAT, maskAVX512LessFLOAT },
+    { maskScalarGreaterFLOAT, maskSSE2GreaterFLOAT, maskAVX2GreaterFLOAT, maskAVX512GreaterFLOAT },
+    { maskScalarMasked32, maskSSE2Masked32, maskAVX2Masked32, maskAVX512Masked32 }
+};
+static const mask_kernel MASKS_DOUBLE[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {
+    { maskScalarEqualDOUBLE, maskSSE2EqualDOUBLE, maskAVX2EqualDOUBLE, maskAVX512EqualDOUBLE },
+    { maskScalarRangeDOUBLE, maskSSE2RangeDOUBLE, maskAVX2RangeDOUBLE, maskAVX512RangeDOUBLE },
+    { maskScalarRangeDOUBLE, maskSSE2RangeDOUBLE, maskAVX2RangeDOUBLE, maskAVX512RangeDOUBLE },
+    { maskScalarLessDOUBLE, maskSSE2LessDOUBLE, maskAVX2LessDOUBLE, maskAVX512LessDOUBLE },
+    { maskScalarGreaterDOUBLE, maskSSE2GreaterDOUBLE, maskAVX2GreaterDOUBLE, maskAVX512GreaterDOUBLE },
+    { maskScalarMasked64, maskSSE2Masked64, maskAVX2Masked64, maskAVX512Masked64 }
+};
+
+#else
+
+#define SCALAR_MASK_ROW(KERNEL) { KERNEL, KERNEL, KERNEL, KERNEL }
+
+static const mask_kernel MASKS_INT[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {
+    SCALAR_MASK_ROW(maskScalarEqualINT), SCALAR_MASK_ROW(maskScalarRangeINT), SCALAR_MASK_ROW(maskScalarRangeINT),
+    SCALAR_MASK_ROW(maskScalarLessINT), SCALAR_MASK_ROW(maskScalarGreaterINT), SCALAR_MASK_ROW(maskScalarMasked32)
+};
+static const mask_kernel MASKS_FLOAT[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {
+    SCALAR_MASK_ROW(maskScalarEqualFLOAT), SCALAR_MASK_ROW(maskScalarRangeFLOAT), SCALAR_MASK_ROW(maskScalarRangeFLOAT),
+    SCALAR_MASK_ROW(maskScalarLessFLOAT), SCALAR_MASK_ROW(maskScalarGreaterFLOAT), SCALAR_MASK_ROW(maskScalarMasked32)
+};
+static const mask_kernel MASKS_DOUBLE[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {
+    SCALAR_MASK_ROW(maskScalarEqualDOUBLE), SCALAR_MASK_ROW(maskScalarRangeDOUBLE), SCALAR_MASK_ROW(maskScalarRangeDOUBLE),
+    SCALAR_MASK_ROW(maskScalarLessDOUBLE), SCALAR_MASK_ROW(maskScalarGreaterDOUBLE), SCALAR_MASK_ROW(maskScalarMasked64)
+};
+
+#endif // SCAN_KERNELS_X86
+
+static inline mask_kernel selectMaskKernel(const mask_kernel table[][SCAN_ISA_COUNT], int kind) {
+    return table[kind][currentScanISA()];
+}
+
+// Predicate scan kernel
+// A scan_kernel (see kernels.h) whose target is a predicate_target; lets the
+// predicate scans reuse the windowed / parallel first scan unchanged.
+static int kernelPredicate(const unsigned char* buffer, SIZE_T count, const void* target,
+    unsigned char* base, vector_uchar_ptr* hits) {
+    const predicate_target* predicate = (const predicate_target*)target;
+    for (SIZE_T i = 0; i < count; i += 64) {
+        SIZE_T block = count - i < 64 ? count - i : 64;
+        unsigned long long mask = predicate->mask(buffer + i * predicate->width, block, &predicate->predicate);
+        if (mask && !emitHitMask(hits, base, i, mask, predicate->width))
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * Scan kernel for stride < width: count is the number of positions, position
+ * j starts at buffer + j * stride. Positions are taken in blocks of
+ * 64 * lanes, lane q holding the positions q, q + lanes, q + 2 * lanes, ...
+ * of the block, which are contiguous elements starting at an offset of
+ * q * stride bytes.
+ */
+static int kernelPredicateStrided(const unsigned char* buffer, SIZE_T count, const void* target,
+    unsigned char* base, vector_uchar_ptr* hits) {
+    const predicate_target* predicate = (const predicate_target*)target;
+    const SIZE_T stride = predicate->stride;
+    const SIZE_T lanes = predicate->width / stride;
+    unsigned long long masks[8];
+
+    for (SIZE_T first = 0; first < count; first += 64 * lanes) {
+        unsigned long long any = 0;
+        for (SIZE_T q = 0; q < lanes; q++) {
+            masks[q] = 0;
+            if (first + q >= count)
+                continue;
+            SIZE_T elements = (count - first - q + lanes - 1) / lanes;
+            if (elements > 64)
+                elements = 64;
+            masks[q] = predicate->mask(buffer + (first + q) * stride, elements, &predicate->predicate);
+            any |= masks[q];
+        }
+        if (!any)
+            continue;
+
+        if (!reserveVectorUCharPtr(hits, hits->size + (int)(64 * lanes)))
+            return 0;
+        while (any) {
+            SIZE_T k = lowestSetBit(any);
+            for (SIZE_T q = 0; q < lanes; q++) {
+                if ((masks[q] >> k) & 1)
+                    hits->array[hits->size++] = base + (first + k * lanes + q) * stride;
+            }
+            any &= any - 1;
+        }
+    }
+    return 1;
+}
+
+#endif // PREDICATES_H
@@ -0,0 +1,198 @@
+/*
+ * processes.h
+ *
+ * Description:
+ * A cached table of the running processes for resolving executable names to
+ * pids. Every lookup used to walk all processes and read the name of each;
+ * with many instances of the same target per host and lookups in a loop that
+ * walk dominated. The table keeps one entry per pid (sorted by pid) with the
+ * executable file name and start time, and is only listed again once it is
+ * older than maxAge.
+ *
+ * A refresh is incremental: the pids are listed again (readdir of /proc, one
+ * Toolhelp snapshot on Windows) and every pid already in the table with the
+ * same stamp (see nextProcess()) keeps its entry without another system call.
+ * Only new pids have their name read; pids that are gone are dropped.
+ *
+ * A lookup returns every pid running the name, lowest first. Matching entries
+ * have their start time checked, so a process that exited since the listing
+ * is left out and a pid reused by another run gets its name read again.
+ *
+ * Usage:
+ * - static process_table table = PROCESS_TABLE_INIT(PROCESS_TABLE_DEFAULT_AGE);
+ * - int count = findProcesses(&table, "target.exe", pids, capacity);   // may exceed capacity
+ *
+ * Note:
+ * - Names are compared exactly (UTF-8 on Windows). On Linux an executable
+ *   whose link cannot be read (another user's process) is known by its comm
+ *   name, which the kernel cuts to 15 characters.
+ * - Include `watcher.h` before this header (watchClockNanos).
+ */
+
+#ifndef PROCESSES_H
+#define PROCESSES_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "memsource.h"
+#include "threadpool.h"
+
+#define PROCESS_TABLE_DEFAULT_AGE 1000000000ull    // 1 s
+#define PROCESS_NAME_SIZE 1024
+
+typedef struct {
+    int pid;
+    unsigned long long stamp;
+    unsigned long long started;     // 0 until a lookup checked it
+    char* name;                     // "" if it could not be read
+} process_entry;
+
+typedef struct {
+    process_entry* entries;         // sorted by pid
+    SIZE_T count;
+    unsigned long long refreshed;   // watchClockNanos() of the last refresh, 0 before the first
+    unsigned long long maxAge;      // nanoseconds a listing is reused for
+    pool_lock lock;
+} process_table;
+
+#define PROCESS_TABLE_INIT(maxAge) { NULL, 0, 0, (maxAge), POOL_LOCK_INIT }
+
+static int compareProcessEntries(const void* a, const void* b) {
+    int x = ((const process_entry*)a)->pid, y = ((const process_entry*)b)->pid;
+    return (x > y) - (x < y);
+}
+
+static process_entry* findProcessEntry(process_entry* entries, SIZE_T count, int pid) {
+    process_entry key;
+    key.pid = pid;
+    return (process_entry*)bsearch(&key, entries, count, sizeof(process_entry), compareProcessEntries);
+}
+
+static char* copyProcessName(const char* name) {
+    char* copy = (char*)malloc(strlen(name) + 1);
+    if (copy != NULL)
+        strcpy(copy, name);
+    return copy;
+}
+
+static void freeProcessEntries(process_entry* entries, SIZE_T count) {
+    for (SIZE_T i = 0; i < count; i++)
+        free(entries[i].name);
+    free(entries);
+}
+
+/*
+ * Lists the processes again, keeping the entries of the pids that are still
+ * there. The caller holds the lock.
+ * Returns 1, -1 on allocation failure, -2 if the processes cannot be listed.
+ */
+static int refreshProcessTable(process_table* table) {
+    process_walk walk;
+    process_entry* listed = NULL;
+    SIZE_T count = 0, capacity = 0;
+    int pid;
+    unsigned long long stamp;
+    const char* name;
+    char buffer[PROCESS_NAME_SIZE];
+
+    if (!beginProcessWalk(&walk))
+        return -2;
+    while (nextProcess(&walk, &pid, &stamp, &name)) {
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            process_entry* grown = (process_entry*)realloc(listed, capacity * sizeof(process_entry));
+            if (grown == NULL) {
+                endProcessWalk(&walk);
+                freeProcessEntries(listed, count);
+                return -1;
+            }
+            listed = grown;
+        }
+        // An entry moved over keeps its name; its slot in the old table is left without one.
+        process_entry* known = findProcessEntry(table->entries, table->count, pid);
+        if (known != NULL && known->name != NULL && known->stamp == stamp
+            && (name == NULL || strcmp(known->name, name) == 0)) {
+            listed[count++] = *known;
+            known->name = NULL;
+            continue;
+        }
+        if (name == NULL)
+            name = processName(pid, buffer, sizeof(buffer)) ? buffer : "";
+        process_entry* entry = &listed[count];
+        entry->pid = pid;
+        entry->stamp = stamp;
+        entry->started = 0;
+        entry->name = copyProcessName(name);
+        if (entry->name == NULL) {
+            endProcessWalk(&walk);
+            freeProcessEntries(listed, count);
+            return -1;
+        }
+        count++;
+    }
+    endProcessWalk(&walk);
+    qsort(listed, count, sizeof(process_entry), compareProcessEntries);
+    freeProcessEntries(table->entries, table->count);
+    table->entries = listed;
+    table->count = count;
+    return 1;
+}
+
+/*
+ * Stores up to capacity pids running the executable name in pids, lowest first.
+ * Returns the number of matching processes (which may exceed capacity), -1 on
+ * allocation failure, -2 if the processes cannot be listed.
+ */
+static int findProcesses(process_table* table, const char* name, int* pids, int capacity) {
+    char buffer[PROCESS_NAME_SIZE];
+    int found = 0;
+
+    poolLockAcquire(&table->lock);
+    unsigned long long now = watchClockNanos();
+    if (table->refreshed == 0 || now - table->refreshed >= table->maxAge) {
+        int result = refreshProcessTable(table);
+        if (result != 1) {
+            poolLockRelease(&table->lock);
+            return result;
+        }
+        table->refreshed = now;
+    }
+    for (SIZE_T i = 0; i < table->count; i++) {
+        process_entry* entry = &table->entries[i];
+        unsigned long long started;
+        if (strcmp(entry->name, name) != 0 || !processStartTime(entry->pid, &started))
+            continue;
+        if (entry->started != 0 && entry->started != started) {
+            // The pid was reused since it was checked.
+            char* renamed = copyProcessName(processName(entry->pid, buffer, sizeof(buffer)) ? buffer : "");
+            if (renamed == NULL) {
+                poolLockRelease(&table->lock);
+                return -1;
+            }
+            free(entry->name);
+            entry->name = renamed;
+            if (strcmp(entry->name, name) != 0) {
+                entry->started = started;
+                continue;
+            }
+        }
+        entry->started = started;
+        if (found < capacity)
+            pids[found] = entry->pid;
+        found++;
+    }
+    poolLockRelease(&table->lock);
+    return found;
+}
+
+// Sets how long a listing is reused for (0 lists the processes on every lookup).
+// Returns the previous age.
+static unsigned long long setProcessTableMaxAge(process_table* table, unsigned long long maxAge) {
+    poolLockAcquire(&table->lock);
+    unsigned long long previous = table->maxAge;
+    table->maxAge = maxAge;
+    poolLockRelease(&table->lock);
+    return previous;
+}
+
+#endif // PROCESSES_H
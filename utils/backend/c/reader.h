@@ -0,0 +1,226 @@
+/*
+ * reader.h
+ *
+ * Description:
+ * Streaming reads of remote memory regions in fixed-size windows.
+ *
+ * Instead of allocating a buffer as large as the region and reading it with a
+ * single call, a region is read window by window into
+ * buffers taken from a buffer_pool. Peak memory is therefore bounded by
+ * (number of readers) x (window size), independent of the region sizes.
+ *
+ * Consecutive windows overlap by `overlap` bytes (sizeof(T) - 1 for a scan of
+ * T), so a value starting in the last bytes of one window is still complete in
+ * the next one. A scan only reports values that *start* before the end of the
+ * window proper, so nothing is reported twice.
+ *
+ * When the read of a whole window fails (for example a guard page or a page
+ * decommitted in the middle of a region) the window is read again page by page
+ * and every run of readable pages is handed to the visitor on its own, so the
+ * readable part of the region is still scanned.
+ *
+ * readCandidates() is the counterpart for next scans: it walks a list of
+ * candidate addresses (sorted, as produced by the first scan), coalesces
+ * neighbours whose distance is at most `gap` bytes into one ranged read and
+ * hands every candidate a pointer to its value inside that buffer. Up to
+ * READER_BATCH_SPANS ranged reads are packed into the buffer and issued with
+ * one readRemoteBatch() call (a single process_vm_readv on Linux). Only when a
+ * ranged read fails is it read again page by page, with one read for the
+ * candidates of each page.
+ *
+ * Usage:
+ * - static buffer_pool pool = BUFFER_POOL_INIT(SCAN_WINDOW_SIZE + SCAN_MAX_OVERLAP);
+ * - unsigned char* buffer = acquireBuffer(&pool);
+ * - readWindow(hProcess, remote, length, buffer, visitor, context);
+ * - releaseBuffer(&pool, buffer, keep);
+ */
+
+#ifndef READER_H
+#define READER_H
+
+#include <stdlib.h>
+#include "memsource.h"
+#include "threadpool.h"
+
+#define SCAN_WINDOW_SIZE (4 * 1024 * 1024)
+#define SCAN_MAX_OVERLAP 4096
+#define READER_PAGE_SIZE 4096
+#define READER_DEFAULT_GAP 4096
+#define READER_BATCH_SPANS 256
+
+// Buffer pool
+
+typedef struct {
+    pool_lock lock;
+    unsigned char** idle;
+    int count;
+    int capacity;
+    SIZE_T bufferSize;
+} buffer_pool;
+
+#define BUFFER_POOL_INIT(bufferSize) { POOL_LOCK_INIT, NULL, 0, 0, (bufferSize) }
+
+// Returns a buffer of pool->bufferSize bytes, or NULL if none could be allocated.
+static unsigned char* acquireBuffer(buffer_pool* pool) {
+    unsigned char* buffer = NULL;
+    poolLockAcquire(&pool->lock);
+    if (pool->count > 0)
+        buffer = pool->idle[--pool->count];
+    poolLockRelease(&pool->lock);
+    if (buffer == NULL)
+        buffer = (unsigned char*)malloc(pool->bufferSize);
+    return buffer;
+}
+
+// Keeps at most `keep` idle buffers around for the next scan and frees the rest.
+static void releaseBuffer(buffer_pool* pool, unsigned char* buffer, int keep) {
+    if (buffer == NULL)
+        return;
+    poolLockAcquire(&pool->lock);
+    if (pool->count < keep) {
+        if (pool->count == pool->capacity) {
+            int capacity = pool->capacity ? pool->capacity * 2 : 8;
+            unsigned char** grown = (unsigned char**)realloc(pool->idle, capacity * sizeof(unsigned char*));
+            if (grown != NULL) {
+                pool->idle = grown;
+                pool->capacity = capacity;
+            }
+        }
+        if (pool->count < pool->capacity) {
+            pool->idle[pool->count++] = buffer;
+            buffer = NULL;
+        }
+    }
+    poolLockRelease(&pool->lock);
+    free(buffer);
+}
+
+static void trimBufferPool(buffer_pool* pool) {
+    poolLockAcquire(&pool->lock);
+    for (int i = 0; i < pool->count; i++)
+        free(pool->idle[i]);
+    pool->count = 0;
+    poolLockRelease(&pool->lock);
+}
+
+// Window reads
+
+typedef void (*window_visitor)(void* context, const unsigned char* data, SIZE_T length, unsigned char* remote);
+
+/*
+ * Reads [remote, remote + length) into buffer and passes it to visit().
+ * If the single read fails, falls back to page sized reads and visits every
+ * run of readable pages separately.
+ * Returns: 1 whole window read, 0 partially read, -1 nothing readable.
+ */
+static int readWindow(HANDLE hProcess, unsigned char* remote, SIZE_T length, unsigned char* buffer,
+    window_visitor visit, void* context) {
+    if (readRemote(hProcess, remote, buffer, length)) {
+        visit(context, buffer, length, remote);
+        return 1;
+    }
+
+    SIZE_T runStart = 0, position = 0, readable = 0;
+    while (position < length) {
+        SIZE_T pageEnd = (((SIZE_T)(remote + position)) & ~(SIZE_T)(READER_PAGE_SIZE - 1)) + READER_PAGE_SIZE
+            - (SIZE_T)remote;
+        if (pageEnd > length)
+            pageEnd = length;
+        if (readRemote(hProcess, remote + position, buffer + position, pageEnd - position)) {
+            readable += pageEnd - position;
+        }
+        else {
+            if (position > runStart)
+                visit(context, buffer + runStart, position - runStart, remote + runStart);
+            runStart = pageEnd;
+        }
+        position = pageEnd;
+    }
+    if (position > runStart)
+        visit(context, buffer + runStart, position - runStart, remote + runStart);
+    return readable ? 0 : -1;
+}
+
+// Batched candidate reads
+
+// value points at the width bytes read for addresses[index], or is NULL if the
+// candidate could not be read. Candidates are visited in index order.
+typedef void (*candidate_visitor)(void* context, SIZE_T index, const unsigned char* value);
+
+/*
+ * Reads every address in addresses[0 .. count) as a width byte value.
+ * Runs of candidates whose gaps are at most `gap` bytes are fetched as one
+ * span; spans are packed into buffer (bufferSize bytes) and read
+ * READER_BATCH_SPANS at a time. Unsorted input is accepted, it just
+ * coalesces less.
+ */
+static void readCandidates(HANDLE hProcess, unsigned char* const* addresses, SIZE_T count, SIZE_T width, SIZE_T gap,
+    unsigned char* buffer, SIZE_T bufferSize, candidate_visitor visit, void* context) {
+    read_span spans[READER_BATCH_SPANS];
+    SIZE_T spanEnds[READER_BATCH_SPANS];
+    SIZE_T i = 0;
+    while (i < count) {
+        SIZE_T batchStart = i, used = 0;
+        int spanCount = 0;
+        while (i < count && spanCount < READER_BATCH_SPANS && bufferSize - used >= width) {
+            SIZE_T room = bufferSize - used;
+            unsigned char* start = addresses[i];
+            unsigned char* end = start + width;
+            SIZE_T j = i + 1;
+            while (j < count && addresses[j] >= start && (SIZE_T)(addresses[j] - start) + width <= room
+                && (addresses[j] <= end || (SIZE_T)(addresses[j] - end) <= gap)) {
+                if (addresses[j] + width > end)
+                    end = addresses[j] + width;
+                j++;
+            }
+            read_span* span = &spans[spanCount];
+            span->remote = start;
+            span->buffer = buffer + used;
+            span->length = (SIZE_T)(end - start);
+            spanEnds[spanCount++] = j;
+            used += span->length;
+            i = j;
+        }
+
+        readRemoteBatch(hProcess, spans, spanCount);
+
+        SIZE_T k = batchStart;
+        for (int s = 0; s < spanCount; s++) {
+            if (spans[s].ok) {
+                for (; k < spanEnds[s]; k++)
+                    visit(context, k, spans[s].buffer + (addresses[k] - spans[s].remote));
+            }
+            else if (spanEnds[s] - k == 1) {
+                visit(context, k++, NULL);
+            }
+            else {
+                // Part of the span is unreadable: read it again page by page, one
+                // read for all candidates within a page; values crossing a page
+                // border are read on their own.
+                unsigned char value[16];
+                while (k < spanEnds[s]) {
+                    unsigned char* start = addresses[k];
+                    unsigned char* pageEnd = (unsigned char*)(((SIZE_T)start & ~(SIZE_T)(READER_PAGE_SIZE - 1)) + READER_PAGE_SIZE);
+                    if (start + width > pageEnd || start < spans[s].remote) {
+                        int ok = readRemote(hProcess, start, value, width);
+                        visit(context, k++, ok ? value : NULL);
+                        continue;
+                    }
+                    SIZE_T j = k + 1;
+                    unsigned char* end = start + width;
+                    while (j < spanEnds[s] && addresses[j] >= start && addresses[j] + width <= pageEnd) {
+                        if (addresses[j] + width > end)
+                            end = addresses[j] + width;
+                        j++;
+                    }
+                    unsigned char* local = spans[s].buffer + (start - spans[s].remote);
+                    int ok = readRemote(hProcess, start, local, (SIZE_T)(end - start));
+                    for (; k < j; k++)
+                        visit(context, k, ok ? local + (addresses[k] - start) : NULL);
+                }
+            }
+        }
+    }
+}
+
+#endif // READER_H
@@ -0,0 +1,345 @@
+/*
+ * regions.h
+ *
+ * Description:
+ * A cached list of the committed memory regions of a process, with the module
+ * each region belongs to, that can be filtered and then used as the scope of
+ * the scans instead of walking the whole address space every time.
+ *
+ * A map is built with one region walk and keeps the filter it was built with,
+ * so refreshRegionMap() walks the process again, applies the same filter and
+ * merges the result with the previous entries (both sorted by base address):
+ * entries whose base, size, protection and type did not change are kept as
+ * they are, every other entry is marked `changed`, and the number of added,
+ * changed and removed regions is returned.
+ *
+ * A filter selects regions by:
+ * - module name (case insensitive, the file name of the image the region is in),
+ * - address range [lo, hi); regions crossing a bound are clipped to it,
+ * - protection (any of the PAGE_* bits in `protect`),
+ * - type (any of MEM_PRIVATE, MEM_MAPPED, MEM_IMAGE in `type`),
+ * - region size window [minSize, maxSize], tested on the unclipped region.
+ * Zero fields do not filter. filterRegionMap() narrows an existing map
+ * without walking the process again; the filters are combined.
+ *
+ * scanRegionWalk() yields the regions of a map, or of the live process when
+ * the map is NULL, in the form of the region walk of memsource.h.
+ *
+ * A map remembers the process it was built for (isRegionMapOf()) and carries
+ * a reference count for the scan scopes of scanner.c, which free it through
+ * freeRegionMapMemory() once the last reference is gone. A refresh is split in
+ * two so scanner.c can build the new entries without a lock and only swap them
+ * in (exchangeRegionEntries()) while no scan walks the map.
+ *
+ * Usage:
+ * - region_filter filter = { 0 }; filter.maxSize = 512 << 20;
+ * - region_map* map = buildRegionMap(hProcess, &filter);
+ * - region_map fresh; if (collectRegionUpdate(hProcess, map, &fresh) >= 0) exchangeRegionEntries(map, &fresh);
+ * - free(fresh.entries); free(fresh.modules);
+ * - freeRegionMapMemory(map);
+ *
+ * Note:
+ * - On Linux every mapped region is MEM_COMMIT and file mappings are MEM_MAPPED,
+ *   so filter images by module name there.
+ * - Include `memsource.h` before this header.
+ */
+
+#ifndef REGIONS_H
+#define REGIONS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_MODULE_NAME MODULE_NAME_SIZE
+
+typedef struct {
+    char module[REGION_MODULE_NAME];
+    unsigned long long lo;
+    unsigned long long hi;
+    DWORD protect;
+    DWORD type;
+    unsigned long long minSize;
+    unsigned long long maxSize;
+} region_filter;
+
+typedef struct {
+    unsigned char* base;
+    SIZE_T size;
+    SIZE_T regionSize;   // before clipping to the filter range
+    DWORD protect;
+    DWORD type;
+    int module;          // index into modules, -1 if the region is not part of a module
+    int changed;         // added or changed by the last refresh
+} region_entry;
+
+typedef struct {
+    region_entry* entries;
+    SIZE_T count;
+    remote_module* modules;
+    SIZE_T moduleCount;
+    region_filter filter;
+    int pid;                        // the process the map was built for (remoteProcessIdentity)
+    unsigned long long started;
+    int references;                 // 1 for the owner; scanner.c adds the scopes and running scans
+    int scans;                      // running scans walking the map (scanner.c)
+    int refreshing;                 // a refresh is building new entries (scanner.c)
+} region_map;
+
+// Clips entry to the filter range. Returns 0 if the filter rejects it.
+static int applyRegionFilter(const region_filter* filter, const remote_module* modules, region_entry* entry) {
+    if (filter->protect && !(entry->protect & filter->protect))
+        return 0;
+    if (filter->type && !(entry->type & filter->type))
+        return 0;
+    if (filter->minSize && entry->regionSize < filter->minSize)
+        return 0;
+    if (filter->maxSize && entry->regionSize > filter->maxSize)
+        return 0;
+    if (filter->module[0] && (entry->module < 0 || !moduleNameEquals(modules[entry->module].name, filter->module)))
+        return 0;
+    unsigned long long start = (unsigned long long)(SIZE_T)entry->base;
+    unsigned long long end = start + entry->size;
+    if (filter->lo && start < filter->lo)
+        start = filter->lo;
+    if (filter->hi && end > filter->hi)
+        end = filter->hi;
+    if (start >= end)
+        return 0;
+    entry->base = (unsigned char*)(SIZE_T)start;
+    entry->size = (SIZE_T)(end - start);
+    return 1;
+}
+
+// Combines two filters into one that accepts what both accept.
+static void intersectRegionFilters(const region_filter* a, const region_filter* b, region_filter* out) {
+    *out = *a;
+    if (b->module[0]) {
+        if (out->module[0] && !moduleNameEquals(out->module, b->module))
+            out->hi = out->lo = 1;   // different modules: empty range
+        else
+            memcpy(out->module, b->module, REGION_MODULE_NAME);
+    }
+    if (b->lo > out->lo)
+        out->lo = b->lo;
+    if (b->hi && (!out->hi || b->hi < out->hi))
+        out->hi = b->hi;
+    if (b->protect)
+        out->protect = out->protect ? out->protect & b->protect : b->protect;
+    if (b->type)
+        out->type = out->type ? out->type & b->type : b->type;
+    if (b->minSize > out->minSize)
+        out->minSize = b->minSize;
+    if (b->maxSize && (!out->maxSize || b->maxSize < out->maxSize))
+        out->maxSize = b->maxSize;
+    if ((b->protect && !out->protect) || (b->type && !out->type))
+        out->hi = out->lo = 1;       // no protection or type left: empty range
+}
+
+// Walks the process and returns the committed regions accepted by filter, sorted by base.
+// Returns: 1 on success, -1 Memory Allocation Failure.
+static int collectRegionEntries(HANDLE hProcess, const region_filter* filter, const remote_module* modules,
+    SIZE_T moduleCount, region_entry** entriesOut, SIZE_T* entryCount) {
+    region_entry* entries = NULL;
+    SIZE_T count = 0, capacity = 0;
+    region_walk walk;
+    MEMORY_BASIC_INFORMATION mbi;
+    beginRegionWalk(&walk, hProcess);
+    while (nextRegion(&walk, &mbi)) {
+        if (mbi.State != MEM_COMMIT)
+            continue;
+        region_entry entry;
+        entry.base = (unsigned char*)mbi.BaseAddress;
+        entry.size = mbi.RegionSize;
+        entry.regionSize = mbi.RegionSize;
+        entry.protect = mbi.Protect;
+        entry.type = mbi.Type;
+        entry.module = findModule(modules, moduleCount, (unsigned long long)(SIZE_T)entry.base);
+        entry.changed = 1;
+        if (!applyRegionFilter(filter, modules, &entry))
+            continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            region_entry* grown = (region_entry*)realloc(entries, capacity * sizeof(region_entry));
+            if (grown == NULL) {
+                endRegionWalk(&walk);
+                free(entries);
+                return -1;
+            }
+            entries = grown;
+        }
+        entries[count++] = entry;
+    }
+    endRegionWalk(&walk);
+    *entriesOut = entries;
+    *entryCount = count;
+    return 1;
+}
+
+static void freeRegionMapMemory(region_map* map) {
+    if (map == NULL)
+        return;
+    free(map->entries);
+    free(map->modules);
+    free(map);
+}
+
+// Returns NULL on allocation or module list failure, or if the process cannot be queried.
+static region_map* buildRegionMap(HANDLE hProcess, const region_filter* filter) {
+    region_map* map = (region_map*)calloc(1, sizeof(region_map));
+    if (map == NULL)
+        return NULL;
+    map->references = 1;
+    if (!remoteProcessIdentity(hProcess, &map->pid, &map->started)) {
+        freeRegionMapMemory(map);
+        return NULL;
+    }
+    if (filter != NULL) {
+        map->filter = *filter;
+        map->filter.module[REGION_MODULE_NAME - 1] = '\0';
+    }
+    if (collectModules(hProcess, &map->modules, &map->moduleCount) != 1
+        || collectRegionEntries(hProcess, &map->filter, map->modules, map->moduleCount, &map->entries, &map->count) != 1) {
+        freeRegionMapMemory(map);
+        return NULL;
+    }
+    return map;
+}
+
+// Returns a new map with the entries of map that filter accepts, NULL on allocation failure.
+static region_map* narrowRegionMap(const region_map* map, const region_filter* filter) {
+    region_map* out = (region_map*)calloc(1, sizeof(region_map));
+    if (out == NULL)
+        return NULL;
+    out->pid = map->pid;
+    out->started = map->started;
+    out->references = 1;
+    region_filter own = *filter;
+    own.module[REGION_MODULE_NAME - 1] = '\0';
+    intersectRegionFilters(&map->filter, &own, &out->filter);
+    out->modules = (remote_module*)malloc((map->moduleCount ? map->moduleCount : 1) * sizeof(remote_module));
+    out->entries = (region_entry*)malloc((map->count ? map->count : 1) * sizeof(region_entry));
+    if (out->modules == NULL || out->entries == NULL) {
+        freeRegionMapMemory(out);
+        return NULL;
+    }
+    if (map->moduleCount > 0)
+        memcpy(out->modules, map->modules, map->moduleCount * sizeof(remote_module));
+    out->moduleCount = map->moduleCount;
+    for (SIZE_T i = 0; i < map->count; i++) {
+        region_entry entry = map->entries[i];
+        if (applyRegionFilter(&own, out->modules, &entry))
+            out->entries[out->count++] = entry;
+    }
+    return out;
+}
+
+// Returns 1 if map was built for the process of hProcess (and not an earlier run with the same pid).
+static int isRegionMapOf(const region_map* map, HANDLE hProcess) {
+    int pid;
+    unsigned long long started;
+    return remoteProcessIdentity(hProcess, &pid, &started) && pid == map->pid && started == map->started;
+}
+
+static int sameRegion(const region_entry* a, const region_entry* b) {
+    return a->base == b->base && a->size == b->size && a->protect == b->protect && a->type == b->type;
+}
+
+/*
+ * Walks the process again with the map's filter into the entries and modules
+ * of fresh, marking the entries that are new or differ from those of map,
+ * which is only read.
+ * Returns: the number of regions added, changed or removed, -1 Memory
+ * Allocation Failure, -2 Module List Failure. fresh holds no arrays on failure.
+ */
+static long long collectRegionUpdate(HANDLE hProcess, const region_map* map, region_map* fresh) {
+    remote_module* modules;
+    SIZE_T moduleCount;
+    fresh->entries = NULL;
+    fresh->count = 0;
+    fresh->modules = NULL;
+    fresh->moduleCount = 0;
+    int result = collectModules(hProcess, &modules, &moduleCount);
+    if (result != 1)
+        return result;
+    region_entry* entries;
+    SIZE_T count;
+    if (collectRegionEntries(hProcess, &map->filter, modules, moduleCount, &entries, &count) != 1) {
+        free(modules);
+        return -1;
+    }
+
+    long long differences = 0;
+    SIZE_T i = 0, j = 0;
+    while (i < map->count || j < count) {
+        if (j == count || (i < map->count && map->entries[i].base < entries[j].base)) {
+            differences++;   // removed
+            i++;
+            continue;
+        }
+        if (i < map->count && map->entries[i].base == entries[j].base) {
+            entries[j].changed = !sameRegion(&map->entries[i], &entries[j]);
+            i++;
+        }
+        differences += entries[j].changed;
+        j++;
+    }
+
+    fresh->entries = entries;
+    fresh->count = count;
+    fresh->modules = modules;
+    fresh->moduleCount = moduleCount;
+    return differences;
+}
+
+// Swaps the entries and modules of a and b.
+static void exchangeRegionEntries(region_map* a, region_map* b) {
+    region_entry* entries = a->entries;
+    SIZE_T count = a->count;
+    remote_module* modules = a->modules;
+    SIZE_T moduleCount = a->moduleCount;
+    a->entries = b->entries;
+    a->count = b->count;
+    a->modules = b->modules;
+    a->moduleCount = b->moduleCount;
+    b->entries = entries;
+    b->count = count;
+    b->modules = modules;
+    b->moduleCount = moduleCount;
+}
+
+// Scope walk
+
+typedef struct {
+    const region_map* map;
+    SIZE_T next;
+    region_walk walk;
+} scan_region_walk;
+
+static void beginScanRegionWalk(scan_region_walk* scope, HANDLE hProcess, const region_map* map) {
+    scope->map = map;
+    scope->next = 0;
+    if (map == NULL)
+        beginRegionWalk(&scope->walk, hProcess);
+}
+
+static int nextScanRegion(scan_region_walk* scope, MEMORY_BASIC_INFORMATION* mbi) {
+    if (scope->map == NULL)
+        return nextRegion(&scope->walk, mbi);
+    if (scope->next == scope->map->count)
+        return 0;
+    const region_entry* entry = &scope->map->entries[scope->next++];
+    memset(mbi, 0, sizeof(*mbi));
+    mbi->BaseAddress = entry->base;
+    mbi->RegionSize = entry->size;
+    mbi->State = MEM_COMMIT;
+    mbi->Protect = entry->protect;
+    mbi->Type = entry->type;
+    return 1;
+}
+
+static void endScanRegionWalk(scan_region_walk* scope) {
+    if (scope->map == NULL)
+        endRegionWalk(&scope->walk);
+}
+
+#endif // REGIONS_H
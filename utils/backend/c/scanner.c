@@ -1,341 +1,2807 @@
-#include <windows.h>
-#include <tlhelp32.h>
+#include "memsource.h"
 #include <stdio.h>
 #include <stdlib.h> 
 #include <string.h>
 #include "vectors.h"
+#include "kernels.h"
+#include "predicates.h"
+#include "valuetypes.h"
+#include "valuestore.h"
+#include "threadpool.h"
+#include "reader.h"
+#include "regions.h"
+#include "snapshot.h"
+#include "candidates.h"
+#include "patterns.h"
+#include "groupscan.h"
+#include "pointers.h"
+#include "watcher.h"
+#include "stats.h"
+#include "scantask.h"
+#include "session.h"
+#include "processes.h"
+#ifdef _WIN32
 #define MEMSCAN_API __declspec(dllexport)
+#else
+#define MEMSCAN_API __attribute__((visibility("default")))
+#endif
 
 
 
-MEMSCAN_API int get_pid_by_name(const char* process_name) {
-	PROCESSENTRY32 pe;
-	HANDLE snapshot;
-	DWORD pid = 0;
-
-	wchar_t w_process_name[MAX_PATH];
-	size_t convertedChars = 0;
-	errno_t err = mbstowcs_s(&convertedChars, w_process_name, MAX_PATH, process_name, _TRUNCATE);
-
-	if (err != 0) {
-		return -1; // Indicate error converting string
-	}
+// Processes
+// Names are resolved through one cached process table (processes.h), listed
+// again at most every processTable.maxAge; the same table answers
+// get_pid_by_name and findProcessIdsByName.
 
-	// Take a snapshot of all processes
-	snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-	if (snapshot == INVALID_HANDLE_VALUE) {
-		printf("Failed to obtain PID by name !\n");
-		return 0; // Failed to take snapshot
-	}
+static process_table processTable = PROCESS_TABLE_INIT(PROCESS_TABLE_DEFAULT_AGE);
 
-	pe.dwSize = sizeof(PROCESSENTRY32);
+MEMSCAN_API int get_pid_by_name(const char* process_name) {
+	/*
+	Returns: the lowest pid running the executable process_name, 0 if there is none
+	*/
+	int pid = 0;
+	return findProcesses(&processTable, process_name, &pid, 1) > 0 ? pid : 0;
+}
 
-	// Retrieve information about the first process
-	if (Process32First(snapshot, &pe)) {
-		do {
-			// Check if the process name matches
-			if (wcscmp(pe.szExeFile, w_process_name) == 0) {
-				pid = pe.th32ProcessID;
-				break;
-			}
-		} while (Process32Next(snapshot, &pe));
-	}
-	else {
-		pid = 0; // Failed to retrieve process information
-		printf("Failed to retrieve process information, check the process name entered\n");
-	}
+MEMSCAN_API int findProcessIdsByName(const char* process_name, int* pids, int capacity)
+{
+	/*
+	Stores up to capacity pids running the executable process_name, lowest first.
+	Returns: the number of matching processes, which may exceed capacity
+	Returns: -1 Memory Allocation Failure
+	Returns: -2 Listing The Processes Failed
+	Returns: -3 Invalid Arguments
+	*/
+	if (process_name == NULL || capacity < 0 || (pids == NULL && capacity > 0))
+		return -3;
+	return findProcesses(&processTable, process_name, pids, capacity);
+}
 
-	CloseHandle(snapshot);
-	return pid;
+MEMSCAN_API unsigned int getProcessTableAge()
+{
+	return (unsigned int)(processTable.maxAge / 1000000ull);
 }
 
+MEMSCAN_API unsigned int setProcessTableAge(unsigned int milliseconds)
+{
+	/*
+	How long in milliseconds a listing of the processes is reused by the name
+	lookups (default 1000). 0 lists the processes again on every lookup.
+	Returns the previous age.
+	*/
+	return (unsigned int)(setProcessTableMaxAge(&processTable, milliseconds * 1000000ull) / 1000000ull);
+}
 
 // INTEGER
 MEMSCAN_API int RPM_INT(HANDLE hProcess, unsigned char* address, int* data)
 {
-	SIZE_T bytesRead;
-	if (ReadProcessMemory(hProcess, address, data, sizeof(int), &bytesRead))
-		return 1;
-	else
-		return 0;
+	return readRemote(hProcess, address, data, sizeof(int));
 }
 
 MEMSCAN_API int WPM_INT(HANDLE hProcess, unsigned char* address, int data)
 {
-	SIZE_T bytesWritten;
-	if (WriteProcessMemory(hProcess, address, &data, sizeof(int), &bytesWritten))
-		return 1;
-	else
-		return 0;
+	return writeRemote(hProcess, address, &data, sizeof(int));
 }
 // FLOAT
 MEMSCAN_API int RPM_FLOAT(HANDLE hProcess, unsigned char* address, float* data)
 {
-	SIZE_T bytesRead;
-	if (ReadProcessMemory(hProcess, address, data, sizeof(float), &bytesRead))
-		return 1;
-	else
-		return 0;
-
+	return readRemote(hProcess, address, data, sizeof(float));
 }
 
 MEMSCAN_API int WPM_FLOAT(HANDLE hProcess, unsigned char* address, float data)
 {
-	SIZE_T bytesWritten;
-	if (WriteProcessMemory(hProcess, address, &data, sizeof(float), &bytesWritten))
-		return 1;
-	else
-		return 0;
+	return writeRemote(hProcess, address, &data, sizeof(float));
 }
 
 // Double
 MEMSCAN_API int RPM_DOUBLE(HANDLE hProcess, unsigned char* address, double* data)
 {
-	SIZE_T bytesRead;
-	if (ReadProcessMemory(hProcess, address, data, sizeof(double), &bytesRead))
-		return 1;
-	else
-		return 0;
+	return readRemote(hProcess, address, data, sizeof(double));
 }
 
 MEMSCAN_API int WPM_DOUBLE(HANDLE hProcess, unsigned char* address, double data)
 {
-	SIZE_T bytesWritten;
-	if (WriteProcessMemory(hProcess, address, &data, sizeof(double), &bytesWritten))
-		return 1;
-	else
-		return 0;
+	return writeRemote(hProcess, address, &data, sizeof(double));
 }
 
-// INT
-MEMSCAN_API int scanINT(HANDLE hProcess, int target, vector_uchar_ptr* addresses)
+// First scan
+// Every scannable region is split into SCAN_WINDOW_SIZE chunks. Each chunk is
+// read through reader.h (pooled buffer, page by page fallback) together with
+// the first sizeof(T) - 1 bytes of the next chunk, so values crossing a chunk
+// border are found exactly once. With more than one thread the chunks run on
+// the work stealing pool: every worker appends to its own hit list and each
+// chunk records where its hits landed, so walking the chunks in order
+// afterwards gives the same address order as the serial scan.
+// Values are tested every `stride` bytes (the alignment of the scan). Kernels
+// other than kernelPredicateStrided only step by sizeof(T); for a stride larger
+// than that the hits that are not aligned to the stride are dropped again.
+// When the result is a candidate_set every chunk encodes its hits into its own
+// segment as soon as it is done, so the raw pointers of at most one chunk per
+// worker exist at any time.
+// A scan limited to the first match skips every chunk past the lowest chunk
+// known to hold a hit and keeps only the first hit of that chunk.
+// A scan running as a task (scantask.h) reports every finished chunk to its
+// progress and skips the remaining chunks once it is cancelled.
+// With telemetry on (stats.h) every chunk adds its reads, read and compare
+// time and hit list growth to the scan_stats of the scan.
+
+typedef struct {
+	unsigned char* base;
+	SIZE_T span;
+	SIZE_T region;
+	int worker;
+	int first;
+	int count;
+	int failed;
+} scan_chunk;
+
+typedef struct {
+	HANDLE hProcess;
+	scan_kernel kernel;
+	const void* target;
+	SIZE_T width;
+	SIZE_T stride;
+	scan_chunk* chunks;
+	candidate_segment* segments;
+	candidate_set* set;
+	vector_uchar_ptr** hits;
+	int firstOnly;
+	scan_progress* progress;
+	scan_stats* stats;
+	pool_lock firstLock;
+	volatile SIZE_T firstHitChunk;
+	volatile int allocationFailed;
+	SIZE_T chunkCount;
+	vector_uchar_ptr* addresses;
+	vector_uchar_ptr* local;
+	int threads;
+	int direct;
+	int addressCount;
+} first_scan;
+
+typedef struct {
+	first_scan* scan;
+	vector_uchar_ptr* hits;
+	unsigned long long compareNanos;
+} chunk_visit;
+
+static buffer_pool scanBuffers = BUFFER_POOL_INIT(SCAN_WINDOW_SIZE + SCAN_MAX_OVERLAP);
+
+// Region classes selectable by the pattern scans, combined with |.
+#define SCAN_REGION_WRITABLE 1
+#define SCAN_REGION_EXECUTABLE 2
+#define SCAN_REGION_READONLY 4
+
+#define SCAN_PROTECT_WRITABLE (PAGE_READWRITE | PAGE_EXECUTE_READWRITE | PAGE_WRITECOPY)
+
+// Returns the page protections matching the SCAN_REGION_* flags in regions.
+static DWORD regionProtection(int regions)
 {
-	unsigned char* START_ADDRESS = 0x0;
-	
-	/*
-	Returns: -1 Memory Allocation Failure
-	Returns: -2 Memory Reading Failure
-	*/
-	MEMORY_BASIC_INFORMATION mbi;
-	while (VirtualQueryEx(hProcess, START_ADDRESS, &mbi, sizeof(mbi)))
-	{
-		if ((mbi.State == MEM_COMMIT) && (mbi.Protect & (PAGE_READWRITE | PAGE_EXECUTE_READWRITE | PAGE_WRITECOPY)))
-		{
+	DWORD protect = 0;
+	if (regions & SCAN_REGION_WRITABLE)
+		protect |= SCAN_PROTECT_WRITABLE | PAGE_EXECUTE_WRITECOPY;
+	if (regions & SCAN_REGION_EXECUTABLE)
+		protect |= PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+	if (regions & SCAN_REGION_READONLY)
+		protect |= PAGE_READONLY;
+	return protect;
+}
 
-			unsigned char* buffer = (unsigned char*)malloc(mbi.RegionSize);
-			if (buffer == NULL) {
-				return -1;
-			}
-			SIZE_T bytesRead;
+static int isRegionWithProtection(const MEMORY_BASIC_INFORMATION* mbi, DWORD protect)
+{
+	return (mbi->State == MEM_COMMIT) && !(mbi->Protect & PAGE_GUARD) && (mbi->Protect & protect);
+}
+
+static int isScannableRegion(const MEMORY_BASIC_INFORMATION* mbi)
+{
+	return (mbi->State == MEM_COMMIT) && (mbi->Protect & SCAN_PROTECT_WRITABLE);
+}
 
-			if (ReadProcessMemory(hProcess, mbi.BaseAddress, buffer, mbi.RegionSize, &bytesRead)) {
+// Scan scopes
+// setScanRegionMap limits the first scans and snapshots of one handle to a
+// region map of the same process. Every scope and every running scan holds a
+// reference to its map (scopeLock guards the table and the counts), so
+// freeRegionMap only frees the memory once the last of them is done. Running
+// scans are also counted on their own, refreshRegionMap is refused while any
+// walks the map.
 
-				for (SIZE_T i = 0; i < bytesRead / sizeof(int); i++) {
-					if (sizeof(int) + i * sizeof(int) > bytesRead)
-						break;
-					int data = *(int*)(buffer + i * sizeof(int));
-					if (data == target) {
-						appendVectorUCharPtr(addresses, (unsigned char*)((unsigned char*)mbi.BaseAddress + i * sizeof(int)));
-					}
-				}
-				
-			}
-			free(buffer);
+typedef struct {
+	HANDLE hProcess;
+	region_map* map;
+} scan_scope;
+
+static pool_lock scopeLock = POOL_LOCK_INIT;
+static scan_scope* scanScopes = NULL;
+static SIZE_T scanScopeCount = 0;
+static SIZE_T scanScopeCapacity = 0;
+
+// Drops one reference to map; the caller holds scopeLock.
+static void dropRegionMap(region_map* map)
+{
+	if (map != NULL && --map->references == 0)
+		freeRegionMapMemory(map);
+}
 
+// Removes the scopes of hProcess, or every scope using map if hProcess is NULL; the caller holds scopeLock.
+static void removeScanScopes(HANDLE hProcess, const region_map* map)
+{
+	SIZE_T kept = 0;
+	for (SIZE_T i = 0; i < scanScopeCount; i++) {
+		if (hProcess != NULL ? scanScopes[i].hProcess == hProcess : scanScopes[i].map == map)
+			dropRegionMap(scanScopes[i].map);
+		else
+			scanScopes[kept++] = scanScopes[i];
+	}
+	scanScopeCount = kept;
+}
+
+// Returns the map the scans of hProcess are limited to, with a reference for
+// the caller (releaseScanScope), or NULL for the whole process.
+static region_map* acquireScanScope(HANDLE hProcess)
+{
+	region_map* map = NULL;
+	poolLockAcquire(&scopeLock);
+	for (SIZE_T i = 0; i < scanScopeCount; i++) {
+		if (scanScopes[i].hProcess == hProcess) {
+			map = scanScopes[i].map;
+			map->references++;
+			map->scans++;
+			break;
 		}
-		// Move to the next region
-		START_ADDRESS += mbi.RegionSize;
 	}
-	shrinkToFitVectorUCharPtr(addresses);
-	return 1;
+	poolLockRelease(&scopeLock);
+	return map;
 }
 
-MEMSCAN_API int scanNextINT(HANDLE hProcess, vector_uchar_ptr* addressArray, int target)
+static void releaseScanScope(region_map* map)
 {
-	for (int i = 0; i < addressArray->size; i++)
+	if (map == NULL)
+		return;
+	poolLockAcquire(&scopeLock);
+	map->scans--;
+	dropRegionMap(map);
+	poolLockRelease(&scopeLock);
+}
+
+static int collectScanChunks(HANDLE hProcess, const region_map* scope, DWORD protect, SIZE_T overlap, scan_chunk** chunksOut,
+	SIZE_T* chunkCount, scan_stats* stats)
+{
+	scan_region_walk walk;
+	MEMORY_BASIC_INFORMATION mbi;
+	scan_chunk* chunks = NULL;
+	SIZE_T count = 0, capacity = 0, regions = 0;
+
+	beginScanRegionWalk(&walk, hProcess, scope);
+	while (nextScanRegion(&walk, &mbi))
 	{
-		SIZE_T bytesRead;
-		int buffer;
-		if (ReadProcessMemory(hProcess, addressArray->array[i], &buffer, sizeof(int), &bytesRead))
+		if (stats != NULL)
+			stats->regionsVisited++;
+		if (!(protect == SCAN_PROTECT_WRITABLE ? isScannableRegion(&mbi) : isRegionWithProtection(&mbi, protect)))
 		{
-			if (buffer != target)
-			{
-				deleteElementVectorUCharPtr(addressArray, i);
-				i--;
-			}
+			if (stats != NULL)
+				stats->regionsSkipped++;
 		}
 		else
 		{
-				deleteElementVectorUCharPtr(addressArray, i);
-				i--;
+			for (SIZE_T offset = 0; offset < mbi.RegionSize; offset += SCAN_WINDOW_SIZE)
+			{
+				if (count == capacity) {
+					capacity = capacity ? capacity * 2 : 256;
+					scan_chunk* grown = (scan_chunk*)realloc(chunks, capacity * sizeof(scan_chunk));
+					if (grown == NULL) {
+						endScanRegionWalk(&walk);
+						free(chunks);
+						return -1;
+					}
+					chunks = grown;
+				}
+				SIZE_T span = SCAN_WINDOW_SIZE + overlap;
+				scan_chunk* chunk = &chunks[count++];
+				chunk->base = (unsigned char*)mbi.BaseAddress + offset;
+				chunk->span = mbi.RegionSize - offset < span ? mbi.RegionSize - offset : span;
+				chunk->region = regions;
+				chunk->worker = 0;
+				chunk->first = 0;
+				chunk->count = 0;
+				chunk->failed = 0;
+			}
+			regions++;
 		}
 	}
+	endScanRegionWalk(&walk);
+	*chunksOut = chunks;
+	*chunkCount = count;
 	return 1;
 }
 
-// FLOAT
+static void scanWindowVisitor(void* context, const unsigned char* data, SIZE_T length, unsigned char* remote)
+{
+	// With an overlap of width - 1 every complete value in the window starts
+	// inside the chunk proper, so the whole window can be handed to the kernel.
+	chunk_visit* visit = (chunk_visit*)context;
+	unsigned long long start = visit->scan->stats != NULL ? watchClockNanos() : 0;
+	SIZE_T width = visit->scan->width;
+	SIZE_T stride = visit->scan->stride;
+	SIZE_T step = stride < width ? stride : width;
+	SIZE_T skip = (SIZE_T)(0 - (SIZE_T)remote) & (step - 1);
+	if (length < skip + width)
+		return;
+	int first = visit->hits->size;
+	int capacity = visit->hits->capacity;
+	if (!visit->scan->kernel(data + skip, (length - skip - width) / step + 1, visit->scan->target, remote + skip, visit->hits))
+		visit->scan->allocationFailed = 1;
+	if (stride > width) {
+		int kept = first;
+		for (int i = first; i < visit->hits->size; i++) {
+			if (((SIZE_T)visit->hits->array[i] & (stride - 1)) == 0)
+				visit->hits->array[kept++] = visit->hits->array[i];
+		}
+		visit->hits->size = kept;
+	}
+	if (visit->scan->stats != NULL) {
+		visit->compareNanos += watchClockNanos() - start;
+		scanCounterAdd(&visit->scan->stats->reallocs, growthSteps(capacity, visit->hits->capacity));
+	}
+}
 
-MEMSCAN_API int scanFLOAT(HANDLE hProcess, float target, vector_uchar_ptr* addresses)
+static void scanChunkTask(void* context, int worker, SIZE_T index)
 {
-	/*
-		Returns: -1 Memory Allocation Failure
-		Returns: -2 Memory Reading Failure
+	first_scan* scan = (first_scan*)context;
+	scan_chunk* chunk = &scan->chunks[index];
+	chunk_visit visit = { scan, scan->hits[worker], 0 };
 
-	 */
-	unsigned char* START_ADDRESS = 0x0;
-	MEMORY_BASIC_INFORMATION mbi;
+	chunk->worker = worker;
+	chunk->first = visit.hits->size;
+	chunk->count = 0;
+	if ((scan->firstOnly && index > scan->firstHitChunk) || scanCancelled(scan->progress))
+		return;
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL) {
+		scan->allocationFailed = 1;
+	}
+	else if (scan->stats != NULL) {
+		read_counters before = readCounters();
+		unsigned long long start = watchClockNanos();
+		chunk->failed = readWindow(scan->hProcess, chunk->base, chunk->span, buffer, scanWindowVisitor, &visit) != 1;
+		unsigned long long elapsed = watchClockNanos() - start;
+		releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+		addReadStats(scan->stats, &before);
+		scanCounterAdd(&scan->stats->nsRead, elapsed - visit.compareNanos);
+		scanCounterAdd(&scan->stats->nsCompare, visit.compareNanos);
+	}
+	else {
+		readWindow(scan->hProcess, chunk->base, chunk->span, buffer, scanWindowVisitor, &visit);
+		releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	}
+	chunk->count = visit.hits->size - chunk->first;
+	if (scan->progress != NULL)
+		scanProgressChunk(scan->progress, chunk->span < SCAN_WINDOW_SIZE ? chunk->span : SCAN_WINDOW_SIZE,
+			visit.hits->array + chunk->first, chunk->count);
 
-	while (VirtualQueryEx(hProcess, START_ADDRESS, &mbi, sizeof(mbi)))
-	{
-		if ((mbi.State == MEM_COMMIT) && (mbi.Protect & (PAGE_READWRITE | PAGE_EXECUTE_READWRITE | PAGE_WRITECOPY)))
-		{
+	if (scan->firstOnly && chunk->count > 0) {
+		poolLockAcquire(&scan->firstLock);
+		if (index < scan->firstHitChunk)
+			scan->firstHitChunk = index;
+		poolLockRelease(&scan->firstLock);
+	}
 
-			unsigned char* buffer = (unsigned char*)malloc(mbi.RegionSize);
-			if (buffer == NULL) {
-				return -1;
-			}
-			SIZE_T bytesRead;
+	if (scan->set != NULL) {
+		SIZE_T positions = (chunk->span + scan->set->unit - 1) / scan->set->unit;
+		if (encodeCandidateSegment(&scan->segments[index], chunk->base, positions, scan->set->unit,
+			visit.hits->array + chunk->first, chunk->count) < 0)
+			scan->allocationFailed = 1;
+		visit.hits->size = chunk->first;
+	}
+}
+
+// Returns the stride for an alignment of 1, 2, 4 or 8 bytes (0 selects sizeof(T)), or 0 if it is invalid.
+static SIZE_T scanStride(int alignment, SIZE_T width)
+{
+	if (alignment == 0)
+		return width;
+	if (alignment == 1 || alignment == 2 || alignment == 4 || alignment == 8)
+		return (SIZE_T)alignment;
+	return 0;
+}
 
-			if (ReadProcessMemory(hProcess, mbi.BaseAddress, buffer, mbi.RegionSize, &bytesRead)) {
+// A first scan runs in three steps: beginFirstScan() lists the chunks,
+// allocateFirstScan() sets up the hit lists for a number of workers and
+// endFirstScan() joins the results once the chunks have run (scanChunkTask).
+// scanRegionsEx() runs them for one process; scanTypedMulti() runs the chunks
+// of several processes on the pool at once.
 
-				for (SIZE_T i = 0; i < bytesRead / sizeof(float); i++) {
-					if (sizeof(float) + i * sizeof(float) > bytesRead)
-						break;
-					float data = *(float*)(buffer + i * sizeof(float));
-					if (data == target) {
-						appendVectorUCharPtr(addresses, (unsigned char*)((unsigned char*)mbi.BaseAddress + i * sizeof(float)));
-					}
-				}
-			}
-			free(buffer);
+// Lists the chunks of a scan of the regions of scope (NULL: all regions) with
+// one of the `protect` page protections. stats, if not NULL, gets the region
+// counts and listing time added.
+static int beginFirstScan(first_scan* scan, HANDLE hProcess, const region_map* scope, scan_kernel kernel, const void* target,
+	SIZE_T width, SIZE_T stride, DWORD protect, int firstOnly, scan_progress* progress, vector_uchar_ptr* addresses,
+	candidate_set* set, scan_stats* stats)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	if (collectScanChunks(hProcess, scope, protect, width - 1, &scan->chunks, &scan->chunkCount, stats) < 0)
+		return -1;
+	if (stats != NULL)
+		stats->nsRegions += watchClockNanos() - start;
+	if (progress != NULL) {
+		unsigned long long bytes = 0;
+		for (SIZE_T i = 0; i < scan->chunkCount; i++)
+			bytes += scan->chunks[i].span < SCAN_WINDOW_SIZE ? scan->chunks[i].span : SCAN_WINDOW_SIZE;
+		scanProgressBegin(progress, scan->chunkCount, bytes);
+	}
+
+	scan->hProcess = hProcess;
+	scan->kernel = kernel;
+	scan->target = target;
+	scan->width = width;
+	scan->stride = stride;
+	scan->set = set;
+	scan->segments = NULL;
+	scan->hits = NULL;
+	scan->firstOnly = firstOnly && set == NULL;
+	scan->progress = progress;
+	scan->stats = stats;
+	scan->firstHitChunk = scan->chunkCount;
+	scan->allocationFailed = 0;
+	scan->addresses = addresses;
+	scan->local = NULL;
+	scan->threads = 0;
+	scan->direct = 0;
+	scan->addressCount = addresses != NULL ? addresses->size : 0;
+	return 1;
+}
+
+// Sets up the hit lists of a scan run by `threads` workers. Frees the chunks on failure.
+static int allocateFirstScan(first_scan* scan, int threads)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	scan->threads = threads;
+	scan->hits = (vector_uchar_ptr**)calloc(threads, sizeof(vector_uchar_ptr*));
+	scan->local = (vector_uchar_ptr*)calloc(threads, sizeof(vector_uchar_ptr));
+	if (scan->set != NULL) {
+		clearCandidateSet(scan->set, scan->stride);
+		scan->segments = (candidate_segment*)calloc(scan->chunkCount ? scan->chunkCount : 1, sizeof(candidate_segment));
+	}
+	if (scan->hits == NULL || scan->local == NULL || (scan->set != NULL && scan->segments == NULL)) {
+		free(scan->hits);
+		free(scan->local);
+		free(scan->segments);
+		free(scan->chunks);
+		return -1;
+	}
 
+	// A single worker writes straight into the caller's vector.
+	scan->direct = threads == 1 && scan->set == NULL;
+	if (scan->direct) {
+		scan->hits[0] = scan->addresses;
+	}
+	else {
+		for (int i = 0; i < threads; i++) {
+			createVectorUCharPtr(&scan->local[i]);
+			scan->hits[i] = &scan->local[i];
 		}
-		// Move to the next region
-		START_ADDRESS += mbi.RegionSize;
 	}
-	shrinkToFitVectorUCharPtr(addresses);
+	poolLockInit(&scan->firstLock);
 	return 1;
 }
 
-MEMSCAN_API int scanNextFLOAT(HANDLE hProcess, vector_uchar_ptr* addressArray, float target)
+// Joins the results of the chunks after they ran with the result `result` and frees the scan.
+static int endFirstScan(first_scan* scan, int result)
 {
-	for (int i = 0; i < addressArray->size; i++)
-	{
-		SIZE_T bytesRead;
-		float buffer;
-		if (ReadProcessMemory(hProcess, addressArray->array[i], &buffer, sizeof(float), &bytesRead))
-		{
-			if (buffer != target)
-			{
-				deleteElementVectorUCharPtr(addressArray, i);
-				i--;
-			}
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -5 Cancelled, nothing is added to addresses and set is left empty
+	*/
+	scan_chunk* chunks = scan->chunks;
+	SIZE_T chunkCount = scan->chunkCount;
+	vector_uchar_ptr* addresses = scan->addresses;
+	candidate_set* set = scan->set;
+	scan_stats* stats = scan->stats;
+
+	poolLockDestroy(&scan->firstLock);
+	unsigned long long merge = stats != NULL ? watchClockNanos() : 0;
+	if (scan->allocationFailed)
+		result = -1;
+	if (result == 1 && scanCancelled(scan->progress)) {
+		result = -5;
+		if (scan->direct)
+			addresses->size = scan->addressCount;
+	}
+
+	if (scan->firstOnly) {
+		for (SIZE_T i = 0; i < chunkCount; i++)
+			chunks[i].count = i == scan->firstHitChunk ? 1 : 0;
+		if (scan->direct)
+			addresses->size = scan->firstHitChunk < chunkCount ? chunks[scan->firstHitChunk].first + 1 : scan->addressCount;
+	}
+
+	if (set != NULL) {
+		for (SIZE_T i = 0; i < chunkCount; i++) {
+			if (result == 1 && adoptCandidateSegment(set, &scan->segments[i]) < 0)
+				result = -1;
+			freeCandidateSegment(&scan->segments[i]);
 		}
-		else
-		{
-			{
-				deleteElementVectorUCharPtr(addressArray, i);
-				i--;
+		if (result != 1)
+			clearCandidateSet(set, scan->stride);
+	}
+	else if (result == 1 && !scan->direct) {
+		SIZE_T total = 0;
+		for (SIZE_T i = 0; i < chunkCount; i++)
+			total += chunks[i].count;
+		if (total > (SIZE_T)(INT_MAX - addresses->size) || !reserveVectorUCharPtr(addresses, addresses->size + (int)total))
+			result = -1;
+		else {
+			for (SIZE_T i = 0; i < chunkCount; i++) {
+				if (chunks[i].count == 0)
+					continue;
+				memcpy(addresses->array + addresses->size, scan->local[chunks[i].worker].array + chunks[i].first,
+					chunks[i].count * sizeof(unsigned char*));
+				addresses->size += chunks[i].count;
 			}
 		}
 	}
-	return 1;
-}
+	if (result == 1 && set == NULL)
+		shrinkToFitVectorUCharPtr(addresses);
 
-// DOUBLE
+	if (stats != NULL) {
+		stats->nsMerge += watchClockNanos() - merge;
+		for (SIZE_T i = 0; i < chunkCount; i++) {
+			stats->hits += chunks[i].count;
+			if (chunks[i].failed && (i == 0 || !chunks[i - 1].failed || chunks[i - 1].region != chunks[i].region))
+				stats->regionsFailed++;
+		}
+	}
 
+	if (!scan->direct) {
+		for (int i = 0; i < scan->threads; i++)
+			deleteVectorUCharPtr(&scan->local[i]);
+	}
+	free(scan->local);
+	free(scan->segments);
+	free(scan->hits);
+	free(chunks);
+	return result;
+}
 
-MEMSCAN_API int scanDOUBLE(HANDLE hProcess, double target, vector_uchar_ptr* addresses)
-{	
+// Scans the committed regions of scope (the whole process if NULL) with one of the `protect` page protections.
+// Hits go to addresses, or, if set is not NULL, replace the content of set.
+// With firstOnly only the lowest hit is kept (vector results only).
+// progress, if not NULL, is the progress of the task running the scan.
+static int scanRegionsEx(HANDLE hProcess, const region_map* scope, scan_kernel kernel, const void* target, SIZE_T width,
+	SIZE_T stride, DWORD protect, int firstOnly, scan_progress* progress, vector_uchar_ptr* addresses, candidate_set* set)
+{
 	/*
-		Returns: -1 Memory Allocation Failure
-		Returns: -2 Memory Reading Failure
+	Returns: -1 Memory Allocation Failure
+	Returns: -5 Cancelled, nothing is added to addresses and set is left empty
+	*/
+	first_scan scan;
+	scan_stats statsStorage;
+	scan_stats* stats = beginScanStats(&statsStorage);
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	if (beginFirstScan(&scan, hProcess, scope, kernel, target, width, stride, protect, firstOnly, progress,
+		addresses, set, stats) < 0)
+		return -1;
 
-	 */
-	unsigned char* START_ADDRESS = 0x0;
-	MEMORY_BASIC_INFORMATION mbi;
+	int threads = getPoolThreadCount();
+	if ((SIZE_T)threads > scan.chunkCount)
+		threads = scan.chunkCount ? (int)scan.chunkCount : 1;
+	if (allocateFirstScan(&scan, threads) < 0)
+		return -1;
 
-	while (VirtualQueryEx(hProcess, START_ADDRESS, &mbi, sizeof(mbi)))
-	{
-		if ((mbi.State == MEM_COMMIT) && (mbi.Protect & (PAGE_READWRITE | PAGE_EXECUTE_READWRITE | PAGE_WRITECOPY)))
-		{
-			unsigned char* buffer = (unsigned char*)malloc(mbi.RegionSize);
-			if (buffer == NULL) {
-				return -1;
-			}
-			SIZE_T bytesRead;
-			if (ReadProcessMemory(hProcess, mbi.BaseAddress, buffer, mbi.RegionSize, &bytesRead)) {
-				for (SIZE_T i = 0; i < bytesRead / sizeof(double); i++) {
-					if (sizeof(double) + i * sizeof(double) > bytesRead)
-						break;
-					double data = *(double*)(buffer + i * sizeof(double));
-					if (data == target) {
-						appendVectorUCharPtr(addresses, (unsigned char*)((unsigned char*)mbi.BaseAddress + i * sizeof(double)));
-					}
-				}
-			}
-			free(buffer);
+	int result = runWorkStealing(threads, scan.chunkCount, scanChunkTask, &scan);
+	result = endFirstScan(&scan, result);
+	endScanStats(stats, start);
+	return result;
+}
 
-		}
-		// Move to the next region
-		START_ADDRESS += mbi.RegionSize;
+// scanRegionsEx within the scope of hProcess (setScanRegionMap), which stays referenced while the scan runs.
+static int scanRegionsScoped(HANDLE hProcess, scan_kernel kernel, const void* target, SIZE_T width, SIZE_T stride,
+	DWORD protect, int firstOnly, vector_uchar_ptr* addresses, candidate_set* set)
+{
+	region_map* scope = acquireScanScope(hProcess);
+	int result = scanRegionsEx(hProcess, scope, kernel, target, width, stride, protect, firstOnly, NULL, addresses, set);
+	releaseScanScope(scope);
+	return result;
+}
+
+// Next scan
+// Candidates are read back in batches through readCandidates(): neighbours no
+// more than nextScanGap bytes apart share one read. The visitor gathers the
+// readable values into blocks of 64 and runs the predicate mask kernel (the
+// same one as the first scan) on each block. The vector is compacted in the
+// same pass with a write cursor; the compaction stays in index order, so the
+// cursor never overtakes a candidate that is still waiting in a block.
+
+static SIZE_T nextScanGap = READER_DEFAULT_GAP;
+
+typedef struct {
+	vector_uchar_ptr* addresses;
+	int kept;
+	mask_kernel mask;
+	const scan_predicate* predicate;
+	SIZE_T width;
+	unsigned char* values;
+	scan_stats* stats;
+	unsigned long long compareNanos;
+	int pending;
+	SIZE_T index[64];
+	unsigned char block[64 * sizeof(double)];
+} predicate_next;
+
+static void flushPredicateBlock(predicate_next* scan)
+{
+	unsigned long long start = scan->stats != NULL ? watchClockNanos() : 0;
+	unsigned long long mask = scan->mask(scan->block, scan->pending, scan->predicate);
+	while (mask) {
+		int bit = lowestSetBit(mask);
+		if (scan->values != NULL)
+			memcpy(scan->values + scan->kept * scan->width, scan->block + bit * scan->width, scan->width);
+		scan->addresses->array[scan->kept++] = scan->addresses->array[scan->index[bit]];
+		mask &= mask - 1;
+	}
+	scan->pending = 0;
+	if (scan->stats != NULL)
+		scan->compareNanos += watchClockNanos() - start;
+}
+
+static void predicateNextVisitor(void* context, SIZE_T index, const unsigned char* value)
+{
+	predicate_next* scan = (predicate_next*)context;
+	if (value == NULL)
+		return;
+	memcpy(scan->block + scan->pending * scan->width, value, scan->width);
+	scan->index[scan->pending++] = index;
+	if (scan->pending == 64)
+		flushPredicateBlock(scan);
+}
+
+// values, if not NULL, receives the value read at every kept address (width bytes each, in order).
+// stats, if not NULL, gets the reads, read and compare time and the hits of the scan added.
+static int predicateNextScan(HANDLE hProcess, const mask_kernel table[][SCAN_ISA_COUNT], const scan_predicate* predicate, SIZE_T width,
+	unsigned char* values, scan_stats* stats, vector_uchar_ptr* addressArray)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL)
+		return -1;
+	predicate_next scan;
+	scan.addresses = addressArray;
+	scan.kept = 0;
+	scan.mask = selectMaskKernel(table, predicate->kind);
+	scan.predicate = predicate;
+	scan.width = width;
+	scan.values = values;
+	scan.stats = stats;
+	scan.compareNanos = 0;
+	scan.pending = 0;
+	read_counters before = readCounters();
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	readCandidates(hProcess, addressArray->array, addressArray->size, width, nextScanGap,
+		buffer, scanBuffers.bufferSize, predicateNextVisitor, &scan);
+	if (scan.pending)
+		flushPredicateBlock(&scan);
+	if (stats != NULL) {
+		addReadStats(stats, &before);
+		stats->nsRead += watchClockNanos() - start - scan.compareNanos;
+		stats->nsCompare += scan.compareNanos;
+		stats->candidates += addressArray->size;
+		stats->hits += scan.kept;
 	}
-	shrinkToFitVectorUCharPtr(addresses);
+	addressArray->size = scan.kept;
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
 	return 1;
 }
 
-MEMSCAN_API int scanNextDOUBLE(HANDLE hProcess, vector_uchar_ptr* addressArray, double target)
+// Typed scans
+// Every scan goes through one engine taking a value type tag (SCAN_TYPE_*,
+// valuetypes.h) and a predicate (SCAN_PREDICATE_*, predicates.h). Operands are
+// passed by address and read as the tagged type. First scans run the predicate
+// mask kernel over every window (kernelPredicate); exact matches at the natural
+// alignment use the equality kernels of kernels.h when the type has them.
+
+// Kernel and target of a typed first scan. target points into the setup, which
+// must stay where it is while the scan runs.
+typedef struct {
+	scan_kernel kernel;
+	const void* target;
+	SIZE_T width;
+	SIZE_T stride;
+	scan_predicate predicate;
+	predicate_target masked;
+} typed_scan_setup;
+
+// Returns 0 for an invalid type, predicate or alignment.
+static int setupTypedScan(typed_scan_setup* setup, int type, int kind, const void* a, const void* b, int alignment)
 {
-	for (int i = 0; i < addressArray->size; i++)
-	{
-		SIZE_T bytesRead;
-		double buffer;
-		if (ReadProcessMemory(hProcess, addressArray->array[i], &buffer, sizeof(double), &bytesRead))
-		{
-			if (buffer != target)
-			{
-				deleteElementVectorUCharPtr(addressArray, i);
-				i--;
-			}
-		}
-		else
-		{
-			
-				deleteElementVectorUCharPtr(addressArray, i);
-				i--;
-		}
+	const scan_value_type* info = scanValueType(type);
+	if (info == NULL)
+		return 0;
+	setup->width = info->width;
+	setup->stride = scanStride(alignment, setup->width);
+	if (setup->stride == 0 || !info->makePredicate(&setup->predicate, kind, a, b))
+		return 0;
+	if (setup->predicate.kind == SCAN_PREDICATE_EQUAL && setup->stride == setup->width && info->equal != NULL) {
+		setup->kernel = selectKernel(info->equal);
+		setup->target = &setup->predicate.a;
+		return 1;
 	}
+
+	setup->masked.mask = selectMaskKernel(info->masks, setup->predicate.kind);
+	setup->masked.width = setup->width;
+	setup->masked.stride = setup->stride < setup->width ? setup->stride : setup->width;
+	setup->masked.predicate = setup->predicate;
+	setup->kernel = setup->stride < setup->width ? kernelPredicateStrided : kernelPredicate;
+	setup->target = &setup->masked;
 	return 1;
 }
-MEMSCAN_API vector_uchar_ptr* createAddressArray()
+
+static int typedScanEx(HANDLE hProcess, const region_map* scope, int type, int kind, const void* a, const void* b,
+	int alignment, scan_progress* progress, vector_uchar_ptr* addresses, candidate_set* set)
 {
-	vector_uchar_ptr* vector = (vector_uchar_ptr*)malloc(sizeof(vector_uchar_ptr));
-	createVectorUCharPtr(vector);
-	return vector;
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type, Predicate or Alignment
+	Returns: -5 Cancelled
+	*/
+	typed_scan_setup setup;
+	if (!setupTypedScan(&setup, type, kind, a, b, alignment))
+		return -3;
+	return scanRegionsEx(hProcess, scope, setup.kernel, setup.target, setup.width, setup.stride,
+		SCAN_PROTECT_WRITABLE, 0, progress, addresses, set);
 }
-MEMSCAN_API void freeAddressArray(vector_uchar_ptr* address)
+
+static int typedScan(HANDLE hProcess, int type, int kind, const void* a, const void* b, int alignment,
+	vector_uchar_ptr* addresses, candidate_set* set)
 {
-	deleteVectorUCharPtr(address);
-	free(address);
+	region_map* scope = acquireScanScope(hProcess);
+	int result = typedScanEx(hProcess, scope, type, kind, a, b, alignment, NULL, addresses, set);
+	releaseScanScope(scope);
+	return result;
 }
-// Freeing Data
-MEMSCAN_API void freeINTAddress(int* data)
+
+static int typedNextScanEx(HANDLE hProcess, vector_uchar_ptr* addressArray, int type, int kind, const void* a, const void* b,
+	scan_stats* stats)
 {
-	free(data);
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type or Predicate
+	*/
+	const scan_value_type* info = scanValueType(type);
+	scan_predicate predicate;
+	if (info == NULL || !info->makePredicate(&predicate, kind, a, b))
+		return -3;
+	return predicateNextScan(hProcess, info->masks, &predicate, info->width, NULL, stats, addressArray);
 }
-MEMSCAN_API void freeFLOATAddress(float* data)
+
+static int typedNextScan(HANDLE hProcess, vector_uchar_ptr* addressArray, int type, int kind, const void* a, const void* b)
 {
-	free(data);
+	scan_stats statsStorage;
+	scan_stats* stats = beginScanStats(&statsStorage);
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	int result = typedNextScanEx(hProcess, addressArray, type, kind, a, b, stats);
+	endScanStats(stats, start);
+	return result;
 }
-MEMSCAN_API void freeDOUBLEAddress(double* data)
+
+MEMSCAN_API int getScanTypeWidth(int type)
 {
-	free(data);
+	/*
+	Returns: the size in bytes of a SCAN_TYPE_* value, 0 if the type is unknown
+	*/
+	const scan_value_type* info = scanValueType(type);
+	return info != NULL ? (int)info->width : 0;
 }
-MEMSCAN_API HANDLE getHandleByPID(int pid)
+
+MEMSCAN_API int scanTyped(HANDLE hProcess, int type, int kind, const void* a, const void* b, int alignment, vector_uchar_ptr* addresses)
 {
-	return OpenProcess(PROCESS_ALL_ACCESS, FALSE, (DWORD)pid);
+	/*
+	Appends the address of every value of type that satisfies the predicate kind
+	with the operands at a and b (b may be NULL for EQUAL, LESS and GREATER).
+	Alignment 0 tests every sizeof(type) bytes, 1, 2, 4 or 8 every that many bytes.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type, Predicate or Alignment
+	*/
+	return typedScan(hProcess, type, kind, a, b, alignment, addresses, NULL);
 }
-MEMSCAN_API int closeHandle(HANDLE hProcess)
+
+MEMSCAN_API int scanNextTyped(HANDLE hProcess, vector_uchar_ptr* addressArray, int type, int kind, const void* a, const void* b)
+{
+	/*
+	Keeps the addresses whose current value of type satisfies the predicate.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type or Predicate
+	*/
+	return typedNextScan(hProcess, addressArray, type, kind, a, b);
+}
+
+MEMSCAN_API int readTyped(HANDLE hProcess, int type, unsigned char* address, void* value)
+{
+	/*
+	Returns: 1 on success, 0 Read Failure, -3 Invalid Type
+	*/
+	const scan_value_type* info = scanValueType(type);
+	if (info == NULL)
+		return -3;
+	return readRemote(hProcess, address, value, info->width);
+}
+
+MEMSCAN_API int writeTyped(HANDLE hProcess, int type, unsigned char* address, const void* value)
+{
+	/*
+	Returns: 1 on success, 0 Write Failure, -3 Invalid Type
+	*/
+	const scan_value_type* info = scanValueType(type);
+	if (info == NULL)
+		return -3;
+	return writeRemote(hProcess, address, value, info->width);
+}
+
+// Multi-process scans
+// The same typed first scan over several processes at once. The chunks of all
+// processes are numbered one after the other and run as one job on the work
+// stealing pool, so every thread stays busy however the memory is spread over
+// the processes, and N processes scan about as fast as one process of their
+// combined size. Each process keeps its own hit lists and gets its hits in
+// address order, exactly as scanTyped returns them.
+
+typedef struct {
+	first_scan* scans;
+	SIZE_T* firstChunk;     // index of the first chunk of every scan, the total at [count]
+	int count;
+} multi_scan;
+
+static void multiScanChunkTask(void* context, int worker, SIZE_T index)
 {
-	return CloseHandle(hProcess);
-}
\ No newline at end of file
+	multi_scan* multi = (multi_scan*)context;
+	int low = 0, high = multi->count - 1;
+	// The last scan starting at or before index; a scan without chunks shares its start with the next one.
+	while (low < high) {
+		int middle = (low + high + 1) / 2;
+		if (multi->firstChunk[middle] <= index)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+	scanChunkTask(&multi->scans[low], worker, index - multi->firstChunk[low]);
+}
+
+MEMSCAN_API int scanTypedMulti(HANDLE* handles, int count, int type, int kind, const void* a, const void* b, int alignment,
+	vector_uchar_ptr** results, int* statuses)
+{
+	/*
+	Runs scanTyped on count processes at once on the scan threads (setScanThreadCount).
+	The hits of handles[i] are appended to results[i] and statuses[i] receives the
+	result of its scan (1, or -1 if its regions could not be listed or joined).
+	Each process is limited to the region map of its handle (setScanRegionMap).
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Arguments, Type, Predicate or Alignment
+	*/
+	typed_scan_setup setup;
+	if (count <= 0 || handles == NULL || results == NULL || statuses == NULL)
+		return -3;
+	for (int i = 0; i < count; i++) {
+		if (handles[i] == NULL || results[i] == NULL)
+			return -3;
+	}
+	if (!setupTypedScan(&setup, type, kind, a, b, alignment))
+		return -3;
+
+	multi_scan multi;
+	multi.count = count;
+	multi.scans = (first_scan*)calloc(count, sizeof(first_scan));
+	multi.firstChunk = (SIZE_T*)calloc((SIZE_T)count + 1, sizeof(SIZE_T));
+	if (multi.scans == NULL || multi.firstChunk == NULL) {
+		free(multi.scans);
+		free(multi.firstChunk);
+		return -1;
+	}
+
+	scan_stats statsStorage;
+	scan_stats* stats = beginScanStats(&statsStorage);
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	SIZE_T total = 0;
+	for (int i = 0; i < count; i++) {
+		// The scope is only walked while the chunks are listed.
+		region_map* scope = acquireScanScope(handles[i]);
+		multi.firstChunk[i] = total;
+		statuses[i] = beginFirstScan(&multi.scans[i], handles[i], scope, setup.kernel, setup.target, setup.width,
+			setup.stride, SCAN_PROTECT_WRITABLE, 0, NULL, results[i], NULL, stats);
+		releaseScanScope(scope);
+		if (statuses[i] == 1)
+			total += multi.scans[i].chunkCount;
+	}
+	multi.firstChunk[count] = total;
+
+	int threads = getPoolThreadCount();
+	if ((SIZE_T)threads > total)
+		threads = total ? (int)total : 1;
+	int result = 1;
+	for (int i = 0; i < count; i++) {
+		if (statuses[i] == 1 && allocateFirstScan(&multi.scans[i], threads) < 0) {
+			statuses[i] = -1;
+			result = -1;
+		}
+	}
+	if (result == 1)
+		result = runWorkStealing(threads, total, multiScanChunkTask, &multi);
+	for (int i = 0; i < count; i++) {
+		if (statuses[i] == 1)
+			statuses[i] = endFirstScan(&multi.scans[i], result);
+	}
+	endScanStats(stats, start);
+	free(multi.scans);
+	free(multi.firstChunk);
+	return result;
+}
+
+// INT
+
+MEMSCAN_API int scanINT(HANDLE hProcess, int target, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedScan(hProcess, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &target, NULL, 0, addresses, NULL);
+}
+
+MEMSCAN_API int scanNextINT(HANDLE hProcess, vector_uchar_ptr* addressArray, int target)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedNextScan(hProcess, addressArray, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &target, NULL);
+}
+
+MEMSCAN_API int scanPredicateINT(HANDLE hProcess, int kind, int a, int b, int alignment, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	return typedScan(hProcess, SCAN_TYPE_I32, kind, &a, &b, alignment, addresses, NULL);
+}
+
+MEMSCAN_API int scanNextPredicateINT(HANDLE hProcess, vector_uchar_ptr* addressArray, int kind, int a, int b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	return typedNextScan(hProcess, addressArray, SCAN_TYPE_I32, kind, &a, &b);
+}
+
+// FLOAT
+
+MEMSCAN_API int scanFLOAT(HANDLE hProcess, float target, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F32, SCAN_PREDICATE_EQUAL, &target, NULL, 0, addresses, NULL);
+}
+
+MEMSCAN_API int scanNextFLOAT(HANDLE hProcess, vector_uchar_ptr* addressArray, float target)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedNextScan(hProcess, addressArray, SCAN_TYPE_F32, SCAN_PREDICATE_EQUAL, &target, NULL);
+}
+
+MEMSCAN_API int scanPredicateFLOAT(HANDLE hProcess, int kind, float a, float b, int alignment, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F32, kind, &a, &b, alignment, addresses, NULL);
+}
+
+MEMSCAN_API int scanNextPredicateFLOAT(HANDLE hProcess, vector_uchar_ptr* addressArray, int kind, float a, float b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	return typedNextScan(hProcess, addressArray, SCAN_TYPE_F32, kind, &a, &b);
+}
+
+// DOUBLE
+
+MEMSCAN_API int scanDOUBLE(HANDLE hProcess, double target, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F64, SCAN_PREDICATE_EQUAL, &target, NULL, 0, addresses, NULL);
+}
+
+MEMSCAN_API int scanNextDOUBLE(HANDLE hProcess, vector_uchar_ptr* addressArray, double target)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedNextScan(hProcess, addressArray, SCAN_TYPE_F64, SCAN_PREDICATE_EQUAL, &target, NULL);
+}
+
+MEMSCAN_API int scanPredicateDOUBLE(HANDLE hProcess, int kind, double a, double b, int alignment, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F64, kind, &a, &b, alignment, addresses, NULL);
+}
+
+MEMSCAN_API int scanNextPredicateDOUBLE(HANDLE hProcess, vector_uchar_ptr* addressArray, int kind, double a, double b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	return typedNextScan(hProcess, addressArray, SCAN_TYPE_F64, kind, &a, &b);
+}
+
+// Candidate sets
+// The same scans writing into a candidate_set (candidates.h) instead of a
+// vector. Next scans run segment by segment: each segment is decoded into a
+// scratch vector, narrowed with the vector next scan and encoded again.
+
+typedef struct {
+	HANDLE hProcess;
+	int type;
+	int kind;
+	const void* a;
+	const void* b;
+	scan_stats* stats;
+} set_next_scan;
+
+static int setNextScanFilter(void* context, vector_uchar_ptr* candidates)
+{
+	set_next_scan* scan = (set_next_scan*)context;
+	return typedNextScanEx(scan->hProcess, candidates, scan->type, scan->kind, scan->a, scan->b, scan->stats);
+}
+
+static int nextScanSet(HANDLE hProcess, candidate_set* set, int type, int kind, const void* a, const void* b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type or Predicate
+	*/
+	scan_predicate predicate;
+	const scan_value_type* info = scanValueType(type);
+	if (info == NULL || !info->makePredicate(&predicate, kind, a, b))
+		return -3;
+	scan_stats statsStorage;
+	scan_stats* stats = beginScanStats(&statsStorage);
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	set_next_scan scan = { hProcess, type, kind, a, b, stats };
+	vector_uchar_ptr scratch;
+	createVectorUCharPtr(&scratch);
+	int result = filterCandidateSegments(set, setNextScanFilter, &scan, &scratch);
+	deleteVectorUCharPtr(&scratch);
+	if (stats != NULL) {
+		// Decoding and encoding the segments is the merge phase of a set.
+		stats->nsMerge = watchClockNanos() - start - stats->nsRead - stats->nsCompare;
+		endScanStats(stats, start);
+	}
+	return result;
+}
+
+MEMSCAN_API candidate_set* createCandidateArray()
+{
+	candidate_set* set = (candidate_set*)malloc(sizeof(candidate_set));
+	if (set != NULL)
+		createCandidateSet(set, 1);
+	return set;
+}
+
+MEMSCAN_API void freeCandidateArray(candidate_set* set)
+{
+	if (set == NULL)
+		return;
+	deleteCandidateSet(set);
+	free(set);
+}
+
+MEMSCAN_API unsigned long long getCandidateCount(candidate_set* set)
+{
+	return set->count;
+}
+
+MEMSCAN_API unsigned char* getCandidateAddress(candidate_set* set, unsigned long long index)
+{
+	/*
+	Returns: NULL if index is out of range
+	*/
+	return getCandidate(set, index);
+}
+
+MEMSCAN_API unsigned long long copyCandidateAddresses(candidate_set* set, unsigned long long start, unsigned long long count, unsigned char** out)
+{
+	/*
+	Copies up to count candidates starting at index start into out.
+	Returns: the number of addresses copied
+	*/
+	if (start >= set->count)
+		return 0;
+	if (count > set->count - start)
+		count = set->count - start;
+	unsigned long long copied = 0;
+	while (copied < count) {
+		// decode in pieces that fit the int sized vector
+		unsigned long long piece = count - copied < 0x10000000ull ? count - copied : 0x10000000ull;
+		vector_uchar_ptr view = { out + copied, 0, (int)piece };
+		if (decodeCandidateRange(set, start + copied, piece, &view) < 0 || view.size == 0)
+			break;
+		copied += (unsigned long long)view.size;
+	}
+	return copied;
+}
+
+MEMSCAN_API SIZE_T getCandidateMemoryUsage(candidate_set* set)
+{
+	return candidateSetMemoryUsage(set);
+}
+
+MEMSCAN_API int filterCandidateArray(candidate_set* set, int (*keep)(void* context, unsigned char* element), void* context)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	vector_uchar_ptr scratch;
+	createVectorUCharPtr(&scratch);
+	int result = filterCandidateSet(set, keep, context, &scratch);
+	deleteVectorUCharPtr(&scratch);
+	return result;
+}
+
+MEMSCAN_API int scanTypedSet(HANDLE hProcess, int type, int kind, const void* a, const void* b, int alignment, candidate_set* set)
+{
+	/*
+	scanTyped writing into a candidate set.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type, Predicate or Alignment
+	*/
+	return typedScan(hProcess, type, kind, a, b, alignment, NULL, set);
+}
+
+MEMSCAN_API int scanNextTypedSet(HANDLE hProcess, candidate_set* set, int type, int kind, const void* a, const void* b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Type or Predicate
+	*/
+	return nextScanSet(hProcess, set, type, kind, a, b);
+}
+
+MEMSCAN_API int scanSetINT(HANDLE hProcess, int target, candidate_set* set)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedScan(hProcess, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &target, NULL, 0, NULL, set);
+}
+
+MEMSCAN_API int scanNextSetINT(HANDLE hProcess, candidate_set* set, int target)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return nextScanSet(hProcess, set, SCAN_TYPE_I32, SCAN_PREDICATE_EQUAL, &target, NULL);
+}
+
+MEMSCAN_API int scanSetFLOAT(HANDLE hProcess, float target, candidate_set* set)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F32, SCAN_PREDICATE_EQUAL, &target, NULL, 0, NULL, set);
+}
+
+MEMSCAN_API int scanNextSetFLOAT(HANDLE hProcess, candidate_set* set, float target)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return nextScanSet(hProcess, set, SCAN_TYPE_F32, SCAN_PREDICATE_EQUAL, &target, NULL);
+}
+
+MEMSCAN_API int scanSetDOUBLE(HANDLE hProcess, double target, candidate_set* set)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F64, SCAN_PREDICATE_EQUAL, &target, NULL, 0, NULL, set);
+}
+
+MEMSCAN_API int scanNextSetDOUBLE(HANDLE hProcess, candidate_set* set, double target)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	return nextScanSet(hProcess, set, SCAN_TYPE_F64, SCAN_PREDICATE_EQUAL, &target, NULL);
+}
+
+MEMSCAN_API int scanPredicateSetINT(HANDLE hProcess, int kind, int a, int b, int alignment, candidate_set* set)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	return typedScan(hProcess, SCAN_TYPE_I32, kind, &a, &b, alignment, NULL, set);
+}
+
+MEMSCAN_API int scanNextPredicateSetINT(HANDLE hProcess, candidate_set* set, int kind, int a, int b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	return nextScanSet(hProcess, set, SCAN_TYPE_I32, kind, &a, &b);
+}
+
+MEMSCAN_API int scanPredicateSetFLOAT(HANDLE hProcess, int kind, float a, float b, int alignment, candidate_set* set)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F32, kind, &a, &b, alignment, NULL, set);
+}
+
+MEMSCAN_API int scanNextPredicateSetFLOAT(HANDLE hProcess, candidate_set* set, int kind, float a, float b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	return nextScanSet(hProcess, set, SCAN_TYPE_F32, kind, &a, &b);
+}
+
+MEMSCAN_API int scanPredicateSetDOUBLE(HANDLE hProcess, int kind, double a, double b, int alignment, candidate_set* set)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	return typedScan(hProcess, SCAN_TYPE_F64, kind, &a, &b, alignment, NULL, set);
+}
+
+MEMSCAN_API int scanNextPredicateSetDOUBLE(HANDLE hProcess, candidate_set* set, int kind, double a, double b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	return nextScanSet(hProcess, set, SCAN_TYPE_F64, kind, &a, &b);
+}
+
+// Scan sessions
+// A session (session.h) keeps the candidates in a memory mapped file. The first
+// scan runs into a candidate set, which is written to the file segment by
+// segment and freed as it goes, so the raw addresses of the whole result never
+// exist at once. A session with values sends every segment through the vector
+// next scan first, which reads the values (and drops the few that changed
+// since). Next scans filter the file in place, SESSION_BATCH records at a
+// time, through the same vector next scan; the write cursor never overtakes
+// the batch being read.
+
+#define SESSION_BATCH 65536
+
+// Appends the addresses and, if values is not NULL, their values.
+static int appendSessionRecords(scan_session* session, const vector_uchar_ptr* addresses, const unsigned char* values)
+{
+	/*
+	Returns: -4 File Failure, the file could not grow
+	*/
+	unsigned long long first = session->header->count;
+	if (!reserveSessionRecords(session, first + addresses->size))
+		return -4;
+	SIZE_T width = session->header->valueWidth;
+	for (int i = 0; i < addresses->size; i++) {
+		unsigned char* record = sessionRecord(session, first + i);
+		unsigned long long address = (unsigned long long)(SIZE_T)addresses->array[i];
+		memcpy(record, &address, sizeof(address));
+		if (values != NULL)
+			memcpy(record + sizeof(address), values + i * width, width);
+	}
+	session->header->count = first + addresses->size;
+	return 1;
+}
+
+static int sessionScan(HANDLE hProcess, scan_session* session, int kind, const void* a, const void* b, int alignment)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	Returns: -4 File Failure
+	*/
+	const scan_value_type* info = scanValueType(session->header->type);
+	scan_predicate predicate;
+	if (!info->makePredicate(&predicate, kind, a, b))
+		return -3;
+	candidate_set set;
+	createCandidateSet(&set, 1);
+	int result = typedScan(hProcess, session->header->type, kind, a, b, alignment, NULL, &set);
+
+	session->header->dirty = 1;
+	session->header->count = 0;
+	vector_uchar_ptr scratch;
+	createVectorUCharPtr(&scratch);
+	unsigned char* values = NULL;
+	SIZE_T valuesCapacity = 0;
+	for (SIZE_T i = 0; i < set.segmentCount; i++) {
+		candidate_segment* segment = &set.segments[i];
+		scratch.size = 0;
+		if (result == 1 && decodeCandidateSegment(segment, set.unit, 0, (SIZE_T)segment->count, &scratch) < 0)
+			result = -1;
+		if (result == 1 && session->header->valueWidth) {
+			if (valuesCapacity < (SIZE_T)scratch.size) {
+				free(values);
+				valuesCapacity = scratch.size;
+				values = (unsigned char*)malloc(valuesCapacity * info->width);
+			}
+			if (values == NULL)
+				result = -1;
+			else
+				result = predicateNextScan(hProcess, info->masks, &predicate, info->width, values, NULL, &scratch);
+		}
+		if (result == 1)
+			result = appendSessionRecords(session, &scratch, values);
+		freeCandidateSegment(segment);
+	}
+	free(values);
+	deleteVectorUCharPtr(&scratch);
+	deleteCandidateSet(&set);
+	if (session->view == NULL)
+		return -4;
+	if (result != 1)
+		session->header->count = 0;
+	else
+		session->header->scans++;
+	session->header->dirty = 0;
+	return result;
+}
+
+static int sessionNextScan(HANDLE hProcess, scan_session* session, int kind, const void* a, const void* b)
+{
+	/*
+	Returns: -1 Memory Allocation Failure, the records not scanned yet are kept
+	Returns: -3 Invalid Predicate
+	*/
+	const scan_value_type* info = scanValueType(session->header->type);
+	scan_predicate predicate;
+	if (!info->makePredicate(&predicate, kind, a, b))
+		return -3;
+	SIZE_T width = info->width;
+	SIZE_T stored = session->header->valueWidth;
+	vector_uchar_ptr scratch;
+	createVectorUCharPtr(&scratch);
+	int reserved = reserveVectorUCharPtr(&scratch, SESSION_BATCH);
+	unsigned char* values = stored ? (unsigned char*)malloc(SESSION_BATCH * width) : NULL;
+	if (!reserved || (stored && values == NULL)) {
+		free(values);
+		deleteVectorUCharPtr(&scratch);
+		return -1;
+	}
+
+	scan_stats statsStorage;
+	scan_stats* stats = beginScanStats(&statsStorage);
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	session_header* header = session->header;
+	unsigned long long count = header->count, read = 0, kept = 0;
+	int result = 1;
+	header->dirty = 1;
+	while (read < count) {
+		int take = count - read < SESSION_BATCH ? (int)(count - read) : SESSION_BATCH;
+		for (int i = 0; i < take; i++) {
+			unsigned long long address;
+			memcpy(&address, sessionRecord(session, read + i), sizeof(address));
+			scratch.array[i] = (unsigned char*)(SIZE_T)address;
+		}
+		scratch.size = take;
+		result = predicateNextScan(hProcess, info->masks, &predicate, width, values, stats, &scratch);
+		if (result != 1)
+			break;
+		for (int i = 0; i < scratch.size; i++) {
+			unsigned char* record = sessionRecord(session, kept + i);
+			unsigned long long address = (unsigned long long)(SIZE_T)scratch.array[i];
+			memcpy(record, &address, sizeof(address));
+			if (stored)
+				memcpy(record + sizeof(address), values + i * width, width);
+		}
+		kept += scratch.size;
+		read += take;
+	}
+	if (read < count)
+		memmove(sessionRecord(session, kept), sessionRecord(session, read), (SIZE_T)(count - read) * session->recordSize);
+	header->count = kept + (count - read);
+	if (result == 1)
+		header->scans++;
+	header->dirty = 0;
+	if (stats != NULL) {
+		// Moving the records from the batches back into the file is the merge phase of a session.
+		stats->nsMerge = watchClockNanos() - start - stats->nsRead - stats->nsCompare;
+		endScanStats(stats, start);
+	}
+	free(values);
+	deleteVectorUCharPtr(&scratch);
+	return result;
+}
+
+MEMSCAN_API scan_session* createScanSession(HANDLE hProcess, const char* path, int type, int storeValues)
+{
+	/*
+	Creates (or replaces) the session file at path for scans of type, taken from
+	hProcess. With storeValues every record also keeps the last value read.
+	Returns NULL if the type is unknown, the file cannot be created or memory allocation fails.
+	*/
+	const scan_value_type* info = scanValueType(type);
+	int pid = 0;
+	unsigned long long started = 0;
+	if (info == NULL)
+		return NULL;
+	remoteProcessIdentity(hProcess, &pid, &started);
+	scan_session* session = (scan_session*)malloc(sizeof(scan_session));
+	if (session == NULL)
+		return NULL;
+	if (!createSessionFile(session, path, type, storeValues ? (unsigned int)info->width : 0, pid, started)) {
+		free(session);
+		return NULL;
+	}
+	return session;
+}
+
+MEMSCAN_API scan_session* openScanSession(const char* path)
+{
+	/*
+	Returns NULL if the file cannot be opened, is not a session, was left in the
+	middle of a scan or memory allocation fails.
+	*/
+	scan_session* session = (scan_session*)malloc(sizeof(scan_session));
+	if (session == NULL)
+		return NULL;
+	if (!openSessionFile(session, path)) {
+		free(session);
+		return NULL;
+	}
+	const scan_value_type* info = scanValueType(session->header->type);
+	if (info == NULL || (session->header->valueWidth != 0 && session->header->valueWidth != info->width)) {
+		unmapSessionFile(session);
+		closeSessionHandle(session);
+		free(session);
+		return NULL;
+	}
+	return session;
+}
+
+MEMSCAN_API int matchScanSession(HANDLE hProcess, scan_session* session)
+{
+	/*
+	Returns: 1 if the session was taken from this run of the process, 0 otherwise
+	Returns: -4 File Failure, the session is unusable
+	*/
+	int pid;
+	unsigned long long started;
+	if (session->view == NULL)
+		return -4;
+	if (!remoteProcessIdentity(hProcess, &pid, &started))
+		return 0;
+	return pid == session->header->pid && started == session->header->started;
+}
+
+MEMSCAN_API int scanTypedSession(HANDLE hProcess, scan_session* session, int kind, const void* a, const void* b, int alignment)
+{
+	/*
+	Replaces the records of the session with every value of the session type
+	that satisfies the predicate, like scanTyped.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	Returns: -4 File Failure, the session is left empty or, if it could not be mapped again, unusable
+	*/
+	if (session->view == NULL)
+		return -4;
+	return sessionScan(hProcess, session, kind, a, b, alignment);
+}
+
+MEMSCAN_API int scanNextTypedSession(HANDLE hProcess, scan_session* session, int kind, const void* a, const void* b)
+{
+	/*
+	Keeps the records whose current value satisfies the predicate, in place,
+	and updates their stored values.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	Returns: -4 File Failure
+	*/
+	if (session->view == NULL)
+		return -4;
+	return sessionNextScan(hProcess, session, kind, a, b);
+}
+
+MEMSCAN_API unsigned long long getScanSessionCount(scan_session* session)
+{
+	return session->view != NULL ? session->header->count : 0;
+}
+
+MEMSCAN_API int getScanSessionType(scan_session* session)
+{
+	/*
+	Returns: -4 File Failure, the session is unusable
+	*/
+	return session->view != NULL ? session->header->type : -4;
+}
+
+MEMSCAN_API int getScanSessionValueWidth(scan_session* session)
+{
+	/*
+	Returns: the size of the stored values, 0 if the session stores none
+	Returns: -4 File Failure, the session is unusable
+	*/
+	return session->view != NULL ? (int)session->header->valueWidth : -4;
+}
+
+MEMSCAN_API int getScanSessionProcessId(scan_session* session)
+{
+	/*
+	Returns: -4 File Failure, the session is unusable
+	*/
+	return session->view != NULL ? session->header->pid : -4;
+}
+
+MEMSCAN_API unsigned long long getScanSessionScanCount(scan_session* session)
+{
+	/*
+	Returns: 0 if the session is unusable, like getScanSessionCount
+	*/
+	return session->view != NULL ? session->header->scans : 0;
+}
+
+MEMSCAN_API unsigned long long copyScanSessionRecords(scan_session* session, unsigned long long start, unsigned long long count,
+	unsigned long long* addresses, unsigned char* values)
+{
+	/*
+	Copies up to count records starting at index start: the addresses to
+	addresses and the stored values (getScanSessionValueWidth bytes each) to
+	values. Either may be NULL.
+	Returns: the number of records copied
+	*/
+	unsigned long long total = getScanSessionCount(session);
+	if (start >= total)
+		return 0;
+	if (count > total - start)
+		count = total - start;
+	SIZE_T width = session->header->valueWidth;
+	for (unsigned long long i = 0; i < count; i++) {
+		const unsigned char* record = sessionRecord(session, start + i);
+		if (addresses != NULL)
+			memcpy(&addresses[i], record, sizeof(unsigned long long));
+		if (values != NULL && width)
+			memcpy(values + i * width, record + sizeof(unsigned long long), width);
+	}
+	return count;
+}
+
+MEMSCAN_API int flushScanSession(scan_session* session)
+{
+	/*
+	Writes the session to disk.
+	Returns: -4 File Failure
+	*/
+	return session->view != NULL && flushSessionFile(session) ? 1 : -4;
+}
+
+MEMSCAN_API void closeScanSession(scan_session* session)
+{
+	/*
+	Unmaps and closes the session file, cut back to the records in use. The file stays.
+	*/
+	if (session == NULL)
+		return;
+	closeSessionFile(session);
+	free(session);
+}
+
+// Value stores
+// A value store (valuestore.h) keeps the value last read next to every
+// candidate. The first scan reads the values of its hits with one more batched
+// pass. Next scans walk the address array through readCandidates() like the
+// vector next scan; the visitor gathers every live value together with the
+// stored value of the same index into blocks of 64 and runs either the
+// predicate mask kernel (absolute predicates) or the relative kernel of the
+// type (previous value predicates) on them. The kept addresses and their new
+// values are written back through one cursor in the same pass.
+
+typedef struct {
+	value_store* store;
+	SIZE_T kept;
+	mask_kernel mask;
+	const scan_predicate* predicate;
+	relative_kernel relative;
+	const relative_predicate* relation;
+	scan_stats* stats;
+	unsigned long long compareNanos;
+	SIZE_T pending;
+	SIZE_T index[64];
+	unsigned char block[64 * sizeof(double)];
+	unsigned char old[64 * sizeof(double)];
+} store_next;
+
+static void flushStoreBlock(store_next* scan)
+{
+	unsigned long long start = scan->stats != NULL ? watchClockNanos() : 0;
+	value_store* store = scan->store;
+	SIZE_T width = store->width;
+	unsigned long long mask = scan->relative != NULL
+		? scan->relative(scan->block, scan->old, scan->pending, scan->relation)
+		: scan->mask(scan->block, (int)scan->pending, scan->predicate);
+	while (mask) {
+		int bit = lowestSetBit(mask);
+		memcpy(store->values + scan->kept * width, scan->block + bit * width, width);
+		store->addresses[scan->kept++] = store->addresses[scan->index[bit]];
+		mask &= mask - 1;
+	}
+	scan->pending = 0;
+	if (scan->stats != NULL)
+		scan->compareNanos += watchClockNanos() - start;
+}
+
+static void storeNextVisitor(void* context, SIZE_T index, const unsigned char* value)
+{
+	store_next* scan = (store_next*)context;
+	SIZE_T width = scan->store->width;
+	if (value == NULL)
+		return;
+	memcpy(scan->block + scan->pending * width, value, width);
+	if (scan->relative != NULL)
+		memcpy(scan->old + scan->pending * width, scan->store->values + index * width, width);
+	scan->index[scan->pending++] = index;
+	if (scan->pending == 64)
+		flushStoreBlock(scan);
+}
+
+// Runs either predicate (mask kernel) or relation (relative kernel) over the store.
+static int storeNextScan(HANDLE hProcess, value_store* store, const scan_predicate* predicate, const relative_predicate* relation)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL)
+		return -1;
+	scan_stats statsStorage;
+	scan_stats* stats = beginScanStats(&statsStorage);
+	unsigned long long start = stats != NULL ? watchClockNanos() : 0;
+	store_next scan;
+	scan.store = store;
+	scan.kept = 0;
+	scan.mask = predicate != NULL ? selectMaskKernel(SCAN_VALUE_TYPE_INFO[store->type].masks, predicate->kind) : NULL;
+	scan.predicate = predicate;
+	scan.relative = relation != NULL ? RELATIVE_KERNELS[store->type] : NULL;
+	scan.relation = relation;
+	scan.stats = stats;
+	scan.compareNanos = 0;
+	scan.pending = 0;
+	read_counters before = readCounters();
+	readCandidates(hProcess, store->addresses, store->count, store->width, nextScanGap,
+		buffer, scanBuffers.bufferSize, storeNextVisitor, &scan);
+	if (scan.pending)
+		flushStoreBlock(&scan);
+	if (stats != NULL) {
+		addReadStats(stats, &before);
+		stats->nsRead = watchClockNanos() - start - scan.compareNanos;
+		stats->nsCompare = scan.compareNanos;
+		stats->candidates = store->count;
+		stats->hits = scan.kept;
+	}
+	store->count = scan.kept;
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	endScanStats(stats, start);
+	return 1;
+}
+
+MEMSCAN_API value_store* createValueStore(int type)
+{
+	/*
+	Returns NULL if the type is unknown or memory allocation fails.
+	*/
+	if (scanValueType(type) == NULL)
+		return NULL;
+	value_store* store = (value_store*)malloc(sizeof(value_store));
+	if (store == NULL)
+		return NULL;
+	initValueStore(store, type);
+	return store;
+}
+
+MEMSCAN_API void freeValueStore(value_store* store)
+{
+	if (store == NULL)
+		return;
+	deleteValueStore(store);
+	free(store);
+}
+
+MEMSCAN_API int scanTypedStore(HANDLE hProcess, value_store* store, int kind, const void* a, const void* b, int alignment)
+{
+	/*
+	Replaces the content of the store with every value of the store type that
+	satisfies the predicate, like scanTyped, and the value read at each.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate or Alignment
+	*/
+	const scan_value_type* info = &SCAN_VALUE_TYPE_INFO[store->type];
+	scan_predicate predicate;
+	if (!info->makePredicate(&predicate, kind, a, b))
+		return -3;
+	vector_uchar_ptr hits;
+	createVectorUCharPtr(&hits);
+	int result = typedScan(hProcess, store->type, kind, a, b, alignment, &hits, NULL);
+	unsigned char* values = NULL;
+	if (result == 1) {
+		values = (unsigned char*)malloc((hits.size > 0 ? (SIZE_T)hits.size : 1) * info->width);
+		result = values != NULL ? predicateNextScan(hProcess, info->masks, &predicate, info->width, values, NULL, &hits) : -1;
+	}
+	if (result != 1) {
+		free(values);
+		deleteVectorUCharPtr(&hits);
+		return result;
+	}
+	adoptValueStoreRecords(store, &hits, values);
+	return 1;
+}
+
+MEMSCAN_API int scanNextTypedStore(HANDLE hProcess, value_store* store, int kind, const void* a, const void* b)
+{
+	/*
+	Keeps the addresses whose current value satisfies the predicate and stores
+	that value.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Predicate
+	*/
+	scan_predicate predicate;
+	if (!SCAN_VALUE_TYPE_INFO[store->type].makePredicate(&predicate, kind, a, b))
+		return -3;
+	return storeNextScan(hProcess, store, &predicate, NULL);
+}
+
+MEMSCAN_API int scanNextRelativeStore(HANDLE hProcess, value_store* store, int mode, const void* a, const void* b)
+{
+	/*
+	Keeps the addresses whose current value compares to the stored one as mode
+	(RELATIVE_*, valuestore.h) says and stores that value. a and b are deltas:
+	the signed type of the store width for integers, the store type for floats,
+	a double percentage for WITHIN_PERCENT.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Mode or Operand
+	*/
+	relative_predicate relation;
+	if (!makeRelativePredicate(&relation, store->type, mode, a, b))
+		return -3;
+	return storeNextScan(hProcess, store, NULL, &relation);
+}
+
+MEMSCAN_API unsigned long long getValueStoreCount(value_store* store)
+{
+	return store->count;
+}
+
+MEMSCAN_API int getValueStoreType(value_store* store)
+{
+	return store->type;
+}
+
+MEMSCAN_API unsigned long long getValueStoreMemoryUsage(value_store* store)
+{
+	return valueStoreMemoryUsage(store);
+}
+
+MEMSCAN_API unsigned long long copyValueStoreRecords(value_store* store, unsigned long long start, unsigned long long count,
+	unsigned long long* addresses, unsigned char* values)
+{
+	/*
+	Copies up to count records starting at index start: the addresses to
+	addresses and the values (getScanTypeWidth bytes each) to values. Either
+	may be NULL.
+	Returns: the number of records copied
+	*/
+	if (start >= store->count)
+		return 0;
+	if (count > store->count - start)
+		count = store->count - start;
+	if (addresses != NULL)
+		for (unsigned long long i = 0; i < count; i++)
+			addresses[i] = (unsigned long long)(SIZE_T)store->addresses[start + i];
+	if (values != NULL)
+		memcpy(values, store->values + (SIZE_T)start * store->width, (SIZE_T)count * store->width);
+	return count;
+}
+
+// Scan tasks
+// startScanTyped runs scanTyped or scanTypedSet on a thread of its own
+// (scantask.h) and returns at once. The caller polls the progress, drains the
+// streamed hits, cancels or waits; the result vector or set must not be used
+// before the task has finished. The task holds a reference to the scope of its
+// handle, so closing the region map meanwhile does not affect it.
+
+typedef struct {
+	HANDLE hProcess;
+	int type;
+	int kind;
+	unsigned char a[8];
+	unsigned char b[8];
+	int alignment;
+	vector_uchar_ptr* addresses;
+	candidate_set* set;
+	region_map* scope;
+} typed_scan_task;
+
+typedef struct {
+	unsigned long long bytesTotal;
+	unsigned long long bytesDone;
+	unsigned long long chunksTotal;
+	unsigned long long chunksDone;
+	unsigned long long hits;
+	int finished;
+	int result;
+	int cancelled;
+	int streamFailed;
+} scan_task_status;
+
+static int runTypedScanTask(void* args, scan_progress* progress)
+{
+	typed_scan_task* scan = (typed_scan_task*)args;
+	int result = typedScanEx(scan->hProcess, scan->scope, scan->type, scan->kind, scan->a, scan->b, scan->alignment,
+		progress, scan->addresses, scan->set);
+	releaseScanScope(scan->scope);
+	return result;
+}
+
+MEMSCAN_API scan_task* startScanTyped(HANDLE hProcess, int type, int kind, const void* a, const void* b, int alignment,
+	vector_uchar_ptr* addresses, candidate_set* set, int stream)
+{
+	/*
+	Starts scanTyped (addresses) or scanTypedSet (set) in the background; pass exactly one of them.
+	With stream set the hits of every finished chunk can be taken with drainScanTask.
+	Returns: the task, NULL if the type, predicate or alignment is invalid or memory or the thread cannot be allocated
+	*/
+	const scan_value_type* info = scanValueType(type);
+	scan_predicate predicate;
+	if (info == NULL || scanStride(alignment, info->width) == 0 || !info->makePredicate(&predicate, kind, a, b))
+		return NULL;
+	if ((addresses == NULL) == (set == NULL))
+		return NULL;
+	typed_scan_task* scan = (typed_scan_task*)calloc(1, sizeof(typed_scan_task));
+	if (scan == NULL)
+		return NULL;
+	scan->hProcess = hProcess;
+	scan->type = type;
+	scan->kind = kind;
+	memcpy(scan->a, a, info->width);
+	if (b != NULL)
+		memcpy(scan->b, b, info->width);
+	scan->alignment = alignment;
+	scan->addresses = addresses;
+	scan->set = set;
+	region_map* scope = acquireScanScope(hProcess);
+	scan->scope = scope;
+	scan_task* task = startScanTask(runTypedScanTask, scan, stream);
+	if (task == NULL)
+		releaseScanScope(scope);
+	return task;
+}
+
+MEMSCAN_API void cancelScanTask(scan_task* task)
+{
+	signalScanCancel(task);
+}
+
+MEMSCAN_API int waitScanTask(scan_task* task, unsigned int timeoutMicros)
+{
+	/*
+	Returns: 1 if the scan has finished, 0 if it is still running after timeoutMicros
+	*/
+	return waitScanFinished(task, timeoutMicros);
+}
+
+MEMSCAN_API void getScanTaskStatus(scan_task* task, scan_task_status* status)
+{
+	/*
+	result is the return value of scanTyped / scanTypedSet once finished is set (-5 if cancelled).
+	*/
+	scan_progress* progress = &task->progress;
+	status->finished = waitScanFinished(task, 0);
+	status->result = status->finished ? task->result : 0;
+	status->bytesTotal = WATCH_LOAD(progress->bytesTotal);
+	status->bytesDone = WATCH_LOAD(progress->bytesDone);
+	status->chunksTotal = WATCH_LOAD(progress->chunksTotal);
+	status->chunksDone = WATCH_LOAD(progress->chunksDone);
+	status->hits = WATCH_LOAD(progress->hits);
+	status->cancelled = WATCH_LOAD(progress->cancelled);
+	status->streamFailed = WATCH_LOAD(progress->streamFailed);
+}
+
+MEMSCAN_API SIZE_T drainScanTask(scan_task* task, unsigned char** addresses, SIZE_T max)
+{
+	/*
+	Returns: the number of streamed hits copied to addresses, in the order their chunks finished
+	*/
+	return drainScanStream(task, addresses, max);
+}
+
+MEMSCAN_API SIZE_T getScanTaskPendingCount(scan_task* task)
+{
+	return pendingScanStream(task);
+}
+
+MEMSCAN_API void freeScanTask(scan_task* task)
+{
+	/*
+	Cancels the scan if it still runs and waits for it; the result vector or set stays with the caller.
+	*/
+	destroyScanTask(task);
+}
+
+// Pattern scan
+// AOB signatures and strings (patterns.h) run on the same region walk as the
+// value scans, with the pattern length as the value width and a stride of one byte.
+
+MEMSCAN_API int scanPattern(HANDLE hProcess, const char* pattern, int regions, int firstOnly, vector_uchar_ptr* addresses)
+{
+	/*
+	Finds the start address of every match of a pattern such as "48 8B 05 ?? ?? ?? ?? 89 ??"
+	in the regions selected by the SCAN_REGION_* flags (0 selects writable and executable).
+	With firstOnly set only the lowest match is returned.
+	Returns: -1 Memory Allocation Failure, -3 Invalid Pattern
+	*/
+	byte_pattern compiled;
+	if (pattern == NULL || !compilePattern(pattern, &compiled))
+		return -3;
+	if (regions == 0)
+		regions = SCAN_REGION_WRITABLE | SCAN_REGION_EXECUTABLE;
+	DWORD protect = regionProtection(regions);
+	if (protect == 0)
+		return -3;
+	return scanRegionsScoped(hProcess, selectKernel(PATTERN_KERNELS), &compiled, compiled.length, 1, protect, firstOnly, addresses, NULL);
+}
+
+MEMSCAN_API int scanString(HANDLE hProcess, const unsigned char* needle, SIZE_T size, int encoding, int ignoreCase,
+	int regions, vector_uchar_ptr* addresses)
+{
+	/*
+	Finds every occurrence of a needle of size bytes, encoded as ASCII (STRING_ASCII) or
+	UTF-16LE (STRING_UTF16). ignoreCase folds the ASCII letters. regions as for scanPattern,
+	0 selects the writable regions scanned by scanINT.
+	Returns: -1 Memory Allocation Failure, -3 Invalid Needle
+	*/
+	byte_pattern compiled;
+	if (needle == NULL || !compileString(needle, size, encoding, ignoreCase, &compiled))
+		return -3;
+	DWORD protect = regions == 0 ? SCAN_PROTECT_WRITABLE : regionProtection(regions);
+	if (protect == 0)
+		return -3;
+	return scanRegionsScoped(hProcess, selectKernel(PATTERN_KERNELS), &compiled, compiled.length, 1, protect, 0, addresses, NULL);
+}
+
+// Group scan
+// A group (groupscan.h) runs as one first scan: the kernel tests the rarest
+// fixed term at every position and verifies the others around its hits, so
+// the scan yields the anchor addresses directly.
+
+MEMSCAN_API int scanGroup(HANDLE hProcess, const group_term* terms, int count, int span, int alignment, vector_uchar_ptr* addresses)
+{
+	/*
+	Appends the anchor address (the address of terms[0]) of every group whose
+	terms all match: fixed terms at their offset from the anchor, free terms
+	anywhere within span bytes of it. Alignment 0 tests every term at
+	multiples of its own width, 1, 2, 4 or 8 every that many bytes.
+	Returns: -1 Memory Allocation Failure
+	Returns: -3 Invalid Term, Count, Span or Alignment
+	*/
+	group_scan group;
+	if (terms == NULL || !compileGroup(&group, hProcess, terms, count, span, alignment))
+		return -3;
+	return scanRegionsScoped(hProcess, kernelGroup, &group, group.prefilter.width, group.prefilter.stride,
+		SCAN_PROTECT_WRITABLE, 0, addresses, NULL);
+}
+
+// Pointer scan
+// createPointerMap dumps every pointer of the writable regions (pointers.h) with
+// one first scan; scanPointerPaths searches a map, live or loaded from a file,
+// for the module based paths to a target.
+
+MEMSCAN_API pointer_map* createPointerMap(HANDLE hProcess)
+{
+	/*
+	Records every pointer of the writable memory of the process and the module list.
+	Returns NULL if memory allocation or the module list fails.
+	*/
+	pointer_map* map = (pointer_map*)malloc(sizeof(pointer_map));
+	vector_uchar_ptr pairs;
+	createVectorUCharPtr(&pairs);
+	remote_module* modules = NULL;
+	SIZE_T moduleCount = 0;
+	pointer_regions regions;
+	regions.starts = NULL;
+	regions.ends = NULL;
+	regions.count = 0;
+	regions.pointerSize = remotePointerSize(hProcess);
+
+	int result = map != NULL ? 1 : -1;
+	if (result == 1)
+		result = collectModules(hProcess, &modules, &moduleCount);
+	if (result == 1)
+		result = collectPointerRegions(hProcess, &regions);
+	if (result == 1)
+		result = scanRegionsScoped(hProcess, pointerKernel, &regions, regions.pointerSize, regions.pointerSize,
+			SCAN_PROTECT_WRITABLE, 0, &pairs, NULL);
+	if (result == 1) {
+		result = buildPointerMap(map, &pairs, modules, moduleCount, regions.pointerSize);
+		modules = NULL;
+	}
+	freePointerRegions(&regions);
+	deleteVectorUCharPtr(&pairs);
+	free(modules);
+	if (result != 1) {
+		if (map != NULL)
+			clearPointerMap(map);
+		free(map);
+		return NULL;
+	}
+	return map;
+}
+
+MEMSCAN_API void freePointerMap(pointer_map* map)
+{
+	if (map == NULL)
+		return;
+	clearPointerMap(map);
+	free(map);
+}
+
+MEMSCAN_API SIZE_T getPointerMapSize(pointer_map* map)
+{
+	return map->entryCount;
+}
+
+MEMSCAN_API int savePointerMap(pointer_map* map, const char* path)
+{
+	/*
+	Returns: -4 File Failure
+	*/
+	return savePointerMapFile(map, path) ? 1 : -4;
+}
+
+MEMSCAN_API pointer_map* loadPointerMap(const char* path)
+{
+	/*
+	Returns NULL if the file cannot be read, is not a pointer map or memory allocation fails.
+	*/
+	pointer_map* map = (pointer_map*)malloc(sizeof(pointer_map));
+	if (map == NULL)
+		return NULL;
+	if (loadPointerMapFile(map, path) != 1) {
+		free(map);
+		return NULL;
+	}
+	return map;
+}
+
+MEMSCAN_API pointer_path_list* createPointerPathArray()
+{
+	pointer_path_list* list = (pointer_path_list*)malloc(sizeof(pointer_path_list));
+	if (list != NULL)
+		createPointerPathList(list);
+	return list;
+}
+
+MEMSCAN_API void freePointerPathArray(pointer_path_list* list)
+{
+	if (list == NULL)
+		return;
+	clearPointerPathList(list);
+	free(list);
+}
+
+MEMSCAN_API SIZE_T getPointerPathCount(pointer_path_list* list)
+{
+	return list->count;
+}
+
+MEMSCAN_API int getPointerPath(pointer_path_list* list, SIZE_T index, char* module, unsigned long long* baseOffset, unsigned int* offsets)
+{
+	/*
+	Copies the module name (POINTER_MODULE_NAME bytes), the offset from the module base and the
+	offsets (POINTER_MAX_DEPTH entries) of a path.
+	Returns the number of offsets, or 0 if index is out of range.
+	*/
+	if (index >= list->count)
+		return 0;
+	const pointer_path* path = &list->paths[index];
+	memcpy(module, list->modules[path->module].name, POINTER_MODULE_NAME);
+	*baseOffset = path->baseOffset;
+	memcpy(offsets, path->offsets, sizeof(path->offsets));
+	return path->depth;
+}
+
+MEMSCAN_API int scanPointerPaths(pointer_map* map, unsigned char* target, int maxDepth, unsigned int maxOffset, SIZE_T maxResults,
+	pointer_path_list* paths)
+{
+	/*
+	Replaces paths with at most maxResults paths from a module to target, each with at most
+	maxDepth (1 to POINTER_MAX_DEPTH) offsets of at most maxOffset bytes.
+	Returns: -1 Memory Allocation Failure, -3 Invalid Arguments
+	*/
+	return searchPointerPaths(map, (unsigned long long)(SIZE_T)target, maxDepth, maxOffset, maxResults,
+		getPoolThreadCount(), paths);
+}
+
+MEMSCAN_API long long intersectPointerPaths(pointer_path_list* paths, pointer_path_list* other)
+{
+	/*
+	Keeps the paths that also occur in other (same module name, base offset and offsets).
+	Returns: -1 Memory Allocation Failure, else the number of paths left
+	*/
+	return intersectPointerPathLists(paths, other);
+}
+
+MEMSCAN_API unsigned char* resolvePointerPath(HANDLE hProcess, pointer_path_list* paths, SIZE_T index)
+{
+	/*
+	Follows a path in the live process, with the module base of this run.
+	Returns the address it leads to, or NULL if the module is not loaded or a read fails.
+	*/
+	if (index >= paths->count)
+		return NULL;
+	const pointer_path* path = &paths->paths[index];
+	remote_module* modules;
+	SIZE_T moduleCount;
+	if (collectModules(hProcess, &modules, &moduleCount) != 1)
+		return NULL;
+	unsigned long long address = 0;
+	int found = 0;
+	for (SIZE_T i = 0; i < moduleCount && !found; i++) {
+		if (moduleNameEquals(modules[i].name, paths->modules[path->module].name)) {
+			address = modules[i].base + path->baseOffset;
+			found = 1;
+		}
+	}
+	free(modules);
+	if (!found)
+		return NULL;
+
+	unsigned int pointerSize = remotePointerSize(hProcess);
+	for (int k = 0; k < path->depth; k++) {
+		unsigned long long value = 0;
+		if (!readRemote(hProcess, (const unsigned char*)(SIZE_T)address, &value, pointerSize))
+			return NULL;
+		address = value + path->offsets[k];
+	}
+	return (unsigned char*)(SIZE_T)address;
+}
+
+// Snapshot scan
+// createSnapshot records the writable memory once (compressed, see snapshot.h).
+// scanSnapshot* compares the live process against it and produces the first
+// address list; scanNextSnapshot* filters an address list the same way.
+
+typedef struct {
+	vector_uchar_ptr* addresses;
+	int kept;
+	const memory_snapshot* snapshot;
+	long long page;
+	snapshot_matcher match;
+	SIZE_T width;
+	int mode;
+	const void* delta;
+	unsigned char old[SNAPSHOT_PAGE_SIZE];
+} snapshot_next;
+
+static int snapshotScan(HANDLE hProcess, memory_snapshot* snapshot, snapshot_matcher match, SIZE_T width, SIZE_T stride, int mode, const void* delta, vector_uchar_ptr* addresses)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL)
+		return -1;
+	int result = compareSnapshot(hProcess, snapshot, match, width, stride, mode, delta, buffer, addresses);
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	if (result == 1)
+		shrinkToFitVectorUCharPtr(addresses);
+	return result;
+}
+
+static void snapshotNextVisitor(void* context, SIZE_T index, const unsigned char* value)
+{
+	snapshot_next* scan = (snapshot_next*)context;
+	unsigned char* address = scan->addresses->array[index];
+	if (value == NULL)
+		return;
+
+	const snapshot_page* pages = scan->snapshot->pages;
+	if (scan->page < 0 || address < pages[scan->page].address || address >= pages[scan->page].address + SNAPSHOT_PAGE_SIZE) {
+		scan->page = findSnapshotPage(scan->snapshot, address);
+		if (scan->page < 0)
+			return;
+		decodeSnapshotPage(scan->snapshot, &pages[scan->page], scan->old);
+	}
+	SIZE_T offset = (SIZE_T)(address - pages[scan->page].address);
+	if (offset + scan->width <= SNAPSHOT_PAGE_SIZE && scan->match(value, scan->old + offset, scan->mode, scan->delta))
+		scan->addresses->array[scan->kept++] = address;
+}
+
+static int snapshotNextScan(HANDLE hProcess, memory_snapshot* snapshot, vector_uchar_ptr* addressArray, snapshot_matcher match, SIZE_T width, int mode, const void* delta)
+{
+	/*
+	Returns: -1 Memory Allocation Failure
+	*/
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	snapshot_next* scan = (snapshot_next*)malloc(sizeof(snapshot_next));
+	if (buffer == NULL || scan == NULL) {
+		releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+		free(scan);
+		return -1;
+	}
+	scan->addresses = addressArray;
+	scan->kept = 0;
+	scan->snapshot = snapshot;
+	scan->page = -1;
+	scan->match = match;
+	scan->width = width;
+	scan->mode = mode;
+	scan->delta = delta;
+	readCandidates(hProcess, addressArray->array, addressArray->size, width, nextScanGap,
+		buffer, scanBuffers.bufferSize, snapshotNextVisitor, scan);
+	addressArray->size = scan->kept;
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	free(scan);
+	return 1;
+}
+
+MEMSCAN_API int updateSnapshot(HANDLE hProcess, memory_snapshot* snapshot)
+{
+	/*
+	Records the current content of every scannable page again.
+	Returns: -1 Memory Allocation Failure
+	*/
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL)
+		return -1;
+	clearSnapshot(snapshot);
+	region_map* scope = acquireScanScope(hProcess);
+	int result = captureSnapshot(hProcess, snapshot, isScannableRegion, scope, buffer);
+	releaseScanScope(scope);
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	return result;
+}
+
+MEMSCAN_API memory_snapshot* createSnapshot(HANDLE hProcess)
+{
+	memory_snapshot* snapshot = (memory_snapshot*)calloc(1, sizeof(memory_snapshot));
+	if (snapshot == NULL)
+		return NULL;
+	if (updateSnapshot(hProcess, snapshot) < 0) {
+		clearSnapshot(snapshot);
+		free(snapshot);
+		return NULL;
+	}
+	return snapshot;
+}
+
+MEMSCAN_API SIZE_T getSnapshotPageCount(memory_snapshot* snapshot)
+{
+	return snapshot->pageCount;
+}
+
+MEMSCAN_API SIZE_T getSnapshotMemoryUsage(memory_snapshot* snapshot)
+{
+	return snapshotMemoryUsage(snapshot);
+}
+
+MEMSCAN_API void freeSnapshot(memory_snapshot* snapshot)
+{
+	clearSnapshot(snapshot);
+	free(snapshot);
+}
+
+MEMSCAN_API int scanSnapshotINT(HANDLE hProcess, memory_snapshot* snapshot, int mode, int delta, int alignment, vector_uchar_ptr* addresses)
+{
+	SIZE_T stride = scanStride(alignment, sizeof(int));
+	if (stride == 0)
+		return -3;
+	return snapshotScan(hProcess, snapshot, snapshotMatchINT, sizeof(int), stride, mode, &delta, addresses);
+}
+
+MEMSCAN_API int scanSnapshotFLOAT(HANDLE hProcess, memory_snapshot* snapshot, int mode, float delta, int alignment, vector_uchar_ptr* addresses)
+{
+	SIZE_T stride = scanStride(alignment, sizeof(float));
+	if (stride == 0)
+		return -3;
+	return snapshotScan(hProcess, snapshot, snapshotMatchFLOAT, sizeof(float), stride, mode, &delta, addresses);
+}
+
+MEMSCAN_API int scanSnapshotDOUBLE(HANDLE hProcess, memory_snapshot* snapshot, int mode, double delta, int alignment, vector_uchar_ptr* addresses)
+{
+	SIZE_T stride = scanStride(alignment, sizeof(double));
+	if (stride == 0)
+		return -3;
+	return snapshotScan(hProcess, snapshot, snapshotMatchDOUBLE, sizeof(double), stride, mode, &delta, addresses);
+}
+
+MEMSCAN_API int scanNextSnapshotINT(HANDLE hProcess, memory_snapshot* snapshot, vector_uchar_ptr* addressArray, int mode, int delta)
+{
+	return snapshotNextScan(hProcess, snapshot, addressArray, snapshotMatchINT, sizeof(int), mode, &delta);
+}
+
+MEMSCAN_API int scanNextSnapshotFLOAT(HANDLE hProcess, memory_snapshot* snapshot, vector_uchar_ptr* addressArray, int mode, float delta)
+{
+	return snapshotNextScan(hProcess, snapshot, addressArray, snapshotMatchFLOAT, sizeof(float), mode, &delta);
+}
+
+MEMSCAN_API int scanNextSnapshotDOUBLE(HANDLE hProcess, memory_snapshot* snapshot, vector_uchar_ptr* addressArray, int mode, double delta)
+{
+	return snapshotNextScan(hProcess, snapshot, addressArray, snapshotMatchDOUBLE, sizeof(double), mode, &delta);
+}
+MEMSCAN_API vector_uchar_ptr* createAddressArray()
+{
+	vector_uchar_ptr* vector = (vector_uchar_ptr*)malloc(sizeof(vector_uchar_ptr));
+	createVectorUCharPtr(vector);
+	return vector;
+}
+MEMSCAN_API void freeAddressArray(vector_uchar_ptr* address)
+{
+	deleteVectorUCharPtr(address);
+	free(address);
+}
+MEMSCAN_API int filterAddressArray(vector_uchar_ptr* address, int (*keep)(void* context, unsigned char* element), void* context)
+{
+	/*
+	Keeps the addresses for which keep(context, address) returns non zero, in order.
+	Returns the number of addresses left.
+	*/
+	filterVectorUCharPtr(address, keep, context);
+	return address->size;
+}
+
+// Bulk reads and writes
+// readAddressArray/writeAddressArray move the values of a whole address array in
+// one native call. Reads go through readCandidates (coalesced, batched);
+// writes merge runs of exactly adjacent addresses into one transfer, since
+// writing the bytes between two values is not allowed. status, if not NULL, is
+// a bitmap of (count + 7) / 8 bytes: bit (i & 7) of status[i >> 3] is set when
+// element i was transferred.
+
+static void setStatusBit(unsigned char* status, SIZE_T index, int ok)
+{
+	if (status == NULL)
+		return;
+	if (ok)
+		status[index >> 3] |= (unsigned char)(1u << (index & 7));
+	else
+		status[index >> 3] &= (unsigned char)~(1u << (index & 7));
+}
+
+typedef struct {
+	unsigned char* values;
+	SIZE_T width;
+	int read;
+	unsigned char* status;
+} value_export;
+
+static void valueExportVisitor(void* context, SIZE_T index, const unsigned char* value)
+{
+	value_export* out = (value_export*)context;
+	if (value != NULL) {
+		memcpy(out->values + index * out->width, value, out->width);
+		out->read++;
+	}
+	else {
+		memset(out->values + index * out->width, 0, out->width);
+	}
+	setStatusBit(out->status, index, value != NULL);
+}
+
+static int exportValues(HANDLE hProcess, unsigned char* const* addresses, SIZE_T count, SIZE_T width,
+	unsigned char* values, unsigned char* status)
+{
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL)
+		return -1;
+	value_export out = { values, width, 0, status };
+	readCandidates(hProcess, addresses, count, width, nextScanGap,
+		buffer, scanBuffers.bufferSize, valueExportVisitor, &out);
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	return out.read;
+}
+
+MEMSCAN_API int readAddressValues(HANDLE hProcess, vector_uchar_ptr* address, SIZE_T width, unsigned char* values)
+{
+	/*
+	Reads the current width byte value of every address into values[i * width],
+	which must hold address->size * width bytes. Values that cannot be read are zeroed.
+	Returns: -1 Memory Allocation Failure, -3 Invalid Width, else the number of values read
+	*/
+	if (width == 0 || width > 16)
+		return -3;
+	return exportValues(hProcess, address->array, address->size, width, values, NULL);
+}
+
+MEMSCAN_API int readAddressArray(HANDLE hProcess, unsigned char* const* addresses, SIZE_T count, SIZE_T width,
+	unsigned char* values, unsigned char* status)
+{
+	/*
+	Reads count width byte values into values[i * width]; unreadable values are
+	zeroed and their status bit cleared. addresses may point into any address
+	array, e.g. &vector->array[first] for a slice of a scan result.
+	Returns: -1 Memory Allocation Failure, -3 Invalid Width, else the number of values read
+	*/
+	if (width == 0 || width > 16)
+		return -3;
+	return exportValues(hProcess, addresses, count, width, values, status);
+}
+
+MEMSCAN_API int writeAddressArray(HANDLE hProcess, unsigned char* const* addresses, SIZE_T count, SIZE_T width,
+	const unsigned char* values, SIZE_T valueStride, unsigned char* status)
+{
+	/*
+	Writes the width byte value values[i * valueStride] to addresses[i]. A
+	valueStride of 0 writes the same value everywhere.
+	Returns: -1 Memory Allocation Failure, -3 Invalid Width, else the number of values written
+	*/
+	if (width == 0 || width > 16)
+		return -3;
+	unsigned char* buffer = acquireBuffer(&scanBuffers);
+	if (buffer == NULL)
+		return -1;
+	int written = 0;
+	SIZE_T i = 0;
+	while (i < count)
+	{
+		SIZE_T j = i + 1;
+		while (j < count && addresses[j] == addresses[j - 1] + width && (j - i + 1) * width <= scanBuffers.bufferSize)
+			j++;
+
+		int ok;
+		if (j - i == 1) {
+			ok = writeRemote(hProcess, addresses[i], values + i * valueStride, width);
+		}
+		else if (valueStride == width) {
+			ok = writeRemote(hProcess, addresses[i], values + i * width, (j - i) * width);
+		}
+		else {
+			for (SIZE_T k = i; k < j; k++)
+				memcpy(buffer + (k - i) * width, values + k * valueStride, width);
+			ok = writeRemote(hProcess, addresses[i], buffer, (j - i) * width);
+		}
+
+		if (ok) {
+			for (SIZE_T k = i; k < j; k++)
+				setStatusBit(status, k, 1);
+			written += (int)(j - i);
+		}
+		else {
+			// Part of the run is not writable, retry value by value.
+			for (SIZE_T k = i; k < j; k++) {
+				int one = j - i > 1 && writeRemote(hProcess, addresses[k], values + k * valueStride, width);
+				setStatusBit(status, k, one);
+				written += one;
+			}
+		}
+		i = j;
+	}
+	releaseBuffer(&scanBuffers, buffer, getPoolThreadCount());
+	return written;
+}
+// Watch
+// A watcher samples a copy of an address list on its own thread (watcher.h)
+// and queues every value change; the caller drains the queue at its own pace.
+
+MEMSCAN_API memory_watcher* createWatcher(HANDLE hProcess, unsigned char* const* addresses, SIZE_T count, SIZE_T width,
+	unsigned int intervalMicros, SIZE_T capacity)
+{
+	/*
+	Starts sampling count addresses of width (1 to 8) bytes every intervalMicros
+	microseconds, queueing up to capacity change events.
+	Returns NULL on invalid width or allocation failure.
+	*/
+	return createMemoryWatcher(hProcess, addresses, count, width, intervalMicros, capacity);
+}
+MEMSCAN_API void freeWatcher(memory_watcher* watcher)
+{
+	destroyMemoryWatcher(watcher);
+}
+MEMSCAN_API SIZE_T drainWatcher(memory_watcher* watcher, watch_event* events, SIZE_T max)
+{
+	/*
+	Moves up to max queued events, oldest first, into events.
+	Returns the number of events moved.
+	*/
+	return drainWatchEvents(watcher, events, max);
+}
+MEMSCAN_API SIZE_T getWatcherPendingCount(memory_watcher* watcher)
+{
+	return pendingWatchEvents(watcher);
+}
+MEMSCAN_API unsigned long long getWatcherSampleCount(memory_watcher* watcher)
+{
+	return watchSampleCount(watcher);
+}
+MEMSCAN_API unsigned long long getWatcherDroppedCount(memory_watcher* watcher)
+{
+	/*
+	Number of events lost because the queue was full.
+	*/
+	return watchDroppedCount(watcher);
+}
+MEMSCAN_API void setWatcherInterval(memory_watcher* watcher, unsigned int intervalMicros)
+{
+	/*
+	Takes effect after the current wait.
+	*/
+	setWatchInterval(watcher, intervalMicros);
+}
+// Region maps
+// A region map caches the committed regions of a process with their modules
+// (regions.h). Set as the scan scope of a handle it replaces the region walk of
+// its first scans (scanTypedMulti included), pattern and string scans, pointer
+// maps and snapshots; next scans are not affected since they only read their
+// candidates, which already lie in the scope of the scan that found them. A map is not
+// refreshed while a scan limited to it runs.
+
+MEMSCAN_API region_map* createRegionMap(HANDLE hProcess, const region_filter* filter)
+{
+	/*
+	Walks the process once and keeps the committed regions accepted by filter
+	(NULL keeps all of them).
+	Returns NULL on allocation or module list failure, or if the process cannot be queried.
+	*/
+	return buildRegionMap(hProcess, filter);
+}
+MEMSCAN_API region_map* filterRegionMap(const region_map* map, const region_filter* filter)
+{
+	/*
+	Returns a new map with the regions of map that filter also accepts, without
+	walking the process. NULL on allocation failure.
+	*/
+	if (map == NULL || filter == NULL)
+		return NULL;
+	// scopeLock keeps a refresh from swapping the entries while they are copied.
+	poolLockAcquire(&scopeLock);
+	region_map* narrowed = narrowRegionMap(map, filter);
+	poolLockRelease(&scopeLock);
+	return narrowed;
+}
+MEMSCAN_API long long refreshRegionMap(HANDLE hProcess, region_map* map)
+{
+	/*
+	Walks the process again with the filter of the map and flags the regions
+	that are new or changed since the last walk. The new regions are swapped in
+	only if no scan limited to the map is running, the map is unchanged otherwise.
+	Returns: number of regions added, changed or removed, -1 Memory Allocation
+	Failure, -2 Module List Failure, -3 Invalid Map or Map of another Process
+	Returns: -6 Map in Use by a running scan or another refresh
+	*/
+	if (map == NULL || !isRegionMapOf(map, hProcess))
+		return -3;
+	poolLockAcquire(&scopeLock);
+	int busy = map->scans > 0 || map->refreshing;
+	if (!busy)
+		map->refreshing = 1;
+	poolLockRelease(&scopeLock);
+	if (busy)
+		return -6;
+
+	// Scans starting meanwhile walk the current entries, which stay in place until the swap.
+	region_map fresh;
+	long long result = collectRegionUpdate(hProcess, map, &fresh);
+	poolLockAcquire(&scopeLock);
+	map->refreshing = 0;
+	if (result >= 0) {
+		if (map->scans > 0)
+			result = -6;
+		else
+			exchangeRegionEntries(map, &fresh);
+	}
+	poolLockRelease(&scopeLock);
+	free(fresh.entries);
+	free(fresh.modules);
+	return result;
+}
+MEMSCAN_API void freeRegionMap(region_map* map)
+{
+	/*
+	Ends every scope using map. Scans that are still running keep their
+	reference; the memory is freed once the last of them is done.
+	*/
+	if (map == NULL)
+		return;
+	poolLockAcquire(&scopeLock);
+	removeScanScopes(NULL, map);
+	dropRegionMap(map);
+	poolLockRelease(&scopeLock);
+}
+MEMSCAN_API SIZE_T getRegionCount(const region_map* map)
+{
+	return map->count;
+}
+MEMSCAN_API unsigned long long getRegionMapSize(const region_map* map)
+{
+	/*
+	Returns the total number of bytes covered by the regions of map.
+	*/
+	unsigned long long total = 0;
+	poolLockAcquire(&scopeLock);
+	for (SIZE_T i = 0; i < map->count; i++)
+		total += map->entries[i].size;
+	poolLockRelease(&scopeLock);
+	return total;
+}
+MEMSCAN_API int getRegion(const region_map* map, SIZE_T index, unsigned char** base, SIZE_T* size,
+	DWORD* protect, DWORD* type, int* changed, char* module, SIZE_T moduleSize)
+{
+	/*
+	Copies region index of map; module receives the module name ("" when the
+	region is not part of a module), truncated to moduleSize bytes.
+	Returns: 1 on success, -3 Invalid Index
+	*/
+	poolLockAcquire(&scopeLock);
+	if (index >= map->count) {
+		poolLockRelease(&scopeLock);
+		return -3;
+	}
+	const region_entry* entry = &map->entries[index];
+	*base = entry->base;
+	*size = entry->size;
+	*protect = entry->protect;
+	*type = entry->type;
+	*changed = entry->changed;
+	if (module != NULL && moduleSize > 0) {
+		const char* name = entry->module < 0 ? "" : map->modules[entry->module].name;
+		SIZE_T length = strlen(name);
+		if (length >= moduleSize)
+			length = moduleSize - 1;
+		memcpy(module, name, length);
+		module[length] = '\0';
+	}
+	poolLockRelease(&scopeLock);
+	return 1;
+}
+MEMSCAN_API int setScanRegionMap(HANDLE hProcess, region_map* map)
+{
+	/*
+	Limits the first scans and snapshots of hProcess to the regions of map, NULL
+	scans the whole process again. map must have been created for the process
+	of hProcess. The scope holds a reference to map until it is replaced, the
+	map is freed or the handle is closed.
+	Returns: 1 on success, -1 Memory Allocation Failure
+	Returns: -3 Invalid Handle or Map of another Process
+	*/
+	if (hProcess == NULL || (map != NULL && !isRegionMapOf(map, hProcess)))
+		return -3;
+	poolLockAcquire(&scopeLock);
+	removeScanScopes(hProcess, NULL);
+	if (map != NULL) {
+		if (scanScopeCount == scanScopeCapacity) {
+			SIZE_T capacity = scanScopeCapacity ? scanScopeCapacity * 2 : 8;
+			scan_scope* grown = (scan_scope*)realloc(scanScopes, capacity * sizeof(scan_scope));
+			if (grown == NULL) {
+				poolLockRelease(&scopeLock);
+				return -1;
+			}
+			scanScopes = grown;
+			scanScopeCapacity = capacity;
+		}
+		scanScopes[scanScopeCount].hProcess = hProcess;
+		scanScopes[scanScopeCount].map = map;
+		scanScopeCount++;
+		map->references++;
+	}
+	poolLockRelease(&scopeLock);
+	return 1;
+}
+
+// Freeing Data
+MEMSCAN_API void freeINTAddress(int* data)
+{
+	free(data);
+}
+MEMSCAN_API void freeFLOATAddress(float* data)
+{
+	free(data);
+}
+MEMSCAN_API void freeDOUBLEAddress(double* data)
+{
+	free(data);
+}
+MEMSCAN_API HANDLE getHandleByPID(int pid)
+{
+	return openMemorySource(pid);
+}
+MEMSCAN_API int closeHandle(HANDLE hProcess)
+{
+	// A later handle may get the same value, so the scope ends here.
+	poolLockAcquire(&scopeLock);
+	removeScanScopes(hProcess, NULL);
+	poolLockRelease(&scopeLock);
+	return closeMemorySource(hProcess);
+}
+// Scan settings
+MEMSCAN_API int getScanISA()
+{
+	/*
+	Returns: 0 scalar, 1 SSE2, 2 AVX2, 3 AVX-512
+	*/
+	return currentScanISA();
+}
+MEMSCAN_API int setScanISA(int isa)
+{
+	/*
+	Forces the kernel level used by the scans, clamped to what the CPU supports.
+	Pass -1 to go back to the detected level. Returns the level now in use.
+	*/
+	return forceScanISA(isa);
+}
+
+MEMSCAN_API int getScanThreadCount()
+{
+	return getPoolThreadCount();
+}
+MEMSCAN_API int setScanThreadCount(int threads)
+{
+	/*
+	Number of threads used by scanINT, scanFLOAT and scanDOUBLE. 1 (the default)
+	keeps the scans serial, 0 uses one thread per logical CPU.
+	Returns the thread count now in use.
+	*/
+	return setPoolThreadCount(threads);
+}
+MEMSCAN_API SIZE_T getNextScanGap()
+{
+	return nextScanGap;
+}
+MEMSCAN_API SIZE_T setNextScanGap(SIZE_T gap)
+{
+	/*
+	Largest distance in bytes between two candidates that scanNext* still reads
+	with a single call. 0 only merges touching candidates. Returns the previous gap.
+	*/
+	SIZE_T previous = nextScanGap;
+	nextScanGap = gap;
+	return previous;
+}
+MEMSCAN_API void releaseScanBuffers()
+{
+	/*
+	Frees the read buffers kept around between scans.
+	*/
+	trimBufferPool(&scanBuffers);
+}
+MEMSCAN_API int setScanStats(int enable)
+{
+	/*
+	Turns scan telemetry on (1) or off (0). While it is on every scan and next
+	scan records a scan_stats, see getLastScanStats. Returns the previous setting.
+	*/
+	int previous = scanStatsEnabled;
+	scanStatsEnabled = enable ? 1 : 0;
+	return previous;
+}
+MEMSCAN_API int getScanStatsEnabled()
+{
+	return scanStatsEnabled;
+}
+MEMSCAN_API void getLastScanStats(scan_stats* out)
+{
+	/*
+	Copies the telemetry of the last scan that finished while it was on, from any
+	thread. All zero if there was none.
+	*/
+	copyLastScanStats(out);
+}
@@ -0,0 +1,203 @@
+/*
+ * scantask.h
+ *
+ * Description:
+ * Runs a scan on a thread of its own, so the caller can poll its progress,
+ * cancel it, wait for it with a timeout and take the hits of finished chunks
+ * while the rest of the scan is still running.
+ *
+ * The scan reports to the scan_progress of its task: the total amount of work
+ * once its chunks are known (scanProgressBegin), then every finished chunk
+ * with its size and its hits (scanProgressChunk). The scan checks
+ * scanCancelled() before each chunk, so a cancel takes effect as soon as the
+ * chunks in flight are done.
+ *
+ * With streaming enabled the hits of every chunk are appended to one list
+ * under a lock and drainScanStream() takes them from the front. Chunks finish
+ * in any order on several workers, so the stream is not sorted by address;
+ * the final result of the scan still is.
+ *
+ * Usage:
+ * - int run(void* args, scan_progress* progress) { ... return result; }
+ * - scan_task* task = startScanTask(run, args, 1);   // args is freed with the task
+ * - SIZE_T n = drainScanStream(task, hits, 4096);    // from any one consumer thread
+ * - if (waitScanFinished(task, 100000)) result = task->result;
+ * - destroyScanTask(task);                           // cancels and joins first
+ *
+ * Note:
+ * - The counters are updated without ordering; read them as a snapshot of
+ *   the progress, not as a consistent set.
+ * - Include `watcher.h` and `stats.h` before this header.
+ */
+
+#ifndef SCANTASK_H
+#define SCANTASK_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "watcher.h"
+#include "stats.h"
+
+typedef struct {
+    volatile unsigned long long bytesTotal;
+    volatile unsigned long long bytesDone;
+    volatile unsigned long long chunksTotal;
+    volatile unsigned long long chunksDone;
+    volatile unsigned long long hits;
+    volatile int cancelled;
+
+    int streaming;
+    volatile int streamFailed;
+    pool_lock streamLock;
+    unsigned char** stream;
+    SIZE_T streamRead;
+    SIZE_T streamSize;
+    SIZE_T streamCapacity;
+} scan_progress;
+
+typedef int (*scan_task_run)(void* args, scan_progress* progress);
+
+typedef struct {
+    scan_progress progress;
+    scan_task_run run;
+    void* args;
+    int result;
+    watch_signal finished;
+    pool_thread thread;
+} scan_task;
+
+static inline int scanCancelled(scan_progress* progress) {
+    return progress != NULL && WATCH_LOAD(progress->cancelled);
+}
+
+static void scanProgressBegin(scan_progress* progress, unsigned long long chunks, unsigned long long bytes) {
+    WATCH_STORE(progress->chunksTotal, chunks);
+    WATCH_STORE(progress->bytesTotal, bytes);
+}
+
+// Counts a finished chunk of `bytes` bytes and streams its hits.
+static void scanProgressChunk(scan_progress* progress, SIZE_T bytes, unsigned char* const* hits, SIZE_T count) {
+    if (count > 0 && progress->streaming) {
+        poolLockAcquire(&progress->streamLock);
+        if (progress->streamRead > 0) {
+            progress->streamSize -= progress->streamRead;
+            memmove(progress->stream, progress->stream + progress->streamRead, progress->streamSize * sizeof(unsigned char*));
+            progress->streamRead = 0;
+        }
+        if (progress->streamSize + count > progress->streamCapacity) {
+            SIZE_T capacity = progress->streamCapacity ? progress->streamCapacity : 4096;
+            while (capacity < progress->streamSize + count)
+                capacity *= 2;
+            unsigned char** grown = (unsigned char**)realloc(progress->stream, capacity * sizeof(unsigned char*));
+            if (grown != NULL) {
+                progress->stream = grown;
+                progress->streamCapacity = capacity;
+            }
+        }
+        // A stream that cannot grow loses these hits; the result of the scan does not.
+        if (progress->streamSize + count <= progress->streamCapacity) {
+            memcpy(progress->stream + progress->streamSize, hits, count * sizeof(unsigned char*));
+            progress->streamSize += count;
+        }
+        else {
+            WATCH_STORE(progress->streamFailed, 1);
+        }
+        poolLockRelease(&progress->streamLock);
+    }
+    scanCounterAdd(&progress->hits, count);
+    scanCounterAdd(&progress->bytesDone, bytes);
+    scanCounterAdd(&progress->chunksDone, 1);
+}
+
+static POOL_THREAD_RETURN scanTaskMain(void* param) {
+    scan_task* task = (scan_task*)param;
+    task->result = task->run(task->args, &task->progress);
+    watchSignalSet(&task->finished);
+    return 0;
+}
+
+static void freeScanTaskMemory(scan_task* task) {
+    free(task->progress.stream);
+    free(task->args);
+    free(task);
+}
+
+/*
+ * Starts run(args, progress) on a new thread. args must come from malloc and
+ * belongs to the task from now on, also when the task cannot be started.
+ * Returns NULL if memory or the thread cannot be allocated.
+ */
+static scan_task* startScanTask(scan_task_run run, void* args, int streaming) {
+    scan_task* task = (scan_task*)calloc(1, sizeof(scan_task));
+    if (task == NULL) {
+        free(args);
+        return NULL;
+    }
+    task->run = run;
+    task->args = args;
+    task->progress.streaming = streaming;
+    if (!watchSignalInit(&task->finished)) {
+        freeScanTaskMemory(task);
+        return NULL;
+    }
+    poolLockInit(&task->progress.streamLock);
+#ifdef _WIN32
+    task->thread = CreateThread(NULL, 0, scanTaskMain, task, 0, NULL);
+    int started = task->thread != NULL;
+#else
+    int started = pthread_create(&task->thread, NULL, scanTaskMain, task) == 0;
+#endif
+    if (!started) {
+        poolLockDestroy(&task->progress.streamLock);
+        watchSignalDestroy(&task->finished);
+        freeScanTaskMemory(task);
+        return NULL;
+    }
+    return task;
+}
+
+static void signalScanCancel(scan_task* task) {
+    WATCH_STORE(task->progress.cancelled, 1);
+}
+
+// Waits up to `micros` microseconds. Returns 1 once the scan has finished; task->result is then valid.
+static int waitScanFinished(scan_task* task, unsigned int micros) {
+    return watchSignalWait(&task->finished, micros);
+}
+
+// Copies up to max streamed hits to out, in the order the chunks finished. Returns the number copied.
+static SIZE_T drainScanStream(scan_task* task, unsigned char** out, SIZE_T max) {
+    scan_progress* progress = &task->progress;
+    poolLockAcquire(&progress->streamLock);
+    SIZE_T available = progress->streamSize - progress->streamRead;
+    SIZE_T n = available < max ? available : max;
+    if (n > 0)
+        memcpy(out, progress->stream + progress->streamRead, n * sizeof(unsigned char*));
+    progress->streamRead += n;
+    poolLockRelease(&progress->streamLock);
+    return n;
+}
+
+static SIZE_T pendingScanStream(scan_task* task) {
+    scan_progress* progress = &task->progress;
+    poolLockAcquire(&progress->streamLock);
+    SIZE_T pending = progress->streamSize - progress->streamRead;
+    poolLockRelease(&progress->streamLock);
+    return pending;
+}
+
+// Cancels the scan, waits for its thread and frees the task.
+static void destroyScanTask(scan_task* task) {
+    signalScanCancel(task);
+#ifdef _WIN32
+    WaitForSingleObject(task->thread, INFINITE);
+    CloseHandle(task->thread);
+#else
+    pthread_join(task->thread, NULL);
+#endif
+    poolLockDestroy(&task->progress.streamLock);
+    watchSignalDestroy(&task->finished);
+    freeScanTaskMemory(task);
+}
+
+#endif // SCANTASK_H
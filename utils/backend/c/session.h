@@ -0,0 +1,252 @@
+/*
+ * session.h
+ *
+ * Description:
+ * A scan session keeps the candidates of a scan in a memory mapped file
+ * instead of the heap, optionally with the last value read at each of them.
+ * The set can outgrow RAM (the OS pages the mapping in and out as the scans
+ * walk it), outlives the process that made it and can be opened again later,
+ * without rescanning and without loading it, against the same run of the
+ * target.
+ *
+ * File layout (native byte order):
+ * - session_header, 64 bytes
+ * - count records of recordSize bytes: the address as 8 bytes, followed by
+ *   valueWidth bytes of the last value read if the session stores values
+ *
+ * The file grows by doubling while a scan appends (reserveSessionRecords) and
+ * is cut back to the records in use when the session is closed. A next scan
+ * compacts the records in place, so the header is marked dirty while it runs;
+ * a session left dirty (the process died mid scan) is refused by
+ * openSessionFile().
+ *
+ * A session records the pid and start time of the process it was taken from
+ * (remoteProcessIdentity), so a reused pid is not mistaken for the same run.
+ *
+ * Usage:
+ * - scan_session s; createSessionFile(&s, path, type, width, pid, started);
+ * - reserveSessionRecords(&s, s.header->count + n); memcpy(sessionRecord(&s, i), ...);
+ * - flushSessionFile(&s); closeSessionFile(&s);
+ * - openSessionFile(&s, path);
+ *
+ * Note:
+ * - Include `memsource.h` before this header.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <string.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SESSION_FILE_MAGIC 0x53534553u   // "SESS"
+#define SESSION_FILE_VERSION 1u
+#define SESSION_GROW_RECORDS 65536
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    int type;                   // SCAN_TYPE_* of the values
+    unsigned int valueWidth;    // bytes of value per record, 0 if values are not stored
+    int pid;
+    unsigned int dirty;         // set while a scan rewrites the records
+    unsigned long long started; // start time of the process, see remoteProcessIdentity
+    unsigned long long count;   // records in use
+    unsigned long long scans;   // scans applied so far
+    unsigned long long reserved[2];
+} session_header;
+
+typedef struct {
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+    unsigned char* view;
+    unsigned long long mapped;  // bytes of the file mapped at view
+    session_header* header;     // the start of view
+    SIZE_T recordSize;
+} scan_session;
+
+static inline unsigned char* sessionRecord(const scan_session* session, unsigned long long index) {
+    return session->view + sizeof(session_header) + (SIZE_T)index * session->recordSize;
+}
+
+static inline unsigned long long sessionFileSize(const scan_session* session, unsigned long long records) {
+    return sizeof(session_header) + records * session->recordSize;
+}
+
+// Sets the file to size bytes (growing only) and maps all of it. Returns 1 on success, 0 otherwise.
+static int mapSessionFile(scan_session* session, unsigned long long size) {
+    if (size > (SIZE_T)-1)
+        return 0;
+#ifdef _WIN32
+    session->mapping = CreateFileMappingA(session->file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL);
+    if (session->mapping == NULL)
+        return 0;
+    session->view = (unsigned char*)MapViewOfFile(session->mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)size);
+    if (session->view == NULL) {
+        CloseHandle(session->mapping);
+        session->mapping = NULL;
+        return 0;
+    }
+#else
+    struct stat info;
+    if (fstat(session->fd, &info) != 0 || ((unsigned long long)info.st_size < size && ftruncate(session->fd, (off_t)size) != 0))
+        return 0;
+    void* view = mmap(NULL, (SIZE_T)size, PROT_READ | PROT_WRITE, MAP_SHARED, session->fd, 0);
+    if (view == MAP_FAILED)
+        return 0;
+    session->view = (unsigned char*)view;
+#endif
+    session->mapped = size;
+    session->header = (session_header*)session->view;
+    return 1;
+}
+
+static void unmapSessionFile(scan_session* session) {
+    if (session->view == NULL)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(session->view);
+    CloseHandle(session->mapping);
+    session->mapping = NULL;
+#else
+    munmap(session->view, (SIZE_T)session->mapped);
+#endif
+    session->view = NULL;
+    session->header = NULL;
+    session->mapped = 0;
+}
+
+static void closeSessionHandle(scan_session* session) {
+#ifdef _WIN32
+    CloseHandle(session->file);
+#else
+    close(session->fd);
+#endif
+}
+
+// Returns: 1 on success, 0 if the file could not be created.
+static int createSessionFile(scan_session* session, const char* path, int type, unsigned int valueWidth,
+    int pid, unsigned long long started) {
+    memset(session, 0, sizeof(*session));
+    session->recordSize = sizeof(unsigned long long) + valueWidth;
+#ifdef _WIN32
+    session->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (session->file == INVALID_HANDLE_VALUE)
+        return 0;
+#else
+    session->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (session->fd < 0)
+        return 0;
+#endif
+    if (!mapSessionFile(session, sessionFileSize(session, SESSION_GROW_RECORDS))) {
+        closeSessionHandle(session);
+        return 0;
+    }
+    session_header* header = session->header;
+    memset(header, 0, sizeof(*header));
+    header->magic = SESSION_FILE_MAGIC;
+    header->version = SESSION_FILE_VERSION;
+    header->type = type;
+    header->valueWidth = valueWidth;
+    header->pid = pid;
+    header->started = started;
+    return 1;
+}
+
+// Returns: 1 on success, 0 if the file is missing, not a session or was left dirty.
+static int openSessionFile(scan_session* session, const char* path) {
+    memset(session, 0, sizeof(*session));
+    unsigned long long size;
+#ifdef _WIN32
+    LARGE_INTEGER length;
+    session->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (session->file == INVALID_HANDLE_VALUE)
+        return 0;
+    if (!GetFileSizeEx(session->file, &length)) {
+        closeSessionHandle(session);
+        return 0;
+    }
+    size = (unsigned long long)length.QuadPart;
+#else
+    struct stat info;
+    session->fd = open(path, O_RDWR | O_CLOEXEC);
+    if (session->fd < 0)
+        return 0;
+    if (fstat(session->fd, &info) != 0) {
+        closeSessionHandle(session);
+        return 0;
+    }
+    size = (unsigned long long)info.st_size;
+#endif
+    if (size < sizeof(session_header) || !mapSessionFile(session, size)) {
+        closeSessionHandle(session);
+        return 0;
+    }
+    const session_header* header = session->header;
+    session->recordSize = sizeof(unsigned long long) + header->valueWidth;
+    if (header->magic != SESSION_FILE_MAGIC || header->version != SESSION_FILE_VERSION || header->dirty
+        || header->valueWidth > sizeof(unsigned long long)
+        || header->count > (size - sizeof(session_header)) / session->recordSize) {
+        unmapSessionFile(session);
+        closeSessionHandle(session);
+        return 0;
+    }
+    return 1;
+}
+
+// Makes room for at least count records. Returns 1 on success, 0 if the file cannot grow.
+static int reserveSessionRecords(scan_session* session, unsigned long long count) {
+    unsigned long long size = sessionFileSize(session, count);
+    if (size <= session->mapped)
+        return 1;
+    unsigned long long previous = session->mapped;
+    unsigned long long grown = previous * 2 > size ? previous * 2 : size;
+    unmapSessionFile(session);
+    if (mapSessionFile(session, grown) || mapSessionFile(session, size))
+        return 1;
+    // Map the old size again so the session stays usable; view is NULL if even that fails.
+    mapSessionFile(session, previous);
+    return 0;
+}
+
+// Writes the mapped pages and the file metadata to disk. Returns 1 on success, 0 otherwise.
+static int flushSessionFile(scan_session* session) {
+#ifdef _WIN32
+    return FlushViewOfFile(session->view, 0) && FlushFileBuffers(session->file);
+#else
+    return msync(session->view, (SIZE_T)session->mapped, MS_SYNC) == 0;
+#endif
+}
+
+// Unmaps the file, cuts it back to the records in use and closes it.
+static void closeSessionFile(scan_session* session) {
+    if (session->view == NULL) {
+        // A failed remap left nothing to cut back.
+        closeSessionHandle(session);
+        return;
+    }
+    unsigned long long size = sessionFileSize(session, session->header->count);
+    unmapSessionFile(session);
+#ifdef _WIN32
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)size;
+    if (SetFilePointerEx(session->file, end, NULL, FILE_BEGIN))
+        SetEndOfFile(session->file);
+#else
+    if (ftruncate(session->fd, (off_t)size) != 0) {
+        // A longer file is still a valid session.
+    }
+#endif
+    closeSessionHandle(session);
+}
+
+#endif // SESSION_H
@@ -0,0 +1,415 @@
+/*
+ * snapshot.h
+ *
+ * Description:
+ * Compressed snapshots of the writable memory of a process, used for scans
+ * where the starting value is unknown ("changed", "increased", ...).
+ *
+ * A snapshot records every readable page of the scannable regions. Pages are
+ * stored in one of three encodings:
+ * - SNAPSHOT_PAGE_ZERO   : page is all zero, nothing is stored.
+ * - SNAPSHOT_PAGE_SPARSE : a 128 byte bitmap of the non zero 4 byte words,
+ *                          followed by those words.
+ * - SNAPSHOT_PAGE_RAW    : the page as is, when sparse would not be smaller.
+ * Identical encoded pages are stored once and shared (deduplicated through a
+ * hash of the encoded bytes). Encoded data lives in fixed 16 MB blocks, so
+ * growing a snapshot never copies what is already stored.
+ *
+ * Comparisons walk the snapshot page list in runs of contiguous pages, read
+ * the live memory of each run with readWindow() and compare it page by page
+ * with the decoded snapshot page. Pages whose bytes did not change are
+ * skipped with a single memcmp unless the mode needs unchanged values.
+ *
+ * Modes (SNAPSHOT_*):
+ * - CHANGED / UNCHANGED       : bitwise comparison of the value.
+ * - INCREASED / DECREASED     : live > old / live < old.
+ * - INCREASED_BY / DECREASED_BY : live == old + delta / live == old - delta.
+ *
+ * Note:
+ * - Values are compared every `stride` bytes but only within a page, so with
+ *   a stride below sizeof(T) the few values crossing a page are not reported.
+ * - captureSnapshot() records the regions of a region map (regions.h) instead
+ *   of the whole process when one is given.
+ * - Include `reader.h`, `regions.h` and `vectors.h` before this header.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "vectors.h"
+#include "reader.h"
+
+#define SNAPSHOT_PAGE_SIZE READER_PAGE_SIZE
+#define SNAPSHOT_WORDS (SNAPSHOT_PAGE_SIZE / 4)
+#define SNAPSHOT_BITMAP_BYTES (SNAPSHOT_WORDS / 8)
+#define SNAPSHOT_BLOCK_SIZE (16 * 1024 * 1024)
+
+enum {
+    SNAPSHOT_PAGE_ZERO = 0,
+    SNAPSHOT_PAGE_SPARSE = 1,
+    SNAPSHOT_PAGE_RAW = 2
+};
+
+enum {
+    SNAPSHOT_CHANGED = 0,
+    SNAPSHOT_UNCHANGED = 1,
+    SNAPSHOT_INCREASED = 2,
+    SNAPSHOT_DECREASED = 3,
+    SNAPSHOT_INCREASED_BY = 4,
+    SNAPSHOT_DECREASED_BY = 5
+};
+
+typedef struct {
+    unsigned char* address;
+    unsigned long long hash;
+    SIZE_T location;
+    unsigned short length;
+    unsigned char encoding;
+} snapshot_page;
+
+typedef struct {
+    snapshot_page* pages;
+    SIZE_T pageCount;
+    SIZE_T pageCapacity;
+    unsigned char** blocks;
+    SIZE_T blockCount;
+    SIZE_T blockUsed;
+    SIZE_T* slots;
+    SIZE_T slotCount;
+    SIZE_T slotUsed;
+    SIZE_T storedBytes;
+} memory_snapshot;
+
+// Storage
+
+static unsigned long long hashSnapshotBytes(const unsigned char* data, SIZE_T length) {
+    unsigned long long hash = 0x9E3779B97F4A7C15ull ^ length;
+    SIZE_T i = 0;
+    for (; i + 8 <= length; i += 8) {
+        unsigned long long word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; i++)
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+static const unsigned char* snapshotData(const memory_snapshot* snapshot, const snapshot_page* page) {
+    return snapshot->blocks[page->location / SNAPSHOT_BLOCK_SIZE] + page->location % SNAPSHOT_BLOCK_SIZE;
+}
+
+// Returns the encoded length and sets *encoding. out must hold SNAPSHOT_PAGE_SIZE bytes.
+static SIZE_T encodeSnapshotPage(const unsigned char* page, unsigned char* out, unsigned char* encoding) {
+    SIZE_T count = 0;
+    memset(out, 0, SNAPSHOT_BITMAP_BYTES);
+    for (int i = 0; i < SNAPSHOT_WORDS; i++) {
+        unsigned int word;
+        memcpy(&word, page + i * 4, 4);
+        if (word == 0)
+            continue;
+        if (SNAPSHOT_BITMAP_BYTES + (count + 1) * 4 >= SNAPSHOT_PAGE_SIZE) {
+            memcpy(out, page, SNAPSHOT_PAGE_SIZE);
+            *encoding = SNAPSHOT_PAGE_RAW;
+            return SNAPSHOT_PAGE_SIZE;
+        }
+        out[i >> 3] |= (unsigned char)(1u << (i & 7));
+        memcpy(out + SNAPSHOT_BITMAP_BYTES + count * 4, &word, 4);
+        count++;
+    }
+    *encoding = count ? SNAPSHOT_PAGE_SPARSE : SNAPSHOT_PAGE_ZERO;
+    return count ? SNAPSHOT_BITMAP_BYTES + count * 4 : 0;
+}
+
+static void decodeSnapshotPage(const memory_snapshot* snapshot, const snapshot_page* page, unsigned char* out) {
+    const unsigned char* data = snapshotData(snapshot, page);
+    if (page->encoding == SNAPSHOT_PAGE_ZERO) {
+        memset(out, 0, SNAPSHOT_PAGE_SIZE);
+        return;
+    }
+    if (page->encoding == SNAPSHOT_PAGE_RAW) {
+        memcpy(out, data, SNAPSHOT_PAGE_SIZE);
+        return;
+    }
+    const unsigned char* words = data + SNAPSHOT_BITMAP_BYTES;
+    for (int i = 0; i < SNAPSHOT_BITMAP_BYTES; i++) {
+        unsigned char bits = data[i];
+        if (bits == 0) {
+            memset(out + i * 32, 0, 32);
+            continue;
+        }
+        for (int b = 0; b < 8; b++) {
+            if (bits & (1u << b)) {
+                memcpy(out + (i * 8 + b) * 4, words, 4);
+                words += 4;
+            }
+            else {
+                memset(out + (i * 8 + b) * 4, 0, 4);
+            }
+        }
+    }
+}
+
+static int growSnapshotSlots(memory_snapshot* snapshot) {
+    SIZE_T count = snapshot->slotCount ? snapshot->slotCount * 2 : 4096;
+    SIZE_T* slots = (SIZE_T*)calloc(count, sizeof(SIZE_T));
+    if (slots == NULL)
+        return -1;
+    for (SIZE_T i = 0; i < snapshot->slotCount; i++) {
+        SIZE_T entry = snapshot->slots[i];
+        if (entry == 0)
+            continue;
+        SIZE_T slot = (SIZE_T)snapshot->pages[entry - 1].hash & (count - 1);
+        while (slots[slot])
+            slot = (slot + 1) & (count - 1);
+        slots[slot] = entry;
+    }
+    free(snapshot->slots);
+    snapshot->slots = slots;
+    snapshot->slotCount = count;
+    return 1;
+}
+
+// Stores the encoded page and sets page->location, pointing at an identical
+// earlier page instead when there is one.
+static int storeSnapshotBytes(memory_snapshot* snapshot, snapshot_page* page, const unsigned char* encoded) {
+    if (snapshot->slotUsed * 2 >= snapshot->slotCount && growSnapshotSlots(snapshot) < 0)
+        return -1;
+
+    page->hash = hashSnapshotBytes(encoded, page->length);
+    SIZE_T slot = (SIZE_T)page->hash & (snapshot->slotCount - 1);
+    while (snapshot->slots[slot]) {
+        const snapshot_page* other = &snapshot->pages[snapshot->slots[slot] - 1];
+        if (other->hash == page->hash && other->length == page->length && other->encoding == page->encoding
+            && memcmp(snapshotData(snapshot, other), encoded, page->length) == 0) {
+            page->location = other->location;
+            return 1;
+        }
+        slot = (slot + 1) & (snapshot->slotCount - 1);
+    }
+
+    if (snapshot->blockCount == 0 || snapshot->blockUsed + page->length > SNAPSHOT_BLOCK_SIZE) {
+        unsigned char** blocks = (unsigned char**)realloc(snapshot->blocks, (snapshot->blockCount + 1) * sizeof(unsigned char*));
+        if (blocks == NULL)
+            return -1;
+        snapshot->blocks = blocks;
+        blocks[snapshot->blockCount] = (unsigned char*)malloc(SNAPSHOT_BLOCK_SIZE);
+        if (blocks[snapshot->blockCount] == NULL)
+            return -1;
+        snapshot->blockCount++;
+        snapshot->blockUsed = 0;
+    }
+    page->location = (snapshot->blockCount - 1) * SNAPSHOT_BLOCK_SIZE + snapshot->blockUsed;
+    memcpy(snapshot->blocks[snapshot->blockCount - 1] + snapshot->blockUsed, encoded, page->length);
+    snapshot->blockUsed += page->length;
+    snapshot->storedBytes += page->length;
+    snapshot->slots[slot] = snapshot->pageCount + 1;
+    snapshot->slotUsed++;
+    return 1;
+}
+
+static int addSnapshotPage(memory_snapshot* snapshot, unsigned char* address, const unsigned char* data, unsigned char* scratch) {
+    if (snapshot->pageCount == snapshot->pageCapacity) {
+        SIZE_T capacity = snapshot->pageCapacity ? snapshot->pageCapacity * 2 : 1024;
+        snapshot_page* pages = (snapshot_page*)realloc(snapshot->pages, capacity * sizeof(snapshot_page));
+        if (pages == NULL)
+            return -1;
+        snapshot->pages = pages;
+        snapshot->pageCapacity = capacity;
+    }
+    snapshot_page* page = &snapshot->pages[snapshot->pageCount];
+    page->address = address;
+    page->length = (unsigned short)encodeSnapshotPage(data, scratch, &page->encoding);
+    page->location = 0;
+    page->hash = 0;
+    if (page->encoding != SNAPSHOT_PAGE_ZERO && storeSnapshotBytes(snapshot, page, scratch) < 0)
+        return -1;
+    snapshot->pageCount++;
+    return 1;
+}
+
+static void clearSnapshot(memory_snapshot* snapshot) {
+    for (SIZE_T i = 0; i < snapshot->blockCount; i++)
+        free(snapshot->blocks[i]);
+    free(snapshot->blocks);
+    free(snapshot->pages);
+    free(snapshot->slots);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+// Bytes held by the snapshot: encoded pages plus the page table and hash slots.
+static SIZE_T snapshotMemoryUsage(const memory_snapshot* snapshot) {
+    return snapshot->blockCount * SNAPSHOT_BLOCK_SIZE + snapshot->pageCapacity * sizeof(snapshot_page)
+        + snapshot->slotCount * sizeof(SIZE_T);
+}
+
+// Capture
+
+typedef struct {
+    memory_snapshot* snapshot;
+    unsigned char scratch[SNAPSHOT_PAGE_SIZE];
+    int failed;
+} snapshot_capture;
+
+static void captureVisitor(void* context, const unsigned char* data, SIZE_T length, unsigned char* remote) {
+    snapshot_capture* capture = (snapshot_capture*)context;
+    for (SIZE_T offset = 0; offset + SNAPSHOT_PAGE_SIZE <= length && !capture->failed; offset += SNAPSHOT_PAGE_SIZE) {
+        if (addSnapshotPage(capture->snapshot, remote + offset, data + offset, capture->scratch) < 0)
+            capture->failed = 1;
+    }
+}
+
+/*
+ * Records every readable page of the regions accepted by isScannable, taken
+ * from scope or, if it is NULL, from the whole process.
+ * Returns: 1 on success, -1 Memory Allocation Failure.
+ */
+static int captureSnapshot(HANDLE hProcess, memory_snapshot* snapshot, int (*isScannable)(const MEMORY_BASIC_INFORMATION*),
+    const region_map* scope, unsigned char* buffer) {
+    snapshot_capture* capture = (snapshot_capture*)malloc(sizeof(snapshot_capture));
+    if (capture == NULL)
+        return -1;
+    capture->snapshot = snapshot;
+    capture->failed = 0;
+
+    scan_region_walk walk;
+    MEMORY_BASIC_INFORMATION mbi;
+    beginScanRegionWalk(&walk, hProcess, scope);
+    while (!capture->failed && nextScanRegion(&walk, &mbi)) {
+        if (isScannable(&mbi)) {
+            for (SIZE_T offset = 0; offset < mbi.RegionSize && !capture->failed; offset += SCAN_WINDOW_SIZE) {
+                SIZE_T length = mbi.RegionSize - offset < SCAN_WINDOW_SIZE ? mbi.RegionSize - offset : SCAN_WINDOW_SIZE;
+                readWindow(hProcess, (unsigned char*)mbi.BaseAddress + offset, length, buffer, captureVisitor, capture);
+            }
+        }
+    }
+    endScanRegionWalk(&walk);
+    int result = capture->failed ? -1 : 1;
+    free(capture);
+    return result;
+}
+
+// Comparison
+
+#define DEFINE_SNAPSHOT_MATCH(NAME, T, BITS)                                                  \
+    static inline int NAME(const unsigned char* live, const unsigned char* old, int mode,   \
+        const void* delta) {                                                                \
+        T now, before;                                                                      \
+        memcpy(&now, live, sizeof(T));                                                      \
+        memcpy(&before, old, sizeof(T));                                                    \
+        switch (mode) {                                                                     \
+        case SNAPSHOT_CHANGED:                                                              \
+            return memcmp(live, old, sizeof(T)) != 0;                                       \
+        case SNAPSHOT_UNCHANGED:                                                            \
+            return memcmp(live, old, sizeof(T)) == 0;                                       \
+        case SNAPSHOT_INCREASED:                                                            \
+            return now > before;                                                            \
+        case SNAPSHOT_DECREASED:                                                            \
+            return now < before;                                                            \
+        case SNAPSHOT_INCREASED_BY:                                                         \
+            return now == (T)((BITS)before + (BITS)*(const T*)delta);                       \
+        case SNAPSHOT_DECREASED_BY:                                                         \
+            return now == (T)((BITS)before - (BITS)*(const T*)delta);                       \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+// Integer arithmetic goes through unsigned so that overflow wraps like the target's would.
+DEFINE_SNAPSHOT_MATCH(snapshotMatchINT, int, unsigned int)
+DEFINE_SNAPSHOT_MATCH(snapshotMatchFLOAT, float, float)
+DEFINE_SNAPSHOT_MATCH(snapshotMatchDOUBLE, double, double)
+
+typedef int (*snapshot_matcher)(const unsigned char* live, const unsigned char* old, int mode, const void* delta);
+
+typedef struct {
+    const memory_snapshot* snapshot;
+    SIZE_T first;
+    unsigned char* start;
+    snapshot_matcher match;
+    SIZE_T width;
+    SIZE_T stride;
+    int mode;
+    const void* delta;
+    vector_uchar_ptr* hits;
+    int failed;                 // hits could not grow
+    unsigned char old[SNAPSHOT_PAGE_SIZE];
+} snapshot_compare;
+
+static void compareVisitor(void* context, const unsigned char* data, SIZE_T length, unsigned char* remote) {
+    snapshot_compare* compare = (snapshot_compare*)context;
+    if (compare->failed)
+        return;
+    SIZE_T index = compare->first + (SIZE_T)(remote - compare->start) / SNAPSHOT_PAGE_SIZE;
+    for (SIZE_T offset = 0; offset + SNAPSHOT_PAGE_SIZE <= length; offset += SNAPSHOT_PAGE_SIZE, index++) {
+        const unsigned char* live = data + offset;
+        decodeSnapshotPage(compare->snapshot, &compare->snapshot->pages[index], compare->old);
+        if (compare->mode <= SNAPSHOT_DECREASED && compare->mode != SNAPSHOT_UNCHANGED
+            && memcmp(live, compare->old, SNAPSHOT_PAGE_SIZE) == 0)
+            continue;
+        for (SIZE_T i = 0; i + compare->width <= SNAPSHOT_PAGE_SIZE; i += compare->stride) {
+            if (!compare->match(live + i, compare->old + i, compare->mode, compare->delta))
+                continue;
+            if (!reserveVectorUCharPtr(compare->hits, compare->hits->size + 1)) {
+                compare->failed = 1;
+                return;
+            }
+            compare->hits->array[compare->hits->size++] = remote + offset + i;
+        }
+    }
+}
+
+/*
+ * Compares the live memory of every snapshot page with its recorded content
+ * and appends the addresses of matching values. Pages that can no longer be
+ * read are skipped.
+ * Returns: 1 on success, -1 Memory Allocation Failure.
+ */
+static int compareSnapshot(HANDLE hProcess, const memory_snapshot* snapshot, snapshot_matcher match, SIZE_T width,
+    SIZE_T stride, int mode, const void* delta, unsigned char* buffer, vector_uchar_ptr* hits) {
+    snapshot_compare* compare = (snapshot_compare*)malloc(sizeof(snapshot_compare));
+    if (compare == NULL)
+        return -1;
+    compare->snapshot = snapshot;
+    compare->match = match;
+    compare->width = width;
+    compare->stride = stride;
+    compare->mode = mode;
+    compare->delta = delta;
+    compare->hits = hits;
+    compare->failed = 0;
+
+    SIZE_T i = 0;
+    while (i < snapshot->pageCount && !compare->failed) {
+        SIZE_T j = i + 1;
+        while (j < snapshot->pageCount && (j - i) * SNAPSHOT_PAGE_SIZE < SCAN_WINDOW_SIZE
+            && snapshot->pages[j].address == snapshot->pages[j - 1].address + SNAPSHOT_PAGE_SIZE)
+            j++;
+        compare->first = i;
+        compare->start = snapshot->pages[i].address;
+        readWindow(hProcess, compare->start, (j - i) * SNAPSHOT_PAGE_SIZE, buffer, compareVisitor, compare);
+        i = j;
+    }
+    int result = compare->failed ? -1 : 1;
+    free(compare);
+    return result;
+}
+
+// Returns the index of the page holding address, or -1.
+static long long findSnapshotPage(const memory_snapshot* snapshot, const unsigned char* address) {
+    SIZE_T lo = 0, hi = snapshot->pageCount;
+    while (lo < hi) {
+        SIZE_T mid = lo + (hi - lo) / 2;
+        if (snapshot->pages[mid].address + SNAPSHOT_PAGE_SIZE <= address)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < snapshot->pageCount && snapshot->pages[lo].address <= address)
+        return (long long)lo;
+    return -1;
+}
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,110 @@
+/*
+ * stats.h
+ *
+ * Description:
+ * Telemetry for the scans: what a scan visited, read and found, and where its
+ * time went. Collection is off by default; a scan started while it is off
+ * gets no scan_stats and pays for nothing but a NULL check per window.
+ *
+ * A scan fills one scan_stats. Workers of a parallel scan add to it with
+ * atomic adds, so the counters are exact and the phase times are summed over
+ * all workers (nsRead + nsCompare can exceed nsTotal with more than one
+ * thread). The phases:
+ * - nsRegions: listing the regions (VirtualQueryEx, /proc/<pid>/maps)
+ * - nsRead   : reading remote memory (ReadProcessMemory, process_vm_readv)
+ * - nsCompare: running the kernels and collecting their hits
+ * - nsMerge  : joining the per worker hit lists (or re-encoding candidate
+ *              segments) and trimming the result
+ * - nsTotal  : the whole scan, wall clock
+ *
+ * Read system calls, bytes read and failed reads are counted per thread by
+ * memsource.h (readCounters); a scan takes the difference around its reads.
+ *
+ * Usage:
+ * - scan_stats stats; scan_stats* s = beginScanStats(&stats);   // NULL when off
+ * - if (s) scanCounterAdd(&s->hits, n);
+ * - endScanStats(s, start);                                     // publishes as the last scan
+ *
+ * Note:
+ * - Include `watcher.h` before this header (watchClockNanos).
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <string.h>
+#include "memsource.h"
+#include "threadpool.h"
+
+typedef struct {
+    unsigned long long regionsVisited;
+    unsigned long long regionsSkipped;
+    unsigned long long regionsFailed;
+    unsigned long long bytesRead;
+    unsigned long long readCalls;
+    unsigned long long readFailures;
+    unsigned long long candidates;
+    unsigned long long hits;
+    unsigned long long reallocs;
+    unsigned long long nsRegions;
+    unsigned long long nsRead;
+    unsigned long long nsCompare;
+    unsigned long long nsMerge;
+    unsigned long long nsTotal;
+} scan_stats;
+
+static inline void scanCounterAdd(volatile unsigned long long* counter, unsigned long long value) {
+#ifdef _MSC_VER
+    InterlockedExchangeAdd64((volatile LONG64*)counter, (LONG64)value);
+#else
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static volatile int scanStatsEnabled = 0;
+static scan_stats lastScanStats;
+static pool_lock lastScanStatsLock = POOL_LOCK_INIT;
+
+// Clears stats and returns it if collection is on, NULL otherwise.
+static scan_stats* beginScanStats(scan_stats* stats) {
+    if (!scanStatsEnabled)
+        return NULL;
+    memset(stats, 0, sizeof(scan_stats));
+    return stats;
+}
+
+// Adds the read counters the calling thread gathered since `before`.
+static void addReadStats(scan_stats* stats, const read_counters* before) {
+    read_counters after = readCounters();
+    scanCounterAdd(&stats->readCalls, after.calls - before->calls);
+    scanCounterAdd(&stats->bytesRead, after.bytes - before->bytes);
+    scanCounterAdd(&stats->readFailures, after.failures - before->failures);
+}
+
+// Number of reallocations that grew a doubling vector from `before` to `after` elements.
+static unsigned long long growthSteps(int before, int after) {
+    unsigned long long steps = 0;
+    while (before > 0 && before < after) {
+        before *= 2;
+        steps++;
+    }
+    return steps;
+}
+
+// Sets nsTotal from `start` and makes stats the last scan's.
+static void endScanStats(scan_stats* stats, unsigned long long start) {
+    if (stats == NULL)
+        return;
+    stats->nsTotal = watchClockNanos() - start;
+    poolLockAcquire(&lastScanStatsLock);
+    lastScanStats = *stats;
+    poolLockRelease(&lastScanStatsLock);
+}
+
+static void copyLastScanStats(scan_stats* out) {
+    poolLockAcquire(&lastScanStatsLock);
+    *out = lastScanStats;
+    poolLockRelease(&lastScanStatsLock);
+}
+
+#endif // STATS_H
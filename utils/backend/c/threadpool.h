@@ -0,0 +1,332 @@
+/*
+ * threadpool.h
+ *
+ * Description:
+ * A small work-stealing thread pool for running a fixed set of independent
+ * tasks, numbered 0 .. taskCount - 1, on several threads.
+ *
+ * The task range is split into one contiguous slice per worker. A worker takes
+ * tasks from the front of its own slice; once the slice is empty it steals the
+ * upper half of the largest remaining slice of another worker. Tasks never
+ * create new tasks, so a worker that finds nothing left to steal can exit.
+ *
+ * The calling thread takes part as worker 0, so runWorkStealing() with one
+ * thread runs everything inline without creating any thread. The other workers
+ * are helper threads kept alive between runs: they are started the first time
+ * a run asks for more of them than exist and then wait for the next run. A run
+ * does not wait for helpers to join; a slice no helper took is stolen by the
+ * workers that are running, so concurrent runs share the helpers.
+ *
+ * Usage:
+ * - void task(void* context, int worker, SIZE_T index) { ... }
+ * - runWorkStealing(getPoolThreadCount(), taskCount, task, context);
+ *
+ * Note:
+ * - `worker` is stable for the duration of a task and lies in [0, threads), so
+ *   it can index per-worker scratch buffers and result lists without locking.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef SRWLOCK pool_lock;
+typedef CONDITION_VARIABLE pool_cond;
+typedef HANDLE pool_thread;
+#define POOL_LOCK_INIT SRWLOCK_INIT
+#define POOL_COND_INIT CONDITION_VARIABLE_INIT
+#define POOL_THREAD_RETURN DWORD WINAPI
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_mutex_t pool_lock;
+typedef pthread_cond_t pool_cond;
+typedef pthread_t pool_thread;
+#define POOL_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define POOL_COND_INIT PTHREAD_COND_INITIALIZER
+#define POOL_THREAD_RETURN void*
+#endif
+
+#define POOL_MAX_THREADS 256
+
+typedef void (*pool_task)(void* context, int worker, SIZE_T index);
+
+static inline void poolLockInit(pool_lock* lock) {
+#ifdef _WIN32
+    InitializeSRWLock(lock);
+#else
+    pthread_mutex_init(lock, NULL);
+#endif
+}
+
+static inline void poolLockAcquire(pool_lock* lock) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(lock);
+#else
+    pthread_mutex_lock(lock);
+#endif
+}
+
+static inline void poolLockRelease(pool_lock* lock) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(lock);
+#else
+    pthread_mutex_unlock(lock);
+#endif
+}
+
+static inline void poolLockDestroy(pool_lock* lock) {
+#ifndef _WIN32
+    pthread_mutex_destroy(lock);
+#else
+    (void)lock;
+#endif
+}
+
+// Releases lock while waiting and holds it again on return.
+static inline void poolCondWait(pool_cond* cond, pool_lock* lock) {
+#ifdef _WIN32
+    SleepConditionVariableSRW(cond, lock, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, lock);
+#endif
+}
+
+static inline void poolCondWakeAll(pool_cond* cond) {
+#ifdef _WIN32
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+static inline int poolCpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+typedef struct {
+    pool_lock lock;
+    SIZE_T next;
+    SIZE_T end;
+} pool_slice;
+
+typedef struct pool_job pool_job;
+
+struct pool_job {
+    pool_task task;
+    void* context;
+    int threads;
+    pool_slice* slices;
+    int joined;         // workers handed out, the caller is worker 0
+    int helping;        // helper threads still running the job
+    pool_job* next;     // next job helpers can join
+};
+
+// The helper threads, shared by every run.
+typedef struct {
+    pool_lock lock;
+    pool_cond wake;     // a job was queued
+    pool_cond left;     // a helper left its job
+    pool_job* jobs;     // jobs with workers left to hand out
+    int helpers;        // helper threads started
+} pool_helpers;
+
+static pool_helpers poolHelpers = { POOL_LOCK_INIT, POOL_COND_INIT, POOL_COND_INIT, NULL, 0 };
+
+static inline int poolTakeOwn(pool_slice* slice, SIZE_T* index) {
+    int found = 0;
+    poolLockAcquire(&slice->lock);
+    if (slice->next < slice->end) {
+        *index = slice->next++;
+        found = 1;
+    }
+    poolLockRelease(&slice->lock);
+    return found;
+}
+
+// Moves the upper half of the fullest other slice into the slice of `self`.
+// Returns 0 when every slice is empty.
+static int poolSteal(pool_job* job, int self) {
+    for (;;) {
+        int victim = -1;
+        SIZE_T most = 0;
+        for (int i = 0; i < job->threads; i++) {
+            if (i == self)
+                continue;
+            pool_slice* slice = &job->slices[i];
+            poolLockAcquire(&slice->lock);
+            SIZE_T left = slice->end > slice->next ? slice->end - slice->next : 0;
+            poolLockRelease(&slice->lock);
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim < 0)
+            return 0;
+
+        pool_slice* from = &job->slices[victim];
+        SIZE_T first = 0, last = 0;
+        poolLockAcquire(&from->lock);
+        if (from->next < from->end) {
+            SIZE_T half = (from->end - from->next + 1) / 2;
+            first = from->end - half;
+            last = from->end;
+            from->end = first;
+        }
+        poolLockRelease(&from->lock);
+        if (first == last)
+            continue; // lost the race for this victim, look again
+
+        pool_slice* own = &job->slices[self];
+        poolLockAcquire(&own->lock);
+        own->next = first;
+        own->end = last;
+        poolLockRelease(&own->lock);
+        return 1;
+    }
+}
+
+static void poolWorkerLoop(pool_job* job, int self) {
+    SIZE_T index;
+    do {
+        while (poolTakeOwn(&job->slices[self], &index))
+            job->task(job->context, self, index);
+    } while (poolSteal(job, self));
+}
+
+static void poolRemoveJob(pool_job* job) {
+    for (pool_job** link = &poolHelpers.jobs; *link != NULL; link = &(*link)->next) {
+        if (*link == job) {
+            *link = job->next;
+            return;
+        }
+    }
+}
+
+static POOL_THREAD_RETURN poolThreadMain(void* param) {
+    (void)param;
+    poolLockAcquire(&poolHelpers.lock);
+    for (;;) {
+        while (poolHelpers.jobs == NULL)
+            poolCondWait(&poolHelpers.wake, &poolHelpers.lock);
+        pool_job* job = poolHelpers.jobs;
+        int self = ++job->joined;
+        if (job->joined == job->threads - 1)
+            poolRemoveJob(job);
+        job->helping++;
+        poolLockRelease(&poolHelpers.lock);
+
+        poolWorkerLoop(job, self);
+
+        poolLockAcquire(&poolHelpers.lock);
+        if (--job->helping == 0)
+            poolCondWakeAll(&poolHelpers.left);
+    }
+    return 0;
+}
+
+// Starts helper threads until there are `wanted`. The caller holds the lock.
+static void poolStartHelpers(int wanted) {
+    while (poolHelpers.helpers < wanted) {
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, poolThreadMain, NULL, 0, NULL);
+        if (thread == NULL)
+            return;
+        CloseHandle(thread);
+#else
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, poolThreadMain, NULL) != 0)
+            return;
+        pthread_detach(thread);
+#endif
+        poolHelpers.helpers++;
+    }
+}
+
+/*
+ * Runs task(context, worker, i) for every i in [0, taskCount) on up to
+ * `threads` workers and returns once all tasks have finished.
+ * Returns: 1 on success, -1 if the bookkeeping could not be allocated.
+ * If a helper thread cannot be started its slice is simply stolen by the others.
+ */
+static int runWorkStealing(int threads, SIZE_T taskCount, pool_task task, void* context) {
+    if (threads < 1)
+        threads = 1;
+    if (threads > POOL_MAX_THREADS)
+        threads = POOL_MAX_THREADS;
+    if ((SIZE_T)threads > taskCount)
+        threads = taskCount ? (int)taskCount : 1;
+
+    pool_job job;
+    job.task = task;
+    job.context = context;
+    job.threads = threads;
+    job.joined = 0;
+    job.helping = 0;
+    job.next = NULL;
+    job.slices = (pool_slice*)malloc(threads * sizeof(pool_slice));
+    if (!job.slices)
+        return -1;
+
+    for (int i = 0; i < threads; i++) {
+        poolLockInit(&job.slices[i].lock);
+        job.slices[i].next = taskCount * i / threads;
+        job.slices[i].end = taskCount * (i + 1) / threads;
+    }
+
+    if (threads > 1) {
+        poolLockAcquire(&poolHelpers.lock);
+        poolStartHelpers(threads - 1);
+        job.next = poolHelpers.jobs;
+        poolHelpers.jobs = &job;
+        poolCondWakeAll(&poolHelpers.wake);
+        poolLockRelease(&poolHelpers.lock);
+    }
+
+    poolWorkerLoop(&job, 0);
+
+    if (threads > 1) {
+        // Every task is done; keep late helpers out and wait for the ones still in the job.
+        poolLockAcquire(&poolHelpers.lock);
+        poolRemoveJob(&job);
+        while (job.helping > 0)
+            poolCondWait(&poolHelpers.left, &poolHelpers.lock);
+        poolLockRelease(&poolHelpers.lock);
+    }
+    for (int i = 0; i < threads; i++)
+        poolLockDestroy(&job.slices[i].lock);
+
+    free(job.slices);
+    return 1;
+}
+
+// Thread count used by the scans. 1 keeps the scans serial.
+
+static int poolThreadCount = 1;
+
+static inline int getPoolThreadCount(void) {
+    return poolThreadCount;
+}
+
+// 0 (or less) selects one thread per logical CPU.
+static inline int setPoolThreadCount(int threads) {
+    if (threads <= 0)
+        threads = poolCpuCount();
+    if (threads > POOL_MAX_THREADS)
+        threads = POOL_MAX_THREADS;
+    poolThreadCount = threads;
+    return poolThreadCount;
+}
+
+#endif // THREADPOOL_H
@@ -0,0 +1,223 @@
+/*
+ * valuestore.h
+ *
+ * Description:
+ * A candidate store that keeps the value last read at every address, for next
+ * scans relative to the previous pass ("changed", "decreased by 5", ...).
+ * Addresses and values are two parallel arrays (structure of arrays): the
+ * address array is what readCandidates() walks, the value array is packed at
+ * the width of the type, so a next scan streams through both in order and
+ * rewrites both in the same pass with one write cursor.
+ *
+ * Relative predicates (RELATIVE_*) compare the live value x with the stored
+ * value o:
+ * - CHANGED / UNCHANGED         : bitwise x != o / x == o
+ * - INCREASED / DECREASED       : x > o / x < o
+ * - INCREASED_BY / DECREASED_BY : x == o + a / x == o - a
+ * - DELTA_RANGE                 : a <= x - o <= b
+ * - WITHIN_PERCENT              : |x - o| <= a / 100 * |o| (a is a double)
+ * The first six match the SNAPSHOT_* modes of snapshot.h. Integer differences
+ * wrap like the target's arithmetic and are signed (x - o of two unsigned
+ * values is read as the signed value of the same width), so the operands of
+ * DELTA_RANGE and *_BY are of the signed type of that width. Float comparisons
+ * are ordered: NaN never matches except through CHANGED / UNCHANGED.
+ *
+ * Like the mask kernels of predicates.h, a relative kernel evaluates a block of
+ * up to 64 live / stored value pairs and returns one bit per pair. There is one
+ * kernel per value type (RELATIVE_KERNELS, indexed by the SCAN_TYPE_* tag); the
+ * mode is switched on once per block and every mode loop is a plain
+ * element-wise loop the compiler vectorizes.
+ *
+ * Usage:
+ * - value_store store; initValueStore(&store, SCAN_TYPE_I32);
+ * - adoptValueStoreRecords(&store, &hits, values);   // values: hits.size * 4 bytes from malloc
+ * - relative_predicate predicate; makeRelativePredicate(&predicate, SCAN_TYPE_I32, RELATIVE_DECREASED_BY, &five, NULL);
+ * - unsigned long long mask = RELATIVE_KERNELS[store.type](live, old, count, &predicate);
+ * - deleteValueStore(&store);
+ *
+ * Note:
+ * - Include `vectors.h` and `valuetypes.h` before this header.
+ */
+
+#ifndef VALUESTORE_H
+#define VALUESTORE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "valuetypes.h"
+
+enum {
+    RELATIVE_CHANGED = 0,
+    RELATIVE_UNCHANGED = 1,
+    RELATIVE_INCREASED = 2,
+    RELATIVE_DECREASED = 3,
+    RELATIVE_INCREASED_BY = 4,
+    RELATIVE_DECREASED_BY = 5,
+    RELATIVE_DELTA_RANGE = 6,
+    RELATIVE_WITHIN_PERCENT = 7,
+    RELATIVE_COUNT = 8
+};
+
+typedef struct {
+    int mode;
+    scan_value a;       // of the delta type of the value type
+    scan_value b;
+    double percent;     // WITHIN_PERCENT, as a fraction
+} relative_predicate;
+
+typedef unsigned long long (*relative_kernel)(const unsigned char* live, const unsigned char* old, SIZE_T count,
+    const relative_predicate* predicate);
+
+typedef struct {
+    unsigned char** addresses;
+    unsigned char* values;      // count * width bytes, values[i] belongs to addresses[i]
+    SIZE_T count;
+    SIZE_T capacity;
+    SIZE_T width;
+    int type;
+} value_store;
+
+static void initValueStore(value_store* store, int type) {
+    memset(store, 0, sizeof(*store));
+    store->type = type;
+    store->width = SCAN_VALUE_TYPE_INFO[type].width;
+}
+
+static void clearValueStore(value_store* store) {
+    free(store->addresses);
+    free(store->values);
+    store->addresses = NULL;
+    store->values = NULL;
+    store->count = 0;
+    store->capacity = 0;
+}
+
+static void deleteValueStore(value_store* store) {
+    clearValueStore(store);
+}
+
+static SIZE_T valueStoreMemoryUsage(const value_store* store) {
+    return sizeof(*store) + store->capacity * (sizeof(unsigned char*) + store->width);
+}
+
+/*
+ * Takes over the array of a vector as the address array and values (one
+ * value per element of the vector) as the value array; the vector is left
+ * empty. Both arrays are cut back to the size of the vector.
+ */
+static void adoptValueStoreRecords(value_store* store, vector_uchar_ptr* addresses, unsigned char* values) {
+    SIZE_T count = (SIZE_T)addresses->size;
+    SIZE_T slots = count > 0 ? count : 1;
+    clearValueStore(store);
+    store->addresses = addresses->array;
+    store->values = values;
+    store->count = count;
+    store->capacity = slots;
+    // A failed shrink keeps the larger block, which is just as usable.
+    unsigned char** shrunkAddresses = (unsigned char**)realloc(store->addresses, slots * sizeof(unsigned char*));
+    if (shrunkAddresses != NULL)
+        store->addresses = shrunkAddresses;
+    unsigned char* shrunkValues = (unsigned char*)realloc(store->values, slots * store->width);
+    if (shrunkValues != NULL)
+        store->values = shrunkValues;
+    addresses->array = NULL;
+    addresses->size = 0;
+    addresses->capacity = 0;
+}
+
+// Relative kernels
+
+// Arithmetic type (D) and delta type (S) per value type: integers wrap in the
+// unsigned type and read differences as signed, floats use the type itself.
+#define RELATIVE_SIGNED_8 signed char
+#define RELATIVE_SIGNED_16 short
+#define RELATIVE_SIGNED_32 int
+#define RELATIVE_SIGNED_64 long long
+#define RELATIVE_ARITH_INTEGER(T, U) U
+#define RELATIVE_ARITH_MASKS_INT(T, U) U
+#define RELATIVE_ARITH_MASKS_FLOAT(T, U) T
+#define RELATIVE_ARITH_MASKS_DOUBLE(T, U) T
+#define RELATIVE_DELTA_INTEGER(T, BITS) RELATIVE_SIGNED_##BITS
+#define RELATIVE_DELTA_MASKS_INT(T, BITS) RELATIVE_SIGNED_##BITS
+#define RELATIVE_DELTA_MASKS_FLOAT(T, BITS) T
+#define RELATIVE_DELTA_MASKS_DOUBLE(T, BITS) T
+
+#define RELATIVE_LOOP(TEST)                                                                 \
+    for (SIZE_T i = 0; i < count; i++)                                                      \
+        mask |= (unsigned long long)(TEST) << i;                                            \
+    break;
+
+#define DEFINE_RELATIVE_KERNEL(NAME, T, U, MIN, MAX, BITS, MASKS, EQUAL)                    \
+    static unsigned long long relativeMask##NAME(const unsigned char* live,                 \
+        const unsigned char* old, SIZE_T count, const relative_predicate* predicate) {      \
+        typedef RELATIVE_ARITH_##MASKS(T, U) D;                                             \
+        typedef RELATIVE_DELTA_##MASKS(T, BITS) S;                                          \
+        T x[64], o[64];                                                                     \
+        U xb[64], ob[64];                                                                   \
+        S a, b;                                                                             \
+        unsigned long long mask = 0;                                                        \
+        memcpy(x, live, count * sizeof(T));                                                 \
+        memcpy(o, old, count * sizeof(T));                                                  \
+        memcpy(xb, live, count * sizeof(T));                                                \
+        memcpy(ob, old, count * sizeof(T));                                                 \
+        memcpy(&a, &predicate->a, sizeof(S));                                               \
+        memcpy(&b, &predicate->b, sizeof(S));                                               \
+        switch (predicate->mode) {                                                          \
+        case RELATIVE_CHANGED:                                                              \
+            RELATIVE_LOOP(xb[i] != ob[i])                                                   \
+        case RELATIVE_UNCHANGED:                                                            \
+            RELATIVE_LOOP(xb[i] == ob[i])                                                   \
+        case RELATIVE_INCREASED:                                                            \
+            RELATIVE_LOOP(x[i] > o[i])                                                      \
+        case RELATIVE_DECREASED:                                                            \
+            RELATIVE_LOOP(x[i] < o[i])                                                      \
+        case RELATIVE_INCREASED_BY:                                                         \
+            RELATIVE_LOOP(x[i] == (T)((D)o[i] + (D)a))                                      \
+        case RELATIVE_DECREASED_BY:                                                         \
+            RELATIVE_LOOP(x[i] == (T)((D)o[i] - (D)a))                                      \
+        case RELATIVE_DELTA_RANGE:                                                          \
+            RELATIVE_LOOP((S)((D)x[i] - (D)o[i]) >= a && (S)((D)x[i] - (D)o[i]) <= b)       \
+        case RELATIVE_WITHIN_PERCENT:                                                       \
+            RELATIVE_LOOP(fabs((double)x[i] - (double)o[i]) <= predicate->percent * fabs((double)o[i])) \
+        }                                                                                   \
+        return mask;                                                                        \
+    }
+
+SCAN_VALUE_TYPES(DEFINE_RELATIVE_KERNEL)
+
+#define RELATIVE_KERNEL_ENTRY(NAME, T, U, MIN, MAX, BITS, MASKS, EQUAL) relativeMask##NAME,
+
+static const relative_kernel RELATIVE_KERNELS[SCAN_TYPE_COUNT] = {
+    SCAN_VALUE_TYPES(RELATIVE_KERNEL_ENTRY)
+};
+
+/*
+ * a and b point at operands of the delta type (the signed type of the width
+ * for integers, the type itself for floats); b may be NULL unless the mode is
+ * DELTA_RANGE. WITHIN_PERCENT reads a as a double percentage.
+ * Returns 1, or 0 for an unknown mode, a missing operand or a negative percentage.
+ */
+static int makeRelativePredicate(relative_predicate* predicate, int type, int mode, const void* a, const void* b) {
+    SIZE_T width = SCAN_VALUE_TYPE_INFO[type].width;
+    memset(predicate, 0, sizeof(*predicate));
+    if (mode < 0 || mode >= RELATIVE_COUNT)
+        return 0;
+    predicate->mode = mode;
+    if (mode == RELATIVE_WITHIN_PERCENT) {
+        if (a == NULL)
+            return 0;
+        memcpy(&predicate->percent, a, sizeof(double));
+        predicate->percent /= 100.0;
+        return predicate->percent >= 0.0;
+    }
+    if (mode >= RELATIVE_INCREASED_BY) {
+        if (a == NULL || (mode == RELATIVE_DELTA_RANGE && b == NULL))
+            return 0;
+        memcpy(&predicate->a, a, width);
+        if (b != NULL)
+            memcpy(&predicate->b, b, width);
+    }
+    return 1;
+}
+
+#endif // VALUESTORE_H
@@ -0,0 +1,414 @@
+/*
+ * valuetypes.h
+ *
+ * Description:
+ * The value types of the typed scans (scanTyped, scanNextTyped, ...). Every
+ * type is one line of SCAN_VALUE_TYPES:
+ *
+ *   X(NAME, T, U, MIN, MAX, BITS, MASKS, EQUAL)
+ *
+ * - NAME  : tag suffix, the type is selected with SCAN_TYPE_<NAME>.
+ * - T / U : the C type and the unsigned type of the same size (MASKED works on U).
+ * - MIN / MAX : the limits EPSILON saturates to.
+ * - BITS  : 8, 16, 32 or 64, selects the bitwise EQUAL and MASKED kernels.
+ * - MASKS : the predicate mask table, or INTEGER to generate one: the bitwise
+ *           SIMD kernels of BITS for EQUAL and MASKED, SIMD compares of BITS
+ *           and the signedness of T for RANGE / EPSILON / LESS / GREATER.
+ * - EQUAL : first scan kernel table (kernels.h) for exact matches, or NONE to
+ *           run EQUAL through the mask kernels.
+ *
+ * Each line expands at compile time into its own predicate setup and, for
+ * INTEGER, its own mask kernels, so every type / predicate pair gets a
+ * dedicated kernel with the comparison inlined. SCAN_VALUE_TYPE_INFO is
+ * indexed by the type tag.
+ *
+ * Usage:
+ * - const scan_value_type* type = &SCAN_VALUE_TYPE_INFO[SCAN_TYPE_I16];
+ * - short a = 100, b = 5;
+ *   type->makePredicate(&predicate, SCAN_PREDICATE_EPSILON, &a, &b);
+ *
+ * Note:
+ * - Integer EQUAL and MASKED only look at the bits, so signed and unsigned
+ *   types of one width share those kernels.
+ * - The ordered kernels compare signed; unsigned types flip the sign bit first.
+ * - AVX-512F has no 8 and 16 bit compares; those widths use AVX2 at that level.
+ * - Include `predicates.h` before this header.
+ */
+
+#ifndef VALUETYPES_H
+#define VALUETYPES_H
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include "predicates.h"
+
+#define SCAN_VALUE_TYPES(X)                                                                                  \
+    X(I8, signed char, unsigned char, SCHAR_MIN, SCHAR_MAX, 8, INTEGER, NONE)                                \
+    X(U8, unsigned char, unsigned char, 0, UCHAR_MAX, 8, INTEGER, NONE)                                      \
+    X(I16, short, unsigned short, SHRT_MIN, SHRT_MAX, 16, INTEGER, NONE)                                     \
+    X(U16, unsigned short, unsigned short, 0, USHRT_MAX, 16, INTEGER, NONE)                                  \
+    X(I32, int, unsigned int, INT_MIN, INT_MAX, 32, MASKS_INT, KERNELS_INT)                                  \
+    X(U32, unsigned int, unsigned int, 0, UINT_MAX, 32, INTEGER, KERNELS_INT)                                \
+    X(I64, long long, unsigned long long, LLONG_MIN, LLONG_MAX, 64, INTEGER, NONE)                           \
+    X(U64, unsigned long long, unsigned long long, 0, ULLONG_MAX, 64, INTEGER, NONE)                         \
+    X(F32, float, unsigned int, -HUGE_VALF, HUGE_VALF, 32, MASKS_FLOAT, KERNELS_FLOAT)                       \
+    X(F64, double, unsigned long long, -HUGE_VAL, HUGE_VAL, 64, MASKS_DOUBLE, KERNELS_DOUBLE)
+
+#define SCAN_TYPE_TAG(NAME, T, U, MIN, MAX, BITS, MASKS, EQUAL) SCAN_TYPE_##NAME,
+
+typedef enum {
+    SCAN_VALUE_TYPES(SCAN_TYPE_TAG)
+    SCAN_TYPE_COUNT
+} scan_value_tag;
+
+typedef struct {
+    SIZE_T width;
+    const mask_kernel (*masks)[SCAN_ISA_COUNT];
+    const scan_kernel* equal;   // NULL: EQUAL runs on the mask kernels
+    int (*makePredicate)(scan_predicate* predicate, int kind, const void* a, const void* b);
+} scan_value_type;
+
+// Bitwise kernels
+// EQUAL and MASKED per width. 32 bits reuse the int kernels of predicates.h.
+
+DEFINE_SCALAR_MASK(maskScalarEqualBits8, unsigned char, PREDICATE_EQUAL)
+DEFINE_SCALAR_MASK(maskScalarEqualBits16, unsigned short, PREDICATE_EQUAL)
+DEFINE_SCALAR_MASK(maskScalarEqualBits64, unsigned long long, PREDICATE_EQUAL)
+DEFINE_SCALAR_MASK(maskScalarMasked8, unsigned char, PREDICATE_MASKED)
+DEFINE_SCALAR_MASK(maskScalarMasked16, unsigned short, PREDICATE_MASKED)
+
+#ifdef SCAN_KERNELS_X86
+
+// Ordered kernels
+// One step function per level and width runs LESS (a > x), GREATER (x > a) or
+// RANGE (neither a > x nor x > b) on signed compares; kind is a constant once
+// inlined. Unsigned types pass the sign bit as bias, flipping it in x, a and b
+// so the signed order matches theirs.
+
+#define SCAN_ORDERED_TEST(GT, OR, X, A, B, KIND)                                            \
+    ((KIND) == SCAN_PREDICATE_LESS ? GT(A, X)                                               \
+        : (KIND) == SCAN_PREDICATE_GREATER ? GT(X, A) : OR(GT(A, X), GT(X, B)))
+
+// 0 for a signed T, SIGN (the sign bit of the width) for an unsigned one.
+#define SCAN_ORDERED_BIAS(T, SIGN) ((T)-1 > 0 ? (SIGN) : 0)
+
+// SSE2
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Equal8(const unsigned char* p, __m128i a, __m128i b) {
+    (void)b;
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), a));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Masked8(const unsigned char* p, __m128i a, __m128i b) {
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i*)p), b), a));
+}
+// 16 elements from two vectors, packed back to one byte per element.
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Equal16(const unsigned char* p, __m128i a, __m128i b) {
+    (void)b;
+    __m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)p), a);
+    __m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(p + 16)), a);
+    return (unsigned int)_mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Masked16(const unsigned char* p, __m128i a, __m128i b) {
+    __m128i lo = _mm_cmpeq_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i*)p), b), a);
+    __m128i hi = _mm_cmpeq_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i*)(p + 16)), b), a);
+    return (unsigned int)_mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+}
+KERNEL_TARGET("sse2") static inline unsigned int predSSE2Equal64(const unsigned char* p, __m128i a, __m128i b) {
+    (void)b;
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)p), a);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (unsigned int)_mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+
+// SSE2 has no 64 bit compare: the high halves decide unless they are equal,
+// then the low halves compared unsigned. Valid in the high half of each lane.
+KERNEL_TARGET("sse2") static inline __m128i cmpgt64SSE2(__m128i x, __m128i y) {
+    const __m128i low = _mm_set_epi32(0, INT_MIN, 0, INT_MIN);
+    __m128i gtLow = _mm_cmpgt_epi32(_mm_xor_si128(x, low), _mm_xor_si128(y, low));
+    __m128i tie = _mm_and_si128(_mm_cmpeq_epi32(x, y), _mm_shuffle_epi32(gtLow, _MM_SHUFFLE(2, 2, 0, 0)));
+    return _mm_or_si128(_mm_cmpgt_epi32(x, y), tie);
+}
+KERNEL_TARGET("sse2") static inline unsigned int orderedSSE2_8(const unsigned char* p, __m128i a, __m128i b, __m128i bias, int kind) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)p), bias);
+    a = _mm_xor_si128(a, bias);
+    b = _mm_xor_si128(b, bias);
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(SCAN_ORDERED_TEST(_mm_cmpgt_epi8, _mm_or_si128, x, a, b, kind));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask & 0xFFFF : mask;
+}
+KERNEL_TARGET("sse2") static inline unsigned int orderedSSE2_16(const unsigned char* p, __m128i a, __m128i b, __m128i bias, int kind) {
+    __m128i lo = _mm_xor_si128(_mm_loadu_si128((const __m128i*)p), bias);
+    __m128i hi = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(p + 16)), bias);
+    a = _mm_xor_si128(a, bias);
+    b = _mm_xor_si128(b, bias);
+    lo = SCAN_ORDERED_TEST(_mm_cmpgt_epi16, _mm_or_si128, lo, a, b, kind);
+    hi = SCAN_ORDERED_TEST(_mm_cmpgt_epi16, _mm_or_si128, hi, a, b, kind);
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask & 0xFFFF : mask;
+}
+KERNEL_TARGET("sse2") static inline unsigned int orderedSSE2_32(const unsigned char* p, __m128i a, __m128i b, __m128i bias, int kind) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)p), bias);
+    a = _mm_xor_si128(a, bias);
+    b = _mm_xor_si128(b, bias);
+    unsigned int mask = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(SCAN_ORDERED_TEST(_mm_cmpgt_epi32, _mm_or_si128, x, a, b, kind)));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask & 0xF : mask;
+}
+KERNEL_TARGET("sse2") static inline unsigned int orderedSSE2_64(const unsigned char* p, __m128i a, __m128i b, __m128i bias, int kind) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)p), bias);
+    a = _mm_xor_si128(a, bias);
+    b = _mm_xor_si128(b, bias);
+    unsigned int mask = (unsigned int)_mm_movemask_pd(_mm_castsi128_pd(SCAN_ORDERED_TEST(cmpgt64SSE2, _mm_or_si128, x, a, b, kind)));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask & 0x3 : mask;
+}
+
+DEFINE_SIMD_MASK(maskSSE2EqualBits8, "sse2", char, __m128i, _mm_set1_epi8, predSSE2Equal8, 16, maskScalarEqualBits8)
+DEFINE_SIMD_MASK(maskSSE2Masked8, "sse2", char, __m128i, _mm_set1_epi8, predSSE2Masked8, 16, maskScalarMasked8)
+DEFINE_SIMD_MASK(maskSSE2EqualBits16, "sse2", short, __m128i, _mm_set1_epi16, predSSE2Equal16, 16, maskScalarEqualBits16)
+DEFINE_SIMD_MASK(maskSSE2Masked16, "sse2", short, __m128i, _mm_set1_epi16, predSSE2Masked16, 16, maskScalarMasked16)
+DEFINE_SIMD_MASK(maskSSE2EqualBits64, "sse2", long long, __m128i, _mm_set1_epi64x, predSSE2Equal64, 2, maskScalarEqualBits64)
+
+// AVX2
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Equal8(const unsigned char* p, __m256i a, __m256i b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), a));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Masked8(const unsigned char* p, __m256i a, __m256i b) {
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), b), a));
+}
+// packs works per 128 bit lane; the permute puts the four quarters back in order.
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Equal16(const unsigned char* p, __m256i a, __m256i b) {
+    (void)b;
+    __m256i lo = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)p), a);
+    __m256i hi = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(p + 32)), a);
+    return (unsigned int)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Masked16(const unsigned char* p, __m256i a, __m256i b) {
+    __m256i lo = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), b), a);
+    __m256i hi = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)(p + 32)), b), a);
+    return (unsigned int)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+KERNEL_TARGET("avx2") static inline unsigned int predAVX2Equal64(const unsigned char* p, __m256i a, __m256i b) {
+    (void)b;
+    return (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)p), a)));
+}
+
+KERNEL_TARGET("avx2") static inline unsigned int orderedAVX2_8(const unsigned char* p, __m256i a, __m256i b, __m256i bias, int kind) {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), bias);
+    a = _mm256_xor_si256(a, bias);
+    b = _mm256_xor_si256(b, bias);
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(SCAN_ORDERED_TEST(_mm256_cmpgt_epi8, _mm256_or_si256, x, a, b, kind));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask : mask;
+}
+KERNEL_TARGET("avx2") static inline unsigned int orderedAVX2_16(const unsigned char* p, __m256i a, __m256i b, __m256i bias, int kind) {
+    __m256i lo = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), bias);
+    __m256i hi = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(p + 32)), bias);
+    a = _mm256_xor_si256(a, bias);
+    b = _mm256_xor_si256(b, bias);
+    lo = SCAN_ORDERED_TEST(_mm256_cmpgt_epi16, _mm256_or_si256, lo, a, b, kind);
+    hi = SCAN_ORDERED_TEST(_mm256_cmpgt_epi16, _mm256_or_si256, hi, a, b, kind);
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0)));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask : mask;
+}
+KERNEL_TARGET("avx2") static inline unsigned int orderedAVX2_32(const unsigned char* p, __m256i a, __m256i b, __m256i bias, int kind) {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), bias);
+    a = _mm256_xor_si256(a, bias);
+    b = _mm256_xor_si256(b, bias);
+    unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(SCAN_ORDERED_TEST(_mm256_cmpgt_epi32, _mm256_or_si256, x, a, b, kind)));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask & 0xFF : mask;
+}
+KERNEL_TARGET("avx2") static inline unsigned int orderedAVX2_64(const unsigned char* p, __m256i a, __m256i b, __m256i bias, int kind) {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), bias);
+    a = _mm256_xor_si256(a, bias);
+    b = _mm256_xor_si256(b, bias);
+    unsigned int mask = (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(SCAN_ORDERED_TEST(_mm256_cmpgt_epi64, _mm256_or_si256, x, a, b, kind)));
+    return kind == SCAN_PREDICATE_RANGE ? ~mask & 0xF : mask;
+}
+
+DEFINE_SIMD_MASK(maskAVX2EqualBits8, "avx2", char, __m256i, _mm256_set1_epi8, predAVX2Equal8, 32, maskScalarEqualBits8)
+DEFINE_SIMD_MASK(maskAVX2Masked8, "avx2", char, __m256i, _mm256_set1_epi8, predAVX2Masked8, 32, maskScalarMasked8)
+DEFINE_SIMD_MASK(maskAVX2EqualBits16, "avx2", short, __m256i, _mm256_set1_epi16, predAVX2Equal16, 32, maskScalarEqualBits16)
+DEFINE_SIMD_MASK(maskAVX2Masked16, "avx2", short, __m256i, _mm256_set1_epi16, predAVX2Masked16, 32, maskScalarMasked16)
+DEFINE_SIMD_MASK(maskAVX2EqualBits64, "avx2", long long, __m256i, _mm256_set1_epi64x, predAVX2Equal64, 4, maskScalarEqualBits64)
+
+// AVX-512
+KERNEL_TARGET("avx512f") static inline unsigned int predAVX512Equal64(const unsigned char* p, __m512i a, __m512i b) {
+    (void)b;
+    return (unsigned int)_mm512_cmpeq_epi64_mask(_mm512_loadu_si512((const void*)p), a);
+}
+
+KERNEL_TARGET("avx512f") static inline unsigned int orderedAVX512_32(const unsigned char* p, __m512i a, __m512i b, __m512i bias, int kind) {
+    __m512i x = _mm512_xor_si512(_mm512_loadu_si512((const void*)p), bias);
+    a = _mm512_xor_si512(a, bias);
+    b = _mm512_xor_si512(b, bias);
+    if (kind == SCAN_PREDICATE_LESS)
+        return (unsigned int)_mm512_cmp_epi32_mask(x, a, _MM_CMPINT_LT);
+    if (kind == SCAN_PREDICATE_GREATER)
+        return (unsigned int)_mm512_cmp_epi32_mask(x, a, _MM_CMPINT_NLE);
+    return (unsigned int)_mm512_mask_cmp_epi32_mask(_mm512_cmp_epi32_mask(x, a, _MM_CMPINT_NLT), x, b, _MM_CMPINT_LE);
+}
+KERNEL_TARGET("avx512f") static inline unsigned int orderedAVX512_64(const unsigned char* p, __m512i a, __m512i b, __m512i bias, int kind) {
+    __m512i x = _mm512_xor_si512(_mm512_loadu_si512((const void*)p), bias);
+    a = _mm512_xor_si512(a, bias);
+    b = _mm512_xor_si512(b, bias);
+    if (kind == SCAN_PREDICATE_LESS)
+        return (unsigned int)_mm512_cmp_epi64_mask(x, a, _MM_CMPINT_LT);
+    if (kind == SCAN_PREDICATE_GREATER)
+        return (unsigned int)_mm512_cmp_epi64_mask(x, a, _MM_CMPINT_NLE);
+    return (unsigned int)_mm512_mask_cmp_epi64_mask(_mm512_cmp_epi64_mask(x, a, _MM_CMPINT_NLT), x, b, _MM_CMPINT_LE);
+}
+
+DEFINE_SIMD_MASK(maskAVX512EqualBits64, "avx512f", long long, __m512i, _mm512_set1_epi64, predAVX512Equal64, 8, maskScalarEqualBits64)
+
+// Range / Less / Greater pred and mask kernels of one type at one level.
+#define DEFINE_ORDERED_SIMD_MASKS(NAME, LEVEL, ISA, T, VEC, SPLAT, ORDERED, BIAS, LANES)   \
+    KERNEL_TARGET(ISA) static inline unsigned int pred##LEVEL##Range##NAME(                 \
+        const unsigned char* p, VEC a, VEC b) {                                             \
+        return ORDERED(p, a, b, SPLAT(BIAS), SCAN_PREDICATE_RANGE);                         \
+    }                                                                                       \
+    KERNEL_TARGET(ISA) static inline unsigned int pred##LEVEL##Less##NAME(                  \
+        const unsigned char* p, VEC a, VEC b) {                                             \
+        return ORDERED(p, a, b, SPLAT(BIAS), SCAN_PREDICATE_LESS);                          \
+    }                                                                                       \
+    KERNEL_TARGET(ISA) static inline unsigned int pred##LEVEL##Greater##NAME(               \
+        const unsigned char* p, VEC a, VEC b) {                                             \
+        return ORDERED(p, a, b, SPLAT(BIAS), SCAN_PREDICATE_GREATER);                       \
+    }                                                                                       \
+    DEFINE_SIMD_MASK(mask##LEVEL##Range##NAME, ISA, T, VEC, SPLAT, pred##LEVEL##Range##NAME, LANES, maskScalarRange##NAME) \
+    DEFINE_SIMD_MASK(mask##LEVEL##Less##NAME, ISA, T, VEC, SPLAT, pred##LEVEL##Less##NAME, LANES, maskScalarLess##NAME) \
+    DEFINE_SIMD_MASK(mask##LEVEL##Greater##NAME, ISA, T, VEC, SPLAT, pred##LEVEL##Greater##NAME, LANES, maskScalarGreater##NAME)
+
+#define DEFINE_ORDERED_MASKS_8(NAME, T)                                                     \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, SSE2, "sse2", T, __m128i, _mm_set1_epi8, orderedSSE2_8, SCAN_ORDERED_BIAS(T, SCHAR_MIN), 16) \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, AVX2, "avx2", T, __m256i, _mm256_set1_epi8, orderedAVX2_8, SCAN_ORDERED_BIAS(T, SCHAR_MIN), 32)
+#define DEFINE_ORDERED_MASKS_16(NAME, T)                                                    \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, SSE2, "sse2", T, __m128i, _mm_set1_epi16, orderedSSE2_16, SCAN_ORDERED_BIAS(T, SHRT_MIN), 16) \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, AVX2, "avx2", T, __m256i, _mm256_set1_epi16, orderedAVX2_16, SCAN_ORDERED_BIAS(T, SHRT_MIN), 32)
+#define DEFINE_ORDERED_MASKS_32(NAME, T)                                                    \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, SSE2, "sse2", T, __m128i, _mm_set1_epi32, orderedSSE2_32, SCAN_ORDERED_BIAS(T, INT_MIN), 4) \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, AVX2, "avx2", T, __m256i, _mm256_set1_epi32, orderedAVX2_32, SCAN_ORDERED_BIAS(T, INT_MIN), 8) \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, AVX512, "avx512f", T, __m512i, _mm512_set1_epi32, orderedAVX512_32, SCAN_ORDERED_BIAS(T, INT_MIN), 16)
+#define DEFINE_ORDERED_MASKS_64(NAME, T)                                                    \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, SSE2, "sse2", T, __m128i, _mm_set1_epi64x, orderedSSE2_64, SCAN_ORDERED_BIAS(T, LLONG_MIN), 2) \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, AVX2, "avx2", T, __m256i, _mm256_set1_epi64x, orderedAVX2_64, SCAN_ORDERED_BIAS(T, LLONG_MIN), 4) \
+    DEFINE_ORDERED_SIMD_MASKS(NAME, AVX512, "avx512f", T, __m512i, _mm512_set1_epi64, orderedAVX512_64, SCAN_ORDERED_BIAS(T, LLONG_MIN), 8)
+
+#define SCAN_MASK_ROW_EQUAL_8 { maskScalarEqualBits8, maskSSE2EqualBits8, maskAVX2EqualBits8, maskAVX2EqualBits8 }
+#define SCAN_MASK_ROW_EQUAL_16 { maskScalarEqualBits16, maskSSE2EqualBits16, maskAVX2EqualBits16, maskAVX2EqualBits16 }
+#define SCAN_MASK_ROW_EQUAL_32 { maskScalarEqualINT, maskSSE2EqualINT, maskAVX2EqualINT, maskAVX512EqualINT }
+#define SCAN_MASK_ROW_EQUAL_64 { maskScalarEqualBits64, maskSSE2EqualBits64, maskAVX2EqualBits64, maskAVX512EqualBits64 }
+#define SCAN_MASK_ROW_MASKED_8 { maskScalarMasked8, maskSSE2Masked8, maskAVX2Masked8, maskAVX2Masked8 }
+#define SCAN_MASK_ROW_MASKED_16 { maskScalarMasked16, maskSSE2Masked16, maskAVX2Masked16, maskAVX2Masked16 }
+#define SCAN_MASK_ROW_MASKED_32 { maskScalarMasked32, maskSSE2Masked32, maskAVX2Masked32, maskAVX512Masked32 }
+#define SCAN_MASK_ROW_MASKED_64 { maskScalarMasked64, maskSSE2Masked64, maskAVX2Masked64, maskAVX512Masked64 }
+#define SCAN_MASK_ROW_ORDERED_8(NAME, KIND) { maskScalar##KIND##NAME, maskSSE2##KIND##NAME, maskAVX2##KIND##NAME, maskAVX2##KIND##NAME }
+#define SCAN_MASK_ROW_ORDERED_16(NAME, KIND) { maskScalar##KIND##NAME, maskSSE2##KIND##NAME, maskAVX2##KIND##NAME, maskAVX2##KIND##NAME }
+#define SCAN_MASK_ROW_ORDERED_32(NAME, KIND) { maskScalar##KIND##NAME, maskSSE2##KIND##NAME, maskAVX2##KIND##NAME, maskAVX512##KIND##NAME }
+#define SCAN_MASK_ROW_ORDERED_64(NAME, KIND) { maskScalar##KIND##NAME, maskSSE2##KIND##NAME, maskAVX2##KIND##NAME, maskAVX512##KIND##NAME }
+
+#else
+
+#define DEFINE_ORDERED_MASKS_8(NAME, T)
+#define DEFINE_ORDERED_MASKS_16(NAME, T)
+#define DEFINE_ORDERED_MASKS_32(NAME, T)
+#define DEFINE_ORDERED_MASKS_64(NAME, T)
+
+#define SCAN_MASK_ROW_EQUAL_8 SCAN_MASK_ROW(maskScalarEqualBits8)
+#define SCAN_MASK_ROW_EQUAL_16 SCAN_MASK_ROW(maskScalarEqualBits16)
+#define SCAN_MASK_ROW_EQUAL_32 SCAN_MASK_ROW(maskScalarEqualINT)
+#define SCAN_MASK_ROW_EQUAL_64 SCAN_MASK_ROW(maskScalarEqualBits64)
+#define SCAN_MASK_ROW_MASKED_8 SCAN_MASK_ROW(maskScalarMasked8)
+#define SCAN_MASK_ROW_MASKED_16 SCAN_MASK_ROW(maskScalarMasked16)
+#define SCAN_MASK_ROW_MASKED_32 SCAN_MASK_ROW(maskScalarMasked32)
+#define SCAN_MASK_ROW_MASKED_64 SCAN_MASK_ROW(maskScalarMasked64)
+#define SCAN_MASK_ROW_ORDERED_8(NAME, KIND) SCAN_MASK_ROW(maskScalar##KIND##NAME)
+#define SCAN_MASK_ROW_ORDERED_16(NAME, KIND) SCAN_MASK_ROW(maskScalar##KIND##NAME)
+#define SCAN_MASK_ROW_ORDERED_32(NAME, KIND) SCAN_MASK_ROW(maskScalar##KIND##NAME)
+#define SCAN_MASK_ROW_ORDERED_64(NAME, KIND) SCAN_MASK_ROW(maskScalar##KIND##NAME)
+
+#endif // SCAN_KERNELS_X86
+
+#define SCAN_MASK_ROW(KERNEL) { KERNEL, KERNEL, KERNEL, KERNEL }
+
+// Per type code
+
+// Operands are read from a and b (b may be NULL when the kind does not use
+// it). EPSILON becomes RANGE saturated to [MIN, MAX], MASKED pre-applies the
+// mask to the value. Returns 1, or 0 for an unknown kind / negative epsilon.
+#define DEFINE_TYPE_PREDICATE(NAME, T, U, MIN, MAX)                                         \
+    static int makePredicate##NAME(scan_predicate* predicate, int kind, const void* pa,     \
+        const void* pb) {                                                                   \
+        T a, b = 0;                                                                         \
+        memset(predicate, 0, sizeof(*predicate));                                           \
+        if (kind < 0 || kind >= SCAN_PREDICATE_COUNT || pa == NULL)                         \
+            return 0;                                                                       \
+        memcpy(&a, pa, sizeof(T));                                                          \
+        if (pb != NULL)                                                                     \
+            memcpy(&b, pb, sizeof(T));                                                      \
+        predicate->kind = kind;                                                             \
+        if (kind == SCAN_PREDICATE_EPSILON) {                                               \
+            if (!((double)b >= 0.0))                                                        \
+                return 0;                                                                   \
+            T lo = a < (T)(MIN) + b ? (T)(MIN) : (T)(a - b);                                \
+            T hi = a > (T)(MAX) - b ? (T)(MAX) : (T)(a + b);                                \
+            predicate->kind = SCAN_PREDICATE_RANGE;                                         \
+            a = lo;                                                                         \
+            b = hi;                                                                         \
+        }                                                                                   \
+        else if (kind == SCAN_PREDICATE_MASKED) {                                           \
+            U value, mask;                                                                  \
+            memcpy(&value, &a, sizeof(U));                                                  \
+            memcpy(&mask, &b, sizeof(U));                                                   \
+            value &= mask;                                                                  \
+            memcpy(&a, &value, sizeof(U));                                                  \
+        }                                                                                   \
+        memcpy(&predicate->a, &a, sizeof(T));                                               \
+        memcpy(&predicate->b, &b, sizeof(T));                                               \
+        return 1;                                                                           \
+    }
+
+// Generated tables: bitwise rows for EQUAL / MASKED, ordered rows of the type.
+#define DEFINE_TYPE_MASKS_INTEGER(NAME, T, BITS)                                            \
+    DEFINE_SCALAR_MASK(maskScalarRange##NAME, T, PREDICATE_RANGE)                           \
+    DEFINE_SCALAR_MASK(maskScalarLess##NAME, T, PREDICATE_LESS)                             \
+    DEFINE_SCALAR_MASK(maskScalarGreater##NAME, T, PREDICATE_GREATER)                       \
+    DEFINE_ORDERED_MASKS_##BITS(NAME, T)                                                    \
+    static const mask_kernel MASKS_##NAME[SCAN_PREDICATE_COUNT][SCAN_ISA_COUNT] = {         \
+        SCAN_MASK_ROW_EQUAL_##BITS,                                                         \
+        SCAN_MASK_ROW_ORDERED_##BITS(NAME, Range),                                          \
+        SCAN_MASK_ROW_ORDERED_##BITS(NAME, Range),                                          \
+        SCAN_MASK_ROW_ORDERED_##BITS(NAME, Less),                                           \
+        SCAN_MASK_ROW_ORDERED_##BITS(NAME, Greater),                                        \
+        SCAN_MASK_ROW_MASKED_##BITS                                                         \
+    };
+#define DEFINE_TYPE_MASKS_MASKS_INT(NAME, T, BITS)
+#define DEFINE_TYPE_MASKS_MASKS_FLOAT(NAME, T, BITS)
+#define DEFINE_TYPE_MASKS_MASKS_DOUBLE(NAME, T, BITS)
+
+#define SCAN_TYPE_MASKS_INTEGER(NAME) MASKS_##NAME
+#define SCAN_TYPE_MASKS_MASKS_INT(NAME) MASKS_INT
+#define SCAN_TYPE_MASKS_MASKS_FLOAT(NAME) MASKS_FLOAT
+#define SCAN_TYPE_MASKS_MASKS_DOUBLE(NAME) MASKS_DOUBLE
+
+#define SCAN_TYPE_EQUAL_NONE NULL
+#define SCAN_TYPE_EQUAL_KERNELS_INT KERNELS_INT
+#define SCAN_TYPE_EQUAL_KERNELS_FLOAT KERNELS_FLOAT
+#define SCAN_TYPE_EQUAL_KERNELS_DOUBLE KERNELS_DOUBLE
+
+#define SCAN_TYPE_DEFINE(NAME, T, U, MIN, MAX, BITS, MASKS, EQUAL)                          \
+    DEFINE_TYPE_PREDICATE(NAME, T, U, MIN, MAX)                                             \
+    DEFINE_TYPE_MASKS_##MASKS(NAME, T, BITS)
+
+#define SCAN_TYPE_INFO(NAME, T, U, MIN, MAX, BITS, MASKS, EQUAL)                            \
+    { sizeof(T), SCAN_TYPE_MASKS_##MASKS(NAME), SCAN_TYPE_EQUAL_##EQUAL, makePredicate##NAME },
+
+SCAN_VALUE_TYPES(SCAN_TYPE_DEFINE)
+
+static const scan_value_type SCAN_VALUE_TYPE_INFO[SCAN_TYPE_COUNT] = {
+    SCAN_VALUE_TYPES(SCAN_TYPE_INFO)
+};
+
+// Returns the description of a type tag, or NULL if it is unknown.
+static inline const scan_value_type* scanValueType(int type) {
+    return type >= 0 && type < SCAN_TYPE_COUNT ? &SCAN_VALUE_TYPE_INFO[type] : NULL;
+}
+
+#endif // VALUETYPES_H
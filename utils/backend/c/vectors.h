@@ -14,6 +14,8 @@
  * - Dynamic resizing: Automatically increases the capacity of the vector when needed.
  * - Element management: Supports appending elements, deleting elements, and shrinking
  *   the vector to fit its current size.
+ * - Filtering: filterVectorUCharPtr() drops every element rejected by a predicate in a
+ *   single pass. Prefer it over calling deleteElement in a loop, which is O(n^2).
  * - Display functions: Provides functions to print the contents of the vector for
  *   debugging and visualization.
  *
@@ -67,6 +69,7 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -557,7 +560,7 @@ void displayVectorCharPtr(vector_char_ptr* vector) {
 }
 
 // Vector for unsigned char pointers
-__declspec(dllexport) typedef struct {
+typedef struct {
     unsigned char** array;
     int size;
     int capacity;
@@ -578,6 +581,28 @@ void appendVectorUCharPtr(vector_uchar_ptr* vector, unsigned char* data) {
     vector->size++;
 }
 
+// Grows the capacity to at least `capacity` elements, doubling up to INT_MAX.
+// Returns 1, or 0 if the memory cannot be allocated (the vector is left as it was).
+int reserveVectorUCharPtr(vector_uchar_ptr* vector, int capacity) {
+    if (capacity < 0) {
+        return 0;
+    }
+    if (vector->capacity >= capacity) {
+        return 1;
+    }
+    int newCapacity = vector->capacity > 0 ? vector->capacity : 1;
+    while (newCapacity < capacity) {
+        newCapacity = newCapacity > INT_MAX / 2 ? INT_MAX : newCapacity * 2;
+    }
+    unsigned char** grown = (unsigned char**)realloc(vector->array, (size_t)newCapacity * sizeof(unsigned char*));
+    if (grown == NULL) {
+        return 0;
+    }
+    vector->array = grown;
+    vector->capacity = newCapacity;
+    return 1;
+}
+
 void deleteVectorUCharPtr(vector_uchar_ptr* vector) {
     free(vector->array);
     vector->array = NULL;
@@ -599,6 +624,19 @@ void deleteElementVectorUCharPtr(vector_uchar_ptr* vector, int index) {
     vector->size--;
 }
 
+// Keeps the elements for which keep() returns non zero, preserving their order.
+// Single read/write cursor pass, O(n) no matter how many elements are dropped.
+void filterVectorUCharPtr(vector_uchar_ptr* vector, int (*keep)(void* context, unsigned char* element), void* context) {
+    int kept = 0;
+    for (int i = 0; i < vector->size; i++) {
+        unsigned char* element = vector->array[i];
+        if (keep(context, element)) {
+            vector->array[kept++] = element;
+        }
+    }
+    vector->size = kept;
+}
+
 void displayVectorUCharPtr(vector_uchar_ptr* vector) {
     printf("{");
     for (int i = 0; i < vector->size; i++) {
@@ -0,0 +1,336 @@
+/*
+ * watcher.h
+ *
+ * Description:
+ * A background thread that samples a fixed set of addresses at a fixed
+ * interval and reports every value change as an event.
+ *
+ * Every sample reads all addresses with readCandidates() (coalesced, batched
+ * reads) and compares each value with the previous sample. A change pushes a
+ * watch_event (address, old value, new value, timestamp) into a single
+ * producer / single consumer ring: the sampler thread is the only writer of
+ * `head`, the consumer the only writer of `tail`, so neither side takes a
+ * lock and draining never stalls the sampler. When the ring is full the
+ * event is dropped and counted in `dropped` instead of blocking; the
+ * previous value still advances, so the next event of that address compares
+ * against what was really there.
+ *
+ * The first sample only records the starting values. Addresses that cannot
+ * be read keep their previous value and produce no event.
+ *
+ * Usage:
+ * - memory_watcher* w = createMemoryWatcher(hProcess, addresses, count, 4, 1000, 65536);
+ * - SIZE_T n = drainWatchEvents(w, events, 256);   // from any one consumer thread
+ * - destroyMemoryWatcher(w);
+ *
+ * Note:
+ * - Values are at most 8 bytes wide; the unused bytes of an event value are zero.
+ * - Timestamps are monotonic nanoseconds (QueryPerformanceCounter on Windows,
+ *   CLOCK_MONOTONIC on Linux). On Windows, intervals below the system timer
+ *   resolution (usually 1 ms or 15.6 ms) are rounded up to it.
+ * - Include `reader.h` before this header.
+ */
+
+#ifndef WATCHER_H
+#define WATCHER_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "reader.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define WATCH_MAX_WIDTH 8
+#define WATCH_BUFFER_SIZE (256 * 1024)
+
+typedef struct {
+    unsigned long long address;
+    unsigned char oldValue[WATCH_MAX_WIDTH];
+    unsigned char newValue[WATCH_MAX_WIDTH];
+    unsigned long long timestamp;
+} watch_event;
+
+// Ring indexes only grow; the slot is index & (capacity - 1).
+
+static inline SIZE_T watchLoadAcquire(volatile SIZE_T* index) {
+#ifdef _MSC_VER
+    SIZE_T value = *index;
+    _ReadWriteBarrier();
+    return value;
+#else
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void watchStoreRelease(volatile SIZE_T* index, SIZE_T value) {
+#ifdef _MSC_VER
+    _ReadWriteBarrier();
+    *index = value;
+#else
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+#endif
+}
+
+// Counters and settings shared with the consumer, without ordering.
+#ifdef _MSC_VER
+#define WATCH_LOAD(field) (field)
+#define WATCH_STORE(field, value) ((field) = (value))
+#else
+#define WATCH_LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define WATCH_STORE(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+#endif
+
+static unsigned long long watchClockNanos(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (unsigned long long)(now.QuadPart / frequency.QuadPart) * 1000000000ull
+        + (unsigned long long)(now.QuadPart % frequency.QuadPart) * 1000000000ull / frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec;
+#endif
+}
+
+// Stop signal, so destroying a watcher with a long interval does not wait it out.
+
+typedef struct {
+#ifdef _WIN32
+    HANDLE event;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int set;
+#endif
+} watch_signal;
+
+static int watchSignalInit(watch_signal* signal) {
+#ifdef _WIN32
+    signal->event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    return signal->event != NULL;
+#else
+    signal->set = 0;
+    if (pthread_mutex_init(&signal->lock, NULL) != 0)
+        return 0;
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    int ok = pthread_cond_init(&signal->wake, &attributes) == 0;
+    pthread_condattr_destroy(&attributes);
+    if (!ok)
+        pthread_mutex_destroy(&signal->lock);
+    return ok;
+#endif
+}
+
+static void watchSignalSet(watch_signal* signal) {
+#ifdef _WIN32
+    SetEvent(signal->event);
+#else
+    pthread_mutex_lock(&signal->lock);
+    signal->set = 1;
+    pthread_cond_signal(&signal->wake);
+    pthread_mutex_unlock(&signal->lock);
+#endif
+}
+
+// Waits up to `micros` microseconds. Returns 1 if the signal was set.
+static int watchSignalWait(watch_signal* signal, unsigned int micros) {
+#ifdef _WIN32
+    return WaitForSingleObject(signal->event, (micros + 999) / 1000) == WAIT_OBJECT_0;
+#else
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_sec += micros / 1000000;
+    until.tv_nsec += (long)(micros % 1000000) * 1000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&signal->lock);
+    while (!signal->set && pthread_cond_timedwait(&signal->wake, &signal->lock, &until) == 0) {
+    }
+    int set = signal->set;
+    pthread_mutex_unlock(&signal->lock);
+    return set;
+#endif
+}
+
+static void watchSignalDestroy(watch_signal* signal) {
+#ifdef _WIN32
+    CloseHandle(signal->event);
+#else
+    pthread_cond_destroy(&signal->wake);
+    pthread_mutex_destroy(&signal->lock);
+#endif
+}
+
+// Watcher
+
+typedef struct {
+    HANDLE hProcess;
+    unsigned char** addresses;
+    SIZE_T count;
+    SIZE_T width;
+    volatile unsigned int intervalMicros;
+    unsigned char* previous;
+    unsigned char* buffer;
+    int primed;
+
+    watch_event* ring;
+    SIZE_T capacity;
+    volatile SIZE_T head;
+    volatile SIZE_T tail;
+    volatile unsigned long long samples;
+    volatile unsigned long long dropped;
+    unsigned long long sampleTime;
+
+    watch_signal stop;
+    pool_thread thread;
+} memory_watcher;
+
+static void watchPush(memory_watcher* watcher, SIZE_T index, const unsigned char* value) {
+    SIZE_T head = watcher->head;
+    if (head - watchLoadAcquire(&watcher->tail) == watcher->capacity) {
+        WATCH_STORE(watcher->dropped, watcher->dropped + 1);
+        return;
+    }
+    watch_event* event = &watcher->ring[head & (watcher->capacity - 1)];
+    event->address = (unsigned long long)(SIZE_T)watcher->addresses[index];
+    memset(event->oldValue, 0, WATCH_MAX_WIDTH);
+    memset(event->newValue, 0, WATCH_MAX_WIDTH);
+    memcpy(event->oldValue, watcher->previous + index * watcher->width, watcher->width);
+    memcpy(event->newValue, value, watcher->width);
+    event->timestamp = watcher->sampleTime;
+    watchStoreRelease(&watcher->head, head + 1);
+}
+
+static void watchSampleVisitor(void* context, SIZE_T index, const unsigned char* value) {
+    memory_watcher* watcher = (memory_watcher*)context;
+    if (value == NULL)
+        return;
+    unsigned char* previous = watcher->previous + index * watcher->width;
+    if (watcher->primed && memcmp(previous, value, watcher->width) != 0)
+        watchPush(watcher, index, value);
+    memcpy(previous, value, watcher->width);
+}
+
+static POOL_THREAD_RETURN watchThreadMain(void* param) {
+    memory_watcher* watcher = (memory_watcher*)param;
+    do {
+        watcher->sampleTime = watchClockNanos();
+        readCandidates(watcher->hProcess, watcher->addresses, watcher->count, watcher->width, READER_DEFAULT_GAP,
+            watcher->buffer, WATCH_BUFFER_SIZE, watchSampleVisitor, watcher);
+        watcher->primed = 1;
+        WATCH_STORE(watcher->samples, watcher->samples + 1);
+    } while (!watchSignalWait(&watcher->stop, WATCH_LOAD(watcher->intervalMicros)));
+    return 0;
+}
+
+static void freeWatcherMemory(memory_watcher* watcher) {
+    free(watcher->addresses);
+    free(watcher->previous);
+    free(watcher->buffer);
+    free(watcher->ring);
+    free(watcher);
+}
+
+/*
+ * Copies addresses[0 .. count) and starts sampling them every intervalMicros.
+ * The ring holds `capacity` events, rounded up to a power of two.
+ * Returns NULL if width is not 1 .. 8 or memory or the thread cannot be allocated.
+ */
+static memory_watcher* createMemoryWatcher(HANDLE hProcess, unsigned char* const* addresses, SIZE_T count,
+    SIZE_T width, unsigned int intervalMicros, SIZE_T capacity) {
+    if (width == 0 || width > WATCH_MAX_WIDTH)
+        return NULL;
+    SIZE_T ringSize = 16;
+    while (ringSize < capacity && ringSize < ((SIZE_T)1 << (sizeof(SIZE_T) * 8 - 2)))
+        ringSize <<= 1;
+
+    memory_watcher* watcher = (memory_watcher*)calloc(1, sizeof(memory_watcher));
+    if (watcher == NULL)
+        return NULL;
+    watcher->hProcess = hProcess;
+    watcher->count = count;
+    watcher->width = width;
+    watcher->intervalMicros = intervalMicros;
+    watcher->capacity = ringSize;
+    watcher->addresses = (unsigned char**)malloc((count ? count : 1) * sizeof(unsigned char*));
+    watcher->previous = (unsigned char*)calloc(count ? count : 1, width);
+    watcher->buffer = (unsigned char*)malloc(WATCH_BUFFER_SIZE);
+    watcher->ring = (watch_event*)malloc(ringSize * sizeof(watch_event));
+    if (!watcher->addresses || !watcher->previous || !watcher->buffer || !watcher->ring) {
+        freeWatcherMemory(watcher);
+        return NULL;
+    }
+    if (count > 0)
+        memcpy(watcher->addresses, addresses, count * sizeof(unsigned char*));
+
+    if (!watchSignalInit(&watcher->stop)) {
+        freeWatcherMemory(watcher);
+        return NULL;
+    }
+#ifdef _WIN32
+    watcher->thread = CreateThread(NULL, 0, watchThreadMain, watcher, 0, NULL);
+    int started = watcher->thread != NULL;
+#else
+    int started = pthread_create(&watcher->thread, NULL, watchThreadMain, watcher) == 0;
+#endif
+    if (!started) {
+        watchSignalDestroy(&watcher->stop);
+        freeWatcherMemory(watcher);
+        return NULL;
+    }
+    return watcher;
+}
+
+// Copies up to max pending events to out, oldest first. Returns the number copied.
+static SIZE_T drainWatchEvents(memory_watcher* watcher, watch_event* out, SIZE_T max) {
+    SIZE_T tail = watcher->tail;
+    SIZE_T available = watchLoadAcquire(&watcher->head) - tail;
+    SIZE_T n = available < max ? available : max;
+    for (SIZE_T i = 0; i < n; i++)
+        out[i] = watcher->ring[(tail + i) & (watcher->capacity - 1)];
+    watchStoreRelease(&watcher->tail, tail + n);
+    return n;
+}
+
+static SIZE_T pendingWatchEvents(memory_watcher* watcher) {
+    return watchLoadAcquire(&watcher->head) - watcher->tail;
+}
+
+static unsigned long long watchSampleCount(memory_watcher* watcher) {
+    return WATCH_LOAD(watcher->samples);
+}
+
+static unsigned long long watchDroppedCount(memory_watcher* watcher) {
+    return WATCH_LOAD(watcher->dropped);
+}
+
+// Takes effect after the current wait.
+static void setWatchInterval(memory_watcher* watcher, unsigned int intervalMicros) {
+    WATCH_STORE(watcher->intervalMicros, intervalMicros);
+}
+
+// Stops the sampler thread and frees the watcher.
+static void destroyMemoryWatcher(memory_watcher* watcher) {
+    watchSignalSet(&watcher->stop);
+#ifdef _WIN32
+    WaitForSingleObject(watcher->thread, INFINITE);
+    CloseHandle(watcher->thread);
+#else
+    pthread_join(watcher->thread, NULL);
+#endif
+    watchSignalDestroy(&watcher->stop);
+    freeWatcherMemory(watcher);
+}
+
+#endif // WATCHER_H
@@ -1,6 +1,46 @@
 import ctypes
 
-memscan = ctypes.CDLL("pywinmemscanner/utils/backend/MemoryScanner.dll")
+
+class _MissingFunction(object):
+    """
+    Stands in for a function the loaded library does not export. argtypes and restype can
+    still be set; calling it raises NotImplementedError.
+    """
+    def __init__(self, name):
+        self.__name__ = name
+        self.argtypes = None
+        self.restype = None
+
+    def __call__(self, *args):
+        raise NotImplementedError(self.__name__ + " is not exported by the loaded MemoryScanner library, rebuild it from utils/backend/c/scanner.c!")
+
+
+class _Library(object):
+    """
+    The native library. A MemoryScanner.dll built before some of these bindings lacks their
+    exports; those resolve to a _MissingFunction, so the module still imports and every
+    function the library does export keeps working.
+    """
+    def __init__(self, path):
+        self.__library = ctypes.CDLL(path)
+
+    def __getattr__(self, name):
+        try:
+            function = getattr(self.__library, name)
+        except AttributeError:
+            function = _MissingFunction(name)
+        setattr(self, name, function)
+        return function
+
+
+memscan = _Library("pywinmemscanner/utils/backend/MemoryScanner.dll")
+
+
+def isExported(function):
+    """
+    Returns whether the loaded library exports 'function', i.e. it is not a _MissingFunction.
+    """
+    return not isinstance(function, _MissingFunction)
 
 HANDLE = ctypes.c_void_p
 UCP = ctypes.POINTER(ctypes.c_ubyte)
@@ -8,6 +48,16 @@ UCPP = ctypes.POINTER(ctypes.POINTER(ctypes.c_ubyte))
 INTP = ctypes.POINTER(ctypes.c_int)
 FLOATP = ctypes.POINTER(ctypes.c_float)
 DOUBLEP = ctypes.POINTER(ctypes.c_double)
+SNAPSHOTP = ctypes.c_void_p
+CANDIDATESP = ctypes.c_void_p
+POINTERMAPP = ctypes.c_void_p
+POINTERPATHSP = ctypes.c_void_p
+WATCHERP = ctypes.c_void_p
+REGIONMAPP = ctypes.c_void_p
+SCANTASKP = ctypes.c_void_p
+SESSIONP = ctypes.c_void_p
+VALUESTOREP = ctypes.c_void_p
+KEEPFUNC = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, UCP)
 
 
 class UCharAddressVector(ctypes.Structure):
@@ -16,12 +66,76 @@ class UCharAddressVector(ctypes.Structure):
                 ("capacity", ctypes.c_int)]
 
 
+class WatchEvent(ctypes.Structure):
+     _fields_ = [("address", ctypes.c_ulonglong),
+                ("oldValue", ctypes.c_ubyte * 8),
+                ("newValue", ctypes.c_ubyte * 8),
+                ("timestamp", ctypes.c_ulonglong)]
+
+
+class RegionFilter(ctypes.Structure):
+     _fields_ = [("module", ctypes.c_char * 128),
+                ("lo", ctypes.c_ulonglong),
+                ("hi", ctypes.c_ulonglong),
+                ("protect", ctypes.c_uint32),
+                ("type", ctypes.c_uint32),
+                ("minSize", ctypes.c_ulonglong),
+                ("maxSize", ctypes.c_ulonglong)]
+
+
+class ScanTaskStatus(ctypes.Structure):
+     _fields_ = [("bytesTotal", ctypes.c_ulonglong),
+                ("bytesDone", ctypes.c_ulonglong),
+                ("chunksTotal", ctypes.c_ulonglong),
+                ("chunksDone", ctypes.c_ulonglong),
+                ("hits", ctypes.c_ulonglong),
+                ("finished", ctypes.c_int),
+                ("result", ctypes.c_int),
+                ("cancelled", ctypes.c_int),
+                ("streamFailed", ctypes.c_int)]
+
+
+class ScanStats(ctypes.Structure):
+     _fields_ = [("regionsVisited", ctypes.c_ulonglong),
+                ("regionsSkipped", ctypes.c_ulonglong),
+                ("regionsFailed", ctypes.c_ulonglong),
+                ("bytesRead", ctypes.c_ulonglong),
+                ("readCalls", ctypes.c_ulonglong),
+                ("readFailures", ctypes.c_ulonglong),
+                ("candidates", ctypes.c_ulonglong),
+                ("hits", ctypes.c_ulonglong),
+                ("reallocs", ctypes.c_ulonglong),
+                ("nsRegions", ctypes.c_ulonglong),
+                ("nsRead", ctypes.c_ulonglong),
+                ("nsCompare", ctypes.c_ulonglong),
+                ("nsMerge", ctypes.c_ulonglong),
+                ("nsTotal", ctypes.c_ulonglong)]
+
+
+class GroupTerm(ctypes.Structure):
+     _fields_ = [("type", ctypes.c_int),
+                ("kind", ctypes.c_int),
+                ("offset", ctypes.c_int),
+                ("fixed", ctypes.c_int),
+                ("a", ctypes.c_ubyte * 8),
+                ("b", ctypes.c_ubyte * 8)]
+
+
 
 
 
 memscan.get_pid_by_name.argtypes = [ctypes.c_char_p]
 memscan.get_pid_by_name.restype = ctypes.c_int
 
+memscan.findProcessIdsByName.argtypes = [ctypes.c_char_p, INTP, ctypes.c_int]
+memscan.findProcessIdsByName.restype = ctypes.c_int
+
+memscan.getProcessTableAge.argtypes = None
+memscan.getProcessTableAge.restype = ctypes.c_uint
+
+memscan.setProcessTableAge.argtypes = [ctypes.c_uint]
+memscan.setProcessTableAge.restype = ctypes.c_uint
+
 memscan.getHandleByPID.argtypes = [ctypes.c_int]
 memscan.getHandleByPID.restype = HANDLE
 
@@ -70,7 +184,370 @@ memscan.scanNextDOUBLE.restype = ctypes.c_int
 memscan.freeAddressArray.argtypes = [ctypes.POINTER(UCharAddressVector)]
 memscan.freeAddressArray.restype = None
 
+memscan.filterAddressArray.argtypes = [ctypes.POINTER(UCharAddressVector), KEEPFUNC, ctypes.c_void_p]
+memscan.filterAddressArray.restype = ctypes.c_int
+
+memscan.readAddressValues.argtypes = [HANDLE, ctypes.POINTER(UCharAddressVector), ctypes.c_size_t, ctypes.c_void_p]
+memscan.readAddressValues.restype = ctypes.c_int
+
+memscan.readAddressArray.argtypes = [HANDLE, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_void_p, ctypes.c_void_p]
+memscan.readAddressArray.restype = ctypes.c_int
+
+memscan.writeAddressArray.argtypes = [HANDLE, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p]
+memscan.writeAddressArray.restype = ctypes.c_int
+# Watchers
+memscan.createWatcher.argtypes = [HANDLE, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_uint, ctypes.c_size_t]
+memscan.createWatcher.restype = WATCHERP
+
+memscan.freeWatcher.argtypes = [WATCHERP]
+memscan.freeWatcher.restype = None
+
+memscan.drainWatcher.argtypes = [WATCHERP, ctypes.POINTER(WatchEvent), ctypes.c_size_t]
+memscan.drainWatcher.restype = ctypes.c_size_t
+
+memscan.getWatcherPendingCount.argtypes = [WATCHERP]
+memscan.getWatcherPendingCount.restype = ctypes.c_size_t
+
+memscan.getWatcherSampleCount.argtypes = [WATCHERP]
+memscan.getWatcherSampleCount.restype = ctypes.c_ulonglong
+
+memscan.getWatcherDroppedCount.argtypes = [WATCHERP]
+memscan.getWatcherDroppedCount.restype = ctypes.c_ulonglong
+
+memscan.setWatcherInterval.argtypes = [WATCHERP, ctypes.c_uint]
+memscan.setWatcherInterval.restype = None
+# Region maps
+memscan.createRegionMap.argtypes = [HANDLE, ctypes.POINTER(RegionFilter)]
+memscan.createRegionMap.restype = REGIONMAPP
+
+memscan.filterRegionMap.argtypes = [REGIONMAPP, ctypes.POINTER(RegionFilter)]
+memscan.filterRegionMap.restype = REGIONMAPP
+
+memscan.refreshRegionMap.argtypes = [HANDLE, REGIONMAPP]
+memscan.refreshRegionMap.restype = ctypes.c_longlong
+
+memscan.freeRegionMap.argtypes = [REGIONMAPP]
+memscan.freeRegionMap.restype = None
+
+memscan.getRegionCount.argtypes = [REGIONMAPP]
+memscan.getRegionCount.restype = ctypes.c_size_t
+
+memscan.getRegionMapSize.argtypes = [REGIONMAPP]
+memscan.getRegionMapSize.restype = ctypes.c_ulonglong
+
+memscan.getRegion.argtypes = [REGIONMAPP, ctypes.c_size_t, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t),
+                              ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_int),
+                              ctypes.c_char_p, ctypes.c_size_t]
+memscan.getRegion.restype = ctypes.c_int
+
+memscan.setScanRegionMap.argtypes = [HANDLE, REGIONMAPP]
+memscan.setScanRegionMap.restype = ctypes.c_int
+# Typed scans
+memscan.getScanTypeWidth.argtypes = [ctypes.c_int]
+memscan.getScanTypeWidth.restype = ctypes.c_int
+
+memscan.scanTyped.argtypes = [HANDLE, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanTyped.restype = ctypes.c_int
+
+memscan.scanNextTyped.argtypes = [HANDLE, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.scanNextTyped.restype = ctypes.c_int
+
+memscan.scanTypedSet.argtypes = [HANDLE, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, CANDIDATESP]
+memscan.scanTypedSet.restype = ctypes.c_int
+
+memscan.scanNextTypedSet.argtypes = [HANDLE, CANDIDATESP, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.scanNextTypedSet.restype = ctypes.c_int
+
+memscan.scanTypedMulti.argtypes = [ctypes.POINTER(HANDLE), ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(ctypes.POINTER(UCharAddressVector)), INTP]
+memscan.scanTypedMulti.restype = ctypes.c_int
+
+memscan.readTyped.argtypes = [HANDLE, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.readTyped.restype = ctypes.c_int
+
+memscan.writeTyped.argtypes = [HANDLE, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.writeTyped.restype = ctypes.c_int
+# Scan tasks
+memscan.startScanTyped.argtypes = [HANDLE, ctypes.c_int, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int,
+                                   ctypes.POINTER(UCharAddressVector), CANDIDATESP, ctypes.c_int]
+memscan.startScanTyped.restype = SCANTASKP
+
+memscan.cancelScanTask.argtypes = [SCANTASKP]
+memscan.cancelScanTask.restype = None
+
+memscan.waitScanTask.argtypes = [SCANTASKP, ctypes.c_uint]
+memscan.waitScanTask.restype = ctypes.c_int
+
+memscan.getScanTaskStatus.argtypes = [SCANTASKP, ctypes.POINTER(ScanTaskStatus)]
+memscan.getScanTaskStatus.restype = None
+
+memscan.drainScanTask.argtypes = [SCANTASKP, ctypes.POINTER(ctypes.c_void_p), ctypes.c_size_t]
+memscan.drainScanTask.restype = ctypes.c_size_t
+
+memscan.getScanTaskPendingCount.argtypes = [SCANTASKP]
+memscan.getScanTaskPendingCount.restype = ctypes.c_size_t
+
+memscan.freeScanTask.argtypes = [SCANTASKP]
+memscan.freeScanTask.restype = None
+# Scan sessions
+memscan.createScanSession.argtypes = [HANDLE, ctypes.c_char_p, ctypes.c_int, ctypes.c_int]
+memscan.createScanSession.restype = SESSIONP
+
+memscan.openScanSession.argtypes = [ctypes.c_char_p]
+memscan.openScanSession.restype = SESSIONP
+
+memscan.matchScanSession.argtypes = [HANDLE, SESSIONP]
+memscan.matchScanSession.restype = ctypes.c_int
+
+memscan.scanTypedSession.argtypes = [HANDLE, SESSIONP, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+memscan.scanTypedSession.restype = ctypes.c_int
+
+memscan.scanNextTypedSession.argtypes = [HANDLE, SESSIONP, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.scanNextTypedSession.restype = ctypes.c_int
+
+memscan.getScanSessionCount.argtypes = [SESSIONP]
+memscan.getScanSessionCount.restype = ctypes.c_ulonglong
+
+memscan.getScanSessionType.argtypes = [SESSIONP]
+memscan.getScanSessionType.restype = ctypes.c_int
+
+memscan.getScanSessionValueWidth.argtypes = [SESSIONP]
+memscan.getScanSessionValueWidth.restype = ctypes.c_int
+
+memscan.getScanSessionProcessId.argtypes = [SESSIONP]
+memscan.getScanSessionProcessId.restype = ctypes.c_int
+
+memscan.getScanSessionScanCount.argtypes = [SESSIONP]
+memscan.getScanSessionScanCount.restype = ctypes.c_ulonglong
+
+memscan.copyScanSessionRecords.argtypes = [SESSIONP, ctypes.c_ulonglong, ctypes.c_ulonglong,
+                                           ctypes.POINTER(ctypes.c_ulonglong), ctypes.c_void_p]
+memscan.copyScanSessionRecords.restype = ctypes.c_ulonglong
+
+memscan.flushScanSession.argtypes = [SESSIONP]
+memscan.flushScanSession.restype = ctypes.c_int
+
+memscan.closeScanSession.argtypes = [SESSIONP]
+memscan.closeScanSession.restype = None
+# Value stores
+memscan.createValueStore.argtypes = [ctypes.c_int]
+memscan.createValueStore.restype = VALUESTOREP
+
+memscan.freeValueStore.argtypes = [VALUESTOREP]
+memscan.freeValueStore.restype = None
+
+memscan.scanTypedStore.argtypes = [HANDLE, VALUESTOREP, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+memscan.scanTypedStore.restype = ctypes.c_int
+
+memscan.scanNextTypedStore.argtypes = [HANDLE, VALUESTOREP, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.scanNextTypedStore.restype = ctypes.c_int
+
+memscan.scanNextRelativeStore.argtypes = [HANDLE, VALUESTOREP, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+memscan.scanNextRelativeStore.restype = ctypes.c_int
+
+memscan.getValueStoreCount.argtypes = [VALUESTOREP]
+memscan.getValueStoreCount.restype = ctypes.c_ulonglong
+
+memscan.getValueStoreType.argtypes = [VALUESTOREP]
+memscan.getValueStoreType.restype = ctypes.c_int
+
+memscan.getValueStoreMemoryUsage.argtypes = [VALUESTOREP]
+memscan.getValueStoreMemoryUsage.restype = ctypes.c_ulonglong
+
+memscan.copyValueStoreRecords.argtypes = [VALUESTOREP, ctypes.c_ulonglong, ctypes.c_ulonglong,
+                                          ctypes.POINTER(ctypes.c_ulonglong), ctypes.c_void_p]
+memscan.copyValueStoreRecords.restype = ctypes.c_ulonglong
+# Predicate scans
+memscan.scanPredicateINT.argtypes = [HANDLE, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanPredicateINT.restype = ctypes.c_int
+
+memscan.scanPredicateFLOAT.argtypes = [HANDLE, ctypes.c_int, ctypes.c_float, ctypes.c_float, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanPredicateFLOAT.restype = ctypes.c_int
+
+memscan.scanPredicateDOUBLE.argtypes = [HANDLE, ctypes.c_int, ctypes.c_double, ctypes.c_double, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanPredicateDOUBLE.restype = ctypes.c_int
+
+memscan.scanNextPredicateINT.argtypes = [HANDLE, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_int, ctypes.c_int]
+memscan.scanNextPredicateINT.restype = ctypes.c_int
+
+memscan.scanNextPredicateFLOAT.argtypes = [HANDLE, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_float, ctypes.c_float]
+memscan.scanNextPredicateFLOAT.restype = ctypes.c_int
+
+memscan.scanNextPredicateDOUBLE.argtypes = [HANDLE, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_double, ctypes.c_double]
+memscan.scanNextPredicateDOUBLE.restype = ctypes.c_int
+
+# Candidate sets
+memscan.createCandidateArray.argtypes = []
+memscan.createCandidateArray.restype = CANDIDATESP
+
+memscan.freeCandidateArray.argtypes = [CANDIDATESP]
+memscan.freeCandidateArray.restype = None
+
+memscan.getCandidateCount.argtypes = [CANDIDATESP]
+memscan.getCandidateCount.restype = ctypes.c_ulonglong
+
+memscan.getCandidateAddress.argtypes = [CANDIDATESP, ctypes.c_ulonglong]
+memscan.getCandidateAddress.restype = ctypes.c_void_p
+
+memscan.copyCandidateAddresses.argtypes = [CANDIDATESP, ctypes.c_ulonglong, ctypes.c_ulonglong, ctypes.POINTER(ctypes.c_void_p)]
+memscan.copyCandidateAddresses.restype = ctypes.c_ulonglong
+
+memscan.getCandidateMemoryUsage.argtypes = [CANDIDATESP]
+memscan.getCandidateMemoryUsage.restype = ctypes.c_size_t
+
+memscan.filterCandidateArray.argtypes = [CANDIDATESP, KEEPFUNC, ctypes.c_void_p]
+memscan.filterCandidateArray.restype = ctypes.c_int
+
+memscan.scanSetINT.argtypes = [HANDLE, ctypes.c_int, CANDIDATESP]
+memscan.scanSetINT.restype = ctypes.c_int
+
+memscan.scanNextSetINT.argtypes = [HANDLE, CANDIDATESP, ctypes.c_int]
+memscan.scanNextSetINT.restype = ctypes.c_int
+
+memscan.scanPredicateSetINT.argtypes = [HANDLE, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, CANDIDATESP]
+memscan.scanPredicateSetINT.restype = ctypes.c_int
+
+memscan.scanNextPredicateSetINT.argtypes = [HANDLE, CANDIDATESP, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+memscan.scanNextPredicateSetINT.restype = ctypes.c_int
+
+memscan.scanSetFLOAT.argtypes = [HANDLE, ctypes.c_float, CANDIDATESP]
+memscan.scanSetFLOAT.restype = ctypes.c_int
+
+memscan.scanNextSetFLOAT.argtypes = [HANDLE, CANDIDATESP, ctypes.c_float]
+memscan.scanNextSetFLOAT.restype = ctypes.c_int
+
+memscan.scanPredicateSetFLOAT.argtypes = [HANDLE, ctypes.c_int, ctypes.c_float, ctypes.c_float, ctypes.c_int, CANDIDATESP]
+memscan.scanPredicateSetFLOAT.restype = ctypes.c_int
+
+memscan.scanNextPredicateSetFLOAT.argtypes = [HANDLE, CANDIDATESP, ctypes.c_int, ctypes.c_float, ctypes.c_float]
+memscan.scanNextPredicateSetFLOAT.restype = ctypes.c_int
+
+memscan.scanSetDOUBLE.argtypes = [HANDLE, ctypes.c_double, CANDIDATESP]
+memscan.scanSetDOUBLE.restype = ctypes.c_int
+
+memscan.scanNextSetDOUBLE.argtypes = [HANDLE, CANDIDATESP, ctypes.c_double]
+memscan.scanNextSetDOUBLE.restype = ctypes.c_int
+
+memscan.scanPredicateSetDOUBLE.argtypes = [HANDLE, ctypes.c_int, ctypes.c_double, ctypes.c_double, ctypes.c_int, CANDIDATESP]
+memscan.scanPredicateSetDOUBLE.restype = ctypes.c_int
+
+memscan.scanNextPredicateSetDOUBLE.argtypes = [HANDLE, CANDIDATESP, ctypes.c_int, ctypes.c_double, ctypes.c_double]
+memscan.scanNextPredicateSetDOUBLE.restype = ctypes.c_int
+
+# Pattern scans
+memscan.scanPattern.argtypes = [HANDLE, ctypes.c_char_p, ctypes.c_int, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanPattern.restype = ctypes.c_int
+
+memscan.scanString.argtypes = [HANDLE, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanString.restype = ctypes.c_int
+
+memscan.scanGroup.argtypes = [HANDLE, ctypes.POINTER(GroupTerm), ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanGroup.restype = ctypes.c_int
+
+# Pointer scans
+memscan.createPointerMap.argtypes = [HANDLE]
+memscan.createPointerMap.restype = POINTERMAPP
+
+memscan.freePointerMap.argtypes = [POINTERMAPP]
+memscan.freePointerMap.restype = None
+
+memscan.getPointerMapSize.argtypes = [POINTERMAPP]
+memscan.getPointerMapSize.restype = ctypes.c_size_t
+
+memscan.savePointerMap.argtypes = [POINTERMAPP, ctypes.c_char_p]
+memscan.savePointerMap.restype = ctypes.c_int
+
+memscan.loadPointerMap.argtypes = [ctypes.c_char_p]
+memscan.loadPointerMap.restype = POINTERMAPP
+
+memscan.createPointerPathArray.argtypes = []
+memscan.createPointerPathArray.restype = POINTERPATHSP
+
+memscan.freePointerPathArray.argtypes = [POINTERPATHSP]
+memscan.freePointerPathArray.restype = None
+
+memscan.getPointerPathCount.argtypes = [POINTERPATHSP]
+memscan.getPointerPathCount.restype = ctypes.c_size_t
+
+memscan.getPointerPath.argtypes = [POINTERPATHSP, ctypes.c_size_t, ctypes.c_char_p, ctypes.POINTER(ctypes.c_ulonglong), ctypes.POINTER(ctypes.c_uint)]
+memscan.getPointerPath.restype = ctypes.c_int
+
+memscan.scanPointerPaths.argtypes = [POINTERMAPP, ctypes.c_void_p, ctypes.c_int, ctypes.c_uint, ctypes.c_size_t, POINTERPATHSP]
+memscan.scanPointerPaths.restype = ctypes.c_int
+
+memscan.intersectPointerPaths.argtypes = [POINTERPATHSP, POINTERPATHSP]
+memscan.intersectPointerPaths.restype = ctypes.c_longlong
+
+memscan.resolvePointerPath.argtypes = [HANDLE, POINTERPATHSP, ctypes.c_size_t]
+memscan.resolvePointerPath.restype = ctypes.c_void_p
+
+# Snapshot scans
+memscan.createSnapshot.argtypes = [HANDLE]
+memscan.createSnapshot.restype = SNAPSHOTP
+
+memscan.updateSnapshot.argtypes = [HANDLE, SNAPSHOTP]
+memscan.updateSnapshot.restype = ctypes.c_int
+
+memscan.getSnapshotPageCount.argtypes = [SNAPSHOTP]
+memscan.getSnapshotPageCount.restype = ctypes.c_size_t
+
+memscan.getSnapshotMemoryUsage.argtypes = [SNAPSHOTP]
+memscan.getSnapshotMemoryUsage.restype = ctypes.c_size_t
+
+memscan.freeSnapshot.argtypes = [SNAPSHOTP]
+memscan.freeSnapshot.restype = None
+
+memscan.scanSnapshotINT.argtypes = [HANDLE, SNAPSHOTP, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanSnapshotINT.restype = ctypes.c_int
+
+memscan.scanSnapshotFLOAT.argtypes = [HANDLE, SNAPSHOTP, ctypes.c_int, ctypes.c_float, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanSnapshotFLOAT.restype = ctypes.c_int
+
+memscan.scanSnapshotDOUBLE.argtypes = [HANDLE, SNAPSHOTP, ctypes.c_int, ctypes.c_double, ctypes.c_int, ctypes.POINTER(UCharAddressVector)]
+memscan.scanSnapshotDOUBLE.restype = ctypes.c_int
+
+memscan.scanNextSnapshotINT.argtypes = [HANDLE, SNAPSHOTP, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_int]
+memscan.scanNextSnapshotINT.restype = ctypes.c_int
+
+memscan.scanNextSnapshotFLOAT.argtypes = [HANDLE, SNAPSHOTP, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_float]
+memscan.scanNextSnapshotFLOAT.restype = ctypes.c_int
+
+memscan.scanNextSnapshotDOUBLE.argtypes = [HANDLE, SNAPSHOTP, ctypes.POINTER(UCharAddressVector), ctypes.c_int, ctypes.c_double]
+memscan.scanNextSnapshotDOUBLE.restype = ctypes.c_int
+# Scan kernels
+memscan.getScanISA.argtypes = None
+memscan.getScanISA.restype = ctypes.c_int
+
+memscan.setScanISA.argtypes = [ctypes.c_int]
+memscan.setScanISA.restype = ctypes.c_int
+
+memscan.getScanThreadCount.argtypes = None
+memscan.getScanThreadCount.restype = ctypes.c_int
+
+memscan.setScanThreadCount.argtypes = [ctypes.c_int]
+memscan.setScanThreadCount.restype = ctypes.c_int
+
+memscan.getNextScanGap.argtypes = None
+memscan.getNextScanGap.restype = ctypes.c_size_t
+
+memscan.setNextScanGap.argtypes = [ctypes.c_size_t]
+memscan.setNextScanGap.restype = ctypes.c_size_t
+
+memscan.releaseScanBuffers.argtypes = None
+memscan.releaseScanBuffers.restype = None
+
+memscan.setScanStats.argtypes = [ctypes.c_int]
+memscan.setScanStats.restype = ctypes.c_int
+
+memscan.getScanStatsEnabled.argtypes = None
+memscan.getScanStatsEnabled.restype = ctypes.c_int
+
+memscan.getLastScanStats.argtypes = [ctypes.POINTER(ScanStats)]
+memscan.getLastScanStats.restype = None
+
 get_pid_by_name = memscan.get_pid_by_name
+findProcessIdsByName = memscan.findProcessIdsByName
+getProcessTableAge = memscan.getProcessTableAge
+setProcessTableAge = memscan.setProcessTableAge
 getHandleByPID = memscan.getHandleByPID
 closeHandle = memscan.closeHandle
 createAddressArray = memscan.createAddressArray
@@ -87,3 +564,120 @@ scanNextINT = memscan.scanNextINT
 scanNextFLOAT = memscan.scanNextFLOAT
 scanNextDOUBLE = memscan.scanNextDOUBLE
 freeAddressArray = memscan.freeAddressArray
+filterAddressArray = memscan.filterAddressArray
+readAddressValues = memscan.readAddressValues
+readAddressArray = memscan.readAddressArray
+writeAddressArray = memscan.writeAddressArray
+createWatcher = memscan.createWatcher
+freeWatcher = memscan.freeWatcher
+drainWatcher = memscan.drainWatcher
+getWatcherPendingCount = memscan.getWatcherPendingCount
+getWatcherSampleCount = memscan.getWatcherSampleCount
+getWatcherDroppedCount = memscan.getWatcherDroppedCount
+setWatcherInterval = memscan.setWatcherInterval
+createRegionMap = memscan.createRegionMap
+filterRegionMap = memscan.filterRegionMap
+refreshRegionMap = memscan.refreshRegionMap
+freeRegionMap = memscan.freeRegionMap
+getRegionCount = memscan.getRegionCount
+getRegionMapSize = memscan.getRegionMapSize
+getRegion = memscan.getRegion
+setScanRegionMap = memscan.setScanRegionMap
+getScanTypeWidth = memscan.getScanTypeWidth
+scanTyped = memscan.scanTyped
+scanNextTyped = memscan.scanNextTyped
+scanTypedSet = memscan.scanTypedSet
+scanNextTypedSet = memscan.scanNextTypedSet
+scanTypedMulti = memscan.scanTypedMulti
+readTyped = memscan.readTyped
+writeTyped = memscan.writeTyped
+startScanTyped = memscan.startScanTyped
+cancelScanTask = memscan.cancelScanTask
+waitScanTask = memscan.waitScanTask
+getScanTaskStatus = memscan.getScanTaskStatus
+drainScanTask = memscan.drainScanTask
+getScanTaskPendingCount = memscan.getScanTaskPendingCount
+freeScanTask = memscan.freeScanTask
+createScanSession = memscan.createScanSession
+openScanSession = memscan.openScanSession
+matchScanSession = memscan.matchScanSession
+scanTypedSession = memscan.scanTypedSession
+scanNextTypedSession = memscan.scanNextTypedSession
+getScanSessionCount = memscan.getScanSessionCount
+getScanSessionType = memscan.getScanSessionType
+getScanSessionValueWidth = memscan.getScanSessionValueWidth
+getScanSessionProcessId = memscan.getScanSessionProcessId
+getScanSessionScanCount = memscan.getScanSessionScanCount
+copyScanSessionRecords = memscan.copyScanSessionRecords
+flushScanSession = memscan.flushScanSession
+closeScanSession = memscan.closeScanSession
+createValueStore = memscan.createValueStore
+freeValueStore = memscan.freeValueStore
+scanTypedStore = memscan.scanTypedStore
+scanNextTypedStore = memscan.scanNextTypedStore
+scanNextRelativeStore = memscan.scanNextRelativeStore
+getValueStoreCount = memscan.getValueStoreCount
+getValueStoreType = memscan.getValueStoreType
+getValueStoreMemoryUsage = memscan.getValueStoreMemoryUsage
+copyValueStoreRecords = memscan.copyValueStoreRecords
+scanPredicateINT = memscan.scanPredicateINT
+scanPredicateFLOAT = memscan.scanPredicateFLOAT
+scanPredicateDOUBLE = memscan.scanPredicateDOUBLE
+scanNextPredicateINT = memscan.scanNextPredicateINT
+scanNextPredicateFLOAT = memscan.scanNextPredicateFLOAT
+scanNextPredicateDOUBLE = memscan.scanNextPredicateDOUBLE
+createCandidateArray = memscan.createCandidateArray
+freeCandidateArray = memscan.freeCandidateArray
+getCandidateCount = memscan.getCandidateCount
+getCandidateAddress = memscan.getCandidateAddress
+copyCandidateAddresses = memscan.copyCandidateAddresses
+getCandidateMemoryUsage = memscan.getCandidateMemoryUsage
+filterCandidateArray = memscan.filterCandidateArray
+scanSetINT = memscan.scanSetINT
+scanNextSetINT = memscan.scanNextSetINT
+scanPredicateSetINT = memscan.scanPredicateSetINT
+scanNextPredicateSetINT = memscan.scanNextPredicateSetINT
+scanSetFLOAT = memscan.scanSetFLOAT
+scanNextSetFLOAT = memscan.scanNextSetFLOAT
+scanPredicateSetFLOAT = memscan.scanPredicateSetFLOAT
+scanNextPredicateSetFLOAT = memscan.scanNextPredicateSetFLOAT
+scanSetDOUBLE = memscan.scanSetDOUBLE
+scanNextSetDOUBLE = memscan.scanNextSetDOUBLE
+scanPredicateSetDOUBLE = memscan.scanPredicateSetDOUBLE
+scanNextPredicateSetDOUBLE = memscan.scanNextPredicateSetDOUBLE
+scanPattern = memscan.scanPattern
+scanString = memscan.scanString
+scanGroup = memscan.scanGroup
+createPointerMap = memscan.createPointerMap
+freePointerMap = memscan.freePointerMap
+getPointerMapSize = memscan.getPointerMapSize
+savePointerMap = memscan.savePointerMap
+loadPointerMap = memscan.loadPointerMap
+createPointerPathArray = memscan.createPointerPathArray
+freePointerPathArray = memscan.freePointerPathArray
+getPointerPathCount = memscan.getPointerPathCount
+getPointerPath = memscan.getPointerPath
+scanPointerPaths = memscan.scanPointerPaths
+intersectPointerPaths = memscan.intersectPointerPaths
+resolvePointerPath = memscan.resolvePointerPath
+createSnapshot = memscan.createSnapshot
+updateSnapshot = memscan.updateSnapshot
+getSnapshotPageCount = memscan.getSnapshotPageCount
+getSnapshotMemoryUsage = memscan.getSnapshotMemoryUsage
+freeSnapshot = memscan.freeSnapshot
+scanSnapshotINT = memscan.scanSnapshotINT
+scanSnapshotFLOAT = memscan.scanSnapshotFLOAT
+scanSnapshotDOUBLE = memscan.scanSnapshotDOUBLE
+scanNextSnapshotINT = memscan.scanNextSnapshotINT
+scanNextSnapshotFLOAT = memscan.scanNextSnapshotFLOAT
+scanNextSnapshotDOUBLE = memscan.scanNextSnapshotDOUBLE
+getScanISA = memscan.getScanISA
+setScanISA = memscan.setScanISA
+getScanThreadCount = memscan.getScanThreadCount
+setScanThreadCount = memscan.setScanThreadCount
+getNextScanGap = memscan.getNextScanGap
+setNextScanGap = memscan.setNextScanGap
+releaseScanBuffers = memscan.releaseScanBuffers
+setScanStats = memscan.setScanStats
+getScanStatsEnabled = memscan.getScanStatsEnabled
+getLastScanStats = memscan.getLastScanStats